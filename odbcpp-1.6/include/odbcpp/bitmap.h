@@ -0,0 +1,71 @@
+//
+// File:	include/odbcpp/bitmap.h
+// Object:	Define the validity bitmap of the odbcpp library
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_BITMAP
+#define ODBCPP_BITMAP
+
+#include	"odbcpp_config.h"
+#include	<sql.h>
+#include	<sqlext.h>
+#include	<vector>
+
+namespace odbcpp
+{
+
+
+
+class validity_bitmap
+{
+public:
+	/// The value returned by next_valid() and next_null() when no row is found
+	static const SQLULEN	npos = static_cast<SQLULEN>(-1);
+
+				validity_bitmap() : f_size(0), f_null_count(0) {}
+
+	void			assign(const SQLLEN *indicators, SQLULEN count);
+	void			clear();
+
+	SQLULEN			size() const { return f_size; }
+	SQLULEN			null_count() const { return f_null_count; }
+	SQLULEN			valid_count() const { return f_size - f_null_count; }
+	bool			is_valid(SQLULEN row) const { return (f_words[row / 64] >> (row % 64)) & 1; }
+	bool			is_null(SQLULEN row) const { return !is_valid(row); }
+	SQLULEN			next_valid(SQLULEN row) const;
+	SQLULEN			next_null(SQLULEN row) const;
+
+	const SQLUBIGINT *	words() const { return f_words.empty() ? 0 : &f_words[0]; }
+	SQLULEN			word_count() const { return f_words.size(); }
+
+private:
+	std::vector<SQLUBIGINT>	f_words;
+	SQLULEN			f_size;
+	SQLULEN			f_null_count;
+};
+
+
+SQLULEN		count_nulls(const SQLLEN *indicators, SQLULEN count);
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_BITMAP
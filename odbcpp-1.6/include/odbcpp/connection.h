@@ -24,6 +24,10 @@
 #define ODBCPP_CONNECTION
 
 #include	"environment.h"
+#include	"connection_string.h"
+#include	"statistics.h"
+#include	"slow_query.h"
+#include	"result_cache.h"
 
 namespace odbcpp
 {
@@ -40,13 +44,32 @@ public:
 	void			set_attr(SQLINTEGER attr, SQLINTEGER integer);
 	void			set_attr(SQLINTEGER attr, SQLPOINTER ptr, SQLINTEGER length);
 	void			connect(const std::string& dns, const std::string& login, const std::string& passwd);
+	void			connect_string(const std::string& str, const std::string& presets = std::string());
 	void			disconnect();
 	void			commit();
 	void			rollback();
 
+	statistics_t		get_statistics() const { return f_statistics; }
+	void			reset_statistics() { f_statistics.reset(); }
+
+	void			set_slow_query_log(slow_query_sink *sink, SQLUBIGINT time_threshold,
+					SQLLEN rows_threshold = 0, SQLUINTEGER max_per_second = 10);
+
+	void			set_result_cache(result_cache *cache) { f_result_cache = cache; }
+	result_cache *		get_result_cache() const { return f_result_cache; }
+
+	void			set_timeout(SQLUBIGINT timeout) { f_timeout = timeout; }
+	SQLUBIGINT		get_timeout() const { return f_timeout; }
+
 private:
+	friend class statement;
+
 	smartptr<environment>	f_environment;
 	bool			f_connected;
+	statistics_t		f_statistics;
+	slow_query_log		f_slow_query_log;
+	result_cache *		f_result_cache;
+	SQLUBIGINT		f_timeout;
 };
 
 
@@ -0,0 +1,67 @@
+//
+// File:	include/odbcpp/connection_string.h
+// Object:	Define the connection string object of the odbcpp library
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_CONNECTION_STRING
+#define ODBCPP_CONNECTION_STRING
+
+#include	"odbcpp_config.h"
+#include	<string>
+#include	<utility>
+#include	<vector>
+
+namespace odbcpp
+{
+
+
+
+class connection_string
+{
+public:
+				connection_string(const std::string& str = std::string());
+
+	void			parse(const std::string& str, bool replace = true);
+	void			set(const std::string& key, const std::string& value, bool replace = true);
+	bool			exists(const std::string& key) const;
+	std::string		get(const std::string& key) const;
+	void			add_preset(const std::string& name);
+	std::string		to_string() const;
+
+	static void		define_preset(const std::string& name, const std::string& settings);
+	static bool		has_preset(const std::string& name);
+
+private:
+	/// A key and its value
+	typedef std::pair<std::string, std::string>	value_t;
+	/// The keys and values in the order they were defined
+	typedef std::vector<value_t>			value_vector_t;
+
+	value_vector_t::iterator	find(const std::string& key);
+	value_vector_t::const_iterator	find(const std::string& key) const;
+
+	value_vector_t		f_values;
+};
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_CONNECTION_STRING
@@ -0,0 +1,54 @@
+//
+// File:	include/odbcpp/datetime.h
+// Object:	Define the date and timestamp conversions of the odbcpp library
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_DATETIME
+#define ODBCPP_DATETIME
+
+#include	"odbcpp_config.h"
+#include	<sql.h>
+#include	<sqlext.h>
+#include	<chrono>
+
+namespace odbcpp
+{
+
+
+
+// one value at a time
+SQLINTEGER	date_to_epoch_days(const SQL_DATE_STRUCT& date);
+void		epoch_days_to_date(SQLINTEGER days, SQL_DATE_STRUCT& date);
+SQLBIGINT	timestamp_to_epoch_ns(const SQL_TIMESTAMP_STRUCT& timestamp);
+void		epoch_ns_to_timestamp(SQLBIGINT ns, SQL_TIMESTAMP_STRUCT& timestamp);
+std::chrono::system_clock::time_point	timestamp_to_time_point(const SQL_TIMESTAMP_STRUCT& timestamp);
+void		time_point_to_timestamp(const std::chrono::system_clock::time_point& time_point, SQL_TIMESTAMP_STRUCT& timestamp);
+
+// arrays as read or written with a rowset
+SQLULEN		dates_to_epoch_days(const SQL_DATE_STRUCT *dates, const SQLLEN *indicators, SQLULEN count, SQLINTEGER *days, SQLINTEGER null_value = 0);
+void		epoch_days_to_dates(const SQLINTEGER *days, const SQLLEN *indicators, SQLULEN count, SQL_DATE_STRUCT *dates);
+SQLULEN		timestamps_to_epoch_ns(const SQL_TIMESTAMP_STRUCT *timestamps, const SQLLEN *indicators, SQLULEN count, SQLBIGINT *ns, SQLBIGINT null_value = 0);
+void		epoch_ns_to_timestamps(const SQLBIGINT *ns, const SQLLEN *indicators, SQLULEN count, SQL_TIMESTAMP_STRUCT *timestamps);
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_DATETIME
@@ -60,6 +60,7 @@ public:
 			diagnostic(SQLSMALLINT handle_type, SQLHANDLE hdl, handle *parent = 0);
 
 	void		set(SQLSMALLINT handle_type, SQLHANDLE handle);
+	void		clear() { f_affected_rows = 0; f_diag.clear(); }
 	std::string	msg() const;
 
 	SQLLEN		get_affected_rows() const { return f_affected_rows; }
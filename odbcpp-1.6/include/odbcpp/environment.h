@@ -24,7 +24,9 @@
 #define ODBCPP_ENVIRONMENT
 
 #include	"handle.h"
+#include	"statistics.h"
 #include	<sqlext.h>
+#include	<mutex>
 
 namespace odbcpp
 {
@@ -54,7 +56,21 @@ public:
 	void			commit();
 	void			rollback();
 
+	static void		set_connection_pooling(SQLUINTEGER pooling = SQL_CP_ONE_PER_HENV);
+	void			set_pool_match(SQLUINTEGER match = SQL_CP_RELAXED_MATCH);
+	void			set_reuse_threshold(SQLUBIGINT threshold);
+	connect_statistics_t	get_connect_statistics() const;
+	void			reset_connect_statistics();
+
 private:
+	friend class connection;
+
+	void			add_connect(SQLUBIGINT elapsed);
+	void			add_disconnect(SQLUBIGINT elapsed);
+
+	mutable std::mutex	f_mutex;
+	SQLUBIGINT		f_reuse_threshold;
+	connect_statistics_t	f_connect_statistics;
 };
 
 
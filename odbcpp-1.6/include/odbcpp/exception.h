@@ -49,6 +49,8 @@ public:
 	static const SQLINTEGER		ODBCPP_TYPE_MISMATCH = 5;
 	/// The specified item (a column?) was not found
 	static const SQLINTEGER		ODBCPP_NOT_FOUND = 6;
+	/// The query did not complete within its time limit and was canceled
+	static const SQLINTEGER		ODBCPP_TIMEOUT = 7;
 
 			odbcpp_error(const diagnostic& diag) :
 				std::runtime_error(diag.msg()),
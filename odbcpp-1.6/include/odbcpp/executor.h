@@ -0,0 +1,300 @@
+//
+// File:	include/odbcpp/executor.h
+// Object:	Define the query executor of the odbcpp library
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_EXECUTOR
+#define ODBCPP_EXECUTOR
+
+#include	"record.h"
+#include	<atomic>
+#include	<condition_variable>
+#include	<functional>
+#include	<future>
+#include	<memory>
+#include	<mutex>
+#include	<thread>
+
+namespace odbcpp
+{
+
+
+
+template<class T>
+class bounded_queue
+{
+public:
+				bounded_queue(size_t size);
+
+	bool			push(const T& value);
+	bool			pop(T& value);
+
+private:
+	struct cell_t {
+		std::atomic<size_t>	f_sequence;
+		T			f_data;
+	};
+
+	// no copy
+				bounded_queue(const bounded_queue& queue);
+	bounded_queue&		operator = (const bounded_queue& queue);
+
+	static size_t		round_size(size_t size);
+
+	// the positions are on their own cache line
+	char			f_pad0[64];
+	const size_t		f_mask;
+	std::unique_ptr<cell_t[]>	f_cells;
+	char			f_pad1[64];
+	std::atomic<size_t>	f_enqueue_position;
+	char			f_pad2[64];
+	std::atomic<size_t>	f_dequeue_position;
+	char			f_pad3[64];
+};
+
+
+class executor
+{
+public:
+	typedef std::function<void (const dynamic_record& rec)>	row_handler_t;
+
+				executor(environment& env, const std::string& connect,
+					SQLULEN workers = 4, SQLULEN queue_size = 1024);
+				~executor();
+
+	std::future<SQLULEN>	execute(const std::string& sql, const row_handler_t& handler = row_handler_t(),
+					SQLULEN rowset_size = 64);
+	template<class R, class F>
+	std::future<R>		submit(F task);
+
+	SQLULEN			workers() const { return f_workers.size(); }
+	SQLUBIGINT		completed() const { return f_completed; }
+	SQLUBIGINT		steals() const { return f_steals; }
+
+private:
+	struct worker_t;
+
+	class job_t
+	{
+	public:
+		virtual			~job_t() {}
+
+		virtual void		run(worker_t& worker) = 0;
+	};
+
+	class query_job;
+
+	struct worker_t {
+					worker_t(environment& env, SQLULEN queue_size) : f_connection(env), f_queue(queue_size) {}
+
+		connection			f_connection;
+		std::unique_ptr<statement>	f_statement;
+		dynamic_record			f_record;
+		bounded_queue<job_t *>		f_queue;
+		std::thread			f_thread;
+	};
+
+	template<class R, class F>
+	class task_job : public job_t
+	{
+	public:
+					task_job(F task) : f_task(task) {}
+
+		virtual void		run(worker_t& worker) { f_task(worker.f_connection); }
+		std::future<R>		get_future() { return f_task.get_future(); }
+
+	private:
+		std::packaged_task<R (connection&)>	f_task;
+	};
+
+	// no copy
+				executor(const executor& exec);
+	executor&		operator = (const executor& exec);
+
+	void			enqueue(job_t *job);
+	job_t *			next_job(SQLULEN index);
+	void			run(SQLULEN index);
+	void			stop();
+
+	std::vector<std::unique_ptr<worker_t> >	f_workers;
+	std::atomic<SQLULEN>	f_next;
+	std::atomic<SQLULEN>	f_sleeping;
+	std::mutex		f_mutex;
+	std::condition_variable	f_condition;
+	bool			f_stop;
+	std::atomic<SQLUBIGINT>	f_completed;
+	std::atomic<SQLUBIGINT>	f_steals;
+};
+
+
+/** \class bounded_queue
+ *
+ * \brief A lock free queue for many producers and many consumers.
+ *
+ * This queue is an array of cells used as a ring buffer. Each cell
+ * has a sequence number telling whether it is free for the producer
+ * at a given position or holds the value for the consumer at that
+ * position. Producers and consumers only compete on one atomic
+ * position each and never wait on each other.
+ *
+ * The size is fixed: push() fails when the queue is full and pop()
+ * fails when it is empty.
+ */
+
+
+/** \brief Initialize a bounded queue.
+ *
+ * \param[in] size   The number of items, rounded up to a power of 2
+ */
+template<class T>
+bounded_queue<T>::bounded_queue(size_t size) :
+	//f_pad0 -- not used
+	f_mask(round_size(size) - 1),
+	f_cells(new cell_t[f_mask + 1]),
+	//f_pad1 -- not used
+	f_enqueue_position(0),
+	//f_pad2 -- not used
+	f_dequeue_position(0)
+	//f_pad3 -- not used
+{
+	for(size_t idx = 0; idx <= f_mask; ++idx) {
+		f_cells[idx].f_sequence.store(idx, std::memory_order_relaxed);
+	}
+}
+
+
+/** \brief Add a value at the end of the queue.
+ *
+ * \param[in] value   The value to add
+ *
+ * \return true if the value was added, false if the queue is full.
+ */
+template<class T>
+bool bounded_queue<T>::push(const T& value)
+{
+	cell_t *cell;
+	size_t position = f_enqueue_position.load(std::memory_order_relaxed);
+	for(;;) {
+		cell = &f_cells[position & f_mask];
+		size_t sequence = cell->f_sequence.load(std::memory_order_acquire);
+		ptrdiff_t diff = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position);
+		if(diff == 0) {
+			// the cell is free, try to reserve it
+			if(f_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if(diff < 0) {
+			// the consumers did not free this cell yet
+			return false;
+		}
+		else {
+			position = f_enqueue_position.load(std::memory_order_relaxed);
+		}
+	}
+	cell->f_data = value;
+	cell->f_sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+
+/** \brief Remove the value at the start of the queue.
+ *
+ * \param[out] value   The value removed from the queue
+ *
+ * \return true if a value was removed, false if the queue is empty.
+ */
+template<class T>
+bool bounded_queue<T>::pop(T& value)
+{
+	cell_t *cell;
+	size_t position = f_dequeue_position.load(std::memory_order_relaxed);
+	for(;;) {
+		cell = &f_cells[position & f_mask];
+		size_t sequence = cell->f_sequence.load(std::memory_order_acquire);
+		ptrdiff_t diff = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position + 1);
+		if(diff == 0) {
+			// the cell holds a value, try to take it
+			if(f_dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if(diff < 0) {
+			// the producers did not fill this cell yet
+			return false;
+		}
+		else {
+			position = f_dequeue_position.load(std::memory_order_relaxed);
+		}
+	}
+	value = cell->f_data;
+	cell->f_sequence.store(position + f_mask + 1, std::memory_order_release);
+	return true;
+}
+
+
+/** \brief Compute the size of the ring buffer.
+ *
+ * \param[in] size   The requested size
+ *
+ * \return The smallest power of 2 larger or equal to \p size, at least 2.
+ */
+template<class T>
+size_t bounded_queue<T>::round_size(size_t size)
+{
+	size_t result = 2;
+	while(result < size) {
+		result <<= 1;
+	}
+	return result;
+}
+
+
+/** \brief Run a task on the connection of a worker.
+ *
+ * This function queues \p task which is later called by a worker
+ * thread with its connection. The future returns the value returned
+ * by the task or the exception it raised. The type of the result has
+ * to be specified:
+ *
+ * \code
+ * std::future<SQLLEN> count(exec.submit<SQLLEN>(purge_sessions));
+ * \endcode
+ *
+ * The connection must only be used during the call.
+ *
+ * \param[in] task   The function called with the connection of a worker
+ *
+ * \return A future with the result of the task.
+ */
+template<class R, class F>
+std::future<R> executor::submit(F task)
+{
+	task_job<R, F> *job = new task_job<R, F>(task);
+	std::future<R> result(job->get_future());
+	enqueue(job);
+	return result;
+}
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_EXECUTOR
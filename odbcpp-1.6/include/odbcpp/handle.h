@@ -26,10 +26,32 @@
 
 #include	"exception.h"
 #include	"object.h"
+#include	<atomic>
 
 namespace odbcpp
 {
 
+struct trace_event_t
+{
+	SQLSMALLINT		f_handle_type;
+	SQLHANDLE		f_handle;
+	SQLUSMALLINT		f_function;
+	SQLRETURN		f_return_code;
+	SQLUBIGINT		f_elapsed;
+	const char *		f_sql;
+};
+
+
+class trace_hook
+{
+public:
+	virtual			~trace_hook() {}
+
+	virtual void		begin(const trace_event_t& event) = 0;
+	virtual void		end(const trace_event_t& event) = 0;
+};
+
+
 class handle : public object
 {
 public:
@@ -37,12 +59,21 @@ public:
 				~handle();
 
 	SQLRETURN		check(SQLRETURN return_code, handle *parent = 0) const;
+	SQLRETURN		diagnose(SQLRETURN return_code, handle *parent = 0) const;
 
 	SQLHANDLE		get_handle() const { return f_handle; }
 	SQLSMALLINT		get_handle_type() const { return f_handle_type; }
 	const diagnostic&	get_diagnostic() const { return f_diag; }
 
+	// tracing of the ODBC calls
+	static void		set_trace_hook(trace_hook *hook);
+	static trace_hook *	get_trace_hook() { return g_trace_hook.load(std::memory_order_acquire); }
+	void			trace(SQLUSMALLINT function, const char *sql = 0) const { if(get_trace_hook() != 0) trace_begin(function, sql); }
+	void			trace_done(SQLRETURN return_code) const { if(f_trace_hook != 0) trace_end(return_code); }
+
 protected:
+	void			set_diagnostic(const diagnostic& diag) const { f_diag = diag; }
+
 	SQLHANDLE		f_handle;
 	const SQLSMALLINT	f_handle_type;
 
@@ -52,7 +83,44 @@ private:
 	/// Cannot copy handles, really, won't work!
 	handle&			operator = (const handle& hdl) { return *this; }
 
+	void			trace_begin(SQLUSMALLINT function, const char *sql) const;
+	void			trace_end(SQLRETURN return_code) const;
+
+	static std::atomic<trace_hook *>	g_trace_hook;
+
 	mutable diagnostic	f_diag;
+	mutable trace_hook *	f_trace_hook;
+	mutable trace_event_t	f_trace_event;
+	mutable SQLUBIGINT	f_trace_start;
+};
+
+
+class trace_call
+{
+public:
+				trace_call(SQLSMALLINT handle_type, SQLHANDLE hdl, SQLUSMALLINT function) :
+					f_hook(handle::get_trace_hook())
+					//f_event -- initialized by begin()
+					//f_start -- initialized by begin()
+				{
+					if(f_hook != 0) {
+						begin(handle_type, hdl, function);
+					}
+				}
+
+	SQLRETURN		done(SQLRETURN return_code) { if(f_hook != 0) end(return_code); return return_code; }
+
+private:
+	// no copy
+				trace_call(const trace_call& call);
+	trace_call&		operator = (const trace_call& call);
+
+	void			begin(SQLSMALLINT handle_type, SQLHANDLE hdl, SQLUSMALLINT function);
+	void			end(SQLRETURN return_code);
+
+	trace_hook *		f_hook;
+	trace_event_t		f_event;
+	SQLUBIGINT		f_start;
 };
 
 
@@ -0,0 +1,164 @@
+//
+// File:	include/odbcpp/lookup_batcher.h
+// Object:	Define the lookup batcher of the odbcpp library
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_LOOKUP_BATCHER
+#define ODBCPP_LOOKUP_BATCHER
+
+#include	"record.h"
+#include	<condition_variable>
+#include	<exception>
+#include	<future>
+#include	<map>
+#include	<memory>
+#include	<mutex>
+#include	<thread>
+
+namespace odbcpp
+{
+
+
+
+class lookup_request
+{
+public:
+	virtual			~lookup_request() {}
+
+	virtual void		row(const dynamic_record& rec) = 0;
+	virtual void		done() = 0;
+	virtual void		failed(std::exception_ptr error) = 0;
+};
+
+
+template<class T, class F>
+class lookup_future_request : public lookup_request
+{
+public:
+				lookup_future_request(F projection) : f_projection(projection) {}
+
+	virtual void		row(const dynamic_record& rec) { f_rows.push_back(f_projection(rec)); }
+	virtual void		done() { f_promise.set_value(std::move(f_rows)); }
+	virtual void		failed(std::exception_ptr error) { f_promise.set_exception(error); }
+
+	std::future<std::vector<T> >	get_future() { return f_promise.get_future(); }
+
+private:
+	F				f_projection;
+	std::vector<T>			f_rows;
+	std::promise<std::vector<T> >	f_promise;
+};
+
+
+class lookup_batcher
+{
+public:
+	typedef std::shared_ptr<lookup_request>	request_pointer_t;
+
+				lookup_batcher(environment& env, const std::string& connect, const std::string& sql,
+					SQLUSMALLINT key_column, SQLULEN max_batch = 100, SQLUBIGINT window = 1000000);
+				~lookup_batcher();
+
+	void			load(SQLBIGINT key, const request_pointer_t& request);
+	void			load(const std::string& key, const request_pointer_t& request);
+	template<class T, class K, class F>
+	std::future<std::vector<T> >	load(const K& key, F projection);
+	void			flush();
+
+	SQLUBIGINT		batches() const;
+	SQLUBIGINT		keys() const;
+
+private:
+	struct pending_key_t {
+		std::string			f_literal;
+		std::vector<request_pointer_t>	f_requests;
+	};
+	/// The pending requests by key
+	typedef std::map<std::string, pending_key_t>	pending_map_t;
+
+	// no copy
+				lookup_batcher(const lookup_batcher& batcher);
+	lookup_batcher&		operator = (const lookup_batcher& batcher);
+
+	void			submit(const std::string& key, const std::string& literal, const request_pointer_t& request);
+	void			run();
+	void			execute_batch(pending_map_t& batch);
+	void			read_key();
+
+	const std::string	f_sql;
+	const std::string::size_type	f_placeholder;
+	const SQLUSMALLINT	f_key_column;
+	const SQLULEN		f_max_batch;
+	const SQLUBIGINT	f_window;
+
+	// only used by the worker thread
+	connection		f_connection;
+	std::unique_ptr<statement>	f_statement;
+	dynamic_record		f_record;
+	std::string		f_query;
+	std::string		f_key;
+
+	// shared with the callers, protected by f_mutex
+	mutable std::mutex	f_mutex;
+	std::condition_variable	f_condition;
+	pending_map_t		f_pending;
+	SQLUBIGINT		f_pending_since;
+	bool			f_flush;
+	bool			f_stop;
+	SQLUBIGINT		f_batches;
+	SQLUBIGINT		f_keys;
+
+	std::thread		f_thread;
+};
+
+
+/** \brief Look up a key and get the rows in a future.
+ *
+ * This function queues \p key in the next batch. Once the batch was
+ * executed, the future returns the rows matching \p key, each row
+ * transformed by \p projection. The type of the items has to be
+ * specified:
+ *
+ * \code
+ * std::future<std::vector<my_row> > rows(batcher.load<my_row>(id, to_my_row));
+ * \endcode
+ *
+ * The projection is called from the worker thread of the batcher.
+ *
+ * \param[in] key          The key to look up, an integer or a string
+ * \param[in] projection   The function transforming a row in a T
+ *
+ * \return A future with the vector of rows, or the exception that
+ *         prevented the batch from running.
+ */
+template<class T, class K, class F>
+std::future<std::vector<T> > lookup_batcher::load(const K& key, F projection)
+{
+	std::shared_ptr<lookup_future_request<T, F> > request(new lookup_future_request<T, F>(projection));
+	std::future<std::vector<T> > result(request->get_future());
+	load(key, request_pointer_t(request));
+	return result;
+}
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_LOOKUP_BATCHER
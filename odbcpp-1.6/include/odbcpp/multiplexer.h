@@ -0,0 +1,148 @@
+//
+// File:	include/odbcpp/multiplexer.h
+// Object:	Define the session multiplexer of the odbcpp library
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_MULTIPLEXER
+#define ODBCPP_MULTIPLEXER
+
+#include	"statement.h"
+#include	<atomic>
+#include	<condition_variable>
+#include	<functional>
+#include	<map>
+#include	<memory>
+#include	<mutex>
+#include	<vector>
+
+namespace odbcpp
+{
+
+
+
+class logical_session;
+
+class session_multiplexer
+{
+public:
+	/// The function using a borrowed connection
+	typedef std::function<void (connection& conn)>	use_t;
+
+				session_multiplexer(environment& env, const std::string& connect,
+					SQLULEN max_connections = 8);
+				~session_multiplexer();
+
+	void			set_default_attr(SQLINTEGER attr, SQLINTEGER integer);
+	void			set_reset_sql(const std::string& sql) { f_reset_sql = sql; }
+	const std::string&	get_reset_sql() const { return f_reset_sql; }
+	void			set_wait_timeout(SQLUBIGINT timeout) { f_wait_timeout = timeout; }
+	SQLUBIGINT		get_wait_timeout() const { return f_wait_timeout; }
+
+	SQLULEN			max_connections() const { return f_max_connections; }
+	SQLULEN			connections() const;
+	SQLULEN			idle() const;
+
+	SQLUBIGINT		borrows() const { return f_borrows; }
+	SQLUBIGINT		waits() const { return f_waits; }
+	SQLUBIGINT		switches() const { return f_switches; }
+	SQLUBIGINT		created() const { return f_created; }
+	SQLUBIGINT		dropped() const { return f_dropped; }
+
+private:
+	friend class logical_session;
+
+	/// The attributes of a session by attribute number
+	typedef std::map<SQLINTEGER, SQLINTEGER>	attr_map_t;
+	/// The identifiers of the settings used by the sessions
+	typedef std::map<std::pair<attr_map_t, std::vector<std::string> >, SQLUBIGINT>	settings_map_t;
+
+	struct physical_t {
+					physical_t(environment& env) : f_connection(env), f_settings(0), f_dirty(false) {}
+
+		connection		f_connection;
+		attr_map_t		f_attrs;	// the attributes set by the last session
+		SQLUBIGINT		f_settings;	// the settings of the last session, 0 if unknown
+		bool			f_dirty;	// whether the init SQL of a session was run
+	};
+
+	class lease_t;
+
+	// no copy
+				session_multiplexer(const session_multiplexer& mux);
+	session_multiplexer&	operator = (const session_multiplexer& mux);
+
+	physical_t *		acquire(SQLUBIGINT settings);
+	void			release(physical_t *physical, bool drop);
+	void			apply(physical_t& physical, const logical_session& session);
+	SQLUBIGINT		settings_id(const attr_map_t& attrs, const std::vector<std::string>& init_sql);
+
+	smartptr<environment>	f_environment;
+	const std::string	f_connect;
+	const SQLULEN		f_max_connections;
+	attr_map_t		f_defaults;
+	std::string		f_reset_sql;
+	SQLUBIGINT		f_wait_timeout;
+	mutable std::mutex	f_mutex;
+	std::condition_variable	f_condition;
+	std::vector<std::unique_ptr<physical_t> >	f_connections;
+	std::vector<physical_t *>	f_idle;
+	SQLULEN			f_connecting;
+	settings_map_t		f_settings;
+	std::atomic<SQLUBIGINT>	f_borrows;
+	std::atomic<SQLUBIGINT>	f_waits;
+	std::atomic<SQLUBIGINT>	f_switches;
+	std::atomic<SQLUBIGINT>	f_created;
+	std::atomic<SQLUBIGINT>	f_dropped;
+};
+
+
+class logical_session
+{
+public:
+	typedef session_multiplexer::use_t	use_t;
+
+				logical_session(session_multiplexer& mux);
+
+	void			set_attr(SQLINTEGER attr, SQLINTEGER integer);
+	void			add_init_sql(const std::string& sql);
+	void			clear_init_sql();
+
+	void			transaction(const use_t& use);
+	void			autocommit(const use_t& use);
+	SQLLEN			execute(const std::string& sql);
+
+private:
+	friend class session_multiplexer;
+
+	// no copy
+				logical_session(const logical_session& session);
+	logical_session&	operator = (const logical_session& session);
+
+	session_multiplexer&	f_multiplexer;
+	session_multiplexer::attr_map_t	f_attrs;
+	std::vector<std::string>	f_init_sql;
+	SQLUBIGINT		f_settings;
+};
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_MULTIPLEXER
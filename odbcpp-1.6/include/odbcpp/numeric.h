@@ -0,0 +1,53 @@
+//
+// File:	include/odbcpp/numeric.h
+// Object:	Define the SQL_NUMERIC_STRUCT conversions of the odbcpp library
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_NUMERIC
+#define ODBCPP_NUMERIC
+
+#include	"odbcpp_config.h"
+#include	<sql.h>
+#include	<sqlext.h>
+#include	<string>
+
+namespace odbcpp
+{
+
+
+
+/// The maximum number of decimal digits in the mantissa of an SQL_NUMERIC_STRUCT
+const int NUMERIC_MAX_DIGITS = 39;
+
+void		int64_to_numeric(SQLBIGINT value, SQLSCHAR scale, SQL_NUMERIC_STRUCT& numeric);
+bool		numeric_to_int64(const SQL_NUMERIC_STRUCT& numeric, SQLSMALLINT scale, SQLBIGINT& value);
+double		numeric_to_double(const SQL_NUMERIC_STRUCT& numeric);
+void		numeric_to_string(const SQL_NUMERIC_STRUCT& numeric, std::string& str);
+std::string	numeric_to_string(const SQL_NUMERIC_STRUCT& numeric);
+int		numeric_digits(const SQL_NUMERIC_STRUCT& numeric, SQLCHAR *digits);
+#ifdef __SIZEOF_INT128__
+__int128	numeric_to_int128(const SQL_NUMERIC_STRUCT& numeric);
+#endif
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_NUMERIC
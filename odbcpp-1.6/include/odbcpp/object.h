@@ -43,6 +43,7 @@ public:
 
 	unsigned long		addref() const;
 	unsigned long		release() const;
+	unsigned long		refcount() const { return f_refcount; }
 
 private:
 	mutable unsigned long	f_refcount;
@@ -58,18 +59,18 @@ public:
 
 	/// Define a smart pointer with the specified bare pointer.
 	// \param[in] obj  The object to be managed by smart pointers
-	smartptr(T *obj) : f_ptr(obj) { f_ptr->addref(); }
+	smartptr(T *obj) : f_ptr(obj) { if (f_ptr != 0) f_ptr->addref(); }
 
 	/// Define a smart pointer as a copy of another, this has the effect of calling addref(); the object is not duplicated.
 	// \param[in] ptr  The object to be copied in another smart pointer
-	smartptr(const smartptr<T>& ptr) : f_ptr(ptr.f_ptr) { f_ptr->addref(); }
+	smartptr(const smartptr<T>& ptr) : f_ptr(ptr.f_ptr) { if (f_ptr != 0) f_ptr->addref(); }
 
 	/// Relase a smart pointer (call release() on the object)
-	~smartptr() { if (f_ptr->release() == 0) f_ptr = NULL; }
+	~smartptr() { if (f_ptr != 0 && f_ptr->release() == 0) f_ptr = NULL; }
 
 	/// Switch the bare pointer with another
 	// \param[in] obj  The object to be manage by smart pointers
-	void reset(T *obj = 0) { obj->addref(); f_ptr->release(); f_ptr = obj; }
+	void reset(T *obj = 0) { if (obj != 0) obj->addref(); if (f_ptr != 0) f_ptr->release(); f_ptr = obj; }
 
 	/// Set the smart pointer with another, same as reset(obj).
 	// \param[in] obj  The object to be manage by smart pointers
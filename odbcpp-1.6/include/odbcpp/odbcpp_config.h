@@ -45,6 +45,12 @@
 #define	HAVE_LONG_LONG	1
 #endif
 
+// the statement and connection objects gather performance statistics
+// (see statistics_t); define ODBCPP_NO_STATISTICS here to remove that
+// code from the library altogether; only the library .cpp files test
+// it so the installed headers are the same either way
+//#define	ODBCPP_NO_STATISTICS	1
+
 
 
 
@@ -24,9 +24,18 @@
 #define ODBCPP_RECORD
 
 #include	"statement.h"
+#include	"numeric.h"
+#include	"datetime.h"
+#include	"bitmap.h"
+#include	"result_schema.h"
+#include	"traits.h"
 #include	<map>
+#include	<vector>
 #include	<sqlucode.h>
 #include	<iostream>
+#if __cplusplus >= 201703L
+#include	<optional>
+#endif
 
 namespace odbcpp
 {
@@ -57,7 +66,7 @@ public:
 	 *
 	 * \param[in] size   The size used to allocate the new buffer.
 	 */
-	buffer(size_t size = 1) : object(0), f_ptr(new T[size]) {}
+	buffer(size_t size = 1) : object(0), f_ptr(new T[size]), f_size(size) {}
 
 	/** \brief Free the block of data.
 	 *
@@ -79,12 +88,27 @@ public:
 	 */
 	T *get() const { return const_cast<T *>(f_ptr); }
 
+	/** \brief Retrieve the number of items in the buffer.
+	 *
+	 * This function returns the size that was passed to the
+	 * constructor.
+	 *
+	 * \return The number of T items in the buffer
+	 */
+	size_t size() const { return f_size; }
+
 private:
 	/** \brief The memory pointer.
 	 *
 	 * This variable holds the buffer memory pointer.
 	 */
 	T *			f_ptr;
+
+	/** \brief The number of items in the buffer.
+	 *
+	 * This variable holds the size of the buffer.
+	 */
+	size_t			f_size;
 };
 /// A specialization of the buffer template of type char
 typedef buffer<char>		buffer_char_t;
@@ -105,21 +129,30 @@ public:
 	bool			is_bound() const { return f_statement; }
 
 	virtual void		bind(statement& stmt);
-	void			unbind() { f_statement.reset(); }
+	void			rebind(statement& stmt);
+	void			unbind();
 	virtual void		finalize() {}
 
 protected:
+	/// The alignment of each column buffer in the arena
+	static const SQLULEN	ARENA_ALIGNMENT = 16;
+
+	static SQLULEN		arena_align(SQLULEN size) { return (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1); }
+	char *			allocate_arena(SQLULEN size);
+
 	smartptr<statement>	f_statement;
+	smartptr<buffer_char_t>	f_arena;
 
 private:
 	virtual void		bind_impl() = 0;
+	virtual bool		rebind_impl() { return false; }
 };
 
 
 class record : public record_base
 {
 public:
-	record(void) {}
+	record(void) : f_result_cols(0) {}
 	~record(void) {}
 	virtual bool		is_dynamic() const { return false; }
 
@@ -134,51 +167,27 @@ protected:
 	void			bind(const std::string& name, std::wstring& str, bool *is_null = 0);
 	void			bind(SQLSMALLINT col, std::wstring& str, bool *is_null = 0);
 
-	// integers
-	void			bind(const std::string& name, SQLCHAR& tiny_int, bool *is_null = 0);	// includes SQL_C_BIT
-	void			bind(SQLSMALLINT col, SQLCHAR& tiny_int, bool *is_null = 0);
-	void			bind(const std::string& name, SQLSCHAR& tiny_int, bool *is_null = 0);
-	void			bind(SQLSMALLINT col, SQLSCHAR& tiny_int, bool *is_null = 0);
-
-	void			bind(const std::string& name, SQLSMALLINT& small_int, bool *is_null = 0);
-	void			bind(SQLSMALLINT col, SQLSMALLINT& small_int, bool *is_null = 0);
-	void			bind(const std::string& name, SQLUSMALLINT& small_int, bool *is_null = 0);
-	void			bind(SQLSMALLINT col, SQLUSMALLINT& small_int, bool *is_null = 0);
-
-	void			bind(const std::string& name, SQLINTEGER& integer, bool *is_null = 0);
-	void			bind(SQLSMALLINT col, SQLINTEGER& integer, bool *is_null = 0);
-	void			bind(const std::string& name, SQLUINTEGER& integer, bool *is_null = 0);
-	void			bind(SQLSMALLINT col, SQLUINTEGER& integer, bool *is_null = 0);
-
-	void			bind(const std::string& name, SQLBIGINT& big_int, bool *is_null = 0);
-	void			bind(SQLSMALLINT col, SQLBIGINT& big_int, bool *is_null = 0);
-	void			bind(const std::string& name, SQLUBIGINT& big_int, bool *is_null = 0);
-	void			bind(SQLSMALLINT col, SQLUBIGINT& big_int, bool *is_null = 0);
-
-	// floating points
-	void			bind(const std::string& name, SQLREAL& real, bool *is_null = 0);	// C float
-	void			bind(SQLSMALLINT col, SQLREAL& real, bool *is_null = 0);
-
-	void			bind(const std::string& name, SQLFLOAT& dbl, bool *is_null = 0);	// C double
-	void			bind(SQLSMALLINT col, SQLFLOAT& dbl, bool *is_null = 0);
+	// all the types with sql_traits (integers, floating points, structures...)
+	template<class T>
+	void			bind(const std::string& name, T& value, bool *is_null = 0);
+	template<class T>
+	void			bind(SQLSMALLINT col, T& value, bool *is_null = 0);
 
 	// binary (bookmarks, C-strings, etc.)
 	void			bind(const std::string& name, SQLCHAR *binary, SQLLEN length, bool *is_null = 0);
 	void			bind(SQLSMALLINT col, SQLCHAR *binary, SQLLEN length, bool *is_null = 0);
 
-	// structures
-	void			bind(const std::string& name, SQL_DATE_STRUCT& date, bool *is_null = 0);
-	void			bind(SQLSMALLINT col, SQL_DATE_STRUCT& date, bool *is_null = 0);
-	void			bind(const std::string& name, SQL_TIME_STRUCT& time, bool *is_null = 0);
-	void			bind(SQLSMALLINT col, SQL_TIME_STRUCT& time, bool *is_null = 0);
-	void			bind(const std::string& name, SQL_TIMESTAMP_STRUCT& timestamp, bool *is_null = 0);
-	void			bind(SQLSMALLINT col, SQL_TIMESTAMP_STRUCT& timestamp, bool *is_null = 0);
-	void			bind(const std::string& name, SQL_NUMERIC_STRUCT& numeric, bool *is_null = 0);
-	void			bind(SQLSMALLINT col, SQL_NUMERIC_STRUCT& numeric, bool *is_null = 0);
-	void			bind(const std::string& name, SQLGUID& guid, bool *is_null = 0);
-	void			bind(SQLSMALLINT col, SQLGUID& guid, bool *is_null = 0);
+	// decimals as scaled integers (i.e. cents)
+	void			bind_decimal(const std::string& name, SQLBIGINT& value, SQLSMALLINT scale, bool *is_null = 0);
+	void			bind_decimal(SQLSMALLINT col, SQLBIGINT& value, SQLSMALLINT scale, bool *is_null = 0);
 
 private:
+	/// The function converting the buffer of a column to a variable
+	typedef void (*converter_t)(const column_buffer_t& column, void *value);
+
+	template<class T>
+	static void		convert(const column_buffer_t& column, void *value);
+
 	struct bind_info_t: public object {
 				bind_info_t() :
 					object(0),
@@ -187,10 +196,14 @@ private:
 					f_target_type(SQL_UNKNOWN_TYPE),
 					f_data(NULL),
 					f_size(0),
-					f_fetch_size(0),
+					f_indicator(NULL),
 					f_is_null(0),
-					f_string(NULL)
+					f_precision(0),
+					f_scale(0),
+					f_string(NULL),
 					//f_wstring(NULL) -- same as f_string(NULL)
+					f_converter(NULL),
+					f_value(NULL)
 				{
 				}
 
@@ -199,13 +212,17 @@ private:
 		SQLSMALLINT		f_target_type;	// the type of the data
 		SQLPOINTER		f_data;		// pointer to the data to bind with
 		SQLULEN			f_size;		// size of the data buffer
-		SQLLEN			f_fetch_size;	// sized defined after the fetch calls
+		SQLLEN *		f_indicator;	// size defined by the fetch calls, in the arena
 		bool *			f_is_null;	// a pointer to mark as TRUE is the value is NULL in the database
-		smartptr<buffer_char_t>	f_data_buffer;	// for strings
+		SQLSMALLINT		f_precision;	// precision of an SQL_C_NUMERIC
+		SQLSMALLINT		f_scale;	// scale of an SQL_C_NUMERIC
 		union {
 			std::string *	f_string;	// pointer to the user string
 			std::wstring *	f_wstring;	// pointer to the user string
+			SQLBIGINT *	f_scaled;	// pointer to the user scaled integer
 		};
+		converter_t		f_converter;	// converts the data of the arena to the user variable
+		void *			f_value;	// the user variable of the converter
 	};
 	/// A map that links a column name and the column bind information
 	typedef std::map<const std::string, smartptr<bind_info_t> >	bind_info_name_map_t;
@@ -215,13 +232,20 @@ private:
 	typedef std::map<const SQLSMALLINT, smartptr<bind_info_t> >	bind_info_col_map_t;
 	/// A pair with the column index and its information
 	typedef std::pair<const SQLSMALLINT, smartptr<bind_info_t> >	bind_info_col_t;
+	/// A vector of the columns found in the result
+	typedef std::vector<std::pair<SQLSMALLINT, bind_info_t *> >	bind_info_bound_vector_t;
 
 	virtual void		bind_impl();
+	virtual bool		rebind_impl();
 	virtual void		finalize();
 	void			finalize_info(smartptr<bind_info_t> &info);
+	void			bind_value(const std::string& name, SQLSMALLINT col, SQLSMALLINT target_type, SQLULEN size,
+					SQLPOINTER data, converter_t converter, bool *is_null);
 
 	bind_info_name_map_t	f_bind_by_name;
 	bind_info_col_map_t	f_bind_by_col;
+	bind_info_bound_vector_t	f_bound;
+	SQLSMALLINT		f_result_cols;
 };
 
 
@@ -229,16 +253,33 @@ private:
 class dynamic_record : public record_base
 {
 public:
-	dynamic_record(void) {}
+	enum decimal_mode_t {
+		DECIMAL_MODE_STRING,
+		DECIMAL_MODE_NUMERIC
+	};
+
+	dynamic_record(void) : f_rowset_size(1), f_row(0), f_decimal_mode(DECIMAL_MODE_STRING), f_source(NULL), f_source_block(0), f_source_rows(0) {}
 	~dynamic_record(void) {}
 	
 	virtual bool		is_dynamic() const { return true; }
 
+	// read several rows with each fetch
+	void			set_rowset_size(SQLULEN size);
+	SQLULEN			get_rowset_size() const { return f_rowset_size; }
+	SQLULEN			rows_fetched() const;
+	void			set_row(SQLULEN row);
+	SQLULEN			get_row() const { return f_row; }
+
+	// how DECIMAL and NUMERIC columns are bound
+	void			set_decimal_mode(decimal_mode_t mode);
+	decimal_mode_t		get_decimal_mode() const { return f_decimal_mode; }
+
 	// use to get the record data by name or column number
-	bool			empty() const { return f_bind_by_name.empty() && f_bind_by_col.empty(); }
+	bool			empty() const { return f_bind_by_col.empty(); }
 	size_t			size() const { return f_bind_by_col.size(); }
 	const std::string&	column_name(SQLSMALLINT col) const;
 	SQLSMALLINT		column_number(const std::string& name) const;
+	const result_schema::pointer_t& get_schema() const { return f_schema; }
 
 	// check columns and types
 	bool			exists(const std::string& name);
@@ -257,91 +298,331 @@ public:
 	void			get(const std::string& name, std::wstring& str) const;
 	void			get(SQLSMALLINT col, std::wstring& str) const;
 
-	// integers
-	void			get(const std::string& name, SQLCHAR& tiny_int) const;	// includes SQL_C_BIT
-	void			get(SQLSMALLINT col, SQLCHAR& tiny_int) const;
-	void			get(const std::string& name, SQLSCHAR& tiny_int) const;
-	void			get(SQLSMALLINT col, SQLSCHAR& tiny_int) const;
-
-	void			get(const std::string& name, SQLSMALLINT& small_int) const;
-	void			get(SQLSMALLINT col, SQLSMALLINT& small_int) const;
-	void			get(const std::string& name, SQLUSMALLINT& small_int) const;
-	void			get(SQLSMALLINT col, SQLUSMALLINT& small_int) const;
-
-	void			get(const std::string& name, SQLINTEGER& integer) const;
-	void			get(SQLSMALLINT col, SQLINTEGER& integer) const;
-	void			get(const std::string& name, SQLUINTEGER& integer) const;
-	void			get(SQLSMALLINT col, SQLUINTEGER& integer) const;
-
-	void			get(const std::string& name, SQLBIGINT& big_int) const;
-	void			get(SQLSMALLINT col, SQLBIGINT& big_int) const;
-	void			get(const std::string& name, SQLUBIGINT& big_int) const;
-	void			get(SQLSMALLINT col, SQLUBIGINT& big_int) const;
-
-	// floating points
-	void			get(const std::string& name, SQLREAL& real) const;	// C float
-	void			get(SQLSMALLINT col, SQLREAL& real) const;
-
-	void			get(const std::string& name, SQLFLOAT& dbl) const;	// C double
-	void			get(SQLSMALLINT col, SQLFLOAT& dbl) const;
+	// all the types with sql_traits (integers, floating points, structures...)
+	template<class T>
+	void			get(const std::string& name, T& value) const;
+	template<class T>
+	void			get(SQLSMALLINT col, T& value) const;
+	template<class T>
+	T			get(const std::string& name) const;
+	template<class T>
+	T			get(SQLSMALLINT col) const;
 
 	// binary (bookmarks, C-strings, etc.)
 	SQLULEN			get(const std::string& name, SQLCHAR *binary, SQLLEN length) const;
 	SQLULEN			get(SQLSMALLINT col, SQLCHAR *binary, SQLLEN length) const;
 
-	// structures
-	void			get(const std::string& name, SQL_DATE_STRUCT& date) const;
-	void			get(SQLSMALLINT col, SQL_DATE_STRUCT& date) const;
-	void			get(const std::string& name, SQL_TIME_STRUCT& time) const;
-	void			get(SQLSMALLINT col, SQL_TIME_STRUCT& time) const;
-	void			get(const std::string& name, SQL_TIMESTAMP_STRUCT& timestamp) const;
-	void			get(SQLSMALLINT col, SQL_TIMESTAMP_STRUCT& timestamp) const;
-	void			get(const std::string& name, SQL_NUMERIC_STRUCT& numeric) const;
-	void			get(SQLSMALLINT col, SQL_NUMERIC_STRUCT& numeric) const;
-	void			get(const std::string& name, SQLGUID& guid) const;
-	void			get(SQLSMALLINT col, SQLGUID& guid) const;
+	// errors returned as an odbcpp_error code instead of thrown
+	template<class T>
+	SQLINTEGER		try_get(const std::string& name, T& value) const;
+	template<class T>
+	SQLINTEGER		try_get(SQLSMALLINT col, T& value) const;
+	SQLINTEGER		try_get(const std::string& name, std::string& str) const;
+	SQLINTEGER		try_get(SQLSMALLINT col, std::string& str) const;
+#if __cplusplus >= 201703L
+	template<class T>
+	std::optional<T>	try_get(const std::string& name) const;
+	template<class T>
+	std::optional<T>	try_get(SQLSMALLINT col) const;
+#endif
+
+	// all the rows of the rowset at once
+	SQLULEN			get_epoch_ns(const std::string& name, SQLBIGINT *ns, SQLBIGINT null_value = 0) const;
+	SQLULEN			get_epoch_ns(SQLSMALLINT col, SQLBIGINT *ns, SQLBIGINT null_value = 0) const;
+	void			get_validity(const std::string& name, validity_bitmap& bitmap) const;
+	void			get_validity(SQLSMALLINT col, validity_bitmap& bitmap) const;
+	SQLULEN			get_null_count(const std::string& name) const;
+	SQLULEN			get_null_count(SQLSMALLINT col) const;
 
 private:
+	friend class snapshot_writer;
+	friend class snapshot_reader;
+	friend class external_sorter;
+
 	struct bind_info_t: public object {
 					bind_info_t() :
 						object(0),
-						//f_name -- auto-init
 						f_col(0),
 						f_target_type(0),
 						f_bind_type(0),
 						f_decimal_digits(0),
-						//f_data -- auto-init
+						f_column_size(0),
+						f_data(NULL),
 						f_size(0),
-						f_fetch_size(0)
+						f_stride(0),
+						f_indicator(NULL)
 					{
 					}
 
-		std::string		f_name;		// if empty, can only use col
 		SQLSMALLINT		f_col;		// 1 to # of columns
 		SQLSMALLINT		f_target_type;	// the type of the data
 		SQLSMALLINT		f_bind_type;	// the type used to bind the column
 		SQLSMALLINT		f_decimal_digits;	// number of digits after decimal point
-		smartptr<buffer_char_t>	f_data;		// pointer to the data to bind with
+		SQLULEN			f_column_size;	// size as described by the driver
+		char *			f_data;		// pointer to the data to bind with, in the arena
 		SQLULEN			f_size;		// size of the data buffer
-		SQLLEN			f_fetch_size;	// sized defined after the fetch calls
+		SQLULEN			f_stride;	// distance between two rows in f_data
+		SQLLEN *		f_indicator;	// size defined by the fetch calls, in the arena
 	};
-	/// A map that links a column name and the column bind information
-	typedef std::map<const std::string, smartptr<bind_info_t> >	bind_info_name_map_t;
-	/// A pair with the column name and its information
-	typedef std::pair<const std::string, smartptr<bind_info_t> >	bind_info_name_t;
 	/// A vector of columns to sort them by index
 	typedef std::vector<smartptr<bind_info_t> >			bind_info_col_vector_t;
 
 	virtual void		bind_impl();
+	virtual bool		rebind_impl();
+	virtual void		finalize() { f_row = 0; }
+	char *			column_data(const smartptr<bind_info_t>& info) const { return info->f_data + f_row * info->f_stride; }
+	SQLLEN			column_indicator(const smartptr<bind_info_t>& info) const { return info->f_indicator[f_row]; }
 	const smartptr<bind_info_t>& find_column(const std::string& name, SQLSMALLINT target_type, bool except_null = false) const;
 	const smartptr<bind_info_t>& find_column(SQLSMALLINT col, SQLSMALLINT target_type, bool except_null = false) const;
 	const smartptr<bind_info_t>& verify_column(const smartptr<bind_info_t> &info, SQLSMALLINT target_type, bool except_null) const;
+	SQLINTEGER		check_column(const smartptr<bind_info_t>& info, SQLSMALLINT target_type, bool except_null) const;
+	const smartptr<bind_info_t> *try_find_column(const std::string& name, SQLSMALLINT target_type, SQLINTEGER& code) const;
+	const smartptr<bind_info_t> *try_find_column(SQLSMALLINT col, SQLSMALLINT target_type, SQLINTEGER& code) const;
+	void			column_string(const smartptr<bind_info_t>& info, std::string& str) const;
+	SQLINTEGER		try_column_string(const smartptr<bind_info_t>& info, std::string& str) const;
+	SQLULEN			column_epoch_ns(const smartptr<bind_info_t>& info, SQLBIGINT *ns, SQLBIGINT null_value) const;
+	static SQLULEN		c_type_size(SQLSMALLINT c_type);
+
+	column_buffer_t		column_buffer(const smartptr<bind_info_t>& info) const
+				{
+					column_buffer_t column = { info->f_bind_type, column_data(info), info->f_size, column_indicator(info) };
+					return column;
+				}
 
-	bind_info_name_map_t	f_bind_by_name;
+	result_schema::pointer_t	f_schema;		// the names and types, shared
 	bind_info_col_vector_t	f_bind_by_col;		// offset 0 is column 1, etc.
+	SQLULEN			f_rowset_size;
+	SQLULEN			f_row;
+	decimal_mode_t		f_decimal_mode;
+	const void *		f_source;
+	SQLULEN			f_source_block;
+	SQLULEN			f_source_rows;
 };
 
 
+template<class T>
+void record::convert(const column_buffer_t& column, void *value)
+{
+	// like the other types, a NULL leaves the variable as is
+	if(sql_traits<T>::nullable || !column.is_null()) {
+		sql_traits<T>::read(column, *static_cast<T *>(value));
+	}
+}
+
+
+template<class T>
+void record::bind(const std::string& name, T& value, bool *is_null)
+{
+	bind_value(name, 0, sql_traits<T>::c_type, sql_traits<T>::buffer_size,
+		&value, sql_traits<T>::direct ? NULL : &record::convert<T>, is_null);
+}
+
+
+template<class T>
+void record::bind(SQLSMALLINT col, T& value, bool *is_null)
+{
+	bind_value(std::string(), col, sql_traits<T>::c_type, sql_traits<T>::buffer_size,
+		&value, sql_traits<T>::direct ? NULL : &record::convert<T>, is_null);
+}
+
+
+template<class T>
+void dynamic_record::get(const std::string& name, T& value) const
+{
+	sql_traits<T>::read(column_buffer(find_column(name, sql_traits<T>::c_type, !sql_traits<T>::nullable)), value);
+}
+
+
+template<class T>
+void dynamic_record::get(SQLSMALLINT col, T& value) const
+{
+	sql_traits<T>::read(column_buffer(find_column(col, sql_traits<T>::c_type, !sql_traits<T>::nullable)), value);
+}
+
+
+template<class T>
+T dynamic_record::get(const std::string& name) const
+{
+	T value;
+	get(name, value);
+	return value;
+}
+
+
+template<class T>
+T dynamic_record::get(SQLSMALLINT col) const
+{
+	T value;
+	get(col, value);
+	return value;
+}
+
+
+template<class T>
+SQLINTEGER dynamic_record::try_get(const std::string& name, T& value) const
+{
+	SQLINTEGER code;
+	const smartptr<bind_info_t> *info = try_find_column(name, sql_traits<T>::c_type, code);
+	if(info != NULL) {
+		sql_traits<T>::read(column_buffer(*info), value);
+	}
+	return code;
+}
+
+
+template<class T>
+SQLINTEGER dynamic_record::try_get(SQLSMALLINT col, T& value) const
+{
+	SQLINTEGER code;
+	const smartptr<bind_info_t> *info = try_find_column(col, sql_traits<T>::c_type, code);
+	if(info != NULL) {
+		sql_traits<T>::read(column_buffer(*info), value);
+	}
+	return code;
+}
+
+
+#if __cplusplus >= 201703L
+template<class T>
+std::optional<T> dynamic_record::try_get(const std::string& name) const
+{
+	T value;
+	SQLINTEGER code = try_get(name, value);
+	if(code == odbcpp_error::ODBCPP_NO_DATA) {
+		return std::nullopt;
+	}
+	if(code != odbcpp_error::ODBCPP_NONE) {
+		// throw the detailed error
+		get(name, value);
+	}
+	return value;
+}
+
+
+template<class T>
+std::optional<T> dynamic_record::try_get(SQLSMALLINT col) const
+{
+	T value;
+	SQLINTEGER code = try_get(col, value);
+	if(code == odbcpp_error::ODBCPP_NO_DATA) {
+		return std::nullopt;
+	}
+	if(code != odbcpp_error::ODBCPP_NONE) {
+		// throw the detailed error
+		get(col, value);
+	}
+	return value;
+}
+#endif
+
+
+/** \brief Drain a result set in a vector.
+ *
+ * This function fetches all the remaining rows of \p stmt with \p rec
+ * and appends the value returned by \p projection for each row to
+ * \p result.
+ *
+ * The projection is called with the record, once per row. It can be
+ * a function or a functor with a function operator such as:
+ *
+ * \code
+ * T operator () (const R& rec) const;
+ * \endcode
+ *
+ * When the driver reports the number of rows of the result, the
+ * capacity of the vector is reserved beforehand.
+ *
+ * With a dynamic record, give it a rowset size with
+ * dynamic_record::set_rowset_size() to fetch many rows with each
+ * call to the driver.
+ *
+ * \param[in] stmt          The statement with the result to read
+ * \param[in] rec           The record used to fetch the rows
+ * \param[in,out] result    The vector receiving the projected rows
+ * \param[in] projection    The function transforming a row in a T
+ *
+ * \return The number of rows appended to \p result.
+ *
+ * \exception odbcpp_error
+ * The function lets the fetch() errors through.
+ */
+template<class T, class R, class F>
+size_t fetch_all(statement& stmt, R& rec, std::vector<T>& result, F projection)
+{
+	size_t start = result.size();
+	SQLLEN count = stmt.rows();
+	if(count > 0) {
+		result.reserve(start + count);
+	}
+	while(stmt.fetch(rec)) {
+		result.push_back(projection(const_cast<const R&>(rec)));
+	}
+	return result.size() - start;
+}
+
+
+/** \brief Drain a result set in a vector using rowsets.
+ *
+ * This version of fetch_all() is used with dynamic records. It
+ * projects all the rows of each rowset fetched.
+ *
+ * \param[in] stmt          The statement with the result to read
+ * \param[in] rec           The dynamic record used to fetch the rows
+ * \param[in,out] result    The vector receiving the projected rows
+ * \param[in] projection    The function transforming a row in a T
+ *
+ * \return The number of rows appended to \p result.
+ *
+ * \exception odbcpp_error
+ * The function lets the fetch() errors through.
+ */
+template<class T, class F>
+size_t fetch_all(statement& stmt, dynamic_record& rec, std::vector<T>& result, F projection)
+{
+	size_t start = result.size();
+	SQLLEN count = stmt.rows();
+	if(count > 0) {
+		result.reserve(start + count);
+	}
+	while(stmt.fetch(rec)) {
+		SQLULEN max = rec.rows_fetched();
+		for(SQLULEN row = 0; row < max; ++row) {
+			rec.set_row(row);
+			result.push_back(projection(const_cast<const dynamic_record&>(rec)));
+		}
+	}
+	return result.size() - start;
+}
+
+
+/** \brief Drain a result set in a new vector.
+ *
+ * This function returns a vector with all the remaining rows of
+ * \p stmt transformed by \p projection. The type of the items has
+ * to be specified:
+ *
+ * \code
+ * std::vector<my_row> rows(fetch_all<my_row>(stmt, rec, to_my_row));
+ * \endcode
+ *
+ * \param[in] stmt          The statement with the result to read
+ * \param[in] rec           The record used to fetch the rows
+ * \param[in] projection    The function transforming a row in a T
+ *
+ * \return A vector with one item per row.
+ *
+ * \exception odbcpp_error
+ * The function lets the fetch() errors through.
+ */
+template<class T, class R, class F>
+std::vector<T> fetch_all(statement& stmt, R& rec, F projection)
+{
+	std::vector<T> result;
+	fetch_all(stmt, rec, result, projection);
+	return result;
+}
+
+
 
 }	// namespace odbcpp
 
@@ -0,0 +1,120 @@
+//
+// File:	include/odbcpp/result_cache.h
+// Object:	Define the result cache of the odbcpp library
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_RESULT_CACHE
+#define ODBCPP_RESULT_CACHE
+
+#include	"statistics.h"
+#include	<list>
+#include	<map>
+#include	<memory>
+#include	<mutex>
+#include	<string>
+#include	<vector>
+
+namespace odbcpp
+{
+
+
+
+struct cached_result_t
+{
+	struct column_t {
+		std::string		f_name;
+		SQLSMALLINT		f_type;
+		SQLULEN			f_size;
+		SQLSMALLINT		f_decimal_digits;
+		SQLSMALLINT		f_nullable;
+	};
+	/// The description of the columns, offset 0 is column 1
+	typedef std::vector<column_t>	column_vector_t;
+
+	SQLULEN			rows() const { return f_offsets.size(); }
+	const char *		row(SQLULEN idx) const { return f_data.data() + f_offsets[idx]; }
+	void			append(const std::vector<char>& image);
+	SQLULEN			memory() const;
+
+	column_vector_t		f_columns;
+	std::string		f_signature;	// the bindings used to save the rows
+	std::vector<char>	f_data;		// the row images
+	std::vector<SQLULEN>	f_offsets;	// the start of each row in f_data
+};
+
+
+class result_cache
+{
+public:
+	typedef std::shared_ptr<const cached_result_t>	result_pointer_t;
+
+				result_cache(SQLULEN memory_limit = 64 * 1024 * 1024, SQLUBIGINT default_ttl = 60000000000ULL);
+
+	void			set_memory_limit(SQLULEN memory_limit);
+	SQLULEN			get_memory_limit() const;
+	void			set_default_ttl(SQLUBIGINT ttl);
+	SQLUBIGINT		get_default_ttl() const;
+
+	result_pointer_t	find(const std::string& key);
+	void			insert(const std::string& key, const result_pointer_t& result,
+					const std::string& tags = std::string(), SQLUBIGINT ttl = 0);
+	void			invalidate(const std::string& tag);
+	void			clear();
+
+	cache_statistics_t	get_statistics() const;
+	void			reset_statistics();
+
+private:
+	/// The list of keys, the most recently used first
+	typedef std::list<std::string>		lru_list_t;
+
+	struct entry_t {
+		result_pointer_t		f_result;
+		SQLUBIGINT			f_expires;
+		SQLULEN				f_memory;
+		std::vector<std::string>	f_tags;
+		lru_list_t::iterator		f_lru;
+	};
+	/// The entries by key
+	typedef std::map<std::string, entry_t>		entry_map_t;
+	/// The keys of the entries by tag
+	typedef std::multimap<std::string, std::string>	tag_map_t;
+
+	// no copy
+				result_cache(const result_cache& cache);
+	result_cache&		operator = (const result_cache& cache);
+
+	void			erase(entry_map_t::iterator itr);
+	void			evict();
+
+	mutable std::mutex	f_mutex;
+	SQLULEN			f_memory_limit;
+	SQLUBIGINT		f_default_ttl;
+	entry_map_t		f_entries;
+	tag_map_t		f_tags;
+	lru_list_t		f_lru;
+	cache_statistics_t	f_statistics;
+};
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_RESULT_CACHE
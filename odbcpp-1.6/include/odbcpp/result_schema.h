@@ -0,0 +1,95 @@
+//
+// File:	include/odbcpp/result_schema.h
+// Object:	Define the shared result schema of the odbcpp library
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_RESULT_SCHEMA
+#define ODBCPP_RESULT_SCHEMA
+
+#include	"odbcpp_config.h"
+#include	<sql.h>
+#include	<memory>
+#include	<string>
+#include	<vector>
+
+namespace odbcpp
+{
+
+
+
+class result_schema
+{
+public:
+	struct column_t {
+				column_t(const std::string *name = 0, SQLSMALLINT type = SQL_UNKNOWN_TYPE,
+						SQLULEN column_size = 0, SQLSMALLINT decimal_digits = 0) :
+					f_name(name),
+					f_type(type),
+					f_column_size(column_size),
+					f_decimal_digits(decimal_digits)
+				{
+				}
+
+		const std::string *	f_name;		// interned, never NULL in a schema
+		SQLSMALLINT		f_type;		// SQL type as described by the driver
+		SQLULEN			f_column_size;	// size as described by the driver
+		SQLSMALLINT		f_decimal_digits;	// number of digits after decimal point
+	};
+	/// The columns of a result, offset 0 is column 1
+	typedef std::vector<column_t>			column_vector_t;
+	/// A schema shared by all the records of results of the same shape
+	typedef std::shared_ptr<const result_schema>	pointer_t;
+
+	static pointer_t	get(const column_vector_t& columns);
+	static const std::string& intern(const char *name, size_t length);
+	static size_t		count();
+
+	SQLSMALLINT		size() const { return static_cast<SQLSMALLINT>(f_columns.size()); }
+	const column_vector_t&	columns() const { return f_columns; }
+	const column_t&		column(SQLSMALLINT col) const { return f_columns[col - 1]; }
+	const std::string&	name(SQLSMALLINT col) const { return *f_columns[col - 1].f_name; }
+	SQLSMALLINT		find(const std::string& name) const { return find(name.data(), name.length()); }
+	SQLSMALLINT		find(const char *name, size_t length) const;
+	bool			same_column(SQLSMALLINT col, const char *name, size_t length,
+					SQLSMALLINT type, SQLULEN column_size, SQLSMALLINT decimal_digits) const;
+
+private:
+	class release_t;
+
+				result_schema(const column_vector_t& columns, size_t hash);
+
+	// no copy
+				result_schema(const result_schema& schema);
+	result_schema&		operator = (const result_schema& schema);
+
+	static size_t		hash_name(const char *name, size_t length);
+	static size_t		hash_columns(const column_vector_t& columns);
+	bool			same_columns(const column_vector_t& columns) const;
+
+	const column_vector_t	f_columns;
+	std::vector<SQLSMALLINT>	f_index;	// open addressing by name hash, 0 is empty
+	const size_t		f_hash;		// hash of all the columns
+};
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_RESULT_SCHEMA
@@ -0,0 +1,70 @@
+//
+// File:	include/odbcpp/row_store.h
+// Object:	Define the row store used by the client side cursor
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_ROW_STORE
+#define ODBCPP_ROW_STORE
+
+#include	"odbcpp_config.h"
+#include	<sql.h>
+#include	<stdio.h>
+#include	<vector>
+
+namespace odbcpp
+{
+
+
+
+class row_store
+{
+public:
+				row_store();
+				~row_store();
+
+	void			clear();
+	void			set_memory_limit(SQLULEN limit) { f_memory_limit = limit; }
+	SQLULEN			get_memory_limit() const { return f_memory_limit; }
+
+	SQLULEN			size() const { return f_offsets.size(); }
+	void			append(const char *data, SQLULEN size);
+	const char *		get(SQLULEN row, SQLULEN& size);
+
+private:
+	// no copies
+				row_store(const row_store& store);
+	row_store&		operator = (const row_store& store);
+
+	void			spill();
+
+	SQLULEN			f_memory_limit;
+	std::vector<SQLUBIGINT>	f_offsets;
+	SQLUBIGINT		f_total;
+	SQLUBIGINT		f_memory_start;
+	std::vector<char>	f_memory;
+	FILE *			f_file;
+	std::vector<char>	f_scratch;
+};
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_ROW_STORE
@@ -0,0 +1,79 @@
+//
+// File:	include/odbcpp/slow_query.h
+// Object:	Define the slow query log objects of the odbcpp library
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_SLOW_QUERY
+#define ODBCPP_SLOW_QUERY
+
+#include	"diagnostic.h"
+
+namespace odbcpp
+{
+
+
+
+struct slow_query_t
+{
+	const char *		f_sql;
+	SQLUBIGINT		f_execute_time;
+	SQLUBIGINT		f_first_row_time;
+	SQLUBIGINT		f_total_time;
+	SQLLEN			f_rows;
+	bool			f_drained;
+	SQLUBIGINT		f_dropped;
+	const diagnostic *	f_diagnostic;
+};
+
+
+class slow_query_sink
+{
+public:
+	virtual			~slow_query_sink() {}
+
+	virtual void		log(const slow_query_t& query) = 0;
+};
+
+
+class slow_query_log
+{
+public:
+				slow_query_log();
+
+	void			set(slow_query_sink *sink, SQLUBIGINT time_threshold, SQLLEN rows_threshold, SQLUINTEGER max_per_second);
+	bool			is_active() const { return f_sink != 0; }
+	bool			is_slow(SQLUBIGINT total_time, SQLLEN rows) const;
+	void			report(slow_query_t& query);
+
+private:
+	slow_query_sink *	f_sink;
+	SQLUBIGINT		f_time_threshold;
+	SQLLEN			f_rows_threshold;
+	SQLUINTEGER		f_max_per_second;
+	SQLUBIGINT		f_window_start;
+	SQLUINTEGER		f_window_count;
+	SQLUBIGINT		f_dropped;
+};
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_SLOW_QUERY
@@ -0,0 +1,86 @@
+//
+// File:	include/odbcpp/snapshot.h
+// Object:	Define the result snapshot files of the odbcpp library
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_SNAPSHOT
+#define ODBCPP_SNAPSHOT
+
+#include	"record.h"
+
+namespace odbcpp
+{
+
+
+
+class snapshot_writer
+{
+public:
+				snapshot_writer(const std::string& filename, SQLULEN block_rows = 1024);
+
+	SQLULEN			write(statement& stmt);
+
+private:
+	const std::string	f_filename;
+	const SQLULEN		f_block_rows;
+};
+
+
+class snapshot_reader
+{
+public:
+				snapshot_reader(const std::string& filename);
+				~snapshot_reader();
+
+	SQLULEN			rows() const { return f_rows; }
+	SQLSMALLINT		cols() const { return f_cols; }
+	SQLULEN			blocks() const { return f_blocks; }
+
+	bool			fetch(dynamic_record& rec);
+	bool			fetch_block(dynamic_record& rec);
+	bool			read(dynamic_record& rec, SQLULEN row);
+	void			rewind() { f_position = 0; }
+
+private:
+	// no copy
+				snapshot_reader(const snapshot_reader& reader);
+	snapshot_reader&	operator = (const snapshot_reader& reader);
+
+	bool			check_layout() const;
+	SQLULEN			find_block(SQLULEN row) const;
+	void			attach_columns(dynamic_record& rec) const;
+	void			attach(dynamic_record& rec, SQLULEN block) const;
+
+	const char *		f_map;
+	SQLULEN			f_map_size;
+	std::vector<char>	f_buffer;
+	SQLULEN			f_rows;
+	SQLSMALLINT		f_cols;
+	SQLULEN			f_blocks;
+	const char *		f_columns;
+	const SQLUBIGINT *	f_directory;
+	SQLULEN			f_position;
+};
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_SNAPSHOT
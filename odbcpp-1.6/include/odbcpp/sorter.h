@@ -0,0 +1,121 @@
+//
+// File:	include/odbcpp/sorter.h
+// Object:	Define the external sorter of the odbcpp library
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_SORTER
+#define ODBCPP_SORTER
+
+#include	"record.h"
+#include	<functional>
+#include	<stdio.h>
+
+namespace odbcpp
+{
+
+
+
+class external_sorter
+{
+public:
+	typedef std::function<void (const dynamic_record& rec, std::string& key)>	key_function_t;
+
+				external_sorter(SQLULEN memory_limit = 64 * 1024 * 1024, const std::string& temp_directory = std::string());
+				~external_sorter();
+
+	void			add_key(SQLSMALLINT col, bool descending = false);
+	void			add_key(const std::string& name, bool descending = false);
+	void			set_key_function(const key_function_t& key) { f_key_function = key; }
+
+	SQLULEN			sort(statement& stmt, SQLULEN rowset_size = 256);
+	bool			fetch(dynamic_record& rec);
+	void			clear();
+
+	SQLULEN			rows() const { return f_rows; }
+	SQLULEN			runs() const { return f_runs.size(); }
+
+	static void		append_key(std::string& key, SQLBIGINT value, bool descending = false);
+	static void		append_key(std::string& key, double value, bool descending = false);
+	static void		append_key(std::string& key, const std::string& value, bool descending = false);
+	static void		append_key(std::string& key, const SQL_NUMERIC_STRUCT& value, bool descending = false);
+	static void		append_null_key(std::string& key, bool descending = false);
+
+private:
+	struct sort_key_t {
+		std::string		f_name;
+		SQLSMALLINT		f_col;
+		bool			f_descending;
+	};
+	struct entry_t {
+		SQLULEN			f_offset;
+		SQLUINTEGER		f_key_size;
+		SQLUINTEGER		f_image_size;
+	};
+	struct run_t {
+		FILE *			f_file;
+		std::string		f_key;
+		std::vector<char>	f_image;
+	};
+	class entry_less;
+	class run_greater;
+
+	// no copy
+				external_sorter(const external_sorter& sorter);
+	external_sorter&	operator = (const external_sorter& sorter);
+
+	void			build_key(const dynamic_record& rec, std::string& key) const;
+	void			build_image(const dynamic_record& rec);
+	void			spill();
+	FILE *			create_run() const;
+	bool			read_run(run_t& run) const;
+	void			write_row(FILE *file, const char *key, SQLUINTEGER key_size, const char *image, SQLUINTEGER image_size) const;
+	void			merge(SQLULEN first, SQLULEN count, FILE *output);
+	void			start_merge(SQLULEN first, SQLULEN count);
+	bool			next_merged(std::string& key, std::vector<char>& image);
+	void			attach(dynamic_record& rec);
+	void			load_image(const char *image);
+	void			close_runs();
+
+	const SQLULEN		f_memory_limit;
+	const std::string	f_temp_directory;
+	std::vector<sort_key_t>	f_keys;
+	key_function_t		f_key_function;
+
+	dynamic_record		f_input;
+	std::vector<char>	f_buffer;
+	std::vector<entry_t>	f_entries;
+	std::vector<run_t>	f_runs;
+	std::vector<SQLULEN>	f_heap;
+	std::string		f_key;
+	std::vector<char>	f_image;
+
+	SQLULEN			f_rows;
+	SQLULEN			f_position;
+	SQLULEN			f_generation;
+	bool			f_sorted;
+	std::vector<char>	f_output;
+	std::vector<SQLLEN>	f_output_indicators;
+};
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_SORTER
@@ -24,6 +24,7 @@
 #define ODBCPP_STATEMENT
 
 #include	"connection.h"
+#include	"row_store.h"
 
 namespace odbcpp
 {
@@ -32,13 +33,26 @@ class record_base;
 
 class statement : public handle
 {
+	friend class record_base;
+
 public:
 				statement(connection& conn);
+				~statement();
 
 	void			set_attr(SQLINTEGER attr, SQLINTEGER integer);
 	void			set_attr(SQLINTEGER attr, SQLPOINTER ptr, SQLINTEGER length);
 	void			set_no_direct_fetch(bool no_direct_fetch = true);
+	void			set_rowset_size(SQLULEN size);
+	SQLULEN			get_rowset_size() const { return f_rowset_size; }
+	SQLULEN			rows_fetched() const { return f_rows_fetched; }
+	void			set_client_cursor(bool client_cursor = true, SQLULEN memory_limit = 0);
+	bool			get_client_cursor() const { return f_client_cursor; }
+	void			set_timeout(SQLUBIGINT timeout) { f_timeout = timeout; }
+	SQLUBIGINT		get_timeout() const { return f_timeout; }
 	void			execute(const std::string& order);
+	SQLRETURN		try_execute(const std::string& order);
+	void			execute_cached(const std::string& order, const std::string& tags = std::string(), SQLUBIGINT ttl = 0);
+	bool			from_cache() const { return static_cast<bool>(f_replay); }
 	void			begin();
 	void			commit();
 	void			rollback();
@@ -47,13 +61,91 @@ public:
 	SQLLEN			cols() const;
 	SQLLEN			rows() const;
 	bool			fetch(record_base& rec, SQLSMALLINT orientation = SQL_FETCH_NEXT, SQLLEN offset = 0);
+	SQLRETURN		try_fetch(record_base& rec, SQLSMALLINT orientation = SQL_FETCH_NEXT, SQLLEN offset = 0);
+	void			describe_col(SQLUSMALLINT col, SQLCHAR *name, SQLSMALLINT name_size, SQLSMALLINT *name_length,
+					SQLSMALLINT *type, SQLULEN *size, SQLSMALLINT *decimal_digits, SQLSMALLINT *nullable);
+	void			bind_col(SQLUSMALLINT col, SQLSMALLINT type, SQLPOINTER data, SQLLEN size, SQLLEN *indicator,
+					SQLSMALLINT precision = 0, SQLSMALLINT scale = 0);
+	void			unbind_cols();
+
+	// performance statistics
+	statistics_t		get_statistics() const { return f_statistics; }
+	void			reset_statistics() { f_statistics.reset(); }
+	void			add_bytes_copied(SQLULEN bytes);
+	void			add_bind_time(SQLUBIGINT ns);
 
 private:
+	struct binding_t {
+				binding_t() :
+					f_type(0),
+					f_data(NULL),
+					f_size(0),
+					f_indicator(NULL)
+				{
+				}
+
+		SQLSMALLINT		f_type;		// the C type of the column
+		SQLPOINTER		f_data;		// the buffer bound to the column
+		SQLLEN			f_size;		// the size of the buffer
+		SQLLEN *		f_indicator;	// the length/indicator buffer
+	};
+	/// The bindings of a statement, by column number
+	typedef std::vector<binding_t>	binding_vector_t;
+
 	void			has_data() const;
+	void			end_query(bool drained);
+	SQLRETURN		execute_order(const std::string& order, bool except);
+	SQLRETURN		fetch_row(SQLSMALLINT orientation, SQLLEN offset, bool except);
+	bool			client_fetch(SQLSMALLINT orientation, SQLLEN offset);
+	bool			client_fetch_next();
+	void			reset_client_cursor();
+	void			save_row();
+	void			load_row(SQLULEN row);
+	void			build_row_image(SQLULEN index);
+	void			load_row_image(const char *image, SQLULEN index);
+	std::string		binding_signature() const;
+	void			verify_replay();
+	bool			replay_rows(SQLSMALLINT orientation);
+	void			record_rows();
+	void			end_recording();
+	SQLUBIGINT		call_timeout() const;
+	void			timed_out(SQLUBIGINT timeout, bool except);
+	void			set_desc_field(SQLHDESC desc, SQLSMALLINT col, SQLSMALLINT field, SQLPOINTER value);
 
 	smartptr<connection>	f_connection;
 	bool			f_has_data;
 	bool			f_no_direct_fetch;	// if true, avoid SQLFetch(), use SQLFetchScroll() instead
+	SQLULEN			f_rowset_size;
+	SQLULEN			f_rows_fetched;
+	binding_vector_t	f_bindings;
+	const record_base *	f_bound_record;
+	SQLUBIGINT		f_timeout;
+
+	// client side cursor
+	bool			f_client_cursor;
+	row_store		f_row_store;
+	SQLLEN			f_cursor_position;
+	bool			f_cursor_drained;
+	std::vector<char>	f_row_image;
+
+	// result cache
+	std::string		f_cache_key;
+	std::string		f_cache_tags;
+	SQLUBIGINT		f_cache_ttl;
+	result_cache::result_pointer_t	f_replay;
+	SQLULEN			f_replay_row;
+	bool			f_replay_verified;
+	std::shared_ptr<cached_result_t>	f_recording;
+
+	statistics_t		f_statistics;
+
+	// slow query log
+	bool			f_query_active;
+	std::string		f_query_sql;
+	SQLUBIGINT		f_query_start;
+	SQLUBIGINT		f_query_execute_time;
+	SQLUBIGINT		f_query_first_row_time;
+	SQLLEN			f_query_rows;
 };
 
 
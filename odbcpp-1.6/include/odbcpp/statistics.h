@@ -0,0 +1,145 @@
+//
+// File:	include/odbcpp/statistics.h
+// Object:	Define the performance statistics objects of the odbcpp library
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_STATISTICS
+#define ODBCPP_STATISTICS
+
+#include	"odbcpp_config.h"
+#include	<sql.h>
+#include	<atomic>
+
+namespace odbcpp
+{
+
+
+
+class stopwatch
+{
+public:
+				stopwatch() : f_start(now()) {}
+
+	void			restart() { f_start = now(); }
+	SQLUBIGINT		elapsed() const { return now() - f_start; }
+
+	static SQLUBIGINT	now();
+
+private:
+	SQLUBIGINT		f_start;
+};
+
+
+class histogram
+{
+public:
+	/// Number of buckets; bucket i counts durations in [2^i, 2^(i+1)) nanoseconds
+	static const int	HISTOGRAM_BUCKETS = 40;
+
+				histogram();
+				histogram(const histogram& h);
+
+	histogram&		operator = (const histogram& h);
+
+	void			reset();
+	void			add(SQLUBIGINT ns);
+	void			merge(const histogram& h);
+
+	SQLUBIGINT		count() const { return f_count.load(std::memory_order_relaxed); }
+	SQLUBIGINT		total() const { return f_total.load(std::memory_order_relaxed); }
+	SQLUBIGINT		minimum() const;
+	SQLUBIGINT		maximum() const { return f_maximum.load(std::memory_order_relaxed); }
+	SQLUBIGINT		bucket(int idx) const { return f_buckets[idx].load(std::memory_order_relaxed); }
+	SQLUBIGINT		percentile(double p) const;
+
+private:
+	std::atomic<SQLUBIGINT>	f_count;
+	std::atomic<SQLUBIGINT>	f_total;
+	std::atomic<SQLUBIGINT>	f_minimum;
+	std::atomic<SQLUBIGINT>	f_maximum;
+	std::atomic<SQLUBIGINT>	f_buckets[HISTOGRAM_BUCKETS];
+};
+
+
+struct statistics_t
+{
+				statistics_t();
+				statistics_t(const statistics_t& stats);
+
+	statistics_t&		operator = (const statistics_t& stats);
+
+	void			reset();
+	void			merge(const statistics_t& stats);
+
+	void			add_execute(SQLUBIGINT ns);
+	void			add_fetch(SQLUBIGINT ns, SQLUBIGINT rows);
+	void			add_bytes_copied(SQLUBIGINT bytes);
+	void			add_describe();
+	void			add_timeout();
+	void			add_bind_time(SQLUBIGINT ns);
+
+	std::atomic<SQLUBIGINT>	f_executes;
+	std::atomic<SQLUBIGINT>	f_fetches;
+	std::atomic<SQLUBIGINT>	f_rows_fetched;
+	std::atomic<SQLUBIGINT>	f_bytes_copied;
+	std::atomic<SQLUBIGINT>	f_describes;
+	std::atomic<SQLUBIGINT>	f_timeouts;
+	histogram		f_execute_time;
+	histogram		f_fetch_time;
+	histogram		f_bind_time;
+};
+
+
+struct connect_statistics_t
+{
+				connect_statistics_t();
+
+	void			reset();
+
+	SQLUBIGINT		f_connects;
+	SQLUBIGINT		f_reused;
+	SQLUBIGINT		f_disconnects;
+	histogram		f_connect_time;
+	histogram		f_disconnect_time;
+};
+
+
+struct cache_statistics_t
+{
+				cache_statistics_t();
+
+	void			reset();
+	double			hit_ratio() const;
+
+	SQLUBIGINT		f_hits;
+	SQLUBIGINT		f_misses;
+	SQLUBIGINT		f_expired;
+	SQLUBIGINT		f_insertions;
+	SQLUBIGINT		f_evictions;
+	SQLUBIGINT		f_invalidations;
+	SQLULEN			f_entries;
+	SQLULEN			f_memory;
+};
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_STATISTICS
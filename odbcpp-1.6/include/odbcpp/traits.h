@@ -0,0 +1,274 @@
+//
+// File:	include/odbcpp/traits.h
+// Object:	Define the SQL traits of the C++ types
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_TRAITS
+#define ODBCPP_TRAITS
+
+#include	"datetime.h"
+#include	<sqlucode.h>
+#include	<string.h>
+#include	<string>
+#if __cplusplus >= 201703L
+#include	<optional>
+#include	<string_view>
+#endif
+
+namespace odbcpp
+{
+
+
+
+/** \brief The buffer of a column as filled by a fetch.
+ *
+ * This structure is given to the read() function of the sql_traits
+ * to convert the data of a column to a C++ value.
+ */
+struct column_buffer_t
+{
+	SQLSMALLINT		f_type;		// the SQL_C_... type of the buffer
+	const char *		f_data;		// the data of the column
+	SQLULEN			f_size;		// the size of the buffer in bytes
+	SQLLEN			f_indicator;	// the length of the data or SQL_NULL_DATA
+
+	/// Check whether the column is NULL.
+	bool			is_null() const { return f_indicator == SQL_NULL_DATA; }
+
+	/** \brief Retrieve the length of the data in bytes.
+	 *
+	 * When the data was truncated, the driver does not return the
+	 * length of the data available in the buffer, it is then searched.
+	 *
+	 * \return The number of bytes of data, without the terminator.
+	 */
+	SQLULEN			length() const
+				{
+					if(f_indicator >= 0 && static_cast<SQLULEN>(f_indicator) < f_size) {
+						return f_indicator;
+					}
+					if(f_type == SQL_C_WCHAR) {
+						const SQLWCHAR *s = reinterpret_cast<const SQLWCHAR *>(f_data);
+						SQLULEN max = f_size / sizeof(SQLWCHAR);
+						SQLULEN length = 0;
+						while(length < max && s[length] != 0) {
+							++length;
+						}
+						return length * sizeof(SQLWCHAR);
+					}
+					const void *end = memchr(f_data, '\0', f_size);
+					return end == NULL ? f_size : static_cast<const char *>(end) - f_data;
+				}
+};
+
+
+/** \brief The SQL traits of a C++ type.
+ *
+ * The record::bind() and dynamic_record::get() templates accept all
+ * the types with sql_traits. The traits define:
+ *
+ * \li c_type -- the SQL_C_... type used to bind the column
+ * \li buffer_size -- the size of the buffer in bytes, 0 to use the
+ *     size of the column (SQL_C_CHAR and SQL_C_WCHAR)
+ * \li direct -- whether the driver can write in the variable itself
+ * \li nullable -- whether read() accepts NULL columns
+ * \li read() -- the function converting the buffer to a value
+ *
+ * The library defines the traits of the ODBC types, bool,
+ * std::string, std::wstring, std::chrono::system_clock time points
+ * and, in C++17, std::string_view and std::optional<T>.
+ *
+ * A std::string_view points to the buffer of the record and is only
+ * valid until the next fetch.
+ *
+ * Other types can be supported by specializing this template in the
+ * odbcpp namespace, usually with converted_sql_traits.
+ */
+template<class T>
+struct sql_traits;
+
+
+/** \brief The traits of the types read as is.
+ *
+ * The driver writes these types directly in the variable bound with
+ * record::bind(), no conversion is necessary.
+ */
+template<class T, SQLSMALLINT C>
+struct fixed_sql_traits
+{
+	static const SQLSMALLINT	c_type = C;
+	static const SQLULEN		buffer_size = sizeof(T);
+	static const bool		direct = true;
+	static const bool		nullable = false;
+
+	static void			read(const column_buffer_t& column, T& value) { value = *reinterpret_cast<const T *>(column.f_data); }
+};
+
+// SQLCHAR was always bound as SQL_C_TINYINT (also used for SQL_C_BIT)
+template<> struct sql_traits<SQLCHAR> : fixed_sql_traits<SQLCHAR, SQL_C_TINYINT> {};
+template<> struct sql_traits<SQLSCHAR> : fixed_sql_traits<SQLSCHAR, SQL_C_TINYINT> {};
+template<> struct sql_traits<SQLSMALLINT> : fixed_sql_traits<SQLSMALLINT, SQL_C_SHORT> {};
+template<> struct sql_traits<SQLUSMALLINT> : fixed_sql_traits<SQLUSMALLINT, SQL_C_USHORT> {};
+template<> struct sql_traits<SQLINTEGER> : fixed_sql_traits<SQLINTEGER, SQL_C_LONG> {};
+template<> struct sql_traits<SQLUINTEGER> : fixed_sql_traits<SQLUINTEGER, SQL_C_ULONG> {};
+template<> struct sql_traits<SQLBIGINT> : fixed_sql_traits<SQLBIGINT, SQL_C_SBIGINT> {};
+template<> struct sql_traits<SQLUBIGINT> : fixed_sql_traits<SQLUBIGINT, SQL_C_UBIGINT> {};
+template<> struct sql_traits<SQLREAL> : fixed_sql_traits<SQLREAL, SQL_C_FLOAT> {};
+template<> struct sql_traits<SQLFLOAT> : fixed_sql_traits<SQLFLOAT, SQL_C_DOUBLE> {};
+template<> struct sql_traits<SQL_DATE_STRUCT> : fixed_sql_traits<SQL_DATE_STRUCT, SQL_C_DATE> {};
+template<> struct sql_traits<SQL_TIME_STRUCT> : fixed_sql_traits<SQL_TIME_STRUCT, SQL_C_TIME> {};
+template<> struct sql_traits<SQL_TIMESTAMP_STRUCT> : fixed_sql_traits<SQL_TIMESTAMP_STRUCT, SQL_C_TIMESTAMP> {};
+template<> struct sql_traits<SQL_NUMERIC_STRUCT> : fixed_sql_traits<SQL_NUMERIC_STRUCT, SQL_C_NUMERIC> {};
+template<> struct sql_traits<SQLGUID> : fixed_sql_traits<SQLGUID, SQL_C_GUID> {};
+
+
+template<>
+struct sql_traits<bool>
+{
+	static const SQLSMALLINT	c_type = SQL_C_BIT;
+	static const SQLULEN		buffer_size = sizeof(SQLCHAR);
+	static const bool		direct = false;
+	static const bool		nullable = false;
+
+	static void			read(const column_buffer_t& column, bool& value) { value = *column.f_data != 0; }
+};
+
+
+template<>
+struct sql_traits<std::string>
+{
+	static const SQLSMALLINT	c_type = SQL_C_CHAR;
+	static const SQLULEN		buffer_size = 0;
+	static const bool		direct = false;
+	static const bool		nullable = false;
+
+	static void			read(const column_buffer_t& column, std::string& value) { value.assign(column.f_data, column.length()); }
+};
+
+
+template<>
+struct sql_traits<std::wstring>
+{
+	static const SQLSMALLINT	c_type = SQL_C_WCHAR;
+	static const SQLULEN		buffer_size = 0;
+	static const bool		direct = false;
+	static const bool		nullable = false;
+
+	static void			read(const column_buffer_t& column, std::wstring& value)
+					{
+						const SQLWCHAR *s = reinterpret_cast<const SQLWCHAR *>(column.f_data);
+						const size_t length = column.length() / sizeof(SQLWCHAR);
+						value.resize(length);
+						for(size_t idx = 0; idx < length; ++idx) {
+							value[idx] = static_cast<wchar_t>(s[idx]);
+						}
+					}
+};
+
+
+template<class D>
+struct sql_traits<std::chrono::time_point<std::chrono::system_clock, D> >
+{
+	static const SQLSMALLINT	c_type = SQL_C_TIMESTAMP;
+	static const SQLULEN		buffer_size = sizeof(SQL_TIMESTAMP_STRUCT);
+	static const bool		direct = false;
+	static const bool		nullable = false;
+
+	static void			read(const column_buffer_t& column, std::chrono::time_point<std::chrono::system_clock, D>& value)
+					{
+						value = std::chrono::time_point_cast<D>(timestamp_to_time_point(*reinterpret_cast<const SQL_TIMESTAMP_STRUCT *>(column.f_data)));
+					}
+};
+
+
+#if __cplusplus >= 201703L
+template<>
+struct sql_traits<std::string_view>
+{
+	static const SQLSMALLINT	c_type = SQL_C_CHAR;
+	static const SQLULEN		buffer_size = 0;
+	static const bool		direct = false;
+	static const bool		nullable = false;
+
+	static void			read(const column_buffer_t& column, std::string_view& value) { value = std::string_view(column.f_data, column.length()); }
+};
+
+
+template<class T>
+struct sql_traits<std::optional<T> >
+{
+	static const SQLSMALLINT	c_type = sql_traits<T>::c_type;
+	static const SQLULEN		buffer_size = sql_traits<T>::buffer_size;
+	static const bool		direct = false;
+	static const bool		nullable = true;
+
+	static void			read(const column_buffer_t& column, std::optional<T>& value)
+					{
+						if(column.is_null()) {
+							value.reset();
+							return;
+						}
+						// reading in the existing value reuses its buffers
+						if(!value) {
+							value.emplace();
+						}
+						sql_traits<T>::read(column, *value);
+					}
+};
+#endif
+
+
+/** \brief The traits of a type converted from another type.
+ *
+ * Derive the sql_traits of your own types from this structure and
+ * define a convert() function. The column is read as a \p B and then
+ * converted to a \p T:
+ *
+ * \code
+ * namespace odbcpp {
+ * template<>
+ * struct sql_traits<money> : converted_sql_traits<money, std::string>
+ * {
+ *	static void convert(const std::string& str, money& value) { value = money::parse(str); }
+ * };
+ * }
+ * \endcode
+ */
+template<class T, class B>
+struct converted_sql_traits
+{
+	static const SQLSMALLINT	c_type = sql_traits<B>::c_type;
+	static const SQLULEN		buffer_size = sql_traits<B>::buffer_size;
+	static const bool		direct = false;
+	static const bool		nullable = sql_traits<B>::nullable;
+
+	static void			read(const column_buffer_t& column, T& value)
+					{
+						B base;
+						sql_traits<B>::read(column, base);
+						sql_traits<T>::convert(base, value);
+					}
+};
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_TRAITS
@@ -0,0 +1,97 @@
+//
+// File:	include/odbcpp/transaction.h
+// Object:	Define the transaction runner of the odbcpp library
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_TRANSACTION
+#define ODBCPP_TRANSACTION
+
+#include	"connection.h"
+#include	<functional>
+#include	<map>
+#include	<random>
+
+namespace odbcpp
+{
+
+
+
+class transaction_runner
+{
+public:
+	/// How an error is handled
+	enum error_class_t {
+		ERROR_FATAL,		///< the error is returned to the caller
+		ERROR_RETRY,		///< the transaction is run again
+		ERROR_RECONNECT		///< the connection is reset and the transaction run again
+	};
+	/// The function running the transaction
+	typedef std::function<void (connection& conn)>	transaction_t;
+	/// The function connecting the connection
+	typedef std::function<void (connection& conn)>	connect_t;
+
+				transaction_runner(connection& conn, const connect_t& reconnect = connect_t());
+
+	void			set_max_attempts(SQLULEN max_attempts) { f_max_attempts = max_attempts; }
+	SQLULEN			get_max_attempts() const { return f_max_attempts; }
+	void			set_backoff(SQLUBIGINT initial, SQLUBIGINT maximum);
+	void			set_budget(SQLUBIGINT budget) { f_budget = budget; }
+	SQLUBIGINT		get_budget() const { return f_budget; }
+	void			set_error_class(const std::string& state, error_class_t error_class);
+	error_class_t		classify(const odbcpp_error& e) const;
+
+	void			run(const transaction_t& transaction);
+
+	SQLUBIGINT		attempts() const { return f_attempts; }
+	SQLUBIGINT		retries() const { return f_retries; }
+	SQLUBIGINT		reconnects() const { return f_reconnects; }
+
+private:
+	/// The error classes by SQLSTATE
+	typedef std::map<std::string, error_class_t>	state_map_t;
+
+	// no copy
+				transaction_runner(const transaction_runner& runner);
+	transaction_runner&	operator = (const transaction_runner& runner);
+
+	void			attempt(const transaction_t& transaction);
+	void			rollback();
+	void			reset_connection();
+	SQLUBIGINT		backoff(SQLULEN retry);
+
+	smartptr<connection>	f_connection;
+	connect_t		f_reconnect;
+	SQLULEN			f_max_attempts;
+	SQLUBIGINT		f_initial_backoff;
+	SQLUBIGINT		f_max_backoff;
+	SQLUBIGINT		f_budget;
+	state_map_t		f_states;
+	std::mt19937_64		f_random;
+	bool			f_reset;
+	SQLUBIGINT		f_attempts;
+	SQLUBIGINT		f_retries;
+	SQLUBIGINT		f_reconnects;
+};
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_TRANSACTION
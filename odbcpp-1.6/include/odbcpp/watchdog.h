@@ -0,0 +1,86 @@
+//
+// File:	include/odbcpp/watchdog.h
+// Object:	Define the query watchdog of the odbcpp library
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+#ifndef ODBCPP_WATCHDOG
+#define ODBCPP_WATCHDOG
+
+#include	"odbcpp_config.h"
+#include	<sql.h>
+#include	<condition_variable>
+#include	<map>
+#include	<mutex>
+#include	<thread>
+
+namespace odbcpp
+{
+
+
+
+class watchdog
+{
+public:
+	/// Identify a watched call
+	typedef SQLUBIGINT	ticket_t;
+
+	static watchdog&	instance();
+
+	ticket_t		arm(SQLHSTMT stmt, SQLUBIGINT timeout);
+	bool			disarm(ticket_t ticket);
+	SQLUBIGINT		cancellations() const;
+
+private:
+	/// The tickets by deadline
+	typedef std::multimap<SQLUBIGINT, ticket_t>	deadline_map_t;
+	struct entry_t {
+		SQLHSTMT			f_handle;
+		bool				f_fired;
+		bool				f_cancelling;
+		deadline_map_t::iterator	f_deadline;
+	};
+	/// The watched calls by ticket
+	typedef std::map<ticket_t, entry_t>		entry_map_t;
+
+				watchdog();
+				~watchdog();
+
+	// no copy
+				watchdog(const watchdog& dog);
+	watchdog&		operator = (const watchdog& dog);
+
+	void			run();
+
+	mutable std::mutex	f_mutex;
+	std::condition_variable	f_condition;
+	std::condition_variable	f_cancelled;
+	entry_map_t		f_entries;
+	deadline_map_t		f_deadlines;
+	ticket_t		f_next_ticket;
+	SQLUBIGINT		f_cancellations;
+	bool			f_stop;
+	std::thread		f_thread;
+};
+
+
+
+}	// namespace odbcpp
+
+#endif		// #ifndef ODBCPP_WATCHDOG
@@ -0,0 +1,368 @@
+//
+// File:	src/bitmap.cpp
+// Object:	Implementation of the validity bitmap
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/bitmap.h"
+
+#if defined(__SSE2__) && defined(__x86_64__) || defined(_M_X64)
+#include	<emmintrin.h>
+#define	ODBCPP_SSE2_BITMAP
+#endif
+
+
+namespace odbcpp
+{
+
+
+namespace
+{
+
+/** \brief Count the bits set in a word.
+ *
+ * \param[in] word   The word to check
+ *
+ * \return The number of bits set to 1.
+ */
+inline SQLULEN popcount(SQLUBIGINT word)
+{
+#ifdef __GNUC__
+	return __builtin_popcountll(word);
+#else
+	word = word - ((word >> 1) & 0x5555555555555555ULL);
+	word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+	word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return static_cast<SQLULEN>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+
+/** \brief Find the first bit set in a word.
+ *
+ * \param[in] word   The word to check, it cannot be zero
+ *
+ * \return The position of the least significant bit set to 1.
+ */
+inline SQLULEN first_bit(SQLUBIGINT word)
+{
+#ifdef __GNUC__
+	return __builtin_ctzll(word);
+#else
+	SQLULEN bit = 0;
+	while((word & 1) == 0) {
+		word >>= 1;
+		++bit;
+	}
+	return bit;
+#endif
+}
+
+
+/** \brief Build one word of the bitmap.
+ *
+ * With SSE2 and 64 bit indicators, the indicators are compared two at
+ * a time: SSE2 has no 64 bit comparison so the two 32 bit halves are
+ * compared and combined, then _mm_movemask_pd() moves the two results
+ * in the low bits of an integer. Eight indicators give one byte of the
+ * word.
+ *
+ * Other targets compare one indicator at a time; compilers do not
+ * vectorize the shift of the results in the word.
+ *
+ * \param[in] indicators   The 64 indicators of the word
+ *
+ * \return The bits of the word, 1 for each row that is not NULL.
+ */
+inline SQLUBIGINT build_word(const SQLLEN *indicators)
+{
+#ifdef ODBCPP_SSE2_BITMAP
+	if(sizeof(SQLLEN) == 8) {
+		const __m128i null_data = _mm_set1_epi64x(SQL_NULL_DATA);
+		const __m128i *v = reinterpret_cast<const __m128i *>(indicators);
+		SQLUBIGINT nulls = 0;
+		for(int byte = 0; byte < 8; ++byte, v += 4) {
+			int bits = 0;
+			for(int pair = 0; pair < 4; ++pair) {
+				const __m128i halves = _mm_cmpeq_epi32(_mm_loadu_si128(v + pair), null_data);
+				const __m128i equal = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+				bits |= _mm_movemask_pd(_mm_castsi128_pd(equal)) << (pair * 2);
+			}
+			nulls |= static_cast<SQLUBIGINT>(bits) << (byte * 8);
+		}
+		return ~nulls;
+	}
+#endif
+	SQLUBIGINT word = 0;
+	for(int bit = 0; bit < 64; ++bit) {
+		word |= static_cast<SQLUBIGINT>(indicators[bit] != SQL_NULL_DATA) << bit;
+	}
+	return word;
+}
+
+}	// no name namespace
+
+
+const SQLULEN validity_bitmap::npos;
+
+
+
+/** \class validity_bitmap
+ *
+ * \brief A compact representation of the NULL state of a column.
+ *
+ * A validity bitmap holds one bit per row of a column: 1 when the
+ * row is defined and 0 when it is NULL. This is 64 times smaller
+ * than the indicator array of a rowset and makes it possible to
+ * count and skip the NULL rows 64 rows at a time.
+ *
+ * The bits of row \em n are bit \em n % 64 of word \em n / 64 which
+ * is the layout used by columnar formats such as Apache Arrow. The
+ * bits past size() in the last word are always 0.
+ *
+ * A bitmap is usually built from the indicator array of a column
+ * read with a rowset:
+ *
+ * \code
+ * validity_bitmap valid;
+ * rec.get_validity("price", valid);
+ * for(SQLULEN row = valid.next_valid(0); row != validity_bitmap::npos; row = valid.next_valid(row + 1)) {
+ *	...
+ * }
+ * \endcode
+ *
+ * \sa dynamic_record::get_validity()
+ */
+
+
+/** \var validity_bitmap::npos
+ *
+ * \brief The value returned when no row is found.
+ */
+
+
+/** \fn validity_bitmap::validity_bitmap()
+ *
+ * \brief Initialize an empty bitmap.
+ */
+
+
+/** \brief Build the bitmap from an array of indicators.
+ *
+ * This function replaces the content of the bitmap with the NULL
+ * state of the \p count rows of \p indicators. A row is NULL when
+ * its indicator is SQL_NULL_DATA.
+ *
+ * The buffer of the bitmap is reused so building the bitmap of each
+ * rowset of a result does not allocate memory once the bitmap is
+ * large enough.
+ *
+ * \param[in] indicators   The array of indicators
+ * \param[in] count        The number of rows
+ */
+void validity_bitmap::assign(const SQLLEN *indicators, SQLULEN count)
+{
+	const SQLULEN full = count / 64;
+	const SQLULEN rest = count % 64;
+	f_words.resize(full + (rest != 0));
+	f_size = count;
+
+	SQLULEN valid = 0;
+	for(SQLULEN idx = 0; idx < full; ++idx, indicators += 64) {
+		const SQLUBIGINT word = build_word(indicators);
+		f_words[idx] = word;
+		valid += popcount(word);
+	}
+	if(rest != 0) {
+		SQLUBIGINT word = 0;
+		for(SQLULEN bit = 0; bit < rest; ++bit) {
+			word |= static_cast<SQLUBIGINT>(indicators[bit] != SQL_NULL_DATA) << bit;
+		}
+		f_words[full] = word;
+		valid += popcount(word);
+	}
+	f_null_count = count - valid;
+}
+
+
+/** \brief Clear the bitmap.
+ *
+ * The bitmap has no rows after this call. The buffer is kept.
+ */
+void validity_bitmap::clear()
+{
+	f_words.clear();
+	f_size = 0;
+	f_null_count = 0;
+}
+
+
+/** \brief Search the next row that is not NULL.
+ *
+ * This function skips the NULL rows 64 at a time.
+ *
+ * \param[in] row   The first row to check
+ *
+ * \return The first row at or after \p row that is not NULL, or npos.
+ */
+SQLULEN validity_bitmap::next_valid(SQLULEN row) const
+{
+	if(row >= f_size) {
+		return npos;
+	}
+	SQLULEN idx = row / 64;
+	SQLUBIGINT word = f_words[idx] & (~0ULL << (row % 64));
+	const SQLULEN max = f_words.size();
+	while(word == 0) {
+		if(++idx >= max) {
+			return npos;
+		}
+		word = f_words[idx];
+	}
+	return idx * 64 + first_bit(word);
+}
+
+
+/** \brief Search the next row that is NULL.
+ *
+ * This function skips the rows that are not NULL 64 at a time.
+ *
+ * \param[in] row   The first row to check
+ *
+ * \return The first row at or after \p row that is NULL, or npos.
+ */
+SQLULEN validity_bitmap::next_null(SQLULEN row) const
+{
+	if(row >= f_size) {
+		return npos;
+	}
+	SQLULEN idx = row / 64;
+	SQLUBIGINT word = ~f_words[idx] & (~0ULL << (row % 64));
+	const SQLULEN max = f_words.size();
+	while(word == 0) {
+		if(++idx >= max) {
+			return npos;
+		}
+		word = ~f_words[idx];
+	}
+	// the bits past the end are 0 in f_words and thus 1 here
+	row = idx * 64 + first_bit(word);
+	return row < f_size ? row : npos;
+}
+
+
+/** \fn validity_bitmap::size() const
+ *
+ * \brief Retrieve the number of rows in the bitmap.
+ *
+ * \return The number of rows.
+ */
+
+/** \fn validity_bitmap::null_count() const
+ *
+ * \brief Retrieve the number of NULL rows.
+ *
+ * The count is computed by assign() so this call is free.
+ *
+ * \return The number of rows that are NULL.
+ */
+
+/** \fn validity_bitmap::valid_count() const
+ *
+ * \brief Retrieve the number of rows that are not NULL.
+ *
+ * \return The number of rows that are not NULL.
+ */
+
+/** \fn validity_bitmap::is_valid(SQLULEN row) const
+ *
+ * \brief Check whether a row is defined.
+ *
+ * \param[in] row   The row to check, it must be smaller than size()
+ *
+ * \return true if the row is not NULL.
+ */
+
+/** \fn validity_bitmap::is_null(SQLULEN row) const
+ *
+ * \brief Check whether a row is NULL.
+ *
+ * \param[in] row   The row to check, it must be smaller than size()
+ *
+ * \return true if the row is NULL.
+ */
+
+/** \fn validity_bitmap::words() const
+ *
+ * \brief Retrieve the words of the bitmap.
+ *
+ * This gives direct access to the bits, for example to combine the
+ * bitmaps of several columns with a bitwise AND.
+ *
+ * \return A pointer to word_count() words, or NULL if the bitmap is empty.
+ */
+
+/** \fn validity_bitmap::word_count() const
+ *
+ * \brief Retrieve the number of words of the bitmap.
+ *
+ * \return The number of 64 bit words, (size() + 63) / 64.
+ */
+
+/** \var validity_bitmap::f_words
+ *
+ * \brief The bits, 64 rows per word.
+ */
+
+/** \var validity_bitmap::f_size
+ *
+ * \brief The number of rows.
+ */
+
+/** \var validity_bitmap::f_null_count
+ *
+ * \brief The number of rows that are NULL, computed by assign().
+ */
+
+
+/** \brief Count the NULL rows of an indicator array.
+ *
+ * This function counts the indicators that are SQL_NULL_DATA. GCC
+ * only vectorizes this loop when AVX2 is available (-march=x86-64-v3
+ * at -O3), otherwise it counts one indicator at a time.
+ *
+ * \param[in] indicators   The array of indicators
+ * \param[in] count        The number of rows
+ *
+ * \return The number of NULL rows.
+ */
+SQLULEN count_nulls(const SQLLEN *indicators, SQLULEN count)
+{
+	SQLULEN nulls = 0;
+	for(SQLULEN idx = 0; idx < count; ++idx) {
+		nulls += indicators[idx] == SQL_NULL_DATA;
+	}
+	return nulls;
+}
+
+
+
+}	// namespace odbcpp
+
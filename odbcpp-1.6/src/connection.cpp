@@ -60,6 +60,36 @@ namespace odbcpp
  * flag.
  */
 
+/** \var connection::f_statistics
+ *
+ * \brief The performance statistics of all the statements of this connection.
+ *
+ * Each statement created on this connection adds its own statistics
+ * to this variable. The statements may be used by different threads;
+ * the counters are atomic so no lock is necessary. Use
+ * get_statistics() to retrieve a copy.
+ */
+
+/** \var connection::f_slow_query_log
+ *
+ * \brief The slow query log settings of this connection.
+ *
+ * The statements of this connection measure their queries when this
+ * log is active and report them here.
+ */
+
+/** \var connection::f_result_cache
+ *
+ * \brief The result cache used by statement::execute_cached().
+ *
+ * The cache is not owned by the connection.
+ */
+
+/** \var connection::f_timeout
+ *
+ * \brief The default time limit of the calls of the statements in nanoseconds.
+ */
+
 /** \var connection::f_environment
  *
  * \brief The parent environment of this connection
@@ -82,10 +112,15 @@ namespace odbcpp
 connection::connection(environment& env) :
 	handle(SQL_HANDLE_DBC),
 	f_environment(&env),
-	f_connected(false)
+	f_connected(false),
+	//f_statistics -- auto-init
+	//f_slow_query_log -- auto-init
+	f_result_cache(NULL),
+	f_timeout(0)
 {
 	// we right away allocate a connection
 	// throw if it fails
+	trace(SQL_API_SQLALLOCHANDLE);
 	check(SQLAllocHandle(f_handle_type, f_environment->get_handle(), &f_handle), f_environment);
 }
 
@@ -95,10 +130,17 @@ connection::connection(environment& env) :
  * The destructor calls the disconnect function to
  * ensure that the connection is closed before freeing
  * the connection.
+ *
+ * When the connection is not connected, SQLDisconnect() is not called
+ * since it would fail and the error would be gathered for nothing.
+ * With connection pooling, the disconnection returns the connection
+ * to the pool of the driver manager.
  */
 connection::~connection()
 {
-	try { disconnect(); } catch(...) {}
+	if(f_connected) {
+		try { disconnect(); } catch(...) {}
+	}
 }
 
 
@@ -122,8 +164,10 @@ void connection::set_attr(SQLINTEGER attr, SQLINTEGER integer)
 		throw odbcpp_error(d);
 	}
 	memcpy(&ptr, &integer, sizeof(integer));
+	trace(SQL_API_SQLSETCONNECTATTR);
 	check(SQLSetConnectAttr(f_handle, attr, ptr, 0));
 #else
+	trace(SQL_API_SQLSETCONNECTATTR);
 	check(SQLSetConnectAttr(f_handle, attr, reinterpret_cast<SQLPOINTER>(integer), 0));
 #endif
 }
@@ -142,6 +186,7 @@ void connection::set_attr(SQLINTEGER attr, SQLINTEGER integer)
  */
 void connection::set_attr(SQLINTEGER attr, SQLPOINTER ptr, SQLINTEGER length)
 {
+	trace(SQL_API_SQLSETCONNECTATTR);
 	check(SQLSetConnectAttr(f_handle, attr, ptr, length));
 }
 
@@ -163,10 +208,67 @@ void connection::set_attr(SQLINTEGER attr, SQLPOINTER ptr, SQLINTEGER length)
  */
 void connection::connect(const std::string& dsn, const std::string& login, const std::string& passwd)
 {
+	stopwatch sw;
+	trace(SQL_API_SQLCONNECT);
 	check(SQLConnect(f_handle,
 			(SQLCHAR *) dsn.c_str(), static_cast<SQLSMALLINT>(dsn.length()),
 			(SQLCHAR *) login.c_str(), static_cast<SQLSMALLINT>(login.length()),
 			(SQLCHAR *) passwd.c_str(), static_cast<SQLSMALLINT>(passwd.length())));
+	f_environment->add_connect(sw.elapsed());
+	f_connected = true;
+}
+
+
+/** \brief Connect to a database with a connection string.
+ *
+ * This function connects with SQLDriverConnect(). Contrary to connect(),
+ * the connection string can include driver specific settings such as
+ * the fetch size or the network packet size so these do not require a
+ * separate DSN.
+ *
+ * The \p presets parameter is a comma separated list of preset names
+ * (see connection_string) which settings get merged in the connection
+ * string. The settings found in \p str have priority over the presets
+ * and the first presets have priority over the following ones.
+ *
+ * \code
+ * conn.connect_string("DSN=sales;UID=me;PWD=secret", "postgresql-stream");
+ * \endcode
+ *
+ * The driver is never allowed to prompt the user.
+ *
+ * \param[in] str       The connection string
+ * \param[in] presets   A comma separated list of preset names
+ *
+ * \exception odbcpp_error
+ * If the connection fails, a preset is not defined, or the
+ * connection string is invalid, this function will throw an
+ * odbcpp_error exception.
+ */
+void connection::connect_string(const std::string& str, const std::string& presets)
+{
+	connection_string cs(str);
+	std::string::size_type pos = 0;
+	while(pos < presets.length()) {
+		std::string::size_type end = presets.find(',', pos);
+		if(end == std::string::npos) {
+			end = presets.length();
+		}
+		std::string::size_type start = presets.find_first_not_of(" \t", pos);
+		std::string::size_type last = presets.find_last_not_of(" \t", end - 1);
+		if(start < end && last != std::string::npos && last >= start) {
+			cs.add_preset(presets.substr(start, last - start + 1));
+		}
+		pos = end + 1;
+	}
+	std::string s(cs.to_string());
+
+	stopwatch sw;
+	trace(SQL_API_SQLDRIVERCONNECT);
+	check(SQLDriverConnect(f_handle, NULL,
+			(SQLCHAR *) s.c_str(), static_cast<SQLSMALLINT>(s.length()),
+			NULL, 0, NULL, SQL_DRIVER_NOPROMPT));
+	f_environment->add_connect(sw.elapsed());
 	f_connected = true;
 }
 
@@ -185,7 +287,10 @@ void connection::connect(const std::string& dsn, const std::string& login, const
 void connection::disconnect()
 {
 	f_connected = false;
+	stopwatch sw;
+	trace(SQL_API_SQLDISCONNECT);
 	check(SQLDisconnect(f_handle));
+	f_environment->add_disconnect(sw.elapsed());
 }
 
 
@@ -205,6 +310,107 @@ void connection::disconnect()
 
 
 
+/** \fn connection::get_statistics() const
+ *
+ * \brief Retrieve a snapshot of the connection statistics.
+ *
+ * This function returns a copy of the performance statistics gathered
+ * by all the statements of this connection since it was created or
+ * since the last call to reset_statistics().
+ *
+ * \return A copy of the connection statistics.
+ *
+ * \sa statement::get_statistics()
+ */
+
+/** \fn connection::reset_statistics()
+ *
+ * \brief Reset the connection statistics.
+ *
+ * This function resets all the counters and histograms of this
+ * connection. The statistics of the statements are not affected.
+ */
+
+
+/** \brief Setup the slow query log.
+ *
+ * This function installs a sink receiving the queries that are
+ * considered slow. A query is slow when the time from the execute()
+ * call to the end of its result is at least \p time_threshold
+ * nanoseconds, or when it returned at least \p rows_threshold rows.
+ * A threshold of zero is ignored.
+ *
+ * When no sink is defined (the default) the statements do not
+ * measure anything more than the statistics. When a sink is defined,
+ * each execute() saves a copy of the SQL order in the statement.
+ * The string buffer is reused from one query to the next.
+ *
+ * To avoid flooding the log when the database gets slow, at most
+ * \p max_per_second queries are sent to the sink each second. The
+ * number of queries dropped is sent with the next query logged.
+ *
+ * The sink is not owned by the connection. It must remain valid
+ * until you set another sink or the connection is destroyed.
+ *
+ * \param[in] sink             The object receiving the slow queries, NULL to turn the log off
+ * \param[in] time_threshold   The time in nanoseconds over which a query is slow
+ * \param[in] rows_threshold   The number of rows over which a query is slow
+ * \param[in] max_per_second   The maximum number of queries logged per second, 0 for no limit
+ *
+ * \sa slow_query_sink
+ */
+void connection::set_slow_query_log(slow_query_sink *sink, SQLUBIGINT time_threshold,
+		SQLLEN rows_threshold, SQLUINTEGER max_per_second)
+{
+	f_slow_query_log.set(sink, time_threshold, rows_threshold, max_per_second);
+}
+
+
+
+/** \fn connection::set_result_cache(result_cache *cache)
+ *
+ * \brief Define the result cache of this connection.
+ *
+ * The statements of this connection use this cache when their
+ * execute_cached() function is called. Without a cache,
+ * execute_cached() is the same as execute().
+ *
+ * The same cache can be shared by several connections. It is not
+ * owned by the connection and must remain valid until you set
+ * another cache or the connection is destroyed.
+ *
+ * \param[in] cache   The result cache, NULL to stop caching
+ *
+ * \sa statement::execute_cached()
+ */
+
+/** \fn connection::get_result_cache() const
+ *
+ * \brief Retrieve the result cache of this connection.
+ *
+ * \return The result cache or NULL.
+ */
+
+
+/** \fn connection::set_timeout(SQLUBIGINT timeout)
+ *
+ * \brief Limit the duration of the calls of the statements.
+ *
+ * This timeout is used by the statements of this connection that
+ * do not have their own (see statement::set_timeout().) The calls
+ * still running after \p timeout nanoseconds are canceled.
+ *
+ * \param[in] timeout   The time limit in nanoseconds, 0 for no limit
+ */
+
+/** \fn connection::get_timeout() const
+ *
+ * \brief Retrieve the default time limit of the statements.
+ *
+ * \return The time limit in nanoseconds, 0 if the calls are not limited.
+ */
+
+
 /** \brief Immediately commit all the transactions.
  *
  * This function sends a commit to all the transactions running
@@ -217,6 +423,7 @@ void connection::disconnect()
  */
 void connection::commit()
 {
+	trace(SQL_API_SQLENDTRAN);
 	check(SQLEndTran(f_handle_type, f_handle, SQL_COMMIT));
 }
 
@@ -234,6 +441,7 @@ void connection::commit()
  */
 void connection::rollback()
 {
+	trace(SQL_API_SQLENDTRAN);
 	check(SQLEndTran(f_handle_type, f_handle, SQL_ROLLBACK));
 }
 
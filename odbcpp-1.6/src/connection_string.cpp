@@ -0,0 +1,422 @@
+//
+// File:	src/connection_string.cpp
+// Object:	Implementation of the connection string and its presets
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/connection_string.h"
+#include	"odbcpp/exception.h"
+#include	<cctype>
+#include	<map>
+#include	<mutex>
+
+
+namespace odbcpp
+{
+
+
+namespace
+{
+
+/** \brief Compare two keys of a connection string.
+ *
+ * The keys of a connection string are case insensitive.
+ *
+ * \param[in] a   The first key
+ * \param[in] b   The second key
+ *
+ * \return true if both keys are equal, ignoring case.
+ */
+bool same_key(const std::string& a, const std::string& b)
+{
+	if(a.length() != b.length()) {
+		return false;
+	}
+	for(std::string::size_type idx = 0; idx < a.length(); ++idx) {
+		if(tolower(static_cast<unsigned char>(a[idx])) != tolower(static_cast<unsigned char>(b[idx]))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+/** \brief The presets by name.
+ *
+ * This function returns the map of presets, initialized with the
+ * presets defined by the library. The caller must lock the mutex
+ * returned by preset_mutex().
+ *
+ * \return The map of presets.
+ */
+std::map<std::string, std::string>& presets()
+{
+	static std::map<std::string, std::string> p;
+	if(p.empty()) {
+		// psqlODBC: stream large results with a server side cursor
+		p["postgresql-stream"] = "UseDeclareFetch=1;Fetch=10000";
+		// psqlODBC: prepare the statements on the server
+		p["postgresql-prepare"] = "UseServerSidePrepare=1";
+		// Microsoft and FreeTDS drivers: largest network packets
+		p["sqlserver-throughput"] = "Packet Size=32767";
+		// MySQL Connector/ODBC: stream results, forward only cursors
+		p["mysql-stream"] = "NO_CACHE=1;FORWARD_CURSOR=1";
+		// MySQL Connector/ODBC: compressed protocol, for slow links
+		p["mysql-compress"] = "COMPRESSED_PROTO=1";
+	}
+	return p;
+}
+
+
+/** \brief The mutex protecting the presets.
+ *
+ * \return The mutex to lock before accessing presets().
+ */
+std::mutex& preset_mutex()
+{
+	static std::mutex m;
+	return m;
+}
+
+}	// no name namespace
+
+
+
+
+/** \class connection_string
+ *
+ * \brief Build the connection string of SQLDriverConnect().
+ *
+ * A connection string is a list of key=value pairs separated by
+ * semicolons. Values that include special characters are written
+ * between curly brackets:
+ *
+ * \code
+ * DRIVER={PostgreSQL Unicode};SERVER=db1;DATABASE=sales;UID=me;PWD=secret
+ * \endcode
+ *
+ * This object parses and generates such strings. The keys are case
+ * insensitive and are kept in the order they were first defined.
+ *
+ * Presets are named lists of settings, usually driver specific
+ * performance settings such as the fetch size or the packet size.
+ * add_preset() adds the settings of a preset that were not already
+ * defined. The library defines the following presets:
+ *
+ * \li postgresql-stream -- UseDeclareFetch=1;Fetch=10000
+ * \li postgresql-prepare -- UseServerSidePrepare=1
+ * \li sqlserver-throughput -- Packet Size=32767
+ * \li mysql-stream -- NO_CACHE=1;FORWARD_CURSOR=1
+ * \li mysql-compress -- COMPRESSED_PROTO=1
+ *
+ * Use define_preset() to add your own or change these.
+ *
+ * \sa connection::connect_string()
+ */
+
+
+/** \brief Initialize a connection string.
+ *
+ * \param[in] str   The initial connection string, may be empty
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if \p str is not a valid connection string.
+ */
+connection_string::connection_string(const std::string& str)
+	//f_values -- auto-init
+{
+	parse(str);
+}
+
+
+/** \brief Add the settings of a connection string.
+ *
+ * This function parses \p str and adds its settings to this object.
+ *
+ * \param[in] str       The connection string to parse
+ * \param[in] replace   Whether the keys already defined get the new values
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if a value starts with a curly bracket
+ * which is not closed.
+ */
+void connection_string::parse(const std::string& str, bool replace)
+{
+	std::string::size_type pos = 0;
+	const std::string::size_type max = str.length();
+	while(pos < max) {
+		// skip empty entries
+		if(str[pos] == ';' || isspace(static_cast<unsigned char>(str[pos]))) {
+			++pos;
+			continue;
+		}
+
+		std::string::size_type end = str.find_first_of("=;", pos);
+		if(end == std::string::npos) {
+			end = max;
+		}
+		std::string::size_type key_end = end;
+		while(key_end > pos && isspace(static_cast<unsigned char>(str[key_end - 1]))) {
+			--key_end;
+		}
+		std::string key(str, pos, key_end - pos);
+		std::string value;
+		pos = end;
+		if(pos < max && str[pos] == '=') {
+			++pos;
+			if(pos < max && str[pos] == '{') {
+				// {...} where }} represents one }
+				for(++pos;; ++pos) {
+					if(pos >= max) {
+						diagnostic d(odbcpp_error::ODBCPP_INCORRECT_USE, std::string("missing } in the connection string value of \"") + key + "\"");
+						throw odbcpp_error(d);
+					}
+					if(str[pos] == '}') {
+						if(pos + 1 < max && str[pos + 1] == '}') {
+							++pos;
+						}
+						else {
+							++pos;
+							break;
+						}
+					}
+					value += str[pos];
+				}
+				end = str.find(';', pos);
+				pos = end == std::string::npos ? max : end;
+			}
+			else {
+				end = str.find(';', pos);
+				if(end == std::string::npos) {
+					end = max;
+				}
+				// spaces around a value without brackets are ignored
+				std::string::size_type start = pos;
+				while(start < end && isspace(static_cast<unsigned char>(str[start]))) {
+					++start;
+				}
+				std::string::size_type value_end = end;
+				while(value_end > start && isspace(static_cast<unsigned char>(str[value_end - 1]))) {
+					--value_end;
+				}
+				value.assign(str, start, value_end - start);
+				pos = end;
+			}
+		}
+		set(key, value, replace);
+	}
+}
+
+
+/** \brief Define a setting.
+ *
+ * This function adds \p key with \p value at the end of the string.
+ * If the key is already defined, its value is changed only if
+ * \p replace is true and it keeps its position.
+ *
+ * \param[in] key       The name of the setting
+ * \param[in] value     The value of the setting
+ * \param[in] replace   Whether an existing value gets replaced
+ */
+void connection_string::set(const std::string& key, const std::string& value, bool replace)
+{
+	value_vector_t::iterator itr(find(key));
+	if(itr == f_values.end()) {
+		f_values.push_back(value_t(key, value));
+	}
+	else if(replace) {
+		itr->second = value;
+	}
+}
+
+
+/** \brief Check whether a setting is defined.
+ *
+ * \param[in] key   The name of the setting, case insensitive
+ *
+ * \return true if the setting is defined.
+ */
+bool connection_string::exists(const std::string& key) const
+{
+	return find(key) != f_values.end();
+}
+
+
+/** \brief Retrieve the value of a setting.
+ *
+ * \param[in] key   The name of the setting, case insensitive
+ *
+ * \return The value of the setting, an empty string if not defined.
+ */
+std::string connection_string::get(const std::string& key) const
+{
+	value_vector_t::const_iterator itr(find(key));
+	if(itr == f_values.end()) {
+		return std::string();
+	}
+	return itr->second;
+}
+
+
+/** \brief Add the settings of a preset.
+ *
+ * This function adds the settings of the named preset. Settings
+ * that are already defined are kept so the settings given by the
+ * user and the presets added first have priority.
+ *
+ * \param[in] name   The name of the preset
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if the preset is not defined.
+ */
+void connection_string::add_preset(const std::string& name)
+{
+	std::string settings;
+	{
+		std::lock_guard<std::mutex> lock(preset_mutex());
+		std::map<std::string, std::string>::const_iterator itr(presets().find(name));
+		if(itr == presets().end()) {
+			diagnostic d(odbcpp_error::ODBCPP_NOT_FOUND, std::string("connection string preset \"") + name + "\" is not defined");
+			throw odbcpp_error(d);
+		}
+		settings = itr->second;
+	}
+	parse(settings, false);
+}
+
+
+/** \brief Generate the connection string.
+ *
+ * This function generates the string to pass to SQLDriverConnect().
+ * Values that include special characters are written between curly
+ * brackets.
+ *
+ * \return The connection string.
+ */
+std::string connection_string::to_string() const
+{
+	std::string result;
+	for(value_vector_t::const_iterator itr(f_values.begin()); itr != f_values.end(); ++itr) {
+		if(!result.empty()) {
+			result += ';';
+		}
+		result += itr->first;
+		result += '=';
+		const std::string& value(itr->second);
+		if(value.find_first_of(";{}") != std::string::npos
+		|| (!value.empty() && (isspace(static_cast<unsigned char>(value[0]))
+				|| isspace(static_cast<unsigned char>(value[value.length() - 1]))))) {
+			result += '{';
+			for(std::string::const_iterator c(value.begin()); c != value.end(); ++c) {
+				if(*c == '}') {
+					result += '}';
+				}
+				result += *c;
+			}
+			result += '}';
+		}
+		else {
+			result += value;
+		}
+	}
+	return result;
+}
+
+
+/** \brief Define a preset.
+ *
+ * This function defines or replaces the preset named \p name. The
+ * \p settings are written like a connection string.
+ *
+ * \code
+ * connection_string::define_preset("reports", "UseDeclareFetch=1;Fetch=50000;ReadOnly=1");
+ * \endcode
+ *
+ * \param[in] name       The name of the preset
+ * \param[in] settings   The settings of the preset
+ */
+void connection_string::define_preset(const std::string& name, const std::string& settings)
+{
+	// validate now instead of at connection time
+	connection_string validate(settings);
+
+	std::lock_guard<std::mutex> lock(preset_mutex());
+	presets()[name] = settings;
+}
+
+
+/** \brief Check whether a preset is defined.
+ *
+ * \param[in] name   The name of the preset
+ *
+ * \return true if the preset exists.
+ */
+bool connection_string::has_preset(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(preset_mutex());
+	return presets().find(name) != presets().end();
+}
+
+
+/** \brief Search a setting.
+ *
+ * \param[in] key   The name of the setting, case insensitive
+ *
+ * \return An iterator to the setting or f_values.end().
+ */
+connection_string::value_vector_t::iterator connection_string::find(const std::string& key)
+{
+	value_vector_t::iterator itr(f_values.begin());
+	for(; itr != f_values.end(); ++itr) {
+		if(same_key(itr->first, key)) {
+			break;
+		}
+	}
+	return itr;
+}
+
+
+/** \brief Search a setting.
+ *
+ * \param[in] key   The name of the setting, case insensitive
+ *
+ * \return An iterator to the setting or f_values.end().
+ */
+connection_string::value_vector_t::const_iterator connection_string::find(const std::string& key) const
+{
+	value_vector_t::const_iterator itr(f_values.begin());
+	for(; itr != f_values.end(); ++itr) {
+		if(same_key(itr->first, key)) {
+			break;
+		}
+	}
+	return itr;
+}
+
+
+/** \var connection_string::f_values
+ *
+ * \brief The settings in the order they were defined.
+ */
+
+
+
+}	// namespace odbcpp
+
@@ -0,0 +1,355 @@
+//
+// File:	src/datetime.cpp
+// Object:	Implementation of the date and timestamp conversions
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/datetime.h"
+
+
+namespace odbcpp
+{
+
+
+namespace
+{
+
+/// Number of 400 years eras added so all the SQLSMALLINT years are positive
+const SQLUINTEGER ERA_SHIFT = 82;
+/// Number of days in an era of 400 years
+const SQLUINTEGER DAYS_PER_ERA = 146097;
+/// Number of days between 0000-03-01 and 1970-01-01
+const SQLUINTEGER EPOCH_OFFSET = 719468;
+/// Number of nanoseconds in a day
+const SQLBIGINT NS_PER_DAY = 86400LL * 1000000000LL;
+
+
+/** \brief Convert a date to a number of days since 1970-01-01.
+ *
+ * This function uses the algorithm described by Howard Hinnant in
+ * "chrono-Compatible Low-Level Date Algorithms". The year starts in
+ * March so the leap day is the last day of the year.
+ *
+ * The years are shifted by 82 eras so the whole SQLSMALLINT range is
+ * positive and all the values fit in 32 bit unsigned integers. The
+ * divisions by constants then become 32 bit multiplications which the
+ * vector units support, where the 64 bit ones are not. The rows of an
+ * array that are NULL may include any value; the result is then
+ * meaningless but the computation remains defined.
+ *
+ * \param[in] year    The year, -32768 to 32767
+ * \param[in] month   The month, 1 to 12
+ * \param[in] day     The day, 1 to 31
+ *
+ * \return The number of days since 1970-01-01, negative before.
+ */
+inline SQLINTEGER days_from_civil(SQLSMALLINT year, SQLUSMALLINT month, SQLUSMALLINT day)
+{
+	const SQLUINTEGER m = month;
+	const SQLUINTEGER before_march = m <= 2;
+	const SQLUINTEGER y = static_cast<SQLUINTEGER>(static_cast<SQLINTEGER>(year)) + ERA_SHIFT * 400 - before_march;
+	const SQLUINTEGER era = y / 400;
+	const SQLUINTEGER yoe = y - era * 400;
+	const SQLUINTEGER mp = m + 9 - 12 * (1 - before_march);
+	const SQLUINTEGER doy = (153 * mp + 2) / 5 + day - 1;
+	const SQLUINTEGER doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return static_cast<SQLINTEGER>(era * DAYS_PER_ERA + doe - EPOCH_OFFSET - ERA_SHIFT * DAYS_PER_ERA);
+}
+
+
+/** \brief Convert a number of days since 1970-01-01 to a date.
+ *
+ * This function is the converse of days_from_civil(). It is exact
+ * for the days of the years -32768 to 32767.
+ *
+ * \param[in] days   The number of days since 1970-01-01
+ * \param[out] date  The resulting date
+ */
+inline void civil_from_days(SQLINTEGER days, SQL_DATE_STRUCT& date)
+{
+	const SQLUINTEGER z = static_cast<SQLUINTEGER>(days) + EPOCH_OFFSET + ERA_SHIFT * DAYS_PER_ERA;
+	const SQLUINTEGER era = z / DAYS_PER_ERA;
+	const SQLUINTEGER doe = z - era * DAYS_PER_ERA;
+	const SQLUINTEGER yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	const SQLUINTEGER doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	const SQLUINTEGER mp = (5 * doy + 2) / 153;
+	const SQLUINTEGER m = mp + 3 - 12 * (mp >= 10);
+	date.year = static_cast<SQLSMALLINT>(static_cast<SQLINTEGER>(yoe + era * 400 + (m <= 2) - ERA_SHIFT * 400));
+	date.month = static_cast<SQLUSMALLINT>(m);
+	date.day = static_cast<SQLUSMALLINT>(doy - (153 * mp + 2) / 5 + 1);
+}
+
+
+/** \brief Convert a timestamp to nanoseconds since the epoch.
+ *
+ * \param[in] t   The timestamp to convert
+ *
+ * \return The number of nanoseconds since 1970-01-01 00:00:00.
+ */
+inline SQLBIGINT ns_from_timestamp(const SQL_TIMESTAMP_STRUCT& t)
+{
+	const SQLUBIGINT seconds = (static_cast<SQLUBIGINT>(t.hour) * 60 + t.minute) * 60 + t.second;
+	return static_cast<SQLBIGINT>(static_cast<SQLUBIGINT>(static_cast<SQLBIGINT>(days_from_civil(t.year, t.month, t.day))) * NS_PER_DAY
+					+ seconds * 1000000000ULL + t.fraction);
+}
+
+
+/** \brief Convert nanoseconds since the epoch to a timestamp.
+ *
+ * \param[in] ns   The number of nanoseconds since 1970-01-01 00:00:00
+ * \param[out] t   The resulting timestamp
+ */
+inline void timestamp_from_ns(SQLBIGINT ns, SQL_TIMESTAMP_STRUCT& t)
+{
+	// floor the division so times before 1970 are in the previous day
+	SQLBIGINT days = ns / NS_PER_DAY;
+	SQLBIGINT rest = ns % NS_PER_DAY;
+	const SQLBIGINT negative = rest < 0;
+	days -= negative;
+	rest += negative * NS_PER_DAY;
+
+	SQL_DATE_STRUCT date;
+	civil_from_days(static_cast<SQLINTEGER>(days), date);
+	t.year = date.year;
+	t.month = date.month;
+	t.day = date.day;
+	const SQLUBIGINT seconds = static_cast<SQLUBIGINT>(rest) / 1000000000ULL;
+	t.hour = static_cast<SQLUSMALLINT>(seconds / 3600);
+	t.minute = static_cast<SQLUSMALLINT>(seconds / 60 % 60);
+	t.second = static_cast<SQLUSMALLINT>(seconds % 60);
+	t.fraction = static_cast<SQLUINTEGER>(static_cast<SQLUBIGINT>(rest) % 1000000000ULL);
+}
+
+}	// no name namespace
+
+
+
+/** \brief Convert a date to a number of days since the epoch.
+ *
+ * The date is viewed as a date of the proleptic Gregorian calendar.
+ * 1970-01-01 is day 0 and the days before are negative.
+ *
+ * \param[in] date   The date to convert
+ *
+ * \return The number of days since 1970-01-01.
+ */
+SQLINTEGER date_to_epoch_days(const SQL_DATE_STRUCT& date)
+{
+	return days_from_civil(date.year, date.month, date.day);
+}
+
+
+/** \brief Convert a number of days since the epoch to a date.
+ *
+ * \param[in] days   The number of days since 1970-01-01
+ * \param[out] date  The resulting date
+ */
+void epoch_days_to_date(SQLINTEGER days, SQL_DATE_STRUCT& date)
+{
+	civil_from_days(days, date);
+}
+
+
+/** \brief Convert a timestamp to a number of nanoseconds since the epoch.
+ *
+ * The timestamp is viewed as a UTC time. The fraction of an
+ * SQL_TIMESTAMP_STRUCT is a number of nanoseconds.
+ *
+ * A 64 bit number of nanoseconds covers the years 1678 to 2261.
+ * Timestamps outside of this range wrap around.
+ *
+ * \param[in] timestamp   The timestamp to convert
+ *
+ * \return The number of nanoseconds since 1970-01-01 00:00:00.
+ */
+SQLBIGINT timestamp_to_epoch_ns(const SQL_TIMESTAMP_STRUCT& timestamp)
+{
+	return ns_from_timestamp(timestamp);
+}
+
+
+/** \brief Convert a number of nanoseconds since the epoch to a timestamp.
+ *
+ * \param[in] ns          The number of nanoseconds since 1970-01-01 00:00:00
+ * \param[out] timestamp  The resulting timestamp
+ */
+void epoch_ns_to_timestamp(SQLBIGINT ns, SQL_TIMESTAMP_STRUCT& timestamp)
+{
+	timestamp_from_ns(ns, timestamp);
+}
+
+
+/** \brief Convert a timestamp to a system clock time point.
+ *
+ * The timestamp is viewed as a UTC time. The nanoseconds are
+ * truncated if the system clock is less precise.
+ *
+ * \param[in] timestamp   The timestamp to convert
+ *
+ * \return The corresponding time point.
+ */
+std::chrono::system_clock::time_point timestamp_to_time_point(const SQL_TIMESTAMP_STRUCT& timestamp)
+{
+	return std::chrono::system_clock::time_point(
+		std::chrono::duration_cast<std::chrono::system_clock::duration>(
+			std::chrono::nanoseconds(ns_from_timestamp(timestamp))));
+}
+
+
+/** \brief Convert a system clock time point to a timestamp.
+ *
+ * \param[in] time_point   The time point to convert
+ * \param[out] timestamp   The resulting UTC timestamp
+ */
+void time_point_to_timestamp(const std::chrono::system_clock::time_point& time_point, SQL_TIMESTAMP_STRUCT& timestamp)
+{
+	timestamp_from_ns(std::chrono::duration_cast<std::chrono::nanoseconds>(time_point.time_since_epoch()).count(), timestamp);
+}
+
+
+/** \brief Convert an array of dates to numbers of days since the epoch.
+ *
+ * This function converts the \p count dates of \p dates as read
+ * by a fetch with a rowset. The rows which indicator is
+ * SQL_NULL_DATA are set to \p null_value. When \p indicators is
+ * NULL, all the rows are converted.
+ *
+ * The loops do not branch. GCC vectorizes them at -O3 when the target
+ * has AVX2 (-march=x86-64-v3) and the loop without indicators also
+ * with SSE4.1. Otherwise they convert one row at a time.
+ *
+ * \param[in] dates        The array of dates
+ * \param[in] indicators   The array of indicators, may be NULL
+ * \param[in] count        The number of rows to convert
+ * \param[out] days        The array receiving the number of days since 1970-01-01
+ * \param[in] null_value   The value saved for NULL rows
+ *
+ * \return The number of rows that were not NULL.
+ */
+SQLULEN dates_to_epoch_days(const SQL_DATE_STRUCT *dates, const SQLLEN *indicators, SQLULEN count, SQLINTEGER *days, SQLINTEGER null_value)
+{
+	if(indicators == 0) {
+		for(SQLULEN idx = 0; idx < count; ++idx) {
+			days[idx] = days_from_civil(dates[idx].year, dates[idx].month, dates[idx].day);
+		}
+		return count;
+	}
+
+	SQLULEN defined = 0;
+	for(SQLULEN idx = 0; idx < count; ++idx) {
+		const SQLINTEGER value = days_from_civil(dates[idx].year, dates[idx].month, dates[idx].day);
+		const bool is_null = indicators[idx] == SQL_NULL_DATA;
+		days[idx] = is_null ? null_value : value;
+		defined += !is_null;
+	}
+	return defined;
+}
+
+
+/** \brief Convert an array of days since the epoch to dates.
+ *
+ * This function fills \p dates as expected by a parameter array.
+ * The rows which indicator is SQL_NULL_DATA are cleared. When
+ * \p indicators is NULL, all the rows are converted.
+ *
+ * \param[in] days         The array of days since 1970-01-01
+ * \param[in] indicators   The array of indicators, may be NULL
+ * \param[in] count        The number of rows to convert
+ * \param[out] dates       The array of dates receiving the result
+ */
+void epoch_days_to_dates(const SQLINTEGER *days, const SQLLEN *indicators, SQLULEN count, SQL_DATE_STRUCT *dates)
+{
+	static const SQL_DATE_STRUCT null_date = { 0, 0, 0 };
+
+	for(SQLULEN idx = 0; idx < count; ++idx) {
+		SQL_DATE_STRUCT date;
+		civil_from_days(days[idx], date);
+		dates[idx] = indicators != 0 && indicators[idx] == SQL_NULL_DATA ? null_date : date;
+	}
+}
+
+
+/** \brief Convert an array of timestamps to nanoseconds since the epoch.
+ *
+ * This function converts the \p count timestamps of \p timestamps
+ * as read by a fetch with a rowset. The rows which indicator is
+ * SQL_NULL_DATA are set to \p null_value. When \p indicators is
+ * NULL, all the rows are converted.
+ *
+ * GCC vectorizes both loops at -O3 with AVX2 and the loop without
+ * indicators with SSE2 as well; the multiplication by the number of
+ * nanoseconds per day stays 64 bit.
+ *
+ * \param[in] timestamps   The array of timestamps
+ * \param[in] indicators   The array of indicators, may be NULL
+ * \param[in] count        The number of rows to convert
+ * \param[out] ns          The array receiving the number of nanoseconds since the epoch
+ * \param[in] null_value   The value saved for NULL rows
+ *
+ * \return The number of rows that were not NULL.
+ *
+ * \sa timestamp_to_epoch_ns()
+ */
+SQLULEN timestamps_to_epoch_ns(const SQL_TIMESTAMP_STRUCT *timestamps, const SQLLEN *indicators, SQLULEN count, SQLBIGINT *ns, SQLBIGINT null_value)
+{
+	if(indicators == 0) {
+		for(SQLULEN idx = 0; idx < count; ++idx) {
+			ns[idx] = ns_from_timestamp(timestamps[idx]);
+		}
+		return count;
+	}
+
+	SQLULEN defined = 0;
+	for(SQLULEN idx = 0; idx < count; ++idx) {
+		const SQLBIGINT value = ns_from_timestamp(timestamps[idx]);
+		const bool is_null = indicators[idx] == SQL_NULL_DATA;
+		ns[idx] = is_null ? null_value : value;
+		defined += !is_null;
+	}
+	return defined;
+}
+
+
+/** \brief Convert an array of nanoseconds since the epoch to timestamps.
+ *
+ * This function fills \p timestamps as expected by a parameter array.
+ * The rows which indicator is SQL_NULL_DATA are cleared. When
+ * \p indicators is NULL, all the rows are converted.
+ *
+ * \param[in] ns           The array of nanoseconds since the epoch
+ * \param[in] indicators   The array of indicators, may be NULL
+ * \param[in] count        The number of rows to convert
+ * \param[out] timestamps  The array of timestamps receiving the result
+ */
+void epoch_ns_to_timestamps(const SQLBIGINT *ns, const SQLLEN *indicators, SQLULEN count, SQL_TIMESTAMP_STRUCT *timestamps)
+{
+	static const SQL_TIMESTAMP_STRUCT null_timestamp = { 0, 0, 0, 0, 0, 0, 0 };
+
+	for(SQLULEN idx = 0; idx < count; ++idx) {
+		SQL_TIMESTAMP_STRUCT timestamp;
+		timestamp_from_ns(ns[idx], timestamp);
+		timestamps[idx] = indicators != 0 && indicators[idx] == SQL_NULL_DATA ? null_timestamp : timestamp;
+	}
+}
+
+
+
+}	// namespace odbcpp
+
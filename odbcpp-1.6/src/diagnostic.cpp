@@ -185,6 +185,9 @@ std::string diag_t::msg() const
  * and whenever they need to generate a diagnostic for an
  * exception, it uses this constructor with a message.
  *
+ * The ODBC state is "HY000" (general error) except for timeouts which
+ * use "HYT00" like the drivers.
+ *
  * \param[in] odbcpp_errno  One of the odbcpp errors
  * \param[in] message       An error message
  */
@@ -195,7 +198,7 @@ diagnostic::diagnostic(SQLINTEGER odbcpp_errno, const std::string& message)
 	//d.f_server = ... -- none, empty is good
 	//d.f_connection = ... -- none, empty is good
 	d.f_message = message;
-	d.f_odbc_state = "HY000";
+	d.f_odbc_state = odbcpp_errno == odbcpp_error::ODBCPP_TIMEOUT ? "HYT00" : "HY000";
 	d.f_native_errno = odbcpp_errno;
 
 	f_diag.push_back(d);
@@ -337,6 +340,14 @@ std::string diagnostic::msg() const
  * \return The number of record defined in this diagnostic
  */
 
+/** \fn diagnostic::clear()
+ *
+ * \brief Remove all the records of this diagnostic.
+ *
+ * The memory used by the records is kept so clearing the diagnostic
+ * of each successful call does not allocate memory.
+ */
+
 /** \fn diagnostic::get(SQLSMALLINT record) const
  *
  * \brief Get the specified diagnostic record.
@@ -406,8 +417,9 @@ bool diagnostic::get_string(SQLSMALLINT handle_type, SQLHANDLE handle,
 
 	// retrieve the diagnostic
 	size = sizeof(buffer);	// as far as I know, size should be an OUT only...
-	return_code = SQLGetDiagField(handle_type, handle, record,
-		identifier, buffer, sizeof(buffer), &size);
+	trace_call call(handle_type, handle, SQL_API_SQLGETDIAGFIELD);
+	return_code = call.done(SQLGetDiagField(handle_type, handle, record,
+		identifier, buffer, sizeof(buffer), &size));
 
 	switch(return_code) {
 	case SQL_SUCCESS:
@@ -462,8 +474,9 @@ bool diagnostic::get_integer(SQLSMALLINT handle_type, SQLHANDLE handle,
 	integer = 0;
 
 	size = sizeof(integer);
-	return_code = SQLGetDiagField(handle_type, handle, record,
-			identifier, &integer, sizeof(integer), &size);
+	trace_call call(handle_type, handle, SQL_API_SQLGETDIAGFIELD);
+	return_code = call.done(SQLGetDiagField(handle_type, handle, record,
+			identifier, &integer, sizeof(integer), &size));
 	switch(return_code) {
 	case SQL_SUCCESS:
 	case SQL_SUCCESS_WITH_INFO:	// truncation occured... more than 1kb message?!
@@ -514,8 +527,9 @@ bool diagnostic::get_length(SQLSMALLINT handle_type, SQLHANDLE handle,
 	length = 0;
 
 	size = sizeof(length);
-	return_code = SQLGetDiagField(handle_type, handle, record,
-			identifier, &length, sizeof(length), &size);
+	trace_call call(handle_type, handle, SQL_API_SQLGETDIAGFIELD);
+	return_code = call.done(SQLGetDiagField(handle_type, handle, record,
+			identifier, &length, sizeof(length), &size));
 	switch(return_code) {
 	case SQL_SUCCESS:
 	case SQL_SUCCESS_WITH_INFO:	// truncation occured?!
@@ -99,10 +99,14 @@ namespace odbcpp
  * will be thrown.
  */
 environment::environment(SQLUINTEGER version) :
-	handle(SQL_HANDLE_ENV)
+	handle(SQL_HANDLE_ENV),
+	//f_mutex -- auto-init
+	f_reuse_threshold(1000000)
+	//f_connect_statistics -- auto-init
 {
 	// we right away allocate an environment
 	// throw if it fails
+	trace(SQL_API_SQLALLOCHANDLE);
 	check(SQLAllocHandle(f_handle_type, SQL_NULL_HANDLE, &f_handle));
 
 	// setup the current version, without that we run in problems
@@ -125,6 +129,7 @@ environment::environment(SQLUINTEGER version) :
 void environment::set_attr(SQLINTEGER attr, SQLINTEGER integer)
 {
 	// Note: the length parameter is ignore in this case
+	trace(SQL_API_SQLSETENVATTR);
 	check(SQLSetEnvAttr(f_handle, attr, int_to_ptr(integer), 0));
 }
 
@@ -142,6 +147,7 @@ void environment::set_attr(SQLINTEGER attr, SQLINTEGER integer)
  */
 void environment::set_attr(SQLINTEGER attr, SQLPOINTER ptr, SQLINTEGER length)
 {
+	trace(SQL_API_SQLSETENVATTR);
 	check(SQLSetEnvAttr(f_handle, attr, ptr, length));
 }
 
@@ -191,11 +197,13 @@ void environment::get_data_source(data_source_type_t type, data_source_vector_t&
 	}
 
 	for(;;) {
+		trace(SQL_API_SQLDATASOURCES);
 		return_code = SQLDataSources(f_handle, direction,
 					server_str, sizeof(server_str), NULL,
 					description_str, sizeof(description_str), NULL);
 		if(return_code == SQL_NO_DATA) {
 			// done
+			trace_done(return_code);
 			return;
 		}
 		check(return_code);
@@ -222,6 +230,7 @@ void environment::get_data_source(data_source_type_t type, data_source_vector_t&
  */
 void environment::commit()
 {
+	trace(SQL_API_SQLENDTRAN);
 	check(SQLEndTran(f_handle_type, f_handle, SQL_COMMIT));
 }
 
@@ -239,10 +248,142 @@ void environment::commit()
  */
 void environment::rollback()
 {
+	trace(SQL_API_SQLENDTRAN);
 	check(SQLEndTran(f_handle_type, f_handle, SQL_ROLLBACK));
 }
 
 
+/** \brief Turn on the connection pooling of the driver manager.
+ *
+ * With connection pooling, connection::disconnect() returns the
+ * connection to a pool instead of closing it and the next connect()
+ * with the same parameters reuses it. This saves the network round
+ * trips and the authentication of a new connection.
+ *
+ * The pooling is a process wide setting of the driver manager. It
+ * has to be turned on before the environments get created:
+ *
+ * \code
+ * odbcpp::environment::set_connection_pooling();
+ * odbcpp::environment env;
+ * env.set_pool_match(SQL_CP_RELAXED_MATCH);
+ * \endcode
+ *
+ * Note that some driver managers (i.e. unixODBC) also need the
+ * Pooling option of the driver turned on in odbcinst.ini.
+ *
+ * \param[in] pooling   SQL_CP_OFF, SQL_CP_ONE_PER_DRIVER or SQL_CP_ONE_PER_HENV
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if the driver manager refuses the setting.
+ */
+void environment::set_connection_pooling(SQLUINTEGER pooling)
+{
+	trace_call call(SQL_HANDLE_ENV, SQL_NULL_HANDLE, SQL_API_SQLSETENVATTR);
+	SQLRETURN return_code = call.done(SQLSetEnvAttr(SQL_NULL_HANDLE, SQL_ATTR_CONNECTION_POOLING,
+			reinterpret_cast<SQLPOINTER>(static_cast<SQLULEN>(pooling)), SQL_IS_UINTEGER));
+	if(return_code != SQL_SUCCESS && return_code != SQL_SUCCESS_WITH_INFO) {
+		diagnostic d(odbcpp_error::ODBCPP_INCORRECT_USE, std::string("the driver manager refused the connection pooling setting"));
+		throw odbcpp_error(d);
+	}
+}
+
+
+/** \brief Define how connections are matched in the pool.
+ *
+ * With SQL_CP_STRICT_MATCH only a pooled connection with exactly the
+ * same connection string and attributes is reused. SQL_CP_RELAXED_MATCH
+ * lets the driver manager reuse more connections.
+ *
+ * \param[in] match   SQL_CP_STRICT_MATCH or SQL_CP_RELAXED_MATCH
+ *
+ * \exception odbcpp_error
+ * And odbcpp_error will be thrown if the SQL function returns an error.
+ */
+void environment::set_pool_match(SQLUINTEGER match)
+{
+	trace(SQL_API_SQLSETENVATTR);
+	check(SQLSetEnvAttr(f_handle, SQL_ATTR_CP_MATCH,
+			reinterpret_cast<SQLPOINTER>(static_cast<SQLULEN>(match)), SQL_IS_UINTEGER));
+}
+
+
+/** \brief Set the duration under which a connection counts as reused.
+ *
+ * The driver manager does not tell whether a connection came from
+ * its pool. A pooled connection is however much faster than a new
+ * one. A connection that takes less than \p threshold nanoseconds is
+ * counted as reused in the connect statistics.
+ *
+ * The default threshold is 1ms.
+ *
+ * \param[in] threshold   The reuse threshold in nanoseconds
+ */
+void environment::set_reuse_threshold(SQLUBIGINT threshold)
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	f_reuse_threshold = threshold;
+}
+
+
+/** \brief Retrieve a snapshot of the connection statistics.
+ *
+ * This function returns a copy of the statistics of the connections
+ * made in this environment.
+ *
+ * \return A copy of the connection statistics.
+ */
+connect_statistics_t environment::get_connect_statistics() const
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	return f_connect_statistics;
+}
+
+
+/** \brief Reset the connection statistics.
+ *
+ * All the connection counters and histograms are reset to zero.
+ */
+void environment::reset_connect_statistics()
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	f_connect_statistics.reset();
+}
+
+
+/** \brief Count a connection.
+ *
+ * The connections call this function each time they connect. Since
+ * connections of one environment can be used by different threads,
+ * the statistics are protected by a mutex.
+ *
+ * \param[in] elapsed   The time the connection took in nanoseconds
+ */
+void environment::add_connect(SQLUBIGINT elapsed)
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	++f_connect_statistics.f_connects;
+	if(elapsed < f_reuse_threshold) {
+		++f_connect_statistics.f_reused;
+	}
+	f_connect_statistics.f_connect_time.add(elapsed);
+}
+
+
+/** \brief Count a disconnection.
+ *
+ * The connections call this function each time they disconnect.
+ *
+ * \param[in] elapsed   The time the disconnection took in nanoseconds
+ */
+void environment::add_disconnect(SQLUBIGINT elapsed)
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	++f_connect_statistics.f_disconnects;
+	f_connect_statistics.f_disconnect_time.add(elapsed);
+}
+
+
 
 /** \class environment::data_source_t
  *
@@ -261,6 +402,21 @@ void environment::rollback()
  * files.
  */
 
+/** \var environment::f_mutex
+ *
+ * \brief The mutex protecting the connection statistics.
+ */
+
+/** \var environment::f_reuse_threshold
+ *
+ * \brief The duration under which a connection counts as reused, in nanoseconds.
+ */
+
+/** \var environment::f_connect_statistics
+ *
+ * \brief The statistics of the connections made in this environment.
+ */
+
 /** \var environment::data_source_t::f_description
  *
  * \brief Holds the description of the server.
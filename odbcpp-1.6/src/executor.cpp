@@ -0,0 +1,403 @@
+//
+// File:	src/executor.cpp
+// Object:	Implementation of the query executor
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/executor.h"
+
+
+namespace odbcpp
+{
+
+
+/** \brief A job executing a query.
+ *
+ * The query is executed with the statement of the worker and the rows
+ * are sent to the row handler with the record of the worker.
+ */
+class executor::query_job : public executor::job_t
+{
+public:
+	query_job(const std::string& sql, const row_handler_t& handler, SQLULEN rowset_size) :
+		f_sql(sql),
+		f_handler(handler),
+		f_rowset_size(rowset_size)
+		//f_promise -- auto-init
+	{
+	}
+
+	virtual void run(worker_t& worker);
+
+	std::future<SQLULEN> get_future() { return f_promise.get_future(); }
+
+private:
+	const std::string	f_sql;
+	const row_handler_t	f_handler;
+	const SQLULEN		f_rowset_size;
+	std::promise<SQLULEN>	f_promise;
+};
+
+
+/** \brief Execute the query.
+ *
+ * This function runs the query and calls the row handler once per
+ * row. The promise receives the number of rows, or the number of
+ * rows affected for a statement without a result, or the exception
+ * raised by the query or the handler.
+ *
+ * \param[in] worker   The worker running the job
+ */
+void executor::query_job::run(worker_t& worker)
+{
+	statement& stmt(*worker.f_statement);
+	try {
+		SQLULEN rows = 0;
+		stmt.execute(f_sql);
+		if(stmt.cols() == 0) {
+			rows = stmt.rows();
+		}
+		else {
+			worker.f_record.set_rowset_size(f_rowset_size);
+			while(stmt.fetch(worker.f_record)) {
+				const SQLULEN max = worker.f_record.rows_fetched();
+				if(f_handler) {
+					for(SQLULEN row = 0; row < max; ++row) {
+						worker.f_record.set_row(row);
+						f_handler(worker.f_record);
+					}
+				}
+				rows += max;
+			}
+		}
+		f_promise.set_value(rows);
+	}
+	catch(...) {
+		// the next job needs a statement without a cursor
+		try {
+			stmt.close_cursor();
+		}
+		catch(...) {
+		}
+		f_promise.set_exception(std::current_exception());
+	}
+}
+
+
+
+
+/** \class executor
+ *
+ * \brief Run queries on a set of worker threads.
+ *
+ * Statements are not thread safe, so threads sharing a connection
+ * have to serialize all their queries. The executor owns a set of
+ * worker threads, each with its own connection, and runs the queries
+ * submitted by any number of threads:
+ *
+ * \code
+ * executor exec(env, "DSN=sales;UID=report;PWD=secret", 8);
+ * std::future<SQLULEN> f(exec.execute("SELECT * FROM orders WHERE ...", handle_order));
+ * ...
+ * SQLULEN count = f.get();	// rethrows the odbcpp_error of the query, if any
+ * \endcode
+ *
+ * Each worker has its own lock free queue. The jobs are distributed
+ * in turn to the queues and a worker with an empty queue steals the
+ * jobs of the other workers, so a slow query does not hold the jobs
+ * queued behind it. Idle workers sleep until a job is submitted.
+ *
+ * The row handlers and tasks are called from the worker threads.
+ */
+
+
+/** \brief Initialize an executor.
+ *
+ * This function connects all the workers and starts their threads.
+ *
+ * \param[in] env          The environment of the connections
+ * \param[in] connect      The connection string, as used by connection::connect_string()
+ * \param[in] workers      The number of worker threads and connections
+ * \param[in] queue_size   The number of jobs each worker can queue
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if a connection fails.
+ */
+executor::executor(environment& env, const std::string& connect, SQLULEN workers, SQLULEN queue_size) :
+	//f_workers -- auto-init
+	f_next(0),
+	f_sleeping(0),
+	//f_mutex -- auto-init
+	//f_condition -- auto-init
+	f_stop(false),
+	f_completed(0),
+	f_steals(0)
+{
+	if(workers == 0) {
+		workers = 1;
+	}
+
+	// the objects are created in this thread, each worker only
+	// uses its own connection afterward
+	for(SQLULEN idx = 0; idx < workers; ++idx) {
+		std::unique_ptr<worker_t> worker(new worker_t(env, queue_size));
+		worker->f_connection.connect_string(connect);
+		worker->f_statement.reset(new statement(worker->f_connection));
+		f_workers.push_back(std::move(worker));
+	}
+
+	try {
+		for(SQLULEN idx = 0; idx < workers; ++idx) {
+			f_workers[idx]->f_thread = std::thread(&executor::run, this, idx);
+		}
+	}
+	catch(...) {
+		stop();
+		throw;
+	}
+}
+
+
+/** \brief Stop the executor.
+ *
+ * The jobs already submitted are run before the worker threads exit
+ * so all the futures get a result.
+ */
+executor::~executor()
+{
+	stop();
+}
+
+
+/** \brief Execute a query on a worker.
+ *
+ * This function queues \p sql which is later executed by a worker.
+ * The \p handler is called with each row of the result, from the
+ * worker thread. The record is only valid during the call.
+ *
+ * If the queues are full, the function waits for a worker to take
+ * a job.
+ *
+ * \param[in] sql           The SQL order to execute
+ * \param[in] handler       The function receiving the rows, may be empty
+ * \param[in] rowset_size   The number of rows read per fetch
+ *
+ * \return A future with the number of rows read, or the number of rows
+ *         affected by a statement without a result.
+ */
+std::future<SQLULEN> executor::execute(const std::string& sql, const row_handler_t& handler, SQLULEN rowset_size)
+{
+	query_job *job = new query_job(sql, handler, rowset_size);
+	std::future<SQLULEN> result(job->get_future());
+	enqueue(job);
+	return result;
+}
+
+
+/** \brief Add a job to the queue of a worker.
+ *
+ * The queues are used in turn. If a queue is full, the next one is
+ * tried and if all are full, the function yields until a worker takes
+ * a job. A sleeping worker is then woken up.
+ *
+ * \param[in] job   The job to queue, deleted once run
+ */
+void executor::enqueue(job_t *job)
+{
+	const SQLULEN max = f_workers.size();
+	const SQLULEN start = f_next.fetch_add(1, std::memory_order_relaxed);
+	for(SQLULEN attempt = 0;; ++attempt) {
+		if(f_workers[(start + attempt) % max]->f_queue.push(job)) {
+			break;
+		}
+		if(attempt % max == max - 1) {
+			std::this_thread::yield();
+		}
+	}
+
+	// pairs with the fence of a worker going to sleep
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(f_sleeping.load(std::memory_order_relaxed) != 0) {
+		std::lock_guard<std::mutex> lock(f_mutex);
+		f_condition.notify_one();
+	}
+}
+
+
+/** \brief Retrieve the next job of a worker.
+ *
+ * The worker first takes the jobs of its own queue. When empty, it
+ * steals the jobs of the other workers.
+ *
+ * \param[in] index   The index of the worker
+ *
+ * \return The next job or NULL if all the queues are empty.
+ */
+executor::job_t *executor::next_job(SQLULEN index)
+{
+	job_t *job;
+	if(f_workers[index]->f_queue.pop(job)) {
+		return job;
+	}
+	const SQLULEN max = f_workers.size();
+	for(SQLULEN idx = 1; idx < max; ++idx) {
+		if(f_workers[(index + idx) % max]->f_queue.pop(job)) {
+			f_steals.fetch_add(1, std::memory_order_relaxed);
+			return job;
+		}
+	}
+	return NULL;
+}
+
+
+/** \brief The worker threads.
+ *
+ * This function runs the jobs until the executor stops. It sleeps
+ * when all the queues are empty.
+ *
+ * \param[in] index   The index of the worker
+ */
+void executor::run(SQLULEN index)
+{
+	worker_t& worker(*f_workers[index]);
+	for(;;) {
+		job_t *job = next_job(index);
+		if(job == NULL) {
+			std::unique_lock<std::mutex> lock(f_mutex);
+			f_sleeping.fetch_add(1, std::memory_order_relaxed);
+			// pairs with the fence of enqueue() so no job gets missed
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			job = next_job(index);
+			if(job == NULL) {
+				if(f_stop) {
+					f_sleeping.fetch_sub(1, std::memory_order_relaxed);
+					break;
+				}
+				f_condition.wait(lock);
+			}
+			f_sleeping.fetch_sub(1, std::memory_order_relaxed);
+			if(job == NULL) {
+				continue;
+			}
+		}
+
+		// the jobs report their errors in their future
+		job->run(worker);
+		delete job;
+		f_completed.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+
+/** \brief Stop the worker threads.
+ *
+ * This function wakes up all the workers and waits for them to exit.
+ * They first run the jobs left in the queues.
+ */
+void executor::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(f_mutex);
+		f_stop = true;
+	}
+	f_condition.notify_all();
+
+	std::vector<std::unique_ptr<worker_t> >::iterator itr(f_workers.begin());
+	for(; itr != f_workers.end(); ++itr) {
+		if((*itr)->f_thread.joinable()) {
+			(*itr)->f_thread.join();
+		}
+	}
+}
+
+
+/** \typedef executor::row_handler_t
+ *
+ * \brief A function receiving the rows of a query.
+ */
+
+/** \fn executor::workers() const
+ *
+ * \brief Retrieve the number of workers.
+ *
+ * \return The number of worker threads, each with its connection.
+ */
+
+/** \fn executor::completed() const
+ *
+ * \brief Retrieve the number of jobs run.
+ *
+ * \return The number of queries and tasks run so far.
+ */
+
+/** \fn executor::steals() const
+ *
+ * \brief Retrieve the number of jobs stolen.
+ *
+ * A job is stolen when a worker runs a job of the queue of another
+ * worker.
+ *
+ * \return The number of jobs stolen so far.
+ */
+
+/** \var executor::f_workers
+ *
+ * \brief The workers with their connection, queue and thread.
+ */
+
+/** \var executor::f_next
+ *
+ * \brief The number of jobs submitted, used to select the next queue.
+ */
+
+/** \var executor::f_sleeping
+ *
+ * \brief The number of workers waiting on f_condition.
+ */
+
+/** \var executor::f_mutex
+ *
+ * \brief The mutex used by the workers to sleep.
+ */
+
+/** \var executor::f_condition
+ *
+ * \brief The condition used to wake up the workers.
+ */
+
+/** \var executor::f_stop
+ *
+ * \brief Whether the workers exit once the queues are empty.
+ */
+
+/** \var executor::f_completed
+ *
+ * \brief The number of jobs run.
+ */
+
+/** \var executor::f_steals
+ *
+ * \brief The number of jobs stolen.
+ */
+
+
+
+}	// namespace odbcpp
+
@@ -22,6 +22,8 @@
 //
 
 #include	"odbcpp/handle.h"
+#include	"odbcpp/statistics.h"
+#include	<sqlext.h>
 #include	<iostream>
 
 
@@ -47,6 +49,11 @@ namespace odbcpp
  * The check() function is the one used to make sure that all
  * errors are being handled.
  *
+ * All the ODBC calls can be observed by installing a trace_hook
+ * with the set_trace_hook() function. The library calls trace()
+ * right before an ODBC function and check() (or trace_done())
+ * reports the end of the call to the hook.
+ *
  * \param[in] handle_type  The SQL handle type (i.e. SQL_HANDLE_ENV)
  *
  * \sa check()
@@ -68,6 +75,16 @@ namespace odbcpp
  * \return A reference to the handle diagnostic.
  */
 
+/** \fn handle::set_diagnostic(const diagnostic& diag) const
+ *
+ * \brief Replace the current diagnostic of this handle.
+ *
+ * This function is used to report errors detected by the library
+ * in the functions that do not throw.
+ *
+ * \param[in] diag   The new diagnostic
+ */
+
 /** \fn handle::get_handle_type() const
  *
  * \brief Retrieve the type of handle.
@@ -121,6 +138,45 @@ namespace odbcpp
  * generated.
  */
 
+/** \var handle::g_trace_hook
+ *
+ * \brief The hook receiving the ODBC call events.
+ *
+ * This variable is NULL unless a hook was installed with the
+ * set_trace_hook() function. It is shared by all the handles.
+ *
+ * The pointer is atomic since the hook can be changed while other
+ * threads (i.e. the watchdog) make ODBC calls. It is read with an
+ * acquire load so the hook is fully constructed when used.
+ */
+
+/** \var handle::f_trace_hook
+ *
+ * \brief The hook used by the ODBC call currently being traced.
+ *
+ * This variable is set by trace() when a hook is installed and
+ * reset by trace_done(). It is NULL when no call is being traced.
+ * The hook is saved so the end event is sent to the same hook as
+ * the begin event even if the hook gets replaced in between.
+ */
+
+/** \var handle::f_trace_event
+ *
+ * \brief The event of the ODBC call currently being traced.
+ *
+ * The begin event is saved in this variable so the end event
+ * can be sent with the same information, plus the return code
+ * and the elapsed time.
+ */
+
+/** \var handle::f_trace_start
+ *
+ * \brief The time at which the traced ODBC call started.
+ *
+ * The time is taken with stopwatch::now() when the begin event is
+ * sent to the hook.
+ */
+
 /** \brief Initialize the low level handle
  *
  * This function initialize the handle as expected.
@@ -130,8 +186,11 @@ namespace odbcpp
  */
 handle::handle(SQLSMALLINT handle_type) :
 	f_handle(SQL_NULL_HANDLE),
-	f_handle_type(handle_type)
+	f_handle_type(handle_type),
 	//f_diag -- auto-init
+	f_trace_hook(0),
+	//f_trace_event -- initialized by trace_begin()
+	f_trace_start(0)
 {
 }
 
@@ -151,7 +210,8 @@ handle::~handle()
 {
 	// we cannot check for errors since we're in
 	// a destructor and we cannot throw from here
-	SQLFreeHandle(f_handle_type, f_handle);
+	trace(SQL_API_SQLFREEHANDLE);
+	trace_done(SQLFreeHandle(f_handle_type, f_handle));
 }
 
 
@@ -176,6 +236,9 @@ handle::~handle()
  * such as SQL_NO_DATA returned by SQLFetch(), then you should
  * test the code before calling the check() function.
  *
+ * When the call was announced with trace(), the end event is sent
+ * to the trace hook before the return code gets checked.
+ *
  * \param[in] return_code   The code returned by an SQL function
  * \param[in] parent        The parent handle when allocating a child handle
  *
@@ -183,10 +246,39 @@ handle::~handle()
  */
 SQLRETURN handle::check(SQLRETURN return_code, handle *parent) const
 {
+	diagnose(return_code, parent);
+
+	// an error or just success with info?
+	if(return_code == SQL_SUCCESS
+	|| return_code == SQL_SUCCESS_WITH_INFO) {
+		return return_code;
+	}
+
+//std::cerr << "return code is " << return_code << "\n";
+
+	throw odbcpp_error(f_diag);
+	/*NOTREACHED*/
+}
+
+
+/** \brief Gather the diagnostic of an SQL function call.
+ *
+ * This function is the same as check() except that it never throws.
+ * The caller tests the return code and retrieves the errors with
+ * get_diagnostic().
+ *
+ * \param[in] return_code   The code returned by an SQL function
+ * \param[in] parent        The parent handle when allocating a child handle
+ *
+ * \return A copy of the return_code parameter
+ */
+SQLRETURN handle::diagnose(SQLRETURN return_code, handle *parent) const
+{
+	trace_done(return_code);
+
 	// no error and no info
 	if(return_code == SQL_SUCCESS) {
-		diagnostic d;
-		f_diag = d;
+		f_diag.clear();
 		return return_code;
 	}
 
@@ -194,18 +286,291 @@ SQLRETURN handle::check(SQLRETURN return_code, handle *parent) const
 	diagnostic d(f_handle_type, f_handle, parent);
 	f_diag = d;
 
-	// an error or just success with info?
-	if(return_code == SQL_SUCCESS_WITH_INFO) {
-		return return_code;
+	return return_code;
+}
+
+
+
+/** \class trace_hook
+ *
+ * \brief Interface used to observe the ODBC calls.
+ *
+ * Derive from this class and install your object with
+ * handle::set_trace_hook() to receive an event before and after
+ * each ODBC function called by the library. This can be used to
+ * feed a tracing system or to find out which ODBC calls take
+ * the most time.
+ *
+ * The hook functions are called from whichever thread calls the
+ * library and thus they must be thread safe if you use the library
+ * from several threads. They must not throw.
+ */
+
+/** \fn trace_hook::begin(const trace_event_t& event)
+ *
+ * \brief Called right before an ODBC function.
+ *
+ * The f_return_code and f_elapsed fields of the event are zero.
+ *
+ * \param[in] event   The description of the ODBC call
+ */
+
+/** \fn trace_hook::end(const trace_event_t& event)
+ *
+ * \brief Called right after an ODBC function returned.
+ *
+ * The event is the same as the one sent to begin() with the
+ * return code and the elapsed time defined.
+ *
+ * \param[in] event   The description of the ODBC call
+ */
+
+
+/** \class trace_event_t
+ *
+ * \brief The description of a traced ODBC call.
+ *
+ * This structure is sent to the trace_hook functions.
+ */
+
+/** \var trace_event_t::f_handle_type
+ *
+ * \brief The type of handle used for the call (i.e. SQL_HANDLE_STMT).
+ */
+
+/** \var trace_event_t::f_handle
+ *
+ * \brief The ODBC handle used for the call.
+ *
+ * This is NULL when the handle is being allocated.
+ */
+
+/** \var trace_event_t::f_function
+ *
+ * \brief The ODBC function identifier (i.e. SQL_API_SQLEXECDIRECT).
+ */
+
+/** \var trace_event_t::f_return_code
+ *
+ * \brief The code returned by the ODBC function, only defined in end().
+ */
+
+/** \var trace_event_t::f_elapsed
+ *
+ * \brief The duration of the call in nanoseconds, only defined in end().
+ */
+
+/** \var trace_event_t::f_sql
+ *
+ * \brief The SQL order sent with the call, or NULL.
+ *
+ * The pointer is only valid during the hook call. Copy the
+ * string if you need to keep it.
+ */
+
+
+std::atomic<trace_hook *> handle::g_trace_hook(0);
+
+
+/** \brief Install a trace hook.
+ *
+ * This function installs the hook that receives the ODBC call
+ * events of all the handles. Set it to NULL to stop tracing.
+ *
+ * When no hook is installed, tracing costs one test of a pointer
+ * per ODBC call.
+ *
+ * The hook is not owned by the library; it must remain valid until
+ * removed and until the calls that started with it are done. The
+ * hook can be changed while other threads use the library. A call
+ * reports its end event to the hook that received its begin event.
+ * The hook functions may be called from several threads at once.
+ *
+ * \param[in] hook   The new hook or NULL
+ */
+void handle::set_trace_hook(trace_hook *hook)
+{
+	g_trace_hook.store(hook, std::memory_order_release);
+}
+
+
+/** \fn handle::get_trace_hook()
+ *
+ * \brief Retrieve the current trace hook.
+ *
+ * \return The hook installed with set_trace_hook() or NULL.
+ */
+
+/** \fn handle::trace(SQLUSMALLINT function, const char *sql) const
+ *
+ * \brief Announce an ODBC call.
+ *
+ * Call this function right before calling an ODBC function on
+ * this handle. If a trace hook is installed, it receives the
+ * begin event. The following check() or trace_done() sends the
+ * end event.
+ *
+ * \code
+ *	trace(SQL_API_SQLEXECDIRECT, order.c_str());
+ *	check(SQLExecDirect( ... ));
+ * \endcode
+ *
+ * \param[in] function   The ODBC function identifier (SQL_API_...)
+ * \param[in] sql        The SQL order if any
+ */
+
+/** \fn handle::trace_done(SQLRETURN return_code) const
+ *
+ * \brief Terminate the trace of an ODBC call.
+ *
+ * The check() function calls this function for you. Call it
+ * directly when a return code is handled without calling
+ * check() (i.e. SQL_NO_DATA returned by SQLFetch().)
+ *
+ * \param[in] return_code   The code returned by the ODBC function
+ */
+
+
+/** \brief Send the begin event to the trace hook.
+ *
+ * This function saves the call information and sends it to
+ * the trace hook.
+ *
+ * \param[in] function   The ODBC function identifier
+ * \param[in] sql        The SQL order if any
+ */
+void handle::trace_begin(SQLUSMALLINT function, const char *sql) const
+{
+	f_trace_hook = get_trace_hook();
+	if(f_trace_hook == 0) {
+		return;
 	}
 
-//std::cerr << "return code is " << return_code << "\n";
+	f_trace_event.f_handle_type = f_handle_type;
+	f_trace_event.f_handle = f_handle;
+	f_trace_event.f_function = function;
+	f_trace_event.f_return_code = SQL_SUCCESS;
+	f_trace_event.f_elapsed = 0;
+	f_trace_event.f_sql = sql;
+	f_trace_hook->begin(f_trace_event);
 
-	throw odbcpp_error(f_diag);
-	/*NOTREACHED*/
+	// start the clock after the hook so its time is not included
+	f_trace_start = stopwatch::now();
+}
+
+
+/** \brief Send the end event to the trace hook.
+ *
+ * This function completes the call information and sends it
+ * to the trace hook.
+ *
+ * \param[in] return_code   The code returned by the ODBC function
+ */
+void handle::trace_end(SQLRETURN return_code) const
+{
+	f_trace_event.f_elapsed = stopwatch::now() - f_trace_start;
+	f_trace_event.f_return_code = return_code;
+
+	// the handle may have been allocated by this very call
+	f_trace_event.f_handle = f_handle;
+
+	trace_hook *hook = f_trace_hook;
+	f_trace_hook = 0;
+	hook->end(f_trace_event);
 }
 
 
+/** \class trace_call
+ *
+ * \brief Trace an ODBC call made without a handle object.
+ *
+ * A few ODBC functions are called with a raw SQL handle: the
+ * diagnostic functions, the watchdog cancelling a statement from
+ * its own thread and the process wide environment attributes.
+ * They cannot use handle::trace() since they do not have a handle
+ * object or, in case of the watchdog, the handle object is busy
+ * tracing the call being cancelled.
+ *
+ * This class holds its own event so it can be used from any thread:
+ *
+ * \code
+ *	trace_call call(SQL_HANDLE_STMT, hstmt, SQL_API_SQLCANCEL);
+ *	SQLRETURN return_code = call.done(SQLCancel(hstmt));
+ * \endcode
+ *
+ * When no hook is installed, it costs one test of a pointer.
+ */
+
+/** \fn trace_call::trace_call(SQLSMALLINT handle_type, SQLHANDLE hdl, SQLUSMALLINT function)
+ *
+ * \brief Announce an ODBC call.
+ *
+ * If a trace hook is installed, it receives the begin event.
+ *
+ * \param[in] handle_type   The type of \p hdl (i.e. SQL_HANDLE_STMT)
+ * \param[in] hdl           The SQL handle, may be SQL_NULL_HANDLE
+ * \param[in] function      The ODBC function identifier (SQL_API_...)
+ */
+
+/** \fn trace_call::done(SQLRETURN return_code)
+ *
+ * \brief Terminate the trace of the ODBC call.
+ *
+ * If a trace hook received the begin event, it receives the end event.
+ *
+ * \param[in] return_code   The code returned by the ODBC function
+ *
+ * \return \p return_code
+ */
+
+/** \var trace_call::f_hook
+ *
+ * \brief The hook receiving the events of this call, or NULL.
+ */
+
+/** \var trace_call::f_event
+ *
+ * \brief The event of this call.
+ */
+
+/** \var trace_call::f_start
+ *
+ * \brief The time at which the call started.
+ */
+
+
+/** \brief Send the begin event to the trace hook.
+ *
+ * \param[in] handle_type   The type of \p hdl
+ * \param[in] hdl           The SQL handle
+ * \param[in] function      The ODBC function identifier
+ */
+void trace_call::begin(SQLSMALLINT handle_type, SQLHANDLE hdl, SQLUSMALLINT function)
+{
+	f_event.f_handle_type = handle_type;
+	f_event.f_handle = hdl;
+	f_event.f_function = function;
+	f_event.f_return_code = SQL_SUCCESS;
+	f_event.f_elapsed = 0;
+	f_event.f_sql = 0;
+	f_hook->begin(f_event);
+
+	// start the clock after the hook so its time is not included
+	f_start = stopwatch::now();
+}
+
+
+/** \brief Send the end event to the trace hook.
+ *
+ * \param[in] return_code   The code returned by the ODBC function
+ */
+void trace_call::end(SQLRETURN return_code)
+{
+	f_event.f_elapsed = stopwatch::now() - f_start;
+	f_event.f_return_code = return_code;
+	f_hook->end(f_event);
+}
+
 
 /** \fn handle::get_handle() const
  *
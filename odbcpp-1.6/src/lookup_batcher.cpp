@@ -0,0 +1,645 @@
+//
+// File:	src/lookup_batcher.cpp
+// Object:	Implementation of the lookup batcher
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/lookup_batcher.h"
+#include	<chrono>
+
+
+namespace odbcpp
+{
+
+
+namespace
+{
+
+/** \brief Append an integer to a string.
+ *
+ * This function appends the decimal representation of \p value
+ * to \p str. It is used to generate the keys and their literals
+ * without going through a stream.
+ *
+ * \param[in,out] str   The string receiving the integer
+ * \param[in] value     The integer to append
+ */
+void append_integer(std::string& str, SQLBIGINT value)
+{
+	char buf[24];
+	char *s = buf + sizeof(buf);
+	SQLUBIGINT v = value < 0 ? 0 - static_cast<SQLUBIGINT>(value) : static_cast<SQLUBIGINT>(value);
+	do {
+		*--s = static_cast<char>('0' + v % 10);
+		v /= 10;
+	} while(v != 0);
+	if(value < 0) {
+		*--s = '-';
+	}
+	str.append(s, buf + sizeof(buf) - s);
+}
+
+
+/** \brief Check that the key column can be compared to the keys.
+ *
+ * \param[in] type   The SQL type of the key column
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error with the ODBCPP_TYPE_MISMATCH code is thrown if the
+ * column is not an integer, a decimal or a narrow string.
+ */
+void check_key_type(SQLSMALLINT type)
+{
+	switch(type) {
+	case SQL_TINYINT:
+	case SQL_SMALLINT:
+	case SQL_INTEGER:
+	case SQL_BIGINT:
+	case SQL_DECIMAL:
+	case SQL_NUMERIC:
+	case SQL_CHAR:
+	case SQL_VARCHAR:
+	case SQL_LONGVARCHAR:
+		return;
+
+	}
+	diagnostic d(odbcpp_error::ODBCPP_TYPE_MISMATCH, std::string("the key column of a lookup batcher must be an integer, a decimal or a string"));
+	throw odbcpp_error(d);
+}
+
+}	// no name namespace
+
+
+
+
+/** \class lookup_request
+ *
+ * \brief The receiver of the rows of one key of a lookup batcher.
+ *
+ * Derive from this class to receive the rows matching a key looked
+ * up with a lookup_batcher. The functions are called from the worker
+ * thread of the batcher. Either row() is called once per matching row
+ * and then done() is called, or failed() is called if the batch could
+ * not be executed. The functions must not throw.
+ *
+ * The lookup_future_request template implements this interface with
+ * a promise.
+ */
+
+/** \fn lookup_request::row(const dynamic_record& rec)
+ *
+ * \brief Receive a row matching the key.
+ *
+ * \param[in] rec   The record with the row; it is only valid during the call
+ */
+
+/** \fn lookup_request::done()
+ *
+ * \brief All the rows matching the key were received.
+ */
+
+/** \fn lookup_request::failed(std::exception_ptr error)
+ *
+ * \brief The batch including the key failed.
+ *
+ * \param[in] error   The exception raised by the batch, usually an odbcpp_error
+ */
+
+
+
+
+/** \class lookup_future_request
+ *
+ * \brief A lookup request returning its rows in a future.
+ *
+ * This template transforms each row with a projection and saves the
+ * result in a vector which is passed to a promise once the batch is
+ * done. It is used by lookup_batcher::load() with a projection.
+ */
+
+
+
+
+/** \class lookup_batcher
+ *
+ * \brief Merge many single key lookups in a few queries.
+ *
+ * The classic N+1 pattern runs one query per row of an outer query:
+ *
+ * \code
+ * SELECT * FROM items WHERE order_id = 1
+ * SELECT * FROM items WHERE order_id = 2
+ * ...
+ * \endcode
+ *
+ * The lookup batcher collects the keys from its callers, possibly in
+ * several threads, during a small time window. Then it runs one query
+ * for all the keys and sends each row to the callers that asked for
+ * its key:
+ *
+ * \code
+ * SELECT * FROM items WHERE order_id IN (1, 2, ...)
+ * \endcode
+ *
+ * The queries are executed by a worker thread on its own connection,
+ * created by the constructor, so the callers can keep using their
+ * connections from any thread.
+ *
+ * Since the library does not bind parameters, the keys are inserted
+ * in the query as literals. String keys are quoted.
+ */
+
+
+/** \brief Initialize a lookup batcher.
+ *
+ * The \p sql parameter is the query to run with a question mark where
+ * the list of keys goes. For example:
+ *
+ * \code
+ * SELECT order_id, name, quantity FROM items WHERE order_id IN (?)
+ * \endcode
+ *
+ * The rows are sent to the requests of the key read from the column
+ * \p key_column. The column value is converted to the form of the keys
+ * given to load():
+ *
+ * \li TINYINT, SMALLINT, INTEGER and BIGINT -- the integer
+ * \li DECIMAL and NUMERIC -- the number without the trailing zeroes of
+ *     its decimal part, so 42.00 matches the integer 42 and 42.50 the
+ *     string "42.5"
+ * \li CHAR -- the string without its padding spaces
+ * \li VARCHAR and LONGVARCHAR -- the string as is
+ *
+ * The query fails with an ODBCPP_TYPE_MISMATCH error when the column has
+ * any other type. DECIMAL and NUMERIC columns are bound with the
+ * dynamic_record::DECIMAL_MODE_NUMERIC mode.
+ *
+ * A batch is executed when \p max_batch distinct keys are pending or
+ * when the first pending key waited \p window nanoseconds.
+ *
+ * \param[in] env           The environment of the connection
+ * \param[in] connect       The connection string, as used by connection::connect_string()
+ * \param[in] sql           The query with a question mark for the keys
+ * \param[in] key_column    The column with the key, starting at 1
+ * \param[in] max_batch     The maximum number of keys per query
+ * \param[in] window        The time to wait for more keys, in nanoseconds
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if \p sql does not include a question mark
+ * or if the connection fails.
+ */
+lookup_batcher::lookup_batcher(environment& env, const std::string& connect, const std::string& sql,
+		SQLUSMALLINT key_column, SQLULEN max_batch, SQLUBIGINT window) :
+	f_sql(sql),
+	f_placeholder(sql.find('?')),
+	f_key_column(key_column),
+	f_max_batch(max_batch == 0 ? 1 : max_batch),
+	f_window(window),
+	f_connection(env),
+	//f_statement -- auto-init
+	//f_record -- auto-init
+	//f_query -- auto-init
+	//f_key -- auto-init
+	//f_mutex -- auto-init
+	//f_condition -- auto-init
+	//f_pending -- auto-init
+	f_pending_since(0),
+	f_flush(false),
+	f_stop(false),
+	f_batches(0),
+	f_keys(0)
+	//f_thread -- auto-init
+{
+	if(f_placeholder == std::string::npos) {
+		diagnostic d(odbcpp_error::ODBCPP_INCORRECT_USE, std::string("the lookup query must include a question mark where the keys go"));
+		throw odbcpp_error(d);
+	}
+
+	// the connection is created in this thread, then only the worker
+	// thread uses it
+	f_connection.connect_string(connect);
+	f_statement.reset(new statement(f_connection));
+
+	// read many rows at once since a batch returns many rows
+	f_record.set_rowset_size(64);
+	f_record.set_decimal_mode(dynamic_record::DECIMAL_MODE_NUMERIC);
+
+	f_thread = std::thread(&lookup_batcher::run, this);
+}
+
+
+/** \brief Stop the lookup batcher.
+ *
+ * The pending keys are executed before the worker thread exits so
+ * all the requests get an answer.
+ */
+lookup_batcher::~lookup_batcher()
+{
+	{
+		std::lock_guard<std::mutex> lock(f_mutex);
+		f_stop = true;
+	}
+	f_condition.notify_one();
+	f_thread.join();
+}
+
+
+/** \brief Look up an integer key.
+ *
+ * This function adds \p key to the next batch. The \p request receives
+ * the rows matching the key from the worker thread.
+ *
+ * \param[in] key       The key to look up
+ * \param[in] request   The object receiving the rows
+ */
+void lookup_batcher::load(SQLBIGINT key, const request_pointer_t& request)
+{
+	std::string k;
+	append_integer(k, key);
+	submit(k, k, request);
+}
+
+
+/** \brief Look up a string key.
+ *
+ * This function adds \p key to the next batch. The \p request receives
+ * the rows matching the key from the worker thread.
+ *
+ * \param[in] key       The key to look up
+ * \param[in] request   The object receiving the rows
+ */
+void lookup_batcher::load(const std::string& key, const request_pointer_t& request)
+{
+	std::string literal;
+	literal.reserve(key.length() + 2);
+	literal += '\'';
+	for(std::string::const_iterator itr(key.begin()); itr != key.end(); ++itr) {
+		if(*itr == '\'') {
+			literal += '\'';
+		}
+		literal += *itr;
+	}
+	literal += '\'';
+	submit(key, literal, request);
+}
+
+
+/** \brief Execute the pending keys now.
+ *
+ * This function wakes up the worker thread so it does not wait for
+ * the end of the time window. It does not wait for the batch to be
+ * executed.
+ */
+void lookup_batcher::flush()
+{
+	{
+		std::lock_guard<std::mutex> lock(f_mutex);
+		f_flush = true;
+	}
+	f_condition.notify_one();
+}
+
+
+/** \brief Retrieve the number of queries executed.
+ *
+ * \return The number of batches executed so far.
+ */
+SQLUBIGINT lookup_batcher::batches() const
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	return f_batches;
+}
+
+
+/** \brief Retrieve the number of distinct keys looked up.
+ *
+ * Keys requested several times within the same batch count once.
+ *
+ * \return The number of keys sent to the database so far.
+ */
+SQLUBIGINT lookup_batcher::keys() const
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	return f_keys;
+}
+
+
+/** \brief Add a key to the pending batch.
+ *
+ * This function saves the request with the pending key. If the key
+ * is already pending, the request shares its result.
+ *
+ * \param[in] key       The key as found in the key column
+ * \param[in] literal   The key as written in the query
+ * \param[in] request   The object receiving the rows
+ */
+void lookup_batcher::submit(const std::string& key, const std::string& literal, const request_pointer_t& request)
+{
+	bool wakeup;
+	{
+		std::lock_guard<std::mutex> lock(f_mutex);
+		if(f_pending.empty()) {
+			f_pending_since = stopwatch::now();
+		}
+		pending_key_t& pending(f_pending[key]);
+		if(pending.f_requests.empty()) {
+			pending.f_literal = literal;
+		}
+		pending.f_requests.push_back(request);
+		wakeup = f_pending.size() == 1 || f_pending.size() >= f_max_batch;
+	}
+	if(wakeup) {
+		f_condition.notify_one();
+	}
+}
+
+
+/** \brief The worker thread.
+ *
+ * This function waits for keys, gives the other callers the time
+ * window to add theirs, and executes the batches.
+ */
+void lookup_batcher::run()
+{
+	std::unique_lock<std::mutex> lock(f_mutex);
+	for(;;) {
+		if(f_pending.empty()) {
+			if(f_stop) {
+				break;
+			}
+			f_flush = false;
+			f_condition.wait(lock);
+			continue;
+		}
+
+		// give the other callers a chance to add keys to this batch
+		if(!f_stop && !f_flush && f_pending.size() < f_max_batch) {
+			SQLUBIGINT elapsed = stopwatch::now() - f_pending_since;
+			if(elapsed < f_window) {
+				f_condition.wait_for(lock, std::chrono::nanoseconds(f_window - elapsed));
+				continue;
+			}
+		}
+
+		pending_map_t batch;
+		if(f_pending.size() <= f_max_batch) {
+			batch.swap(f_pending);
+			f_flush = false;
+		}
+		else {
+			pending_map_t::iterator end(f_pending.begin());
+			for(SQLULEN idx = 0; idx < f_max_batch; ++idx) {
+				++end;
+			}
+			batch.insert(f_pending.begin(), end);
+			f_pending.erase(f_pending.begin(), end);
+		}
+		++f_batches;
+		f_keys += batch.size();
+
+		lock.unlock();
+		execute_batch(batch);
+		lock.lock();
+	}
+}
+
+
+/** \brief Execute one batch.
+ *
+ * This function runs the query with the keys of \p batch and sends
+ * the rows to the requests. If anything fails, all the requests of
+ * the batch receive the exception.
+ *
+ * \param[in] batch   The keys and their requests
+ */
+void lookup_batcher::execute_batch(pending_map_t& batch)
+{
+	f_query.assign(f_sql, 0, f_placeholder);
+	for(pending_map_t::const_iterator itr(batch.begin()); itr != batch.end(); ++itr) {
+		if(itr != batch.begin()) {
+			f_query += ", ";
+		}
+		f_query += itr->second.f_literal;
+	}
+	f_query.append(f_sql, f_placeholder + 1, std::string::npos);
+
+	try {
+		f_statement->execute(f_query);
+		bool first = true;
+		while(f_statement->fetch(f_record)) {
+			if(first) {
+				check_key_type(f_record.get_type(f_key_column));
+				first = false;
+			}
+			SQLULEN max = f_record.rows_fetched();
+			for(SQLULEN row = 0; row < max; ++row) {
+				f_record.set_row(row);
+				if(f_record.get_is_null(f_key_column)) {
+					continue;
+				}
+				read_key();
+				pending_map_t::const_iterator pending(batch.find(f_key));
+				if(pending == batch.end()) {
+					continue;
+				}
+				std::vector<request_pointer_t>::const_iterator request(pending->second.f_requests.begin());
+				for(; request != pending->second.f_requests.end(); ++request) {
+					(*request)->row(f_record);
+				}
+			}
+		}
+		f_statement->close_cursor();
+	}
+	catch(...) {
+		std::exception_ptr error(std::current_exception());
+		try {
+			// the next batch needs a closed cursor
+			f_statement->close_cursor();
+		}
+		catch(const odbcpp_error&) {
+		}
+		for(pending_map_t::const_iterator itr(batch.begin()); itr != batch.end(); ++itr) {
+			std::vector<request_pointer_t>::const_iterator request(itr->second.f_requests.begin());
+			for(; request != itr->second.f_requests.end(); ++request) {
+				(*request)->failed(error);
+			}
+		}
+		return;
+	}
+
+	for(pending_map_t::const_iterator itr(batch.begin()); itr != batch.end(); ++itr) {
+		std::vector<request_pointer_t>::const_iterator request(itr->second.f_requests.begin());
+		for(; request != itr->second.f_requests.end(); ++request) {
+			(*request)->done();
+		}
+	}
+}
+
+
+/** \brief Read the key of the current row.
+ *
+ * This function converts the key column of the current row to the
+ * form used by load() and saves it in f_key. The type of the column
+ * was verified by check_key_type().
+ */
+void lookup_batcher::read_key()
+{
+	f_key.clear();
+	switch(f_record.get_type(f_key_column)) {
+	case SQL_TINYINT:
+		append_integer(f_key, f_record.get<SQLSCHAR>(f_key_column));
+		break;
+
+	case SQL_SMALLINT:
+		append_integer(f_key, f_record.get<SQLSMALLINT>(f_key_column));
+		break;
+
+	case SQL_INTEGER:
+		append_integer(f_key, f_record.get<SQLINTEGER>(f_key_column));
+		break;
+
+	case SQL_BIGINT:
+		append_integer(f_key, f_record.get<SQLBIGINT>(f_key_column));
+		break;
+
+	case SQL_DECIMAL:
+	case SQL_NUMERIC:
+		// converted with numeric_to_string(), remove the trailing zeroes
+		f_record.get(f_key_column, f_key);
+		if(f_key.find('.') != std::string::npos) {
+			f_key.erase(f_key.find_last_not_of('0') + 1);
+			if(f_key[f_key.length() - 1] == '.') {
+				f_key.erase(f_key.length() - 1);
+			}
+		}
+		break;
+
+	case SQL_CHAR:
+		f_record.get(f_key_column, f_key);
+		f_key.erase(f_key.find_last_not_of(' ') + 1);
+		break;
+
+	default:
+		f_record.get(f_key_column, f_key);
+		break;
+
+	}
+}
+
+
+/** \var lookup_batcher::f_sql
+ *
+ * \brief The query with a question mark where the keys go.
+ */
+
+/** \var lookup_batcher::f_placeholder
+ *
+ * \brief The position of the question mark in f_sql.
+ */
+
+/** \var lookup_batcher::f_key_column
+ *
+ * \brief The column with the key of each row.
+ */
+
+/** \var lookup_batcher::f_max_batch
+ *
+ * \brief The maximum number of distinct keys per query.
+ */
+
+/** \var lookup_batcher::f_window
+ *
+ * \brief The time the first pending key waits for other keys, in nanoseconds.
+ */
+
+/** \var lookup_batcher::f_connection
+ *
+ * \brief The connection of the worker thread.
+ */
+
+/** \var lookup_batcher::f_statement
+ *
+ * \brief The statement used by the worker thread to run the queries.
+ */
+
+/** \var lookup_batcher::f_record
+ *
+ * \brief The record used by the worker thread to read the rows.
+ */
+
+/** \var lookup_batcher::f_query
+ *
+ * \brief The query of the current batch, the buffer is reused.
+ */
+
+/** \var lookup_batcher::f_key
+ *
+ * \brief The key of the current row, the buffer is reused.
+ */
+
+/** \var lookup_batcher::f_mutex
+ *
+ * \brief The mutex protecting the pending keys and the counters.
+ */
+
+/** \var lookup_batcher::f_condition
+ *
+ * \brief The condition used to wake up the worker thread.
+ */
+
+/** \var lookup_batcher::f_pending
+ *
+ * \brief The keys of the next batch with their requests.
+ */
+
+/** \var lookup_batcher::f_pending_since
+ *
+ * \brief The time when the first pending key was added.
+ */
+
+/** \var lookup_batcher::f_flush
+ *
+ * \brief Whether flush() was called since the worker thread last waited.
+ */
+
+/** \var lookup_batcher::f_stop
+ *
+ * \brief Whether the destructor asked the worker thread to stop.
+ */
+
+/** \var lookup_batcher::f_batches
+ *
+ * \brief The number of queries executed.
+ */
+
+/** \var lookup_batcher::f_keys
+ *
+ * \brief The number of keys sent in the queries.
+ */
+
+/** \var lookup_batcher::f_thread
+ *
+ * \brief The worker thread.
+ */
+
+
+
+}	// namespace odbcpp
+
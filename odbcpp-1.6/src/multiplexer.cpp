@@ -0,0 +1,833 @@
+//
+// File:	src/multiplexer.cpp
+// Object:	Implementation of the session multiplexer
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/multiplexer.h"
+#include	<chrono>
+
+
+namespace odbcpp
+{
+
+
+namespace
+{
+
+/** \brief The settings of the sessions which did not change anything.
+ *
+ * All the sessions using the default attributes share this identifier
+ * so they never need to apply anything to a connection which was not
+ * used by a session with other settings.
+ */
+const SQLUBIGINT	DEFAULT_SETTINGS = 1;
+
+
+/** \brief Check whether an error reports a broken connection.
+ *
+ * \param[in] e   The error to check
+ *
+ * \return true if one of the diagnostics has an 08xxx SQLSTATE.
+ */
+bool connection_lost(const odbcpp_error& e)
+{
+	const diagnostic d(e.get());
+	for(SQLSMALLINT record = 1; record <= d.size(); ++record) {
+		if(d.get(record).f_odbc_state.compare(0, 2, "08") == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+}	// no name namespace
+
+
+
+
+/** \brief A connection borrowed by a logical session.
+ *
+ * The lease borrows a connection, applies the settings of the session
+ * and gives the connection back when destroyed. A connection which
+ * failed in a way that leaves it in an unknown state is disconnected
+ * instead of being given back.
+ */
+class session_multiplexer::lease_t
+{
+public:
+	lease_t(session_multiplexer& mux, const logical_session& session) :
+		f_multiplexer(mux),
+		f_physical(mux.acquire(session.f_settings)),
+		f_drop(false)
+	{
+		try {
+			mux.apply(*f_physical, session);
+		}
+		catch(const odbcpp_error& e) {
+			mux.release(f_physical, connection_lost(e));
+			throw;
+		}
+		catch(...) {
+			mux.release(f_physical, false);
+			throw;
+		}
+	}
+
+	~lease_t()
+	{
+		f_multiplexer.release(f_physical, f_drop);
+	}
+
+	connection& get() { return f_physical->f_connection; }
+
+	void failed(const odbcpp_error& e)
+	{
+		if(connection_lost(e)) {
+			f_drop = true;
+		}
+	}
+
+	void abort()
+	{
+		// a connection which cannot rollback is in an unknown state
+		try {
+			f_physical->f_connection.rollback();
+			f_physical->f_connection.set_attr(SQL_ATTR_AUTOCOMMIT, static_cast<SQLINTEGER>(SQL_AUTOCOMMIT_ON));
+		}
+		catch(const odbcpp_error&) {
+			f_drop = true;
+		}
+	}
+
+private:
+	// no copy
+	lease_t(const lease_t& lease);
+	lease_t& operator = (const lease_t& lease);
+
+	session_multiplexer&	f_multiplexer;
+	physical_t *		f_physical;
+	bool			f_drop;
+};
+
+
+
+
+/** \class session_multiplexer
+ *
+ * \brief Share a few connections between many logical sessions.
+ *
+ * A service with thousands of mostly idle sessions cannot hold one
+ * connection per session: the database accepts a limited number of
+ * connections and each of them uses memory on the server. Like a
+ * pooler in transaction mode, the multiplexer only gives a connection
+ * to a logical_session for the duration of a transaction or of a
+ * statement in autocommit mode:
+ *
+ * \code
+ * session_multiplexer mux(env, "DSN=sales;UID=web;PWD=secret", 50);
+ * mux.set_default_attr(SQL_ATTR_TXN_ISOLATION, SQL_TXN_READ_COMMITTED);
+ * ...
+ * logical_session session(mux);
+ * session.set_attr(SQL_ATTR_TXN_ISOLATION, SQL_TXN_SERIALIZABLE);
+ * session.transaction(transfer_funds(from, to, amount));
+ * \endcode
+ *
+ * The connections are created when needed, up to the maximum. When
+ * they are all in use, the sessions wait for one to be given back.
+ *
+ * The settings of a session, its connection attributes and its init
+ * SQL statements, are applied to the connection it borrows unless the
+ * connection was last used with the same settings. The idle connection
+ * last used with the settings of the session is preferred, so sessions
+ * with the default settings never apply anything. The attributes of
+ * the previous session which the new session did not set are restored
+ * to their default. When the previous session ran init SQL statements,
+ * the reset SQL statement, such as "DISCARD ALL" with PostgreSQL, is
+ * executed first. Without a reset statement, the init statements of a
+ * session must set everything the session depends on.
+ *
+ * As with a pooler in transaction mode, a session cannot rely on
+ * anything kept by the connection between two transactions: temporary
+ * tables, prepared statements, cursors and session variables other
+ * than those set by the init SQL. The statements must be created and
+ * destroyed by the function using the connection.
+ *
+ * The multiplexer is thread safe. The defaults, the reset statement
+ * and the wait timeout must be defined before the sessions are used.
+ * The environment must not be used by other threads while the
+ * multiplexer creates or destroys connections since the reference
+ * counter of the environment is not atomic.
+ */
+
+
+/** \brief Initialize a session multiplexer.
+ *
+ * No connection is created until a session needs one.
+ *
+ * \param[in] env               The environment of the connections
+ * \param[in] connect           The connection string, as used by connection::connect_string()
+ * \param[in] max_connections   The maximum number of connections
+ */
+session_multiplexer::session_multiplexer(environment& env, const std::string& connect, SQLULEN max_connections) :
+	f_environment(&env),
+	f_connect(connect),
+	f_max_connections(max_connections == 0 ? 1 : max_connections),
+	//f_defaults -- auto-init
+	//f_reset_sql -- auto-init
+	f_wait_timeout(0),
+	//f_mutex -- auto-init
+	//f_condition -- auto-init
+	//f_connections -- auto-init
+	//f_idle -- auto-init
+	f_connecting(0),
+	//f_settings -- auto-init
+	f_borrows(0),
+	f_waits(0),
+	f_switches(0),
+	f_created(0),
+	f_dropped(0)
+{
+}
+
+
+/** \brief Close all the connections.
+ *
+ * The sessions must not be using a connection anymore.
+ */
+session_multiplexer::~session_multiplexer()
+{
+	// the connections disconnect when destroyed
+	f_idle.clear();
+	f_connections.clear();
+}
+
+
+/** \brief Define the default value of an attribute.
+ *
+ * The sessions can only change the attributes with a default since
+ * the multiplexer has to restore them before the connection is used
+ * by another session. The default is also set on each new connection.
+ *
+ * This function must be called before the sessions are used.
+ *
+ * \param[in] attr      The SQL_ATTR_... attribute
+ * \param[in] integer   The default value of the attribute
+ */
+void session_multiplexer::set_default_attr(SQLINTEGER attr, SQLINTEGER integer)
+{
+	f_defaults[attr] = integer;
+}
+
+
+/** \brief Retrieve the number of connections.
+ *
+ * \return The number of connections currently open, in use or idle.
+ */
+SQLULEN session_multiplexer::connections() const
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	return f_connections.size();
+}
+
+
+/** \brief Retrieve the number of idle connections.
+ *
+ * \return The number of connections not used by a session.
+ */
+SQLULEN session_multiplexer::idle() const
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	return f_idle.size();
+}
+
+
+/** \brief Borrow a connection.
+ *
+ * This function returns the idle connection last used with
+ * \p settings or, if none, the idle connection used last. If no
+ * connection is idle, a new one is created unless the maximum is
+ * reached in which case the function waits for a connection to be
+ * given back.
+ *
+ * \param[in] settings   The settings of the session borrowing the connection
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if the connection fails or with the
+ * ODBCPP_TIMEOUT code when no connection is given back in time.
+ *
+ * \return The borrowed connection.
+ */
+session_multiplexer::physical_t *session_multiplexer::acquire(SQLUBIGINT settings)
+{
+	std::chrono::steady_clock::time_point deadline(std::chrono::steady_clock::now()
+				+ std::chrono::nanoseconds(f_wait_timeout));
+	std::unique_lock<std::mutex> lock(f_mutex);
+	++f_borrows;
+	bool waited = false;
+	for(;;) {
+		if(!f_idle.empty()) {
+			// the most recently used connections are at the end
+			std::vector<physical_t *>::iterator found(f_idle.end() - 1);
+			for(std::vector<physical_t *>::iterator itr(found);; --itr) {
+				if((*itr)->f_settings == settings) {
+					found = itr;
+					break;
+				}
+				if(itr == f_idle.begin()) {
+					break;
+				}
+			}
+			physical_t *physical = *found;
+			f_idle.erase(found);
+			return physical;
+		}
+
+		if(f_connections.size() + f_connecting < f_max_connections) {
+			// the environment reference counter is changed under the lock
+			++f_connecting;
+			std::unique_ptr<physical_t> physical(new physical_t(*f_environment));
+			lock.unlock();
+			try {
+				physical->f_connection.connect_string(f_connect);
+				for(attr_map_t::const_iterator itr(f_defaults.begin()); itr != f_defaults.end(); ++itr) {
+					physical->f_connection.set_attr(itr->first, itr->second);
+				}
+				physical->f_settings = DEFAULT_SETTINGS;
+			}
+			catch(...) {
+				lock.lock();
+				physical.reset();
+				--f_connecting;
+				// another session may be able to connect
+				f_condition.notify_one();
+				throw;
+			}
+			lock.lock();
+			--f_connecting;
+			f_connections.push_back(std::move(physical));
+			++f_created;
+			return f_connections.back().get();
+		}
+
+		if(!waited) {
+			waited = true;
+			++f_waits;
+		}
+		if(f_wait_timeout == 0) {
+			f_condition.wait(lock);
+		}
+		else if(f_condition.wait_until(lock, deadline) == std::cv_status::timeout
+				&& f_idle.empty()
+				&& f_connections.size() + f_connecting >= f_max_connections) {
+			diagnostic d(odbcpp_error::ODBCPP_TIMEOUT, std::string("no connection of the session multiplexer was available in time"));
+			throw odbcpp_error(d);
+		}
+	}
+}
+
+
+/** \brief Give back a connection.
+ *
+ * The connection becomes idle unless \p drop is true in which case it
+ * is disconnected and destroyed. A waiting session is woken up.
+ *
+ * \param[in] physical   The connection given back
+ * \param[in] drop       Whether the connection is in an unknown state
+ */
+void session_multiplexer::release(physical_t *physical, bool drop)
+{
+	if(drop) {
+		try {
+			physical->f_connection.disconnect();
+		}
+		catch(const odbcpp_error&) {
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(f_mutex);
+		if(drop) {
+			std::vector<std::unique_ptr<physical_t> >::iterator itr(f_connections.begin());
+			for(; itr != f_connections.end(); ++itr) {
+				if(itr->get() == physical) {
+					f_connections.erase(itr);
+					break;
+				}
+			}
+			++f_dropped;
+		}
+		else {
+			f_idle.push_back(physical);
+		}
+	}
+	f_condition.notify_one();
+}
+
+
+/** \brief Retrieve the identifier of settings.
+ *
+ * The sessions with the same attributes and init SQL statements get
+ * the same identifier so they share the connections without applying
+ * their settings again.
+ *
+ * \param[in] attrs      The attributes of the session
+ * \param[in] init_sql   The init SQL statements of the session
+ *
+ * \return The identifier of the settings.
+ */
+SQLUBIGINT session_multiplexer::settings_id(const attr_map_t& attrs, const std::vector<std::string>& init_sql)
+{
+	if(attrs.empty() && init_sql.empty()) {
+		return DEFAULT_SETTINGS;
+	}
+	std::lock_guard<std::mutex> lock(f_mutex);
+	settings_map_t::iterator itr(f_settings.insert(settings_map_t::value_type(
+				settings_map_t::key_type(attrs, init_sql), 0)).first);
+	if(itr->second == 0) {
+		itr->second = DEFAULT_SETTINGS + f_settings.size();
+	}
+	return itr->second;
+}
+
+
+/** \brief Apply the settings of a session to a connection.
+ *
+ * Nothing is done when the connection was last used with the same
+ * settings. Otherwise the reset SQL statement is executed if the
+ * previous session ran init SQL statements, the attributes are set
+ * to the values of the session or restored to their default, then
+ * the init SQL statements of the session are executed.
+ *
+ * \param[in] physical   The borrowed connection
+ * \param[in] session    The session borrowing the connection
+ */
+void session_multiplexer::apply(physical_t& physical, const logical_session& session)
+{
+	if(physical.f_settings == session.f_settings) {
+		return;
+	}
+	++f_switches;
+
+	// in case of failure, the settings of the connection are unknown
+	physical.f_settings = 0;
+
+	if(physical.f_dirty && !f_reset_sql.empty()) {
+		statement stmt(physical.f_connection);
+		stmt.execute(f_reset_sql);
+	}
+	physical.f_dirty = false;
+
+	attr_map_t::iterator itr(physical.f_attrs.begin());
+	while(itr != physical.f_attrs.end()) {
+		if(session.f_attrs.find(itr->first) == session.f_attrs.end()) {
+			const SQLINTEGER value = f_defaults.find(itr->first)->second;
+			if(itr->second != value) {
+				physical.f_connection.set_attr(itr->first, value);
+			}
+			physical.f_attrs.erase(itr++);
+		}
+		else {
+			++itr;
+		}
+	}
+
+	for(attr_map_t::const_iterator attr(session.f_attrs.begin()); attr != session.f_attrs.end(); ++attr) {
+		attr_map_t::const_iterator current(physical.f_attrs.find(attr->first));
+		const SQLINTEGER value = current == physical.f_attrs.end()
+				? f_defaults.find(attr->first)->second : current->second;
+		if(value != attr->second) {
+			physical.f_connection.set_attr(attr->first, attr->second);
+		}
+		physical.f_attrs[attr->first] = attr->second;
+	}
+
+	std::vector<std::string>::const_iterator sql(session.f_init_sql.begin());
+	for(; sql != session.f_init_sql.end(); ++sql) {
+		physical.f_dirty = true;
+		statement stmt(physical.f_connection);
+		stmt.execute(*sql);
+	}
+
+	physical.f_settings = session.f_settings;
+}
+
+
+/** \typedef session_multiplexer::use_t
+ *
+ * \brief A function using the connection borrowed by a session.
+ */
+
+/** \fn session_multiplexer::set_reset_sql(const std::string& sql)
+ *
+ * \brief Define the SQL statement resetting a connection.
+ *
+ * This statement is executed before a connection is used by a session
+ * with other settings when the previous session ran init SQL
+ * statements. For example "DISCARD ALL" with PostgreSQL or
+ * "RESET CONNECTION" with MySQL.
+ *
+ * This function must be called before the sessions are used.
+ *
+ * \param[in] sql   The reset statement, empty to not reset
+ */
+
+/** \fn session_multiplexer::get_reset_sql() const
+ *
+ * \brief Retrieve the SQL statement resetting a connection.
+ *
+ * \return The reset statement, empty by default.
+ */
+
+/** \fn session_multiplexer::set_wait_timeout(SQLUBIGINT timeout)
+ *
+ * \brief Define how long a session waits for a connection.
+ *
+ * When all the connections are in use for longer than \p timeout,
+ * the session gets an odbcpp_error with the ODBCPP_TIMEOUT code.
+ *
+ * This function must be called before the sessions are used.
+ *
+ * \param[in] timeout   The maximum wait in nanoseconds, 0 to wait forever
+ */
+
+/** \fn session_multiplexer::get_wait_timeout() const
+ *
+ * \brief Retrieve how long a session waits for a connection.
+ *
+ * \return The maximum wait in nanoseconds, 0 by default (forever).
+ */
+
+/** \fn session_multiplexer::max_connections() const
+ *
+ * \brief Retrieve the maximum number of connections.
+ *
+ * \return The maximum number of connections opened by the multiplexer.
+ */
+
+/** \fn session_multiplexer::borrows() const
+ *
+ * \brief Retrieve the number of times a connection was borrowed.
+ *
+ * \return The number of transactions and autocommit calls so far.
+ */
+
+/** \fn session_multiplexer::waits() const
+ *
+ * \brief Retrieve the number of times a session waited.
+ *
+ * \return The number of borrows which waited for a connection.
+ */
+
+/** \fn session_multiplexer::switches() const
+ *
+ * \brief Retrieve the number of times settings were applied.
+ *
+ * \return The number of borrows with settings other than the settings
+ *         of the previous session of the connection.
+ */
+
+/** \fn session_multiplexer::created() const
+ *
+ * \brief Retrieve the number of connections created.
+ *
+ * \return The number of connections opened so far.
+ */
+
+/** \fn session_multiplexer::dropped() const
+ *
+ * \brief Retrieve the number of connections dropped.
+ *
+ * A connection is dropped when it could not be rolled back or reported
+ * a connection error (SQLSTATE 08xxx).
+ *
+ * \return The number of connections dropped so far.
+ */
+
+/** \var session_multiplexer::f_environment
+ *
+ * \brief The environment of the connections.
+ */
+
+/** \var session_multiplexer::f_connect
+ *
+ * \brief The connection string.
+ */
+
+/** \var session_multiplexer::f_max_connections
+ *
+ * \brief The maximum number of connections.
+ */
+
+/** \var session_multiplexer::f_defaults
+ *
+ * \brief The default value of the attributes sessions can set.
+ */
+
+/** \var session_multiplexer::f_reset_sql
+ *
+ * \brief The statement resetting a connection after init SQL statements.
+ */
+
+/** \var session_multiplexer::f_wait_timeout
+ *
+ * \brief The maximum wait for a connection in nanoseconds, 0 for no limit.
+ */
+
+/** \var session_multiplexer::f_mutex
+ *
+ * \brief The mutex protecting the connections.
+ */
+
+/** \var session_multiplexer::f_condition
+ *
+ * \brief The condition signaled when a connection is given back.
+ */
+
+/** \var session_multiplexer::f_connections
+ *
+ * \brief All the connections, in use or idle.
+ */
+
+/** \var session_multiplexer::f_idle
+ *
+ * \brief The idle connections, the most recently used last.
+ */
+
+/** \var session_multiplexer::f_connecting
+ *
+ * \brief The number of connections being connected.
+ */
+
+/** \var session_multiplexer::f_settings
+ *
+ * \brief The identifiers of the settings of the sessions.
+ */
+
+/** \var session_multiplexer::f_borrows
+ *
+ * \brief The number of connections borrowed.
+ */
+
+/** \var session_multiplexer::f_waits
+ *
+ * \brief The number of borrows which had to wait.
+ */
+
+/** \var session_multiplexer::f_switches
+ *
+ * \brief The number of times settings were applied to a connection.
+ */
+
+/** \var session_multiplexer::f_created
+ *
+ * \brief The number of connections created.
+ */
+
+/** \var session_multiplexer::f_dropped
+ *
+ * \brief The number of connections dropped.
+ */
+
+
+
+
+/** \class logical_session
+ *
+ * \brief A session borrowing a connection of a session multiplexer.
+ *
+ * A logical session is a small object holding the settings of the
+ * session: the connection attributes and the init SQL statements.
+ * It only uses a connection while it runs a transaction or an
+ * autocommit function.
+ *
+ * A logical session must only be used by one thread at a time.
+ */
+
+
+/** \brief Initialize a logical session.
+ *
+ * The session starts with the default settings of the multiplexer.
+ *
+ * \param[in] mux   The multiplexer lending the connections
+ */
+logical_session::logical_session(session_multiplexer& mux) :
+	f_multiplexer(mux),
+	//f_attrs -- auto-init
+	//f_init_sql -- auto-init
+	f_settings(DEFAULT_SETTINGS)
+{
+}
+
+
+/** \brief Set an attribute of the session.
+ *
+ * The attribute is set on each connection borrowed by the session.
+ * The multiplexer must have a default for the attribute.
+ *
+ * \param[in] attr      The SQL_ATTR_... attribute
+ * \param[in] integer   The value of the attribute
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if the attribute has no default.
+ */
+void logical_session::set_attr(SQLINTEGER attr, SQLINTEGER integer)
+{
+	if(f_multiplexer.f_defaults.find(attr) == f_multiplexer.f_defaults.end()) {
+		diagnostic d(odbcpp_error::ODBCPP_INCORRECT_USE, std::string("the session multiplexer has no default for this attribute"));
+		throw odbcpp_error(d);
+	}
+	f_attrs[attr] = integer;
+	f_settings = f_multiplexer.settings_id(f_attrs, f_init_sql);
+}
+
+
+/** \brief Add an init SQL statement to the session.
+ *
+ * The init statements are executed on each connection borrowed by the
+ * session, unless the connection was last used by a session with the
+ * same settings. They are used to set session variables, for example
+ * "SET search_path TO tenant_42".
+ *
+ * \param[in] sql   The statement to execute
+ */
+void logical_session::add_init_sql(const std::string& sql)
+{
+	f_init_sql.push_back(sql);
+	f_settings = f_multiplexer.settings_id(f_attrs, f_init_sql);
+}
+
+
+/** \brief Remove all the init SQL statements of the session.
+ */
+void logical_session::clear_init_sql()
+{
+	f_init_sql.clear();
+	f_settings = f_multiplexer.settings_id(f_attrs, f_init_sql);
+}
+
+
+/** \brief Run a transaction.
+ *
+ * This function borrows a connection, turns off autocommit, calls
+ * \p use and commits. When \p use raises an exception, the transaction
+ * is rolled back and the exception is rethrown. The connection is
+ * given back in autocommit mode.
+ *
+ * \param[in] use   The function running the statements of the transaction
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if no connection is available or the
+ * commit fails.
+ */
+void logical_session::transaction(const use_t& use)
+{
+	session_multiplexer::lease_t lease(f_multiplexer, *this);
+	connection& conn(lease.get());
+	try {
+		conn.set_attr(SQL_ATTR_AUTOCOMMIT, static_cast<SQLINTEGER>(SQL_AUTOCOMMIT_OFF));
+		use(conn);
+		conn.commit();
+		conn.set_attr(SQL_ATTR_AUTOCOMMIT, static_cast<SQLINTEGER>(SQL_AUTOCOMMIT_ON));
+	}
+	catch(const odbcpp_error& e) {
+		lease.failed(e);
+		lease.abort();
+		throw;
+	}
+	catch(...) {
+		lease.abort();
+		throw;
+	}
+}
+
+
+/** \brief Use a connection in autocommit mode.
+ *
+ * This function borrows a connection and calls \p use. Each statement
+ * is committed as it is executed.
+ *
+ * \param[in] use   The function executing the statements
+ */
+void logical_session::autocommit(const use_t& use)
+{
+	session_multiplexer::lease_t lease(f_multiplexer, *this);
+	try {
+		use(lease.get());
+	}
+	catch(const odbcpp_error& e) {
+		lease.failed(e);
+		throw;
+	}
+}
+
+
+/** \brief Execute one statement in autocommit mode.
+ *
+ * \param[in] sql   The statement to execute
+ *
+ * \return The number of rows affected by the statement.
+ */
+SQLLEN logical_session::execute(const std::string& sql)
+{
+	session_multiplexer::lease_t lease(f_multiplexer, *this);
+	try {
+		statement stmt(lease.get());
+		stmt.execute(sql);
+		return stmt.rows();
+	}
+	catch(const odbcpp_error& e) {
+		lease.failed(e);
+		throw;
+	}
+}
+
+
+/** \typedef logical_session::use_t
+ *
+ * \brief A function using the borrowed connection.
+ */
+
+/** \var logical_session::f_multiplexer
+ *
+ * \brief The multiplexer lending the connections.
+ */
+
+/** \var logical_session::f_attrs
+ *
+ * \brief The attributes set by the session.
+ */
+
+/** \var logical_session::f_init_sql
+ *
+ * \brief The statements executed on the connections before use.
+ */
+
+/** \var logical_session::f_settings
+ *
+ * \brief The identifier of the current settings of the session.
+ *
+ * The sessions with the same settings share the same identifier.
+ */
+
+
+
+}	// namespace odbcpp
+
@@ -0,0 +1,336 @@
+//
+// File:	src/numeric.cpp
+// Object:	Implementation of the SQL_NUMERIC_STRUCT conversions
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/numeric.h"
+#include	<algorithm>
+#include	<cmath>
+
+
+namespace odbcpp
+{
+
+
+namespace
+{
+
+/// The number of 32 bit limbs in the mantissa of an SQL_NUMERIC_STRUCT
+const int NUMERIC_LIMBS = SQL_MAX_NUMERIC_LEN / 4;
+
+
+/** \brief Load the mantissa of a numeric in 32 bit limbs.
+ *
+ * The mantissa of an SQL_NUMERIC_STRUCT is a little endian integer
+ * of SQL_MAX_NUMERIC_LEN bytes. This function loads it in limbs,
+ * the least significant limb first.
+ *
+ * \param[in] numeric   The numeric to load
+ * \param[out] limbs    The limbs receiving the mantissa
+ */
+void load_limbs(const SQL_NUMERIC_STRUCT& numeric, SQLUINTEGER *limbs)
+{
+	for(int idx = 0; idx < NUMERIC_LIMBS; ++idx) {
+		const SQLCHAR *v = numeric.val + idx * 4;
+		limbs[idx] = static_cast<SQLUINTEGER>(v[0])
+			   | (static_cast<SQLUINTEGER>(v[1]) << 8)
+			   | (static_cast<SQLUINTEGER>(v[2]) << 16)
+			   | (static_cast<SQLUINTEGER>(v[3]) << 24);
+	}
+}
+
+
+/** \brief Divide the limbs by a small number.
+ *
+ * \param[in,out] limbs   The limbs to divide
+ * \param[in] divisor     The divisor, at most 2^32 - 1
+ *
+ * \return The remainder of the division.
+ */
+SQLUINTEGER divide_limbs(SQLUINTEGER *limbs, SQLUINTEGER divisor)
+{
+	SQLUBIGINT remainder = 0;
+	for(int idx = NUMERIC_LIMBS - 1; idx >= 0; --idx) {
+		SQLUBIGINT v = (remainder << 32) | limbs[idx];
+		limbs[idx] = static_cast<SQLUINTEGER>(v / divisor);
+		remainder = v % divisor;
+	}
+	return static_cast<SQLUINTEGER>(remainder);
+}
+
+
+/** \brief Check whether the limbs are all zero.
+ *
+ * \param[in] limbs   The limbs to check
+ *
+ * \return true if the mantissa is zero.
+ */
+bool zero_limbs(const SQLUINTEGER *limbs)
+{
+	for(int idx = 0; idx < NUMERIC_LIMBS; ++idx) {
+		if(limbs[idx] != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+}	// no name namespace
+
+
+
+/** \brief Convert a scaled 64 bit integer to a numeric.
+ *
+ * This function is the converse of numeric_to_int64(). The \p value
+ * is viewed as having \p scale decimal digits (i.e. 1234 with a scale
+ * of 2 represents 12.34.)
+ *
+ * \param[in] value      The scaled integer
+ * \param[in] scale      The number of decimal digits in \p value
+ * \param[out] numeric   The numeric receiving the value
+ */
+void int64_to_numeric(SQLBIGINT value, SQLSCHAR scale, SQL_NUMERIC_STRUCT& numeric)
+{
+	SQLUBIGINT v = value < 0 ? 0 - static_cast<SQLUBIGINT>(value) : static_cast<SQLUBIGINT>(value);
+
+	numeric.precision = 19;
+	numeric.scale = scale;
+	numeric.sign = value < 0 ? 0 : 1;
+	for(int idx = 0; idx < SQL_MAX_NUMERIC_LEN; ++idx) {
+		numeric.val[idx] = static_cast<SQLCHAR>(v & 255);
+		v >>= 8;
+	}
+}
+
+
+/** \brief Convert a numeric to a scaled 64 bit integer.
+ *
+ * This function converts \p numeric to an integer with \p scale
+ * decimal digits. For example, 12.345 with a scale of 2 gives 1234.
+ * Digits past the requested scale are truncated.
+ *
+ * This is the fastest way to handle monetary values exactly.
+ *
+ * \param[in] numeric   The numeric to convert
+ * \param[in] scale     The number of decimal digits of the result
+ * \param[out] value    The scaled integer
+ *
+ * \return false if the value does not fit in 64 bits, \p value is then undefined.
+ */
+bool numeric_to_int64(const SQL_NUMERIC_STRUCT& numeric, SQLSMALLINT scale, SQLBIGINT& value)
+{
+	SQLUINTEGER limbs[NUMERIC_LIMBS];
+	load_limbs(numeric, limbs);
+
+	// remove the extra digits first so large mantissas can still fit
+	int diff = scale - numeric.scale;
+	for(; diff < 0 && !zero_limbs(limbs); ++diff) {
+		divide_limbs(limbs, 10);
+	}
+	for(int idx = 2; idx < NUMERIC_LIMBS; ++idx) {
+		if(limbs[idx] != 0) {
+			return false;
+		}
+	}
+	SQLUBIGINT v = (static_cast<SQLUBIGINT>(limbs[1]) << 32) | limbs[0];
+	for(; diff > 0 && v != 0; --diff) {
+		if(v > 0xFFFFFFFFFFFFFFFFULL / 10) {
+			return false;
+		}
+		v *= 10;
+	}
+
+	// sign is 1 for positive values and 0 for negative values
+	if(numeric.sign == 0) {
+		if(v > 0x8000000000000000ULL) {
+			return false;
+		}
+		value = v == 0x8000000000000000ULL
+			? static_cast<SQLBIGINT>(-0x7FFFFFFFFFFFFFFFLL - 1)
+			: -static_cast<SQLBIGINT>(v);
+	}
+	else {
+		if(v > 0x7FFFFFFFFFFFFFFFULL) {
+			return false;
+		}
+		value = static_cast<SQLBIGINT>(v);
+	}
+	return true;
+}
+
+
+/** \brief Convert a numeric to a double.
+ *
+ * This function converts \p numeric to the nearest double. Large
+ * mantissas lose precision.
+ *
+ * \param[in] numeric   The numeric to convert
+ *
+ * \return The numeric as a double.
+ */
+double numeric_to_double(const SQL_NUMERIC_STRUCT& numeric)
+{
+	SQLUINTEGER limbs[NUMERIC_LIMBS];
+	load_limbs(numeric, limbs);
+
+	double result = 0.0;
+	for(int idx = NUMERIC_LIMBS - 1; idx >= 0; --idx) {
+		result = result * 4294967296.0 + limbs[idx];
+	}
+	if(numeric.scale > 0) {
+		result /= pow(10.0, numeric.scale);
+	}
+	else if(numeric.scale < 0) {
+		result *= pow(10.0, -numeric.scale);
+	}
+
+	return numeric.sign == 0 ? -result : result;
+}
+
+
+/** \brief Convert a numeric to a string.
+ *
+ * This function writes \p numeric in \p str as the database would,
+ * with exactly scale decimal digits (i.e. "-12.50".) The previous
+ * content of \p str is replaced.
+ *
+ * \param[in] numeric   The numeric to convert
+ * \param[out] str      The string receiving the numeric
+ */
+void numeric_to_string(const SQL_NUMERIC_STRUCT& numeric, std::string& str)
+{
+	SQLUINTEGER limbs[NUMERIC_LIMBS];
+	load_limbs(numeric, limbs);
+
+	// the digits, least significant first (at most 39 digits)
+	char digits[48];
+	int count = 0;
+	do {
+		digits[count++] = static_cast<char>('0' + divide_limbs(limbs, 10));
+	} while(!zero_limbs(limbs));
+	bool is_zero = count == 1 && digits[0] == '0';
+
+	str.clear();
+	if(numeric.sign == 0 && !is_zero) {
+		str += '-';
+	}
+	const int scale = numeric.scale;
+	if(scale > 0) {
+		if(count <= scale) {
+			str += "0.";
+			str.append(scale - count, '0');
+			while(count > 0) {
+				str += digits[--count];
+			}
+		}
+		else {
+			while(count > scale) {
+				str += digits[--count];
+			}
+			str += '.';
+			while(count > 0) {
+				str += digits[--count];
+			}
+		}
+	}
+	else {
+		while(count > 0) {
+			str += digits[--count];
+		}
+		if(scale < 0 && !is_zero) {
+			str.append(-scale, '0');
+		}
+	}
+}
+
+
+/** \brief Convert a numeric to a string.
+ *
+ * This function returns \p numeric as a string with exactly scale
+ * decimal digits.
+ *
+ * \param[in] numeric   The numeric to convert
+ *
+ * \return The numeric as a string.
+ */
+std::string numeric_to_string(const SQL_NUMERIC_STRUCT& numeric)
+{
+	std::string str;
+	numeric_to_string(numeric, str);
+	return str;
+}
+
+
+/** \brief Retrieve the decimal digits of a numeric.
+ *
+ * This function writes the digits of the mantissa of \p numeric in
+ * \p digits, the most significant digit first and without leading
+ * zeroes. The sign and the scale are ignored.
+ *
+ * \param[in] numeric   The numeric to convert
+ * \param[out] digits   The digits, from 0 to 9, at least NUMERIC_MAX_DIGITS of them
+ *
+ * \return The number of digits, 0 when the mantissa is zero.
+ */
+int numeric_digits(const SQL_NUMERIC_STRUCT& numeric, SQLCHAR *digits)
+{
+	SQLUINTEGER limbs[NUMERIC_LIMBS];
+	load_limbs(numeric, limbs);
+
+	int count = 0;
+	while(!zero_limbs(limbs)) {
+		digits[count++] = static_cast<SQLCHAR>(divide_limbs(limbs, 10));
+	}
+	std::reverse(digits, digits + count);
+
+	return count;
+}
+
+
+#ifdef __SIZEOF_INT128__
+/** \brief Convert a numeric to a 128 bit integer.
+ *
+ * This function returns the signed mantissa of \p numeric. The value
+ * is scaled by 10^scale (i.e. 12.50 with a scale of 2 returns 1250.)
+ * An SQL_NUMERIC_STRUCT mantissa has at most 38 digits so it always
+ * fits.
+ *
+ * This function is only available with compilers that support the
+ * __int128 type.
+ *
+ * \param[in] numeric   The numeric to convert
+ *
+ * \return The signed mantissa.
+ */
+__int128 numeric_to_int128(const SQL_NUMERIC_STRUCT& numeric)
+{
+	unsigned __int128 v = 0;
+	for(int idx = SQL_MAX_NUMERIC_LEN - 1; idx >= 0; --idx) {
+		v = (v << 8) | numeric.val[idx];
+	}
+	return numeric.sign == 0 ? -static_cast<__int128>(v) : static_cast<__int128>(v);
+}
+#endif
+
+
+
+}	// namespace odbcpp
+
@@ -181,6 +181,18 @@ unsigned long object::release() const
 }
 
 
+/** \fn object::refcount() const
+ *
+ * \brief Retrieve the reference counter.
+ *
+ * This function returns the current value of the reference counter.
+ * A value of 1 or less means that only one smart pointer references
+ * this object, so the owner can safely reuse it.
+ *
+ * \return The current reference count.
+ */
+
+
 
 }	// namespace odbcpp
 
@@ -37,6 +37,58 @@ namespace odbcpp
 {
 
 
+namespace
+{
+
+/** \brief Compute the precision of an SQL_C_NUMERIC buffer.
+ *
+ * The column size of a DECIMAL or NUMERIC column is its precision.
+ * An SQL_NUMERIC_STRUCT supports up to 38 digits.
+ *
+ * \param[in] column_size   The column size as described by the driver
+ *
+ * \return The precision to use with SQL_C_NUMERIC.
+ */
+SQLSMALLINT numeric_precision(SQLULEN column_size)
+{
+	if(column_size == 0 || column_size > 38) {
+		return 38;
+	}
+	return static_cast<SQLSMALLINT>(column_size);
+}
+
+
+/** \brief Compute the other type accepted for a requested type.
+ *
+ * Strings can be bound as SQL_VARCHAR and the date and time types
+ * have an ODBC 2.x and a 3.x code.
+ *
+ * \param[in] target_type   The requested type
+ *
+ * \return The other type accepted, or \p target_type.
+ */
+SQLSMALLINT alternate_type(SQLSMALLINT target_type)
+{
+	switch(target_type) {
+	case SQL_C_CHAR:
+		return SQL_VARCHAR;
+
+	case SQL_C_DATE: // 2.x versus 3.x
+		return SQL_TYPE_DATE;
+
+	case SQL_C_TIME: // 2.x versus 3.x
+		return SQL_TYPE_TIME;
+
+	case SQL_C_TIMESTAMP: // 2.x versus 3.x
+		return SQL_TYPE_TIMESTAMP;
+
+	}
+	return target_type;
+}
+
+}	// no name namespace
+
+
 /** \class record_base
  *
  * \brief The record base class, used mainly internally
@@ -58,6 +110,7 @@ namespace odbcpp
  */
 record_base::record_base()
 	//f_statement -- auto-init
+	//f_arena -- auto-init
 {
 }
 
@@ -69,13 +122,16 @@ record_base::record_base()
  * Thus, one can copy a record base, but the new record looks
  * unbound.
  *
+ * The arena is shared since the column information of the copy
+ * points to it.
+ *
  * \param[in] rec   The record to be copied.
  */
-record_base::record_base(const record_base& rec)
+record_base::record_base(const record_base& rec) :
+	object(),
 	//f_statement -- auto-init
+	f_arena(rec.f_arena)
 {
-	// avoid warnings
-	(void) &rec;
 }
 
 /** \fn record_base::~record_base()
@@ -96,6 +152,28 @@ record_base::record_base(const record_base& rec)
  * same record with a different statement.
  */
 
+/** \var record_base::f_arena
+ *
+ * \brief The buffer holding the column data and indicators.
+ *
+ * When binding, the records allocate a single block of memory
+ * for all the column buffers that the ODBC driver writes to.
+ * It starts with the array of SQLLEN indicators (one per bound
+ * column) and is followed by the data buffers of the columns
+ * that are not bound directly to your variables.
+ *
+ * Each buffer starts on an ARENA_ALIGNMENT boundary.
+ */
+
+/** \fn record_base::arena_align(SQLULEN size)
+ *
+ * \brief Round up a size to the arena alignment.
+ *
+ * \param[in] size   The size to align
+ *
+ * \return \p size rounded up to a multiple of ARENA_ALIGNMENT.
+ */
+
 /** \brief Copy a record in another.
  *
  * This function copies a record in another.
@@ -113,8 +191,7 @@ record_base& record_base::operator = (const record_base& rec)
 {
 	unbind();
 
-	// avoid warnings
-	(void) &rec;
+	f_arena = rec.f_arena;
 
 	return *this;
 }
@@ -147,11 +224,16 @@ record_base& record_base::operator = (const record_base& rec)
  *
  * Note that one record cannot be bound more than once and especially
  * not to two different statements unless unbound first. Call the
- * record_base::unbind() function to unbind a record from a statement.
+ * record_base::unbind() function to unbind a record from a statement,
+ * or record_base::rebind() to move it to another statement.
+ *
+ * The columns \p stmt had bound to another record are unbound first
+ * so none of the previous bindings remain.
  *
  * \param[in] stmt   The statement to which this record is to be bound
  *
  * \sa bind_impl()
+ * \sa rebind()
  */
 void record_base::bind(statement& stmt)
 {
@@ -166,30 +248,154 @@ void record_base::bind(statement& stmt)
 		throw odbcpp_error(d);
 	}
 
+	// the statement may still have the columns of another record
+	// bound; the bindings of a record with more columns would remain
+	stmt.unbind_cols();
+
 	f_statement = &stmt;
 
 	// okay, we can bind then
+#ifndef ODBCPP_NO_STATISTICS
+	stopwatch sw;
+#endif
 	bind_impl();
+#ifndef ODBCPP_NO_STATISTICS
+	f_statement->add_bind_time(sw.elapsed());
+#endif
+	f_statement->f_bound_record = this;
+}
+
+
+
+/** \brief Re-target a record to another statement.
+ *
+ * This function binds this record to \p stmt even if it is currently
+ * bound to another statement. This is useful when records are reused
+ * with statements coming from a pool.
+ *
+ * When the result of \p stmt has the same shape as the result the
+ * record was last bound to, the existing binding plan and buffers are
+ * kept and only the SQLBindCol() calls are sent to the new statement.
+ * The name resolution and buffer computations are skipped. Otherwise
+ * the record is fully bound as with bind().
+ *
+ * The shape is the number of columns for a record. For a dynamic record
+ * the type, size and number of decimal digits of each column must
+ * also match. The column names are not verified, so only use this
+ * function with statements executing the same query.
+ *
+ * The columns of the previous statement are unbound first, unless
+ * another record was bound to it since, because the buffers of this
+ * record may be reallocated by the new binding. Bind another record to
+ * the previous statement before fetching from it. The columns \p stmt
+ * had bound to another record are also unbound.
+ *
+ * \param[in] stmt   The statement to which this record is to be bound
+ *
+ * \sa bind()
+ * \sa rebind_impl()
+ */
+void record_base::rebind(statement& stmt)
+{
+	if(f_statement == stmt) {
+		return;
+	}
+
+	// the previous statement must not keep pointers to our buffers
+	if(f_statement && f_statement->f_bound_record == this) {
+		f_statement->unbind_cols();
+	}
+	stmt.unbind_cols();
+
+	f_statement = &stmt;
+
+#ifndef ODBCPP_NO_STATISTICS
+	stopwatch sw;
+#endif
+	if(!rebind_impl()) {
+		bind_impl();
+	}
+#ifndef ODBCPP_NO_STATISTICS
+	f_statement->add_bind_time(sw.elapsed());
+#endif
+	f_statement->f_bound_record = this;
 }
 
 
+/** \fn record_base::rebind_impl()
+ *
+ * \brief Re-issue the column bindings on the current statement.
+ *
+ * This function checks whether the result of the statement has the
+ * same shape as the one the record was last bound to. If so, it sends
+ * the SQLBindCol() calls to the statement with the existing buffers
+ * and returns true.
+ *
+ * The default implementation returns false so the record gets fully
+ * bound with bind_impl().
+ *
+ * \return true if the record was bound, false if bind_impl() has to be called
+ */
+
 
-/** \fn record_base::unbind()
+/** \brief Allocate the arena.
+ *
+ * This function allocates the block of memory used to hold all the
+ * column buffers and indicators of this record.
+ *
+ * If the current arena is large enough and is not shared with a copy
+ * of this record, it is reused. This way re-executing the same query,
+ * or a query with a similar shape, does not allocate anything.
+ * Otherwise the previous arena, if any, is released.
  *
- * \brief Unbinds a record from its statement.
+ * The buffer is allocated with new[] which returns memory aligned
+ * for any type, so offsets aligned with arena_align() are properly
+ * aligned for all the ODBC C types.
+ *
+ * \param[in] size   The total size of the arena in bytes
+ *
+ * \return A pointer to the arena.
+ */
+char *record_base::allocate_arena(SQLULEN size)
+{
+	if(f_arena && f_arena->refcount() <= 1 && f_arena->size() >= size) {
+		return f_arena->get();
+	}
+	f_arena.reset(new buffer_char_t(size == 0 ? 1 : size));
+	return f_arena->get();
+}
+
+
+
+/** \brief Unbinds a record from its statement.
  *
  * This function unbinds the statement from this record. This is
  * used if you do not have direct control over the record and thus
  * cannot know when the record will be freed and release the statement.
  *
+ * If the columns of the statement are still bound to this record
+ * buffers, they get unbound with statement::unbind_cols() so the
+ * statement does not keep pointers to them.
+ *
  * After a fetch() the data in a record is defined and thus keeping
  * it bound is not necessary. However, if you are to reuse the same
  * record over and over again, keeping it bound will make it a lot
  * faster to read the next row.
  *
+ * \exception odbcpp_error
+ * And odbcpp_error will be thrown if the columns cannot be unbound.
+ *
  * \sa bind(statement& stmt)
  * \sa bind_impl()
  */
+void record_base::unbind()
+{
+	if(f_statement && f_statement->f_bound_record == this) {
+		f_statement->unbind_cols();
+	}
+	f_statement.reset();
+}
+
 
 /** \fn record_base::finalize()
  *
@@ -364,6 +570,24 @@ void record_base::bind(statement& stmt)
  * record. They are ordered by index.
  */
 
+/** \var record::f_bound
+ *
+ * \brief The columns of the current result bound to this record.
+ *
+ * This vector holds the column number and the information of all
+ * the columns that were found in the result when the record was
+ * last bound. The information pointers are owned by the
+ * f_bind_by_name and f_bind_by_col maps.
+ */
+
+/** \var record::f_result_cols
+ *
+ * \brief The number of columns in the result the record was last bound to.
+ *
+ * This number is used by rebind() to check whether a new result has the
+ * same shape.
+ */
+
 
 /** \brief Bind a string to the specified column
  *
@@ -383,9 +607,8 @@ void record::bind(const std::string& name, std::string& str, bool *is_null)
 	bi->f_target_type = SQL_C_CHAR;
 	//bi->f_data -- dynamic
 	//bi->f_size -- dynamic
-	//bi->f_fetch_size -- dynamic
+	//bi->f_indicator -- dynamic
 	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
 	bi->f_string = &str;
 	f_bind_by_name.insert(bind_info_name_t(name, bi));
 }
@@ -409,9 +632,8 @@ void record::bind(SQLSMALLINT col, std::string& str, bool *is_null)
 	bi->f_target_type = SQL_C_CHAR;
 	//bi->f_data -- dynamic
 	//bi->f_size -- dynamic
-	//bi->f_fetch_size -- dynamic
+	//bi->f_indicator -- dynamic
 	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
 	bi->f_string = &str;
 	f_bind_by_col.insert(bind_info_col_t(col, bi));
 }
@@ -435,9 +657,8 @@ void record::bind(const std::string& name, std::wstring& str, bool *is_null)
 	bi->f_target_type = SQL_C_WCHAR;
 	//bi->f_data -- dynamic
 	//bi->f_size -- dynamic
-	//bi->f_fetch_size -- dynamic
+	//bi->f_indicator -- dynamic
 	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
 	bi->f_wstring = &str;
 	f_bind_by_name.insert(bind_info_name_t(name, bi));
 }
@@ -461,872 +682,242 @@ void record::bind(SQLSMALLINT col, std::wstring& str, bool *is_null)
 	bi->f_target_type = SQL_C_WCHAR;
 	//bi->f_data -- dynamic
 	//bi->f_size -- dynamic
-	//bi->f_fetch_size -- dynamic
+	//bi->f_indicator -- dynamic
 	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
 	bi->f_wstring = &str;
 	f_bind_by_col.insert(bind_info_col_t(col, bi));
 }
 
 
-/** \brief Bind a tiny integer to the specified column
- *
- * This function binds the tiny integer variable to the specified
- * colunm.
- *
- * \param[in] name      The name of the column
- * \param[in] tiny_int  The tiny integer variable to bind
- * \param[in] is_null   A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(const std::string& name, SQLCHAR& tiny_int, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	bi->f_name = name;
-	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_TINYINT;
-	bi->f_data = &tiny_int;
-	bi->f_size = sizeof(SQLSCHAR);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_name.insert(bind_info_name_t(name, bi));
-}
-
-
-/** \brief Bind a tiny integer to the specified column
- *
- * This function binds the tiny integer variable to the specified
- * colunm.
- *
- * \param[in] col       The column number, starting at 1
- * \param[in] tiny_int  The tiny integer variable to bind
- * \param[in] is_null   A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(SQLSMALLINT col, SQLCHAR& tiny_int, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	//bi->f_name -- unused
-	bi->f_col = col;
-	bi->f_target_type = SQL_C_TINYINT;
-	bi->f_data = &tiny_int;
-	bi->f_size = sizeof(SQLSCHAR);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_col.insert(bind_info_col_t(col, bi));
-}
-
-
-/** \brief Bind a tiny integer to the specified column
- *
- * This function binds the tiny integer variable to the specified
- * colunm.
+/** \fn record::bind(const std::string& name, T& value, bool *is_null)
  *
- * \param[in] name      The name of the column
- * \param[in] tiny_int  The tiny integer variable to bind
- * \param[in] is_null   A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(const std::string& name, SQLSCHAR& tiny_int, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	bi->f_name = name;
-	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_TINYINT;
-	bi->f_data = &tiny_int;
-	bi->f_size = sizeof(SQLSCHAR);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_name.insert(bind_info_name_t(name, bi));
-}
-
-
-/** \brief Bind a tiny integer to the specified column
+ * \brief Bind a variable to the specified column
  *
- * This function binds the tiny integer variable to the specified
- * colunm.
+ * This function binds a variable of any type with sql_traits to the
+ * specified column: the integers, the floating points, the date,
+ * time, timestamp, numeric and guid structures, bool, the
+ * std::chrono::system_clock time points and, in C++17,
+ * std::optional<T> and std::string_view. Your own types can be
+ * added by specializing sql_traits.
  *
- * \param[in] col       The column number, starting at 1
- * \param[in] tiny_int  The tiny integer variable to bind
- * \param[in] is_null   A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(SQLSMALLINT col, SQLSCHAR& tiny_int, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	//bi->f_name -- unused
-	bi->f_col = col;
-	bi->f_target_type = SQL_C_TINYINT;
-	bi->f_data = &tiny_int;
-	bi->f_size = sizeof(SQLSCHAR);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_col.insert(bind_info_col_t(col, bi));
-}
-
-
-/** \brief Bind a small integer to the specified column
+ * The ODBC types are written directly in your variable by the
+ * driver. The other types are read in the record arena and converted
+ * by the fetch() function.
  *
- * This function binds the small integer variable to the specified
- * colunm.
+ * A NULL column leaves the variable unchanged, except for the
+ * std::optional<T> variables which get reset.
  *
- * \param[in] name       The name of the column
- * \param[in] small_int  The small integer variable to bind
- * \param[in] is_null    A pointer to a boolean variable set to true whenever this column is NULL in the database
+ * \param[in] name     The name of the column
+ * \param[in] value    The variable to bind
+ * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
  */
-void record::bind(const std::string& name, SQLSMALLINT& small_int, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	bi->f_name = name;
-	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_SHORT;
-	bi->f_data = &small_int;
-	bi->f_size = sizeof(SQLSMALLINT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_name.insert(bind_info_name_t(name, bi));
-}
 
 
-/** \brief Bind a small integer to the specified column
- *
- * This function binds the small integer variable to the specified
- * colunm.
+/** \fn record::bind(SQLSMALLINT col, T& value, bool *is_null)
  *
- * \param[in] col        The column number, starting at 1
- * \param[in] small_int  The small integer variable to bind
- * \param[in] is_null    A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(SQLSMALLINT col, SQLSMALLINT& small_int, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	//bi->f_name -- unused
-	bi->f_col = col;
-	bi->f_target_type = SQL_C_SHORT;
-	bi->f_data = &small_int;
-	bi->f_size = sizeof(SQLSMALLINT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_col.insert(bind_info_col_t(col, bi));
-}
-
-
-/** \brief Bind a small integer to the specified column
+ * \brief Bind a variable to the specified column
  *
- * This function binds the small integer variable to the specified
- * colunm.
+ * See the bind() function using the column name.
  *
- * \param[in] name       The name of the column
- * \param[in] small_int  The small integer variable to bind
- * \param[in] is_null    A pointer to a boolean variable set to true whenever this column is NULL in the database
+ * \param[in] col      The column number, starting at 1
+ * \param[in] value    The variable to bind
+ * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
  */
-void record::bind(const std::string& name, SQLUSMALLINT& small_int, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
 
-	bi->f_name = name;
-	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_USHORT;
-	bi->f_data = &small_int;
-	bi->f_size = sizeof(SQLUSMALLINT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_name.insert(bind_info_name_t(name, bi));
-}
 
-
-/** \brief Bind a small integer to the specified column
+/** \brief Add the binding information of a variable
  *
- * This function binds the small integer variable to the specified
- * colunm.
+ * This function is used by the bind() templates. When \p converter
+ * is NULL, the driver writes directly in \p data. Otherwise the column
+ * is read in the arena and finalize() calls \p converter to copy it
+ * in \p data.
  *
- * \param[in] col        The column number, starting at 1
- * \param[in] small_int  The small integer variable to bind
- * \param[in] is_null    A pointer to a boolean variable set to true whenever this column is NULL in the database
+ * \param[in] name          The name of the column, used if \p col is 0
+ * \param[in] col           The column number, starting at 1, or 0
+ * \param[in] target_type   The SQL_C_... type of the column
+ * \param[in] size          The size of the buffer, 0 for the size of the column
+ * \param[in] data          The variable to bind
+ * \param[in] converter     The converter of the column, or NULL
+ * \param[in] is_null       A pointer to a boolean variable set to true whenever this column is NULL in the database
  */
-void record::bind(SQLSMALLINT col, SQLUSMALLINT& small_int, bool *is_null)
+void record::bind_value(const std::string& name, SQLSMALLINT col, SQLSMALLINT target_type, SQLULEN size,
+		SQLPOINTER data, converter_t converter, bool *is_null)
 {
 	bind_info_t	*bi = new bind_info_t;
 
-	//bi->f_name -- unused
-	bi->f_col = col;
-	bi->f_target_type = SQL_C_USHORT;
-	bi->f_data = &small_int;
-	bi->f_size = sizeof(SQLUSMALLINT);
-	//bi->f_fetch_size -- dynamic
+	bi->f_target_type = target_type;
+	bi->f_size = size;
+	//bi->f_indicator -- dynamic
 	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
 	//bi->f_string -- unused
-	f_bind_by_col.insert(bind_info_col_t(col, bi));
+	if(converter == NULL) {
+		bi->f_data = data;
+	}
+	else {
+		// the driver writes in the arena
+		bi->f_converter = converter;
+		bi->f_value = data;
+	}
+	if(col == 0) {
+		bi->f_name = name;
+		f_bind_by_name.insert(bind_info_name_t(name, bi));
+	}
+	else {
+		bi->f_col = col;
+		f_bind_by_col.insert(bind_info_col_t(col, bi));
+	}
 }
 
 
-/** \brief Bind an integer to the specified column
+/** \brief Bind a binary buffer to the specified column
  *
- * This function binds the integer variable to the specified
+ * This function binds the binary variable to the specified
  * colunm.
  *
  * \param[in] name     The name of the column
- * \param[in] integer  The integer variable to bind
+ * \param[in] binary   The binary variable to bind
+ * \param[in] length   The size of the binary buffer in bytes
  * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
  */
-void record::bind(const std::string& name, SQLINTEGER& integer, bool *is_null)
+void record::bind(const std::string& name, SQLCHAR *binary, SQLLEN length, bool *is_null)
 {
 	bind_info_t	*bi = new bind_info_t;
 
 	bi->f_name = name;
 	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_LONG;
-	bi->f_data = &integer;
-	bi->f_size = sizeof(SQLINTEGER);
-	//bi->f_fetch_size -- dynamic
+	bi->f_target_type = SQL_C_BINARY;
+	bi->f_data = binary;
+	bi->f_size = length;
+	//bi->f_indicator -- dynamic
 	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
 	//bi->f_string -- unused
 	f_bind_by_name.insert(bind_info_name_t(name, bi));
 }
 
 
-/** \brief Bind an integer to the specified column
+/** \brief Bind a binary buffer to the specified column
  *
- * This function binds the integer variable to the specified
+ * This function binds the binary variable to the specified
  * colunm.
  *
  * \param[in] col      The column number, starting at 1
- * \param[in] integer  The integer variable to bind
+ * \param[in] binary   The binary variable to bind
+ * \param[in] length   The size of the binary buffer in bytes
  * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
  */
-void record::bind(SQLSMALLINT col, SQLINTEGER& integer, bool *is_null)
+void record::bind(SQLSMALLINT col, SQLCHAR *binary, SQLLEN length, bool *is_null)
 {
 	bind_info_t	*bi = new bind_info_t;
 
 	//bi->f_name -- unused
 	bi->f_col = col;
-	bi->f_target_type = SQL_C_LONG;
-	bi->f_data = &integer;
-	bi->f_size = sizeof(SQLINTEGER);
-	//bi->f_fetch_size -- dynamic
+	bi->f_target_type = SQL_C_BINARY;
+	bi->f_data = binary;
+	bi->f_size = length;
+	//bi->f_indicator -- dynamic
 	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
 	//bi->f_string -- unused
 	f_bind_by_col.insert(bind_info_col_t(col, bi));
 }
 
 
-/** \brief Bind an integer to the specified column
+/** \brief Bind a decimal as a scaled integer to the specified column
  *
- * This function binds the integer variable to the specified
- * colunm.
+ * This function binds a DECIMAL or NUMERIC column to a 64 bit integer
+ * with \p scale decimal digits. For example, with a scale of 2, the
+ * value 12.34 is saved as 1234 in \p value. This is exact and a lot
+ * faster than going through a string.
  *
- * \param[in] name     The name of the column
- * \param[in] integer  The integer variable to bind
+ * The column is read as an SQL_C_NUMERIC with the requested scale.
+ *
+ * \param[in] name     The name of column
+ * \param[in] value    The integer variable to bind
+ * \param[in] scale    The number of decimal digits in \p value
  * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
+ *
+ * \sa numeric_to_int64()
  */
-void record::bind(const std::string& name, SQLUINTEGER& integer, bool *is_null)
+void record::bind_decimal(const std::string& name, SQLBIGINT& value, SQLSMALLINT scale, bool *is_null)
 {
 	bind_info_t	*bi = new bind_info_t;
 
 	bi->f_name = name;
 	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_ULONG;
-	bi->f_data = &integer;
-	bi->f_size = sizeof(SQLUINTEGER);
-	//bi->f_fetch_size -- dynamic
+	bi->f_target_type = SQL_C_NUMERIC;
+	//bi->f_data -- dynamic
+	bi->f_size = sizeof(SQL_NUMERIC_STRUCT);
+	//bi->f_indicator -- dynamic
 	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
+	//bi->f_precision -- dynamic
+	bi->f_scale = scale;
+	bi->f_scaled = &value;
 	f_bind_by_name.insert(bind_info_name_t(name, bi));
 }
 
 
-/** \brief Bind an integer to the specified column
+/** \brief Bind a decimal as a scaled integer to the specified column
  *
- * This function binds the integer variable to the specified
- * colunm.
+ * This function binds a DECIMAL or NUMERIC column to a 64 bit integer
+ * with \p scale decimal digits. For example, with a scale of 2, the
+ * value 12.34 is saved as 1234 in \p value.
  *
  * \param[in] col      The column number, starting at 1
- * \param[in] integer  The integer variable to bind
+ * \param[in] value    The integer variable to bind
+ * \param[in] scale    The number of decimal digits in \p value
  * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
+ *
+ * \sa numeric_to_int64()
  */
-void record::bind(SQLSMALLINT col, SQLUINTEGER& integer, bool *is_null)
+void record::bind_decimal(SQLSMALLINT col, SQLBIGINT& value, SQLSMALLINT scale, bool *is_null)
 {
 	bind_info_t	*bi = new bind_info_t;
 
 	//bi->f_name -- unused
 	bi->f_col = col;
-	bi->f_target_type = SQL_C_ULONG;
-	bi->f_data = &integer;
-	bi->f_size = sizeof(SQLUINTEGER);
-	//bi->f_fetch_size -- dynamic
+	bi->f_target_type = SQL_C_NUMERIC;
+	//bi->f_data -- dynamic
+	bi->f_size = sizeof(SQL_NUMERIC_STRUCT);
+	//bi->f_indicator -- dynamic
 	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
+	//bi->f_precision -- dynamic
+	bi->f_scale = scale;
+	bi->f_scaled = &value;
 	f_bind_by_col.insert(bind_info_col_t(col, bi));
 }
 
 
-/** \brief Bind a big integer to the specified column
- *
- * This function binds the big integer variable to the specified
- * colunm.
- *
- * \param[in] name     The name of the column
- * \param[in] big_int  The big integer variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(const std::string& name, SQLBIGINT& big_int, bool *is_null)
+// documented in record_base
+void record::bind_impl()
 {
-	bind_info_t	*bi = new bind_info_t;
-
-	bi->f_name = name;
-	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_SBIGINT;
-	bi->f_data = &big_int;
-	bi->f_size = sizeof(SQLBIGINT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_name.insert(bind_info_name_t(name, bi));
-}
-
-
-/** \brief Bind a big integer to the specified column
- *
- * This function binds the big integer variable to the specified
- * colunm.
- *
- * \param[in] col      The column number, starting at 1
- * \param[in] big_int  The big integer variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(SQLSMALLINT col, SQLBIGINT& big_int, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	//bi->f_name -- unused
-	bi->f_col = col;
-	bi->f_target_type = SQL_C_SBIGINT;
-	bi->f_data = &big_int;
-	bi->f_size = sizeof(SQLBIGINT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_col.insert(bind_info_col_t(col, bi));
-}
-
-
-/** \brief Bind a big integer to the specified column
- *
- * This function binds the big integer variable to the specified
- * colunm.
- *
- * \param[in] name     The name of the column
- * \param[in] big_int  The big integer variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(const std::string& name, SQLUBIGINT& big_int, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	bi->f_name = name;
-	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_UBIGINT;
-	bi->f_data = &big_int;
-	bi->f_size = sizeof(SQLUBIGINT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_name.insert(bind_info_name_t(name, bi));
-}
-
-
-/** \brief Bind a big integer to the specified column
- *
- * This function binds the big integer variable to the specified
- * colunm.
- *
- * \param[in] col      The column number, starting at 1
- * \param[in] big_int  The big integer variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(SQLSMALLINT col, SQLUBIGINT& big_int, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	//bi->f_name -- unused
-	bi->f_col = col;
-	bi->f_target_type = SQL_C_UBIGINT;
-	bi->f_data = &big_int;
-	bi->f_size = sizeof(SQLUBIGINT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_col.insert(bind_info_col_t(col, bi));
-}
-
-
-/** \brief Bind a real (C/C++ float) to the specified column
- *
- * This function binds the real variable to the specified
- * colunm.
- *
- * \warning
- * An SQLREAL is really a float in C/C++.
- *
- * \param[in] name     The name of the column
- * \param[in] real     The real variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(const std::string& name, SQLREAL& real, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	bi->f_name = name;
-	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_FLOAT;
-	bi->f_data = &real;
-	bi->f_size = sizeof(SQLREAL);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_name.insert(bind_info_name_t(name, bi));
-}
-
-
-/** \brief Bind a real (C/C++ float) to the specified column
- *
- * This function binds the real variable to the specified
- * colunm.
- *
- * \warning
- * An SQLREAL is really a float in C/C++.
- *
- * \param[in] col      The column number, starting at 1
- * \param[in] real     The real variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(SQLSMALLINT col, SQLREAL& real, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	//bi->f_name -- unused
-	bi->f_col = col;
-	bi->f_target_type = SQL_C_FLOAT;
-	bi->f_data = &real;
-	bi->f_size = sizeof(SQLREAL);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_col.insert(bind_info_col_t(col, bi));
-}
-
-
-/** \brief Bind a float (C/C++ double) to the specified column
- *
- * This function binds the float variable to the specified
- * colunm.
- *
- * \warning
- * An SQLFLOAT is really a double in C/C++.
- *
- * \param[in] name     The name of the column
- * \param[in] dbl      The double variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(const std::string& name, SQLFLOAT& dbl, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	bi->f_name = name;
-	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_DOUBLE;
-	bi->f_data = &dbl;
-	bi->f_size = sizeof(SQLFLOAT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_name.insert(bind_info_name_t(name, bi));
-}
-
-
-/** \brief Bind a float (C/C++ double) to the specified column
- *
- * This function binds the float variable to the specified
- * colunm.
- *
- * \warning
- * An SQLFLOAT is really a double in C/C++.
- *
- * \param[in] col      The column number, starting at 1
- * \param[in] dbl      The double variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(SQLSMALLINT col, SQLFLOAT& dbl, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	//bi->f_name -- unused
-	bi->f_col = col;
-	bi->f_target_type = SQL_C_DOUBLE;
-	bi->f_data = &dbl;
-	bi->f_size = sizeof(SQLFLOAT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_col.insert(bind_info_col_t(col, bi));
-}
-
-
-/** \brief Bind a binary buffer to the specified column
- *
- * This function binds the binary variable to the specified
- * colunm.
- *
- * \param[in] name     The name of the column
- * \param[in] binary   The binary variable to bind
- * \param[in] length   The size of the binary buffer in bytes
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(const std::string& name, SQLCHAR *binary, SQLLEN length, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	bi->f_name = name;
-	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_BINARY;
-	bi->f_data = binary;
-	bi->f_size = length;
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_name.insert(bind_info_name_t(name, bi));
-}
-
-
-/** \brief Bind a binary buffer to the specified column
- *
- * This function binds the binary variable to the specified
- * colunm.
- *
- * \param[in] col      The column number, starting at 1
- * \param[in] binary   The binary variable to bind
- * \param[in] length   The size of the binary buffer in bytes
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(SQLSMALLINT col, SQLCHAR *binary, SQLLEN length, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	//bi->f_name -- unused
-	bi->f_col = col;
-	bi->f_target_type = SQL_C_BINARY;
-	bi->f_data = binary;
-	bi->f_size = length;
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_col.insert(bind_info_col_t(col, bi));
-}
-
-
-/** \brief Bind a date to the specified column
- *
- * This function binds the date variable to the specified
- * colunm.
- *
- * \param[in] name     The name of the column
- * \param[in] date     The date variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(const std::string& name, SQL_DATE_STRUCT& date, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	bi->f_name = name;
-	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_DATE;
-	bi->f_data = &date;
-	bi->f_size = sizeof(SQL_DATE_STRUCT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_name.insert(bind_info_name_t(name, bi));
-}
-
-
-/** \brief Bind a date to the specified column
- *
- * This function binds the date variable to the specified
- * colunm.
- *
- * \param[in] col      The column number, starting at 1
- * \param[in] date     The date variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(SQLSMALLINT col, SQL_DATE_STRUCT& date, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	//bi->f_name -- unused
-	bi->f_col = col;
-	bi->f_target_type = SQL_C_DATE;
-	bi->f_data = &date;
-	bi->f_size = sizeof(SQL_DATE_STRUCT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_col.insert(bind_info_col_t(col, bi));
-}
-
-
-/** \brief Bind a time to the specified column
- *
- * This function binds the time variable to the specified
- * colunm.
- *
- * \param[in] name     The name of the column
- * \param[in] time     The time variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(const std::string& name, SQL_TIME_STRUCT& time, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	bi->f_name = name;
-	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_TIME;
-	bi->f_data = &time;
-	bi->f_size = sizeof(SQL_TIME_STRUCT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_name.insert(bind_info_name_t(name, bi));
-}
-
-
-/** \brief Bind a time to the specified column
- *
- * This function binds the time variable to the specified
- * colunm.
- *
- * \param[in] col      The column number, starting at 1
- * \param[in] time     The time variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(SQLSMALLINT col, SQL_TIME_STRUCT& time, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	//bi->f_name -- unused
-	bi->f_col = col;
-	bi->f_target_type = SQL_C_TIME;
-	bi->f_data = &time;
-	bi->f_size = sizeof(SQL_TIME_STRUCT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_col.insert(bind_info_col_t(col, bi));
-}
-
-
-/** \brief Bind a timestamp to the specified column
- *
- * This function binds the timestamp variable to the specified
- * colunm.
- *
- * \param[in] name       The name of the column
- * \param[in] timestamp  The timestamp variable to bind
- * \param[in] is_null    A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(const std::string& name, SQL_TIMESTAMP_STRUCT& timestamp, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	bi->f_name = name;
-	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_TIMESTAMP;
-	bi->f_data = &timestamp;
-	bi->f_size = sizeof(SQL_TIMESTAMP_STRUCT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_name.insert(bind_info_name_t(name, bi));
-}
-
-
-/** \brief Bind a timestamp to the specified column
- *
- * This function binds the timestamp variable to the specified
- * colunm.
- *
- * \param[in] col        The column number, starting at 1
- * \param[in] timestamp  The timestamp variable to bind
- * \param[in] is_null    A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(SQLSMALLINT col, SQL_TIMESTAMP_STRUCT& timestamp, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	//bi->f_name -- unused
-	bi->f_col = col;
-	bi->f_target_type = SQL_C_TIMESTAMP;
-	bi->f_data = &timestamp;
-	bi->f_size = sizeof(SQL_TIMESTAMP_STRUCT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_col.insert(bind_info_col_t(col, bi));
-}
-
-
-/** \brief Bind a Numeric to the specified column
- *
- * This function binds the numeric variable to the specified
- * colunm.
- *
- * \param[in] name     The name of column
- * \param[in] numeric  The numeric variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(const std::string& name, SQL_NUMERIC_STRUCT& numeric, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	bi->f_name = name;
-	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_NUMERIC;
-	bi->f_data = &numeric;
-	bi->f_size = sizeof(SQL_NUMERIC_STRUCT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_name.insert(bind_info_name_t(name, bi));
-}
-
-
-/** \brief Bind a Numeric to the specified column
- *
- * This function binds the numeric variable to the specified
- * colunm.
- *
- * \param[in] col      The column number, starting at 1
- * \param[in] numeric  The numeric variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(SQLSMALLINT col, SQL_NUMERIC_STRUCT& numeric, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	//bi->f_name -- unused
-	bi->f_col = col;
-	bi->f_target_type = SQL_C_NUMERIC;
-	bi->f_data = &numeric;
-	bi->f_size = sizeof(SQL_NUMERIC_STRUCT);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_col.insert(bind_info_col_t(col, bi));
-}
-
-
-/** \brief Bind a GUID to the specified column
- *
- * This function binds the GUID variable to the specified
- * colunm.
- *
- * \param[in] name     The name of the column
- * \param[in] guid     The guid variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(const std::string& name, SQLGUID& guid, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	bi->f_name = name;
-	//bi->f_col -- unused
-	bi->f_target_type = SQL_C_GUID;
-	bi->f_data = &guid;
-	bi->f_size = sizeof(SQLGUID);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- dynamic
-	f_bind_by_name.insert(bind_info_name_t(name, bi));
-}
-
-
-/** \brief Bind a GUID to the specified column
- *
- * This function binds the GUID variable to the specified
- * colunm.
- *
- * \param[in] col      The column number, starting at 1
- * \param[in] guid     The guid variable to bind
- * \param[in] is_null  A pointer to a boolean variable set to true whenever this column is NULL in the database
- */
-void record::bind(SQLSMALLINT col, SQLGUID& guid, bool *is_null)
-{
-	bind_info_t	*bi = new bind_info_t;
-
-	//bi->f_name -- unused
-	bi->f_col = col;
-	bi->f_target_type = SQL_C_GUID;
-	bi->f_data = &guid;
-	bi->f_size = sizeof(SQLGUID);
-	//bi->f_fetch_size -- dynamic
-	bi->f_is_null = is_null;
-	//bi->f_data_buffer -- auto
-	//bi->f_string -- unused
-	f_bind_by_col.insert(bind_info_col_t(col, bi));
-}
-
-
-// documented in record_base
-void record::bind_impl()
-{
-	SQLSMALLINT	idx, max, type, name_length;
-	SQLULEN		size;
-	SQLCHAR		column_name[256];
-	bind_info_t	*info;
+	SQLSMALLINT	idx, max, type, name_length;
+	SQLULEN		size;
+	SQLCHAR		column_name[256];
+	bind_info_t	*info;
 
 	// TODO: should we check the column types (at least in debug)
 	//	 against the target type?
 
+	// the previous arena is going away, forget about it
+	bind_info_bound_vector_t::const_iterator itr(f_bound.begin());
+	for(; itr != f_bound.end(); ++itr) {
+		info = itr->second;
+		info->f_indicator = 0;
+		if(info->f_target_type == SQL_C_CHAR
+		|| info->f_target_type == SQL_C_WCHAR
+		|| (info->f_target_type == SQL_C_NUMERIC && info->f_scaled != 0)
+		|| info->f_converter) {
+			info->f_data = 0;
+		}
+	}
+	f_bound.clear();
+
+	// first find the columns and the size of their buffers
+	SQLULEN arena_size = 0;
 	max = static_cast<SQLSMALLINT>(f_statement->cols());
+	f_result_cols = max;
+
+	// the variables can only receive one row
+	f_statement->set_rowset_size(1);
 	for(idx = 1; idx <= max; ++idx) {
 
 		// if the user defined this by column, bind blindly
@@ -1335,8 +926,7 @@ void record::bind_impl()
 		if(by_col == f_bind_by_col.end()) {
 			// search by name then...
 			name_length = sizeof(column_name);	// probably useless
-			f_statement->check(SQLDescribeCol(
-				f_statement->get_handle(),// StatementHandle
+			f_statement->describe_col(
 				idx,			// ColumnNumber
 				column_name,		// ColumnName
 				sizeof(column_name),	// BufferLength
@@ -1344,7 +934,7 @@ void record::bind_impl()
 				&type,			// DataTypePtr
 				&size,			// ColumnSizePtr
 				NULL,			// DecimalDigitsPtr
-				NULL));			// NullablePtr
+				NULL);			// NullablePtr
 
 			// make totally sure that the string is null terminated
 			column_name[sizeof(column_name) - 1] = '\0';
@@ -1361,12 +951,11 @@ void record::bind_impl()
 			size = 0;
 		}
 
-		// got some info, let's bind
+		// got some info, compute the string buffer sizes
 		if(info->f_target_type == SQL_C_CHAR
 		|| info->f_target_type == SQL_C_WCHAR) {
 			if(size == 0) {
-				f_statement->check(SQLDescribeCol(
-					f_statement->get_handle(),// StatementHandle
+				f_statement->describe_col(
 					idx,			// ColumnNumber
 					NULL,			// ColumnName
 					0,			// BufferLength
@@ -1374,7 +963,7 @@ void record::bind_impl()
 					NULL,			// DataTypePtr
 					&info->f_size,		// ColumnSizePtr
 					NULL,			// DecimalDigitsPtr
-					NULL));			// NullablePtr
+					NULL);			// NullablePtr
 			}
 			else {
 				info->f_size = size;
@@ -1387,25 +976,113 @@ void record::bind_impl()
 				// make sure the size is even if we read SQLWCHAR characters
 				// (SQLWCHAR characters are UCS-2, UTF-16 or UCS-4)
 				info->f_size = (info->f_size + 1) * sizeof(SQLWCHAR);
+				if(!info->f_converter) {
+					info->f_wstring->reserve(info->f_size / sizeof(SQLWCHAR));
+				}
 			}
 			else {
 				info->f_size += sizeof(SQLCHAR);
+				// the fetches then reuse this capacity
+				if(!info->f_converter) {
+					info->f_string->reserve(info->f_size);
+				}
 			}
 			// add a character so CHAR(1) generates a buffer of 2 characters
 			// we use sizeof(SQLWCHAR) since it is the larger than sizeof(SQLCHAR)
-		//	std::cout << "new buffer!!!" << endl;
-			info->f_data_buffer.reset(new buffer_char_t(info->f_size + sizeof(SQLWCHAR)));
-			info->f_data = info->f_data_buffer->get();
+			arena_size += arena_align(info->f_size + sizeof(SQLWCHAR));
+		}
+		else if(info->f_target_type == SQL_C_NUMERIC) {
+			// the driver needs the precision and scale of the numeric
+			SQLSMALLINT decimal_digits;
+			f_statement->describe_col(
+				idx,			// ColumnNumber
+				NULL,			// ColumnName
+				0,			// BufferLength
+				NULL,			// NameLengthPtr
+				NULL,			// DataTypePtr
+				&size,			// ColumnSizePtr
+				&decimal_digits,	// DecimalDigitsPtr
+				NULL);			// NullablePtr
+			info->f_precision = numeric_precision(size);
+			if(info->f_scaled == 0) {
+				info->f_scale = decimal_digits;
+			}
+			else {
+				// scaled integers are converted from a numeric in the arena
+				arena_size += arena_align(sizeof(SQL_NUMERIC_STRUCT));
+			}
 		}
+		if(info->f_converter
+		&& info->f_target_type != SQL_C_CHAR
+		&& info->f_target_type != SQL_C_WCHAR) {
+			// converted types are read in the arena
+			arena_size += arena_align(info->f_size);
+		}
+
+		f_bound.push_back(std::make_pair(idx, info));
+	}
+
+	// one block for all the indicators and string buffers
+	SQLULEN indicators_size = arena_align(f_bound.size() * sizeof(SQLLEN));
+	char *arena = allocate_arena(indicators_size + arena_size);
+	SQLLEN *indicators = reinterpret_cast<SQLLEN *>(arena);
+	arena += indicators_size;
+
+	// now bind the columns
+	for(itr = f_bound.begin(); itr != f_bound.end(); ++itr, ++indicators) {
+		info = itr->second;
+		info->f_indicator = indicators;
+		*indicators = SQL_NULL_DATA;
+		if(info->f_target_type == SQL_C_CHAR
+		|| info->f_target_type == SQL_C_WCHAR) {
+			info->f_data = arena;
+			arena += arena_align(info->f_size + sizeof(SQLWCHAR));
+		}
+		else if(info->f_target_type == SQL_C_NUMERIC && info->f_scaled != 0) {
+			info->f_data = arena;
+			arena += arena_align(sizeof(SQL_NUMERIC_STRUCT));
+		}
+		else if(info->f_converter) {
+			info->f_data = arena;
+			arena += arena_align(info->f_size);
+		}
+
+		f_statement->bind_col(
+			itr->first,
+			info->f_target_type,
+			info->f_data,
+			info->f_size,
+			info->f_indicator,
+			info->f_precision,
+			info->f_scale);
+	}
+}
+
+
+
+// documented in record_base
+bool record::rebind_impl()
+{
+	if(!f_arena || f_statement->cols() != f_result_cols) {
+		return false;
+	}
 
-		f_statement->check(SQLBindCol(
-			f_statement->get_handle(),
-			idx,
+	f_statement->set_rowset_size(1);
+
+	bind_info_bound_vector_t::const_iterator itr(f_bound.begin());
+	for(; itr != f_bound.end(); ++itr) {
+		bind_info_t *info = itr->second;
+		f_statement->bind_col(
+			itr->first,
 			info->f_target_type,
 			info->f_data,
 			info->f_size,
-			&info->f_fetch_size));
+			info->f_indicator,
+			info->f_precision,
+			info->f_scale);
 	}
+
+	return true;
 }
 
 
@@ -1439,12 +1116,35 @@ void record::finalize()
  */
 void record::finalize_info(smartptr<record::bind_info_t> &info)
 {
+	// columns that are not part of the result have no indicator
+	SQLLEN fetch_size = info->f_indicator == 0 ? 0 : *info->f_indicator;
+
 	if(info->f_is_null != 0) {
-		*info->f_is_null = info->f_fetch_size == SQL_NULL_DATA;
+		*info->f_is_null = fetch_size == SQL_NULL_DATA;
+	}
+
+	if(info->f_converter) {
+		if(info->f_indicator != 0) {
+			column_buffer_t column = { info->f_target_type, reinterpret_cast<const char *>(info->f_data), info->f_size, fetch_size };
+			info->f_converter(column, info->f_value);
+		}
+		return;
+	}
+
+	if(info->f_target_type == SQL_C_NUMERIC && info->f_scaled != 0) {
+		if(info->f_indicator == 0 || fetch_size == SQL_NULL_DATA) {
+			*info->f_scaled = 0;
+		}
+		else if(!numeric_to_int64(*reinterpret_cast<const SQL_NUMERIC_STRUCT *>(info->f_data), info->f_scale, *info->f_scaled)) {
+			diagnostic d(odbcpp_error::ODBCPP_TYPE_MISMATCH, std::string("decimal value does not fit in a 64 bit integer"));
+			throw odbcpp_error(d);
+		}
+		return;
 	}
 
 	// We want to clear all the strings in case no data is available for them
 	// it is a good idea to have a default like this.
+	// (clear() keeps the capacity reserved by bind_impl())
 	if(info->f_string != 0) {
 		if(info->f_target_type == SQL_C_CHAR) {
 			info->f_string->clear();
@@ -1458,24 +1158,40 @@ void record::finalize_info(smartptr<record::bind_info_t> &info)
 	if(info->f_data != 0
 	&& info->f_string != 0
 	&& info->f_size > 0
-	&& info->f_fetch_size != SQL_NULL_DATA) {
+	&& fetch_size != SQL_NULL_DATA) {
 		if(info->f_target_type == SQL_C_CHAR) {
 			// make sure that the data buffer is null terminated
 			// note that we have 1 extra character in the buffer, see bind_impl()
 			char *s = reinterpret_cast<char *>(info->f_data);
 			s[info->f_size] = '\0';
-			*info->f_string = s;
+			// the indicator is the length unless the data was truncated
+			if(fetch_size >= 0 && static_cast<SQLULEN>(fetch_size) < info->f_size) {
+				info->f_string->assign(s, fetch_size);
+			}
+			else {
+				info->f_string->assign(s);
+			}
+			f_statement->add_bytes_copied(info->f_string->length());
 		}
 		else if(info->f_target_type == SQL_C_WCHAR) {
 			// make sure that the data buffer is null terminated
 			// note that we have 1 extra character in the buffer, see bind_impl()
 			SQLWCHAR *s = reinterpret_cast<SQLWCHAR *>(info->f_data);
 			s[info->f_size / sizeof(SQLWCHAR)] = '\0';
-			while(*s != static_cast<SQLWCHAR>(0)) {
-				// TODO: if we detect an 0xFFFE or 0xFEFF we could also
-				//	 swap the bytes as required...
-				*info->f_wstring += static_cast<wchar_t>(*s++);
+			size_t length;
+			if(fetch_size >= 0 && static_cast<SQLULEN>(fetch_size) < info->f_size) {
+				length = fetch_size / sizeof(SQLWCHAR);
+			}
+			else {
+				for(length = 0; s[length] != static_cast<SQLWCHAR>(0); ++length);
 			}
+			// TODO: if we detect an 0xFFFE or 0xFEFF we could also
+			//	 swap the bytes as required...
+			info->f_wstring->resize(length);
+			for(size_t idx = 0; idx < length; ++idx) {
+				(*info->f_wstring)[idx] = static_cast<wchar_t>(s[idx]);
+			}
+			f_statement->add_bytes_copied(length * sizeof(SQLWCHAR));
 		}
 	}
 }
@@ -1532,7 +1248,8 @@ void record::finalize_info(smartptr<record::bind_info_t> &info)
  * \brief The pointer to your variable.
  *
  * In most cases, this is the pointer to your variable. The only
- * two exceptions at this time are the string and wstring types.
+ * two exceptions at this time are the string and wstring types
+ * which point to a buffer in the record arena.
  *
  * This pointer is never freed. It has to be done by you. Do not
  * free your variable until after you are done with calls to
@@ -1548,12 +1265,16 @@ void record::finalize_info(smartptr<record::bind_info_t> &info)
  * variable.
  */
 
-/** \var record::bind_info_t::f_fetch_size
+/** \var record::bind_info_t::f_indicator
  *
  * \brief The number of bytes the last fetch() command read.
  *
- * This value represents the exact size of the variable buffer that
- * has been defined by the last fetch() command.
+ * This pointer points to the indicator of this column in the record
+ * arena. The value represents the exact size of the variable buffer
+ * that has been defined by the last fetch() command, or
+ * SQL_NULL_DATA.
+ *
+ * The pointer is NULL when the column is not part of the result.
  */
 
 /** \var record::bind_info_t::f_is_null
@@ -1568,13 +1289,19 @@ void record::finalize_info(smartptr<record::bind_info_t> &info)
  * be changed only by a call to fetch().
  */
 
-/** \var record::bind_info_t::f_data_buffer
+/** \var record::bind_info_t::f_precision
+ *
+ * \brief The precision of an SQL_C_NUMERIC column.
+ *
+ * This variable is set by bind_impl() from the column size.
+ */
+
+/** \var record::bind_info_t::f_scale
  *
- * \brief The buffer used to hold dynamically allocated data pointers.
+ * \brief The scale of an SQL_C_NUMERIC column.
  *
- * This variable is allocated only when a dynamically allocated data
- * buffer is necessary. This is the case for the string and wstring
- * types.
+ * This variable is the scale described by the driver, or the scale
+ * requested with bind_decimal().
  */
 
 /** \var record::bind_info_t::f_string
@@ -1595,6 +1322,53 @@ void record::finalize_info(smartptr<record::bind_info_t> &info)
  * in the caller string.
  */
 
+/** \var record::bind_info_t::f_scaled
+ *
+ * \brief A pointer to the caller scaled integer.
+ *
+ * This variable holds a pointer to the integer bound with
+ * bind_decimal(). The finalize() function converts the numeric
+ * read with fetch() to this integer.
+ */
+
+/** \var record::bind_info_t::f_converter
+ *
+ * \brief The converter of the column, if any.
+ *
+ * The types that the driver cannot write directly in the variable
+ * (see sql_traits) are read in the record arena. The finalize()
+ * function calls this converter to copy the data in the variable.
+ */
+
+/** \var record::bind_info_t::f_value
+ *
+ * \brief The variable of the converter.
+ *
+ * This variable holds a pointer to the user variable that f_converter
+ * writes to.
+ */
+
+/** \typedef record::converter_t
+ *
+ * \brief Convert the buffer of a column to a variable.
+ *
+ * The converters are instantiations of the convert() template. They
+ * are plain functions so binding a variable allocates nothing and
+ * finalize() calls them without a virtual table.
+ */
+
+/** \fn record::convert(const column_buffer_t& column, void *value)
+ *
+ * \brief Convert the buffer of a column to a variable of type T.
+ *
+ * This function calls the read() function of the sql_traits of T.
+ * It is instantiated by the bind() templates so the conversion is
+ * compiled with the caller code.
+ *
+ * \param[in] column   The buffer of the column, as filled by the last fetch
+ * \param[out] value   The variable of type T receiving the value
+ */
+
 
 
 
@@ -1639,13 +1413,12 @@ void record::finalize_info(smartptr<record::bind_info_t> &info)
  * \return The number of records (variables, columns) allocated in this dynamic record
  */
 
-/** \var dynamic_record::f_bind_by_name
- *
- * \brief Map holding the column binding information by name.
+/** \var dynamic_record::f_schema
  *
- * This variable holds all the named columns ordered by name.
+ * \brief The names and types of the columns.
  *
- * It is used internally to quickly find the columns by name
+ * The schema is shared with the other records bound to results of
+ * the same shape. Its hash table is used to find the columns by name
  * (i.e. whenever you use one of the get() functions with a column
  * name instead of an index.)
  */
@@ -1660,6 +1433,49 @@ void record::finalize_info(smartptr<record::bind_info_t> &info)
  * index.
  */
 
+/** \var dynamic_record::f_rowset_size
+ *
+ * \brief The number of rows read by each fetch.
+ *
+ * Each column buffer and indicator is an array of this many items.
+ */
+
+/** \var dynamic_record::f_row
+ *
+ * \brief The current row in the rowset.
+ *
+ * The get() functions return the data of this row.
+ */
+
+/** \var dynamic_record::f_decimal_mode
+ *
+ * \brief How the DECIMAL and NUMERIC columns are bound.
+ *
+ * \sa set_decimal_mode()
+ */
+
+/** \var dynamic_record::f_source
+ *
+ * \brief The object the columns point to, if any.
+ *
+ * When a snapshot_reader or an external_sorter attaches this record,
+ * the column data and indicators point in the buffers of that object
+ * instead of the arena.
+ */
+
+/** \var dynamic_record::f_source_block
+ *
+ * \brief The block of the source the columns point to.
+ */
+
+/** \var dynamic_record::f_source_rows
+ *
+ * \brief The number of rows in the block of the source.
+ *
+ * This is returned by rows_fetched() while the record is attached
+ * to a source.
+ */
+
 
 /** \brief Return the name of a column.
  *
@@ -1676,9 +1492,22 @@ void record::finalize_info(smartptr<record::bind_info_t> &info)
  */
 const std::string& dynamic_record::column_name(SQLSMALLINT col) const
 {
-	return find_column(col, SQL_UNKNOWN_TYPE)->f_name;
+	return f_schema->name(find_column(col, SQL_UNKNOWN_TYPE)->f_col);
 }
 
+
+/** \fn dynamic_record::get_schema() const
+ *
+ * \brief Retrieve the schema of the result.
+ *
+ * The schema holds the names and types of the columns. It is shared
+ * by all the records bound to results with the same columns, so two
+ * records have the same columns when their schemas are the same
+ * pointer.
+ *
+ * \return The schema, empty if the record was never bound.
+ */
+
 /** \brief Return the number of a named column.
  *
  * This function returns the indice of the named column.
@@ -1702,24 +1531,47 @@ void dynamic_record::bind_impl()
 	SQLSMALLINT	idx, max, name_length;
 	SQLCHAR		column_name[256];
 
+	// the columns now come from the statement
+	f_source = NULL;
+	f_source_rows = 0;
+
 	max = static_cast<SQLSMALLINT>(f_statement->cols());
+
+	// the column information of the previous result can be reused
+	// unless it is shared with a copy of this record (a copy shares
+	// the arena and the column information)
+	if(!f_arena || f_arena->refcount() > 1) {
+		f_bind_by_col.clear();
+	}
+	f_bind_by_col.resize(max);
+
+	// the schema is kept as long as the columns do not change, the
+	// vector is only filled when they do
+	bool same_schema = f_schema && f_schema->size() == max;
+	result_schema::column_vector_t columns;
+
+	// first describe all the columns to compute the size of the arena
+	SQLULEN arena_size = 0;
 	for(idx = 1; idx <= max; ++idx) {
-		// we want the info to be reset on each loop
-		bind_info_t *info = new bind_info_t;
+		smartptr<bind_info_t>& slot = f_bind_by_col[idx - 1];
+		if(!slot) {
+			slot = new bind_info_t;
+		}
+		bind_info_t *info = slot;
 		info->f_col = idx;
 
 		// get the next column info
 		name_length = sizeof(column_name);	// probably useless
-		f_statement->check(SQLDescribeCol(
-			f_statement->get_handle(),// StatementHandle
+		f_statement->describe_col(
 			idx,			// ColumnNumber
 			column_name,		// ColumnName
 			sizeof(column_name),	// BufferLength
 			&name_length,		// NameLengthPtr
 			&info->f_target_type,	// DataTypePtr
-			&info->f_size,		// ColumnSizePtr in characters
+			&info->f_column_size,	// ColumnSizePtr in characters
 			&info->f_decimal_digits,	// DecimalDigitsPtr
-			NULL));			// NullablePtr
+			NULL);			// NullablePtr
+		info->f_size = info->f_column_size;
 
 		// We must change the SQL type of a corresponding C type
 		switch(info->f_target_type) {
@@ -1729,11 +1581,30 @@ void dynamic_record::bind_impl()
 		case SQL_VARBINARY:
 		case SQL_LONGVARBINARY:
 		case SQL_GUID:
-		case SQL_DECIMAL:
 			info->f_bind_type = SQL_C_CHAR;
 			info->f_size += sizeof(SQLCHAR);
 			break;
 
+		case SQL_DECIMAL:
+			if(f_decimal_mode == DECIMAL_MODE_STRING) {
+				info->f_bind_type = SQL_C_CHAR;
+				info->f_size += sizeof(SQLCHAR);
+				break;
+			}
+			/*FALLTHROUGH*/
+		case SQL_NUMERIC:
+			// integers that fit in 64 bits are read as such
+			if(f_decimal_mode == DECIMAL_MODE_NUMERIC
+			&& info->f_decimal_digits <= 0
+			&& info->f_column_size > 0
+			&& info->f_column_size <= 18) {
+				info->f_bind_type = SQL_C_SBIGINT;
+			}
+			else {
+				info->f_bind_type = SQL_C_NUMERIC;
+			}
+			break;
+
 		case SQL_WLONGVARCHAR:
 		case SQL_WVARCHAR:
 			info->f_bind_type = SQL_C_WCHAR;
@@ -1764,31 +1635,346 @@ void dynamic_record::bind_impl()
 
 		}
 
-		// copy the name if any
-		if(name_length >= sizeof(column_name)) {
+		// the column size of fixed types is a number of digits which
+		// may be smaller than the C structure (i.e. NUMERIC(5))
+		if(info->f_size < sizeof(SQL_INTERVAL_STRUCT)) {
+			info->f_size = sizeof(SQL_INTERVAL_STRUCT);
+		}
+
+		// compare with the previous schema
+		if(name_length >= static_cast<SQLSMALLINT>(sizeof(column_name))) {
 			name_length = sizeof(column_name) - 1;
 		}
-		column_name[name_length] = '\0';
-		info->f_name = reinterpret_cast<char *>(column_name);
+		const char *name = reinterpret_cast<const char *>(column_name);
+		if(same_schema && !f_schema->same_column(idx, name, name_length,
+				info->f_target_type, info->f_column_size, info->f_decimal_digits)) {
+			same_schema = false;
+			columns.assign(f_schema->columns().begin(), f_schema->columns().begin() + (idx - 1));
+		}
+		if(!same_schema) {
+			columns.push_back(result_schema::column_t(&result_schema::intern(name, name_length),
+					info->f_target_type, info->f_column_size, info->f_decimal_digits));
+		}
 
 		// at this point info->f_size is the buffer size in bytes,
-		// it can be longer than necessary for SQLBindCol()
-		info->f_data.reset(new buffer_char_t(info->f_size));
+		// it can be longer than necessary for SQLBindCol(); with
+		// column-wise arrays, the driver uses the size of the C type
+		// as the distance between rows of fixed types so the stride
+		// is also the buffer length we pass to SQLBindCol()
+		info->f_stride = c_type_size(info->f_bind_type);
+		if(info->f_stride == 0) {
+			info->f_size = arena_align(info->f_size);
+			info->f_stride = info->f_size;
+		}
+		arena_size += arena_align(info->f_stride * f_rowset_size);
+	}
+
+	// records bound to the same shape share the same schema
+	if(!same_schema) {
+		f_schema = result_schema::get(columns);
+	}
 
-		f_statement->check(SQLBindCol(
-			f_statement->get_handle(),
-			idx,
+	// one block for all the indicators and data buffers
+	SQLULEN indicators_size = arena_align(f_bind_by_col.size() * f_rowset_size * sizeof(SQLLEN));
+	char *arena = allocate_arena(indicators_size + arena_size);
+	SQLLEN *indicators = reinterpret_cast<SQLLEN *>(arena);
+	arena += indicators_size;
+
+	f_statement->set_rowset_size(f_rowset_size);
+	f_row = 0;
+
+	// now bind the columns
+	bind_info_col_vector_t::iterator itr(f_bind_by_col.begin());
+	for(; itr != f_bind_by_col.end(); ++itr, indicators += f_rowset_size) {
+		bind_info_t *info = *itr;
+		info->f_data = arena;
+		info->f_indicator = indicators;
+		*indicators = SQL_NULL_DATA;
+		arena += arena_align(info->f_stride * f_rowset_size);
+
+		f_statement->bind_col(
+			info->f_col,
 			info->f_bind_type,
-			info->f_data->get(),
-			info->f_size,
-			&info->f_fetch_size));
-		if(!info->f_name.empty()) {
-			f_bind_by_name.insert(bind_info_name_t(info->f_name, info));
+			info->f_data,
+			info->f_stride,
+			info->f_indicator,
+			info->f_bind_type == SQL_C_NUMERIC ? numeric_precision(info->f_column_size) : 0,
+			info->f_bind_type == SQL_C_NUMERIC ? info->f_decimal_digits : 0);
+	}
+}
+
+// documented in record_base
+bool dynamic_record::rebind_impl()
+{
+	SQLSMALLINT	type, decimal_digits;
+	SQLULEN		size;
+
+	if(!f_arena || static_cast<size_t>(f_statement->cols()) != f_bind_by_col.size()) {
+		return false;
+	}
+
+	// the types and sizes must match since the buffers depend on them
+	bind_info_col_vector_t::iterator itr(f_bind_by_col.begin());
+	for(; itr != f_bind_by_col.end(); ++itr) {
+		bind_info_t *info = *itr;
+		f_statement->describe_col(
+			info->f_col,		// ColumnNumber
+			NULL,			// ColumnName
+			0,			// BufferLength
+			NULL,			// NameLengthPtr
+			&type,			// DataTypePtr
+			&size,			// ColumnSizePtr in characters
+			&decimal_digits,	// DecimalDigitsPtr
+			NULL);			// NullablePtr
+		if(type != info->f_target_type
+		|| size != info->f_column_size
+		|| decimal_digits != info->f_decimal_digits) {
+			return false;
+		}
+	}
+
+	f_statement->set_rowset_size(f_rowset_size);
+	f_row = 0;
+
+	for(itr = f_bind_by_col.begin(); itr != f_bind_by_col.end(); ++itr) {
+		bind_info_t *info = *itr;
+		f_statement->bind_col(
+			info->f_col,
+			info->f_bind_type,
+			info->f_data,
+			info->f_stride,
+			info->f_indicator,
+			info->f_bind_type == SQL_C_NUMERIC ? numeric_precision(info->f_column_size) : 0,
+			info->f_bind_type == SQL_C_NUMERIC ? info->f_decimal_digits : 0);
+	}
+
+	return true;
+}
+
+/** \brief Define the number of rows read by each fetch.
+ *
+ * By default a dynamic record reads one row per fetch. With a
+ * larger rowset size, each call to statement::fetch() reads up to
+ * \p size rows with a single call to the driver. The columns are
+ * bound as arrays, all allocated in the record arena.
+ *
+ * After a fetch, the current row is row 0. Use rows_fetched() to
+ * know how many rows were read and set_row() to select the row
+ * that the get() functions return.
+ *
+ * Changing the size unbinds the record so the next fetch binds
+ * it again.
+ *
+ * \param[in] size   The number of rows to read with each fetch, 0 is viewed as 1
+ *
+ * \sa fetch_all()
+ */
+void dynamic_record::set_rowset_size(SQLULEN size)
+{
+	if(size == 0) {
+		size = 1;
+	}
+	if(size != f_rowset_size) {
+		f_rowset_size = size;
+		unbind();
+	}
+}
+
+
+/** \brief Define how DECIMAL columns are read.
+ *
+ * By default, DECIMAL columns are read as strings as most drivers
+ * are not capable of anything else with older versions of ODBC.
+ * In this mode, NUMERIC columns are read as SQL_NUMERIC_STRUCT.
+ *
+ * With DECIMAL_MODE_NUMERIC, DECIMAL and NUMERIC columns without
+ * decimal digits and up to 18 digits are read as 64 bit integers
+ * (SQLBIGINT) and the other DECIMAL and NUMERIC columns are read
+ * as SQL_NUMERIC_STRUCT with their precision and scale. This avoids
+ * formatting and parsing a string for each value.
+ *
+ * In both modes, the get() function returning an std::string
+ * works with these columns.
+ *
+ * Changing the mode unbinds the record so the next fetch binds
+ * it again.
+ *
+ * \param[in] mode   The new decimal mode
+ *
+ * \sa numeric_to_string(), numeric_to_int64()
+ */
+void dynamic_record::set_decimal_mode(decimal_mode_t mode)
+{
+	if(mode != f_decimal_mode) {
+		f_decimal_mode = mode;
+		unbind();
+	}
+}
+
+
+/** \fn dynamic_record::get_decimal_mode() const
+ *
+ * \brief Retrieve how DECIMAL columns are read.
+ *
+ * \return The current decimal mode.
+ *
+ * \sa set_decimal_mode()
+ */
+
+
+/** \fn dynamic_record::get_rowset_size() const
+ *
+ * \brief Retrieve the number of rows read by each fetch.
+ *
+ * \return The rowset size of this record.
+ */
+
+
+/** \brief Retrieve the number of rows read by the last fetch.
+ *
+ * This function returns the number of rows available in the record
+ * after the last call to statement::fetch(). When the record is
+ * attached to a snapshot or a sorter, this is the number of rows
+ * of the block.
+ *
+ * \return The number of rows in the record, 0 if not bound
+ */
+SQLULEN dynamic_record::rows_fetched() const
+{
+	if(f_source != NULL) {
+		return f_source_rows;
+	}
+	if(!f_statement) {
+		return 0;
+	}
+	return f_statement->rows_fetched();
+}
+
+
+/** \brief Select the current row.
+ *
+ * This function selects the row of the current rowset that the
+ * get() functions return.
+ *
+ * \param[in] row   The row number, from 0 to rows_fetched() - 1
+ *
+ * \exception odbcpp_error
+ * If the row is out of bounds, an odbcpp_error is raised.
+ */
+void dynamic_record::set_row(SQLULEN row)
+{
+	if(row >= rows_fetched()) {
+		diagnostic d(odbcpp_error::ODBCPP_NOT_FOUND, std::string("the row is out of bounds in this rowset"));
+		throw odbcpp_error(d);
+	}
+	f_row = row;
+}
+
+
+/** \fn dynamic_record::get_row() const
+ *
+ * \brief Retrieve the current row.
+ *
+ * \return The number of the row that the get() functions return.
+ */
+
+
+/** \fn dynamic_record::finalize()
+ *
+ * \brief Reset the current row after a fetch.
+ *
+ * After each fetch, the current row becomes the first row of the
+ * rowset.
+ */
+
+
+/** \fn dynamic_record::column_data(const smartptr<bind_info_t>& info) const
+ *
+ * \brief Get a pointer to the data of a column in the current row.
+ *
+ * \param[in] info   The column information
+ *
+ * \return A pointer in the arena.
+ */
+
+
+/** \fn dynamic_record::column_indicator(const smartptr<bind_info_t>& info) const
+ *
+ * \brief Get the indicator of a column in the current row.
+ *
+ * \param[in] info   The column information
+ *
+ * \return The size of the data or SQL_NULL_DATA.
+ */
+
+
+/** \brief Return the size of a fixed C type.
+ *
+ * This function returns the size of the buffer required by the
+ * specified C type. With column-wise binding the driver uses this
+ * size as the distance between two rows.
+ *
+ * \param[in] c_type   The C type (SQL_C_...)
+ *
+ * \return The size in bytes or 0 if the type has a variable size.
+ */
+SQLULEN dynamic_record::c_type_size(SQLSMALLINT c_type)
+{
+	switch(c_type) {
+	case SQL_C_BIT:
+	case SQL_C_TINYINT:
+	case SQL_C_STINYINT:
+	case SQL_C_UTINYINT:
+		return sizeof(SQLCHAR);
+
+	case SQL_C_SHORT:
+	case SQL_C_SSHORT:
+	case SQL_C_USHORT:
+		return sizeof(SQLSMALLINT);
+
+	case SQL_C_LONG:
+	case SQL_C_SLONG:
+	case SQL_C_ULONG:
+		return sizeof(SQLINTEGER);
+
+	case SQL_C_SBIGINT:
+	case SQL_C_UBIGINT:
+		return sizeof(SQLBIGINT);
+
+	case SQL_C_FLOAT:
+		return sizeof(SQLREAL);
+
+	case SQL_C_DOUBLE:
+		return sizeof(SQLDOUBLE);
+
+	case SQL_C_DATE:
+	case SQL_C_TYPE_DATE:
+		return sizeof(SQL_DATE_STRUCT);
+
+	case SQL_C_TIME:
+	case SQL_C_TYPE_TIME:
+		return sizeof(SQL_TIME_STRUCT);
+
+	case SQL_C_TIMESTAMP:
+	case SQL_C_TYPE_TIMESTAMP:
+		return sizeof(SQL_TIMESTAMP_STRUCT);
+
+	case SQL_C_NUMERIC:
+		return sizeof(SQL_NUMERIC_STRUCT);
+
+	case SQL_C_GUID:
+		return sizeof(SQLGUID);
+
+	default:
+		if(c_type >= SQL_C_INTERVAL_YEAR && c_type <= SQL_C_INTERVAL_MINUTE_TO_SECOND) {
+			return sizeof(SQL_INTERVAL_STRUCT);
 		}
-		f_bind_by_col.push_back(info);
+		return 0;
+
 	}
 }
 
+
 /** \brief Search for a column by name.
  *
  * This function searches for a column using its name.
@@ -1805,10 +1991,7 @@ void dynamic_record::bind_impl()
  */
 bool dynamic_record::exists(const std::string& name)
 {
-	bind_info_name_map_t::iterator	itr;
-
-	itr = f_bind_by_name.find(name);
-	return itr != f_bind_by_name.end();
+	return f_schema && f_schema->find(name) != 0;
 }
 
 
@@ -1842,17 +2025,15 @@ bool dynamic_record::exists(const std::string& name)
  */
 const smartptr<dynamic_record::bind_info_t>& dynamic_record::find_column(const std::string& name, SQLSMALLINT target_type, bool except_null) const
 {
-	bind_info_name_map_t::const_iterator	itr;
-
 	// find the column by name
-	itr = f_bind_by_name.find(name);
-	if(itr == f_bind_by_name.end()) {
+	SQLSMALLINT col = f_schema ? f_schema->find(name) : 0;
+	if(col == 0) {
 		diagnostic d(odbcpp_error::ODBCPP_NOT_FOUND, "the column \"" + name + "\" was not found in this record");
 		throw odbcpp_error(d);
 	}
 
 	// verify the column info and if correct return it
-	return verify_column(itr->second, target_type, except_null);
+	return verify_column(f_bind_by_col[col - 1], target_type, except_null);
 }
 
 
@@ -1894,60 +2075,117 @@ const smartptr<dynamic_record::bind_info_t>& dynamic_record::find_column(SQLSMAL
 
 
 
-/** \brief Verify that the column matches what the user wants.
+/** \brief Verify that the column matches what the user wants.
+ *
+ * This function is a private function that verifies that the
+ * found column has the correct type.
+ *
+ * \param[in] info           The column information structure
+ * \param[in] target_type    The expected type for the found column
+ * \param[in] except_null    Refuse the column if the data is set to NULL
+ *
+ * \return A pointer to the corresponding column information
+ *
+ * \exception odbcpp_error
+ * If the column has a different type or the column cannot be
+ * null (i.e. except_null is true), then this function throws.
+ */
+const smartptr<dynamic_record::bind_info_t>& dynamic_record::verify_column(const smartptr<bind_info_t>& info, SQLSMALLINT target_type, bool except_null) const
+{
+	switch(check_column(info, target_type, except_null)) {
+	case odbcpp_error::ODBCPP_TYPE_MISMATCH:
+		{
+			std::ostringstream err;
+			err << "type mismatch for column \"" + f_schema->name(info->f_col) + "\"";
+			err << " (expected " << info->f_bind_type << ", requested " << alternate_type(target_type) << ")";
+			diagnostic d(odbcpp_error::ODBCPP_TYPE_MISMATCH, err.str());
+			throw odbcpp_error(d);
+		}
+
+	case odbcpp_error::ODBCPP_NO_DATA:
+		{
+			diagnostic d(odbcpp_error::ODBCPP_NO_DATA, std::string("this column is NULL and cannot be retrieved"));
+			throw odbcpp_error(d);
+		}
+
+	}
+
+	return info;
+}
+
+
+/** \brief Check that the column matches what the user wants.
  *
- * This function is a private function that verifies that the
- * found column has the correct type.
+ * This function is the same as verify_column() except that it
+ * returns an error code instead of throwing.
  *
  * \param[in] info           The column information structure
  * \param[in] target_type    The expected type for the found column
  * \param[in] except_null    Refuse the column if the data is set to NULL
  *
- * \return A pointer to the corresponding column information
- *
- * \exception odbcpp_error
- * If the column has a different type or the column cannot be
- * null (i.e. except_null is true), then this function throws.
+ * \return ODBCPP_NONE, ODBCPP_TYPE_MISMATCH or ODBCPP_NO_DATA.
  */
-const smartptr<dynamic_record::bind_info_t>& dynamic_record::verify_column(const smartptr<bind_info_t>& info, SQLSMALLINT target_type, bool except_null) const
+SQLINTEGER dynamic_record::check_column(const smartptr<bind_info_t>& info, SQLSMALLINT target_type, bool except_null) const
 {
 	// verify that the column is of the proper type
 	if(target_type != SQL_UNKNOWN_TYPE
-	&& info->f_bind_type != target_type) {
-		// handle special cases
-		switch(target_type) {
-		case SQL_C_CHAR:
-			target_type = SQL_VARCHAR;
-			break;
+	&& info->f_bind_type != target_type
+	&& info->f_bind_type != alternate_type(target_type)) {
+		return odbcpp_error::ODBCPP_TYPE_MISMATCH;
+	}
 
-		case SQL_C_DATE: // 2.x versus 3.x
-			target_type = SQL_TYPE_DATE;
-			break;
+	if(except_null && column_indicator(info) == SQL_NULL_DATA) {
+		return odbcpp_error::ODBCPP_NO_DATA;
+	}
 
-		case SQL_C_TIME: // 2.x versus 3.x
-			target_type = SQL_TYPE_TIME;
-			break;
+	return odbcpp_error::ODBCPP_NONE;
+}
 
-		case SQL_C_TIMESTAMP: // 2.x versus 3.x
-			target_type = SQL_TYPE_TIMESTAMP;
-			break;
 
-		}
-		if(info->f_bind_type != target_type) {
-			std::ostringstream err;
-			err << "type mismatch for column \"" + info->f_name + "\"";
-			err << " (expected " << info->f_bind_type << ", requested " << target_type << ")";
-			diagnostic d(odbcpp_error::ODBCPP_TYPE_MISMATCH, err.str());
-			throw odbcpp_error(d);
-		}
+/** \brief Search a column by name without throwing.
+ *
+ * This function is the same as find_column() except that errors
+ * are returned in \p code. NULL columns are refused.
+ *
+ * \param[in] name          The name of the column to search
+ * \param[in] target_type   The expected type for the found column
+ * \param[out] code         ODBCPP_NONE, ODBCPP_NOT_FOUND, ODBCPP_TYPE_MISMATCH or ODBCPP_NO_DATA
+ *
+ * \return A pointer to the column information, NULL on errors.
+ */
+const smartptr<dynamic_record::bind_info_t> *dynamic_record::try_find_column(const std::string& name, SQLSMALLINT target_type, SQLINTEGER& code) const
+{
+	SQLSMALLINT col = f_schema ? f_schema->find(name) : 0;
+	if(col == 0) {
+		code = odbcpp_error::ODBCPP_NOT_FOUND;
+		return NULL;
 	}
+	const smartptr<bind_info_t>& info(f_bind_by_col[col - 1]);
+	code = check_column(info, target_type, true);
+	return code == odbcpp_error::ODBCPP_NONE ? &info : NULL;
+}
 
-	if(except_null && info->f_fetch_size == SQL_NULL_DATA) {
-		diagnostic d(odbcpp_error::ODBCPP_NO_DATA, std::string("this column is NULL and cannot be retrieved"));
-		throw odbcpp_error(d);
-	}
 
-	return info;
+/** \brief Search a column by number without throwing.
+ *
+ * This function is the same as find_column() except that errors
+ * are returned in \p code. NULL columns are refused.
+ *
+ * \param[in] col           The number of the column to find
+ * \param[in] target_type   The expected type for the found column
+ * \param[out] code         ODBCPP_NONE, ODBCPP_NOT_FOUND, ODBCPP_TYPE_MISMATCH or ODBCPP_NO_DATA
+ *
+ * \return A pointer to the column information, NULL on errors.
+ */
+const smartptr<dynamic_record::bind_info_t> *dynamic_record::try_find_column(SQLSMALLINT col, SQLSMALLINT target_type, SQLINTEGER& code) const
+{
+	--col;
+	if(static_cast<SQLUSMALLINT>(col) >= f_bind_by_col.size()) {
+		code = odbcpp_error::ODBCPP_NOT_FOUND;
+		return NULL;
+	}
+	code = check_column(f_bind_by_col[col], target_type, true);
+	return code == odbcpp_error::ODBCPP_NONE ? &f_bind_by_col[col] : NULL;
 }
 
 
@@ -2057,7 +2295,7 @@ SQLSMALLINT dynamic_record::get_decimal_digits(SQLSMALLINT col) const
  */
 SQLSMALLINT dynamic_record::get_is_null(const std::string& name) const
 {
-	return find_column(name, SQL_UNKNOWN_TYPE)->f_fetch_size == SQL_NULL_DATA;
+	return column_indicator(find_column(name, SQL_UNKNOWN_TYPE)) == SQL_NULL_DATA;
 }
 
 
@@ -2079,7 +2317,7 @@ SQLSMALLINT dynamic_record::get_is_null(const std::string& name) const
  */
 SQLSMALLINT dynamic_record::get_is_null(SQLSMALLINT col) const
 {
-	return find_column(col, SQL_UNKNOWN_TYPE)->f_fetch_size == SQL_NULL_DATA;
+	return column_indicator(find_column(col, SQL_UNKNOWN_TYPE)) == SQL_NULL_DATA;
 }
 
 
@@ -2097,509 +2335,260 @@ SQLSMALLINT dynamic_record::get_is_null(SQLSMALLINT col) const
  *
  * \param[in] name   The name of the column to check
  *
- * \return the size of the column in bytes
- *
- * \exception odbcpp_error
- * If the named column cannot be found, this function will
- * throw an error.
- */
-SQLLEN dynamic_record::get_size(const std::string& name) const
-{
-	return find_column(name, SQL_UNKNOWN_TYPE)->f_fetch_size;
-}
-
-
-/** \brief Retrieve the size of the column.
- *
- * This function searches for the named column and then
- * return its size in bytes. This is useful for any
- * column that has a variable size.
- *
- * Null terminated strings can have their size set to
- * SQL_NTS.
- *
- * Columns that are not set (i.e. are NULL) have a
- * size set to SQL_NULL_DATA.
- *
- * The column number goes from 1 to dynamic_record::size()
- * inclusive.
- *
- * \param[in] col   The number of the column to check
- *
- * \return the size of the column in bytes
- *
- * \exception odbcpp_error
- * If the column does not exist, this function will
- * throw an error.
- */
-SQLLEN dynamic_record::get_size(SQLSMALLINT col) const
-{
-	return find_column(col, SQL_UNKNOWN_TYPE)->f_fetch_size;
-}
-
-
-/** \brief Retrieve a column data as a string.
- *
- * This function attempt to retrieve the data of a column
- * as a string. If the column is not a string, then an
- * exception is generated.
- *
- * \param[in] name    The name of the column to retrieve
- * \param[in] str     The user string set to the data
- *
- * \exception
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
- */
-void dynamic_record::get(const std::string& name, std::string& str) const
-{
-	str = reinterpret_cast<const char *>(find_column(name, SQL_C_CHAR, true)->f_data->get());
-}
-
-
-/** \brief Retrieve a column data as a string.
- *
- * This function attempt to retrieve the data of a column
- * as a string. If the column is not a string, then an
- * exception is generated.
- *
- * \param[in] col     The index of the column to retrieve
- * \param[in] str     The user string set to the data
- *
- * \exception
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
- */
-void dynamic_record::get(SQLSMALLINT col, std::string& str) const
-{
-	str = reinterpret_cast<const char *>(find_column(col, SQL_C_CHAR, true)->f_data->get());
-}
-
-
-/** \brief Retrieve a column data as a string.
- *
- * This function attempt to retrieve the data of a column
- * as a string. If the column is not a string, then an
- * exception is generated.
- *
- * \param[in] name    The name of the column to retrieve
- * \param[in] str     The user string set to the data
- *
- * \exception
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
- */
-void dynamic_record::get(const std::string& name, std::wstring& str) const
-{
-	const SQLWCHAR *s = reinterpret_cast<const SQLWCHAR *>(find_column(name, SQL_C_WCHAR, true)->f_data->get());
-	str.clear();
-	while(*s != '\0') {
-		str += static_cast<wchar_t>(*s++);
-	}
-}
-
-
-/** \brief Retrieve a column data as a string.
- *
- * This function attempt to retrieve the data of a column
- * as a string. If the column is not a string, then an
- * exception is generated.
- *
- * \param[in] col     The index of the column to retrieve
- * \param[in] str     The user string set to the data
- *
- * \exception
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
- */
-void dynamic_record::get(SQLSMALLINT col, std::wstring& str) const
-{
-	const SQLWCHAR *s = reinterpret_cast<const SQLWCHAR *>(find_column(col, SQL_C_WCHAR, true)->f_data->get());
-	str.clear();
-	while(*s != '\0') {
-		str += static_cast<wchar_t>(*s++);
-	}
-}
-
-
-/** \brief Retrieve a column data as a tiny integer.
- *
- * This function attempt to retrieve the data of a column
- * as a tiny integer. If the column is not a tiny integer, then an
- * exception is generated.
- *
- * \param[in] name        The name of the column to retrieve
- * \param[in] tiny_int    The user tiny integer set to the data
- *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
- */
-void dynamic_record::get(const std::string& name, SQLCHAR& tiny_int) const
-{
-	tiny_int = *reinterpret_cast<SQLCHAR *>(find_column(name, SQL_C_UTINYINT, true)->f_data->get());
-}
-
-
-/** \brief Retrieve a column data as a tiny integer.
- *
- * This function attempt to retrieve the data of a column
- * as a tiny integer. If the column is not a tiny integer, then an
- * exception is generated.
- *
- * \param[in] col         The index of the column to retrieve
- * \param[in] tiny_int    The user tiny integer set to the data
- *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
- */
-void dynamic_record::get(SQLSMALLINT col, SQLCHAR& tiny_int) const
-{
-	tiny_int = *reinterpret_cast<SQLCHAR *>(find_column(col, SQL_C_UTINYINT, true)->f_data->get());
-}
-
-
-/** \brief Retrieve a column data as a tiny integer.
- *
- * This function attempt to retrieve the data of a column
- * as a tiny integer. If the column is not a tiny integer, then an
- * exception is generated.
- *
- * \param[in] name        The name of the column to retrieve
- * \param[in] tiny_int    The user tiny integer set to the data
- *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
- */
-void dynamic_record::get(const std::string& name, SQLSCHAR& tiny_int) const
-{
-	tiny_int = *reinterpret_cast<SQLSCHAR *>(find_column(name, SQL_C_TINYINT, true)->f_data->get());
-}
-
-
-/** \brief Retrieve a column data as a tiny integer.
- *
- * This function attempt to retrieve the data of a column
- * as a tiny integer. If the column is not a tiny integer, then an
- * exception is generated.
- *
- * \param[in] col         The index of the column to retrieve
- * \param[in] tiny_int    The user tiny integer set to the data
- *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
- */
-void dynamic_record::get(SQLSMALLINT col, SQLSCHAR& tiny_int) const
-{
-	tiny_int = *reinterpret_cast<SQLSCHAR *>(find_column(col, SQL_C_TINYINT, true)->f_data->get());
-}
-
-
-/** \brief Retrieve a column data as a small integer.
- *
- * This function attempt to retrieve the data of a column
- * as a small integer. If the column is not a small integer,
- * then an exception is generated.
- *
- * \param[in] name         The name of the column to retrieve
- * \param[in] small_int    The user small integer set to the data
- *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
- */
-void dynamic_record::get(const std::string& name, SQLSMALLINT& small_int) const
-{
-	small_int = *reinterpret_cast<SQLSMALLINT *>(find_column(name, SQL_C_SHORT, true)->f_data->get());
-}
-
-
-/** \brief Retrieve a column data as a small integer.
- *
- * This function attempt to retrieve the data of a column
- * as a small integer. If the column is not a small integer,
- * then an exception is generated.
- *
- * \param[in] col          The index of the column to retrieve
- * \param[in] small_int    The user small integer set to the data
- *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
- */
-void dynamic_record::get(SQLSMALLINT col, SQLSMALLINT& small_int) const
-{
-	small_int = *reinterpret_cast<SQLSMALLINT *>(find_column(col, SQL_C_SHORT, true)->f_data->get());
-}
-
-
-/** \brief Retrieve a column data as a small integer.
- *
- * This function attempt to retrieve the data of a column
- * as a small integer. If the column is not a small integer,
- * then an exception is generated.
- *
- * \param[in] name         The name of the column to retrieve
- * \param[in] small_int    The user small integer set to the data
- *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
- */
-void dynamic_record::get(const std::string& name, SQLUSMALLINT& small_int) const
-{
-	small_int = *reinterpret_cast<SQLUSMALLINT *>(find_column(name, SQL_C_USHORT, true)->f_data->get());
-}
-
-
-/** \brief Retrieve a column data as a small integer.
- *
- * This function attempt to retrieve the data of a column
- * as a small integer. If the column is not a small integer,
- * then an exception is generated.
- *
- * \param[in] col          The index of the column to retrieve
- * \param[in] small_int    The user small integer set to the data
+ * \return the size of the column in bytes
  *
  * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * If the named column cannot be found, this function will
+ * throw an error.
  */
-void dynamic_record::get(SQLSMALLINT col, SQLUSMALLINT& small_int) const
+SQLLEN dynamic_record::get_size(const std::string& name) const
 {
-	small_int = *reinterpret_cast<SQLUSMALLINT *>(find_column(col, SQL_C_USHORT, true)->f_data->get());
+	return column_indicator(find_column(name, SQL_UNKNOWN_TYPE));
 }
 
 
-/** \brief Retrieve a column data as an integer.
+/** \brief Retrieve the size of the column.
  *
- * This function attempt to retrieve the data of a column
- * as an integer. If the column is not an integer,
- * then an exception is generated.
+ * This function searches for the named column and then
+ * return its size in bytes. This is useful for any
+ * column that has a variable size.
  *
- * \param[in] name         The name of the column to retrieve
- * \param[in] integer    The user integer set to the data
+ * Null terminated strings can have their size set to
+ * SQL_NTS.
  *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
- */
-void dynamic_record::get(const std::string& name, SQLINTEGER& integer) const
-{
-	integer = *reinterpret_cast<SQLINTEGER *>(find_column(name, SQL_C_LONG, true)->f_data->get());
-}
-
-
-/** \brief Retrieve a column data as an integer.
+ * Columns that are not set (i.e. are NULL) have a
+ * size set to SQL_NULL_DATA.
  *
- * This function attempt to retrieve the data of a column
- * as an integer. If the column is not an integer,
- * then an exception is generated.
+ * The column number goes from 1 to dynamic_record::size()
+ * inclusive.
  *
- * \param[in] col        The index of the column to retrieve
- * \param[in] integer    The user integer set to the data
+ * \param[in] col   The number of the column to check
+ *
+ * \return the size of the column in bytes
  *
  * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * If the column does not exist, this function will
+ * throw an error.
  */
-void dynamic_record::get(SQLSMALLINT col, SQLINTEGER& integer) const
+SQLLEN dynamic_record::get_size(SQLSMALLINT col) const
 {
-	integer = *reinterpret_cast<SQLUINTEGER *>(find_column(col, SQL_C_LONG, true)->f_data->get());
+	return column_indicator(find_column(col, SQL_UNKNOWN_TYPE));
 }
 
 
-/** \brief Retrieve a column data as an integer.
+/** \brief Retrieve a column data as a string.
  *
  * This function attempt to retrieve the data of a column
- * as an integer. If the column is not an integer,
- * then an exception is generated.
+ * as a string. If the column is not a string, then an
+ * exception is generated.
  *
- * \param[in] name         The name of the column to retrieve
- * \param[in] integer    The user integer set to the data
+ * \param[in] name    The name of the column to retrieve
+ * \param[in] str     The user string set to the data
  *
- * \exception odbcpp_error
+ * \exception
  * If the column data does not match or is null, this function generates an
  * odbcpp_error exception.
  */
-void dynamic_record::get(const std::string& name, SQLUINTEGER& integer) const
+void dynamic_record::get(const std::string& name, std::string& str) const
 {
-	integer = *reinterpret_cast<SQLUINTEGER *>(find_column(name, SQL_C_ULONG, true)->f_data->get());
+	column_string(find_column(name, SQL_UNKNOWN_TYPE, true), str);
 }
 
 
-/** \brief Retrieve a column data as an integer.
+/** \brief Retrieve a column data as a string.
  *
  * This function attempt to retrieve the data of a column
- * as an integer. If the column is not an integer,
- * then an exception is generated.
+ * as a string. If the column is not a string, then an
+ * exception is generated.
  *
- * \param[in] col        The index of the column to retrieve
- * \param[in] integer    The user integer set to the data
+ * \param[in] col     The index of the column to retrieve
+ * \param[in] str     The user string set to the data
  *
- * \exception odbcpp_error
+ * \exception
  * If the column data does not match or is null, this function generates an
  * odbcpp_error exception.
  */
-void dynamic_record::get(SQLSMALLINT col, SQLUINTEGER& integer) const
+void dynamic_record::get(SQLSMALLINT col, std::string& str) const
 {
-	integer = *reinterpret_cast<SQLUINTEGER *>(find_column(col, SQL_C_ULONG, true)->f_data->get());
+	column_string(find_column(col, SQL_UNKNOWN_TYPE, true), str);
 }
 
 
-/** \brief Retrieve a column data as a big integer.
+/** \brief Retrieve a column data as a string.
  *
- * This function attempt to retrieve the data of a column
- * as a big integer. If the column is not a big integer,
- * then an exception is generated.
+ * This function converts DECIMAL and NUMERIC columns bound as
+ * SQL_NUMERIC_STRUCT or SQLBIGINT to a string. The other columns
+ * must have been bound as strings.
  *
- * \param[in] name       The name of the column to retrieve
- * \param[in] big_int    The user big integer set to the data
+ * \param[in] info   The column to retrieve
+ * \param[out] str   The user string set to the data
  *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * \exception
+ * If the column is not a string or a decimal, this function generates
+ * an odbcpp_error exception.
  */
-void dynamic_record::get(const std::string& name, SQLBIGINT& big_int) const
+void dynamic_record::column_string(const smartptr<bind_info_t>& info, std::string& str) const
 {
-	big_int = *reinterpret_cast<SQLBIGINT *>(find_column(name, SQL_C_SBIGINT, true)->f_data->get());
+	switch(info->f_target_type) {
+	case SQL_DECIMAL:
+	case SQL_NUMERIC:
+		if(info->f_bind_type == SQL_C_NUMERIC) {
+			numeric_to_string(*reinterpret_cast<const SQL_NUMERIC_STRUCT *>(column_data(info)), str);
+			return;
+		}
+		if(info->f_bind_type == SQL_C_SBIGINT) {
+			SQL_NUMERIC_STRUCT numeric;
+			int64_to_numeric(*reinterpret_cast<const SQLBIGINT *>(column_data(info)), 0, numeric);
+			numeric_to_string(numeric, str);
+			return;
+		}
+		break;
+
+	}
+	const char *data = column_data(verify_column(info, SQL_C_CHAR, true));
+	// the indicator is the length unless the data was truncated
+	// (the terminator is searched within the buffer since the data
+	// of a snapshot file may not be terminated)
+	const SQLLEN length = column_indicator(info);
+	if(length >= 0 && static_cast<SQLULEN>(length) < info->f_size) {
+		str.assign(data, length);
+	}
+	else {
+		const char *end = static_cast<const char *>(memchr(data, '\0', info->f_size));
+		str.assign(data, end == NULL ? info->f_size : end - data);
+	}
 }
 
 
-/** \brief Retrieve a column data as a big integer.
+/** \brief Retrieve a column data as a string.
  *
  * This function attempt to retrieve the data of a column
- * as a big integer. If the column is not a big integer,
- * then an exception is generated.
+ * as a string. If the column is not a string, then an
+ * exception is generated.
  *
- * \param[in] col        The index of the column to retrieve
- * \param[in] big_int    The user big integer set to the data
+ * \param[in] name    The name of the column to retrieve
+ * \param[in] str     The user string set to the data
  *
- * \exception odbcpp_error
+ * \exception
  * If the column data does not match or is null, this function generates an
  * odbcpp_error exception.
  */
-void dynamic_record::get(SQLSMALLINT col, SQLBIGINT& big_int) const
+void dynamic_record::get(const std::string& name, std::wstring& str) const
 {
-	big_int = *reinterpret_cast<SQLBIGINT *>(find_column(col, SQL_C_SBIGINT, true)->f_data->get());
+	const SQLWCHAR *s = reinterpret_cast<const SQLWCHAR *>(column_data(find_column(name, SQL_C_WCHAR, true)));
+	str.clear();
+	while(*s != '\0') {
+		str += static_cast<wchar_t>(*s++);
+	}
 }
 
 
-/** \brief Retrieve a column data as a big integer.
+/** \brief Retrieve a column data as a string.
  *
  * This function attempt to retrieve the data of a column
- * as a big integer. If the column is not a big integer,
- * then an exception is generated.
+ * as a string. If the column is not a string, then an
+ * exception is generated.
  *
- * \param[in] name       The name of the column to retrieve
- * \param[in] big_int    The user big integer set to the data
+ * \param[in] col     The index of the column to retrieve
+ * \param[in] str     The user string set to the data
  *
- * \exception odbcpp_error
+ * \exception
  * If the column data does not match or is null, this function generates an
  * odbcpp_error exception.
  */
-void dynamic_record::get(const std::string& name, SQLUBIGINT& big_int) const
+void dynamic_record::get(SQLSMALLINT col, std::wstring& str) const
 {
-	big_int = *reinterpret_cast<SQLUBIGINT *>(find_column(name, SQL_C_UBIGINT, true)->f_data->get());
+	const SQLWCHAR *s = reinterpret_cast<const SQLWCHAR *>(column_data(find_column(col, SQL_C_WCHAR, true)));
+	str.clear();
+	while(*s != '\0') {
+		str += static_cast<wchar_t>(*s++);
+	}
 }
 
 
-/** \brief Retrieve a column data as a big integer.
+/** \fn dynamic_record::get(const std::string& name, T& value) const
  *
- * This function attempt to retrieve the data of a column
- * as a big integer. If the column is not a big integer,
- * then an exception is generated.
+ * \brief Retrieve a column data as a value of type T.
  *
- * \param[in] col        The index of the column to retrieve
- * \param[in] big_int    The user big integer set to the data
+ * This function retrieves the data of a column as any type with
+ * sql_traits: the integers, the floating points, the date, time,
+ * timestamp, numeric and guid structures, bool, the
+ * std::chrono::system_clock time points and, in C++17,
+ * std::optional<T> and std::string_view. Your own types can be
+ * added by specializing sql_traits.
+ *
+ * The column must have been bound with the C type of T, i.e. an
+ * INTEGER column is read in an SQLINTEGER.
+ *
+ * A std::string_view points to the buffer of the record, it is valid
+ * until the next fetch.
+ *
+ * \param[in] name    The name of the column to retrieve
+ * \param[out] value  The variable set to the data
  *
  * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * If the column does not exist, the type does not match or the data
+ * is null (except with a std::optional<T>), this function generates
+ * an odbcpp_error exception.
  */
-void dynamic_record::get(SQLSMALLINT col, SQLUBIGINT& big_int) const
-{
-	big_int = *reinterpret_cast<SQLUBIGINT *>(find_column(col, SQL_C_UBIGINT, true)->f_data->get());
-}
-
 
-/** \brief Retrieve a column data as a real number.
+/** \fn dynamic_record::get(SQLSMALLINT col, T& value) const
  *
- * This function attempt to retrieve the data of a column
- * as a real number. If the column is not a real number,
- * then an exception is generated.
+ * \brief Retrieve a column data as a value of type T.
  *
- * \param[in] name        The name of the column to retrieve
- * \param[in] real       The user real number set to the data
+ * See the get() function using the column name.
+ *
+ * \param[in] col     The index of the column to retrieve
+ * \param[out] value  The variable set to the data
  *
  * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * If the column does not exist, the type does not match or the data
+ * is null, this function generates an odbcpp_error exception.
  */
-void dynamic_record::get(const std::string& name, SQLREAL& real) const
-{
-	real = *reinterpret_cast<SQLREAL *>(find_column(name, SQL_C_FLOAT, true)->f_data->get());
-}
 
-
-/** \brief Retrieve a column data as a real number.
+/** \fn dynamic_record::get(const std::string& name) const
  *
- * This function attempt to retrieve the data of a column
- * as a real number. If the column is not a real number,
- * then an exception is generated.
+ * \brief Retrieve a column data as a value of type T.
  *
- * \param[in] col        The index of the column to retrieve
- * \param[in] real       The user real number set to the data
+ * The type has to be specified:
+ *
+ * \code
+ * std::optional<SQLINTEGER> quantity(rec.get<std::optional<SQLINTEGER> >("quantity"));
+ * \endcode
+ *
+ * \param[in] name   The name of the column to retrieve
+ *
+ * \return The data of the column.
  *
  * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * If the column does not exist, the type does not match or the data
+ * is null (except with a std::optional<T>), this function generates
+ * an odbcpp_error exception.
  */
-void dynamic_record::get(SQLSMALLINT col, SQLREAL& real) const
-{
-	real = *reinterpret_cast<SQLREAL *>(find_column(col, SQL_C_FLOAT, true)->f_data->get());
-}
 
-
-/** \brief Retrieve a column data as a float number.
+/** \fn dynamic_record::get(SQLSMALLINT col) const
  *
- * This function attempt to retrieve the data of a column
- * as a float number. If the column is not a float number,
- * then an exception is generated.
+ * \brief Retrieve a column data as a value of type T.
  *
- * \param[in] name        The name of the column to retrieve
- * \param[in] dbl        The user float number set to the data
+ * See the get() function using the column name.
+ *
+ * \param[in] col   The index of the column to retrieve
+ *
+ * \return The data of the column.
  *
  * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * If the column does not exist, the type does not match or the data
+ * is null, this function generates an odbcpp_error exception.
  */
-void dynamic_record::get(const std::string& name, SQLFLOAT& dbl) const
-{
-	dbl = *reinterpret_cast<SQLFLOAT *>(find_column(name, SQL_C_DOUBLE, true)->f_data->get());
-}
-
 
-/** \brief Retrieve a column data as a float number.
+/** \fn dynamic_record::column_buffer(const smartptr<bind_info_t>& info) const
  *
- * This function attempt to retrieve the data of a column
- * as a float number. If the column is not a float number,
- * then an exception is generated.
+ * \brief Describe the buffer of a column for sql_traits::read().
  *
- * \param[in] col        The index of the column to retrieve
- * \param[in] dbl        The user float number set to the data
+ * \param[in] info   The column
  *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * \return The buffer of the column at the current row.
  */
-void dynamic_record::get(SQLSMALLINT col, SQLFLOAT& dbl) const
-{
-	dbl = *reinterpret_cast<SQLFLOAT *>(find_column(col, SQL_C_DOUBLE, true)->f_data->get());
-}
 
 
 /** \brief Retrieve a column data as a binary buffer.
@@ -2636,9 +2625,16 @@ SQLULEN dynamic_record::get(const std::string& name, SQLCHAR *binary, SQLLEN len
 
 	const smartptr<bind_info_t>& info = find_column(name, SQL_UNKNOWN_TYPE, true);
 
-	SQLLEN size = static_cast<SQLUINTEGER>(length) < info->f_fetch_size ? length : info->f_size;
+	SQLLEN size = column_indicator(info);
+	if(size < 0 || static_cast<SQLULEN>(size) > info->f_stride) {
+		// SQL_NO_TOTAL or truncated data
+		size = info->f_stride;
+	}
+	if(length < size) {
+		size = length;
+	}
 
-	memcpy(binary, info->f_data->get(), size);
+	memcpy(binary, column_data(info), size);
 
 	return size;
 }
@@ -2678,201 +2674,331 @@ SQLULEN dynamic_record::get(SQLSMALLINT col, SQLCHAR *binary, SQLLEN length) con
 
 	const smartptr<bind_info_t>& info = find_column(col, SQL_UNKNOWN_TYPE, true);
 
-	SQLLEN size = static_cast<SQLUINTEGER>(length) < info->f_fetch_size ? length : info->f_size;
+	SQLLEN size = column_indicator(info);
+	if(size < 0 || static_cast<SQLULEN>(size) > info->f_stride) {
+		// SQL_NO_TOTAL or truncated data
+		size = info->f_stride;
+	}
+	if(length < size) {
+		size = length;
+	}
 
-	memcpy(binary, info->f_data->get(), size);
+	memcpy(binary, column_data(info), size);
 
 	return size;
 }
 
 
-/** \brief Retrieve a column data as a date structure.
+/** \fn dynamic_record::try_get(const std::string& name, T& value) const
  *
- * This function attempt to retrieve the data of a column
- * as a date structure. If the column is not a date structure,
- * then an exception is generated.
+ * \brief Retrieve a column data without throwing.
  *
- * \param[in] name        The name of the column to retrieve
- * \param[in] date        The user date structure set to the data
+ * This function is the same as get() except that errors are returned
+ * instead of thrown. In loops over columns that can be NULL, testing
+ * the returned code is much faster than catching an exception:
+ *
+ * \code
+ * SQLINTEGER quantity;
+ * if(rec.try_get("quantity", quantity) == odbcpp_error::ODBCPP_NO_DATA) {
+ *     quantity = 0;	// NULL
+ * }
+ * \endcode
+ *
+ * All the types supported by get() can be used except wide strings
+ * and binary buffers.
+ *
+ * \param[in] name     The name of the column to retrieve
+ * \param[out] value   The variable set to the data, unchanged on errors
+ *
+ * \return ODBCPP_NONE, or ODBCPP_NO_DATA if the column is NULL,
+ *         ODBCPP_NOT_FOUND if it does not exist, ODBCPP_TYPE_MISMATCH
+ *         if it has another type.
+ */
+
+/** \fn dynamic_record::try_get(SQLSMALLINT col, T& value) const
+ *
+ * \brief Retrieve a column data without throwing.
+ *
+ * See the try_get() function using the column name.
+ *
+ * \param[in] col      The index of the column to retrieve
+ * \param[out] value   The variable set to the data, unchanged on errors
+ *
+ * \return ODBCPP_NONE, or ODBCPP_NO_DATA if the column is NULL,
+ *         ODBCPP_NOT_FOUND if it does not exist, ODBCPP_TYPE_MISMATCH
+ *         if it has another type.
+ */
+
+/** \fn dynamic_record::try_get(const std::string& name) const
+ *
+ * \brief Retrieve a column that can be NULL.
+ *
+ * This function returns an empty std::optional if the column is NULL.
+ * Since the other errors are mistakes in the program, these are
+ * still thrown.
+ *
+ * \code
+ * std::optional<SQLINTEGER> quantity(rec.try_get<SQLINTEGER>("quantity"));
+ * \endcode
+ *
+ * This function requires a C++17 compiler.
+ *
+ * \param[in] name   The name of the column to retrieve
+ *
+ * \return The data or an empty std::optional if the column is NULL.
  *
  * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * If the column does not exist or has another type, this function
+ * generates an odbcpp_error exception.
+ */
+
+/** \fn dynamic_record::try_get(SQLSMALLINT col) const
+ *
+ * \brief Retrieve a column that can be NULL.
+ *
+ * See the try_get() function using the column name.
+ *
+ * \param[in] col   The index of the column to retrieve
+ *
+ * \return The data or an empty std::optional if the column is NULL.
+ *
+ * \exception odbcpp_error
+ * If the column does not exist or has another type, this function
+ * generates an odbcpp_error exception.
+ */
+
+
+/** \brief Retrieve a column data as a string without throwing.
+ *
+ * This function is the same as get() except that errors are returned
+ * instead of thrown.
+ *
+ * \param[in] name   The name of the column to retrieve
+ * \param[out] str   The user string set to the data, unchanged on errors
+ *
+ * \return ODBCPP_NONE, or ODBCPP_NO_DATA if the column is NULL,
+ *         ODBCPP_NOT_FOUND if it does not exist, ODBCPP_TYPE_MISMATCH
+ *         if it is not a string or a decimal.
  */
-void dynamic_record::get(const std::string& name, SQL_DATE_STRUCT& date) const
+SQLINTEGER dynamic_record::try_get(const std::string& name, std::string& str) const
 {
-	date = *reinterpret_cast<SQL_DATE_STRUCT *>(find_column(name, SQL_C_DATE, true)->f_data->get());
+	SQLINTEGER code;
+	const smartptr<bind_info_t> *info = try_find_column(name, SQL_UNKNOWN_TYPE, code);
+	return info == NULL ? code : try_column_string(*info, str);
 }
 
 
-/** \brief Retrieve a column data as a date structure.
+/** \brief Retrieve a column data as a string without throwing.
  *
- * This function attempt to retrieve the data of a column
- * as a date structure. If the column is not a date structure,
- * then an exception is generated.
+ * This function is the same as get() except that errors are returned
+ * instead of thrown.
  *
- * \param[in] col         The index of the column to retrieve
- * \param[in] date        The user date structure set to the data
+ * \param[in] col    The index of the column to retrieve
+ * \param[out] str   The user string set to the data, unchanged on errors
  *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * \return ODBCPP_NONE, or ODBCPP_NO_DATA if the column is NULL,
+ *         ODBCPP_NOT_FOUND if it does not exist, ODBCPP_TYPE_MISMATCH
+ *         if it is not a string or a decimal.
  */
-void dynamic_record::get(SQLSMALLINT col, SQL_DATE_STRUCT& date) const
+SQLINTEGER dynamic_record::try_get(SQLSMALLINT col, std::string& str) const
 {
-	date = *reinterpret_cast<SQL_DATE_STRUCT *>(find_column(col, SQL_C_DATE, true)->f_data->get());
+	SQLINTEGER code;
+	const smartptr<bind_info_t> *info = try_find_column(col, SQL_UNKNOWN_TYPE, code);
+	return info == NULL ? code : try_column_string(*info, str);
 }
 
 
-/** \brief Retrieve a column data as a time structure.
+/** \brief Retrieve a column data as a string without throwing.
  *
- * This function attempt to retrieve the data of a column
- * as a time structure. If the column is not a time structure,
- * then an exception is generated.
+ * This function checks that column_string() accepts the column
+ * before calling it.
  *
- * \param[in] name        The name of the column to retrieve
- * \param[in] time        The user time structure set to the data
+ * \param[in] info   The column to retrieve, not NULL
+ * \param[out] str   The user string set to the data
  *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * \return ODBCPP_NONE or ODBCPP_TYPE_MISMATCH.
  */
-void dynamic_record::get(const std::string& name, SQL_TIME_STRUCT& time) const
+SQLINTEGER dynamic_record::try_column_string(const smartptr<bind_info_t>& info, std::string& str) const
 {
-	time = *reinterpret_cast<SQL_TIME_STRUCT *>(find_column(name, SQL_C_TIME, true)->f_data->get());
+	const bool is_decimal = (info->f_target_type == SQL_DECIMAL || info->f_target_type == SQL_NUMERIC)
+			&& (info->f_bind_type == SQL_C_NUMERIC || info->f_bind_type == SQL_C_SBIGINT);
+	if(!is_decimal) {
+		SQLINTEGER code = check_column(info, SQL_C_CHAR, false);
+		if(code != odbcpp_error::ODBCPP_NONE) {
+			return code;
+		}
+	}
+	column_string(info, str);
+	return odbcpp_error::ODBCPP_NONE;
 }
 
 
-/** \brief Retrieve a column data as a time structure.
+/** \brief Retrieve all the rows of a date or timestamp column.
  *
- * This function attempt to retrieve the data of a column
- * as a time structure. If the column is not a time structure,
- * then an exception is generated.
+ * This function converts the date or timestamp of each row read by
+ * the last fetch to a number of nanoseconds since 1970-01-01 in
+ * \p ns. Dates are converted to midnight. The rows that are NULL
+ * are set to \p null_value.
  *
- * \param[in] col         The index of the column to retrieve
- * \param[in] time        The user time structure set to the data
+ * The \p ns array must have room for get_rowset_size() items.
+ * This is much faster than calling set_row() and get() for each
+ * row of a large rowset.
  *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * \param[in] name         The name of the column to retrieve
+ * \param[out] ns          The array receiving the nanoseconds
+ * \param[in] null_value   The value saved for NULL rows
+ *
+ * \return The number of rows saved in \p ns, i.e. rows_fetched().
+ *
+ * \exception
+ * If the column is not a date or a timestamp, this function generates
+ * an odbcpp_error exception.
+ *
+ * \sa timestamps_to_epoch_ns()
  */
-void dynamic_record::get(SQLSMALLINT col, SQL_TIME_STRUCT& time) const
+SQLULEN dynamic_record::get_epoch_ns(const std::string& name, SQLBIGINT *ns, SQLBIGINT null_value) const
 {
-	time = *reinterpret_cast<SQL_TIME_STRUCT *>(find_column(col, SQL_C_TIME, true)->f_data->get());
+	return column_epoch_ns(find_column(name, SQL_UNKNOWN_TYPE), ns, null_value);
 }
 
 
-/** \brief Retrieve a column data as a timestamp structure.
+/** \brief Retrieve all the rows of a date or timestamp column.
  *
- * This function attempt to retrieve the data of a column
- * as a timestamp structure. If the column is not a timestamp structure,
- * then an exception is generated.
+ * This function converts the date or timestamp of each row read by
+ * the last fetch to a number of nanoseconds since 1970-01-01 in
+ * \p ns. Dates are converted to midnight. The rows that are NULL
+ * are set to \p null_value.
  *
- * \param[in] name        The name of the column to retrieve
- * \param[in] timestamp   The user timestamp structure set to the data
+ * \param[in] col          The index of the column to retrieve
+ * \param[out] ns          The array receiving the nanoseconds
+ * \param[in] null_value   The value saved for NULL rows
  *
- * \exception odbcpp_error
- * If the column data does not match, this function generates an
- * odbcpp_error exception.
+ * \return The number of rows saved in \p ns, i.e. rows_fetched().
+ *
+ * \exception
+ * If the column is not a date or a timestamp, this function generates
+ * an odbcpp_error exception.
+ *
+ * \sa timestamps_to_epoch_ns()
  */
-void dynamic_record::get(const std::string& name, SQL_TIMESTAMP_STRUCT& timestamp) const
+SQLULEN dynamic_record::get_epoch_ns(SQLSMALLINT col, SQLBIGINT *ns, SQLBIGINT null_value) const
 {
-	timestamp = *reinterpret_cast<SQL_TIMESTAMP_STRUCT *>(find_column(name, SQL_C_TIMESTAMP, true)->f_data->get());
+	return column_epoch_ns(find_column(col, SQL_UNKNOWN_TYPE), ns, null_value);
 }
 
 
-/** \brief Retrieve a column data as a timestamp structure.
+/** \brief Retrieve the NULL state of all the rows of a column.
  *
- * This function attempt to retrieve the data of a column
- * as a timestamp structure. If the column is not a timestamp structure,
- * then an exception is generated.
+ * This function builds the validity bitmap of the named column for
+ * the rows read by the last fetch.
  *
- * \param[in] col         The index of the column to retrieve
- * \param[in] timestamp   The user timestamp structure set to the data
+ * \param[in] name     The name of the column
+ * \param[out] bitmap  The bitmap receiving the NULL state of each row
  *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * \sa validity_bitmap::assign()
  */
-void dynamic_record::get(SQLSMALLINT col, SQL_TIMESTAMP_STRUCT& timestamp) const
+void dynamic_record::get_validity(const std::string& name, validity_bitmap& bitmap) const
 {
-	timestamp = *reinterpret_cast<SQL_TIMESTAMP_STRUCT *>(find_column(col, SQL_C_TIMESTAMP, true)->f_data->get());
+	bitmap.assign(find_column(name, SQL_UNKNOWN_TYPE)->f_indicator, rows_fetched());
 }
 
 
-/** \brief Retrieve a column data as a numeric structure.
+/** \brief Retrieve the NULL state of all the rows of a column.
  *
- * This function attempt to retrieve the data of a column
- * as a numeric structure. If the column is not a numeric structure,
- * then an exception is generated.
+ * This function builds the validity bitmap of the specified column
+ * for the rows read by the last fetch.
  *
- * \param[in] name        The name of the column to retrieve
- * \param[in] numeric     The user numeric structure set to the data
+ * \param[in] col      The index of the column
+ * \param[out] bitmap  The bitmap receiving the NULL state of each row
  *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * \sa validity_bitmap::assign()
  */
-void dynamic_record::get(const std::string& name, SQL_NUMERIC_STRUCT& numeric) const
+void dynamic_record::get_validity(SQLSMALLINT col, validity_bitmap& bitmap) const
 {
-	numeric = *reinterpret_cast<SQL_NUMERIC_STRUCT *>(find_column(name, SQL_C_NUMERIC, true)->f_data->get());
+	bitmap.assign(find_column(col, SQL_UNKNOWN_TYPE)->f_indicator, rows_fetched());
 }
 
 
-/** \brief Retrieve a column data as a numeric structure.
+/** \brief Count the NULL rows of a column.
  *
- * This function attempt to retrieve the data of a column
- * as a numeric structure. If the column is not a numeric structure,
- * then an exception is generated.
+ * This function counts the rows of the named column that are NULL
+ * in the rowset read by the last fetch.
  *
- * \param[in] col         The index of the column to retrieve
- * \param[in] numeric     The user numeric structure set to the data
+ * \param[in] name   The name of the column
  *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * \return The number of NULL rows.
  */
-void dynamic_record::get(SQLSMALLINT col, SQL_NUMERIC_STRUCT& numeric) const
+SQLULEN dynamic_record::get_null_count(const std::string& name) const
 {
-	numeric = *reinterpret_cast<SQL_NUMERIC_STRUCT *>(find_column(col, SQL_C_NUMERIC, true)->f_data->get());
+	return count_nulls(find_column(name, SQL_UNKNOWN_TYPE)->f_indicator, rows_fetched());
 }
 
 
-/** \brief Retrieve a column data as a guid structure.
+/** \brief Count the NULL rows of a column.
  *
- * This function attempt to retrieve the data of a column
- * as a guid structure. If the column is not a guid structure,
- * then an exception is generated.
+ * This function counts the rows of the specified column that are
+ * NULL in the rowset read by the last fetch.
  *
- * \param[in] name        The name of the column to retrieve
- * \param[in] guid        The user guid structure set to the data
+ * \param[in] col   The index of the column
  *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * \return The number of NULL rows.
  */
-void dynamic_record::get(const std::string& name, SQLGUID& guid) const
+SQLULEN dynamic_record::get_null_count(SQLSMALLINT col) const
 {
-	guid = *reinterpret_cast<SQLGUID *>(find_column(name, SQL_C_GUID, true)->f_data->get());
+	return count_nulls(find_column(col, SQL_UNKNOWN_TYPE)->f_indicator, rows_fetched());
 }
 
 
-/** \brief Retrieve a column data as a guid structure.
+/** \brief Convert all the rows of a date or timestamp column.
  *
- * This function attempt to retrieve the data of a column
- * as a guid structure. If the column is not a guid structure,
- * then an exception is generated.
+ * The column is bound as an array of structures so the whole
+ * column is converted with one call to the batch functions.
  *
- * \param[in] col         The index of the column to retrieve
- * \param[in] guid        The user guid structure set to the data
+ * \param[in] info         The column to convert
+ * \param[out] ns          The array receiving the nanoseconds
+ * \param[in] null_value   The value saved for NULL rows
  *
- * \exception odbcpp_error
- * If the column data does not match or is null, this function generates an
- * odbcpp_error exception.
+ * \return The number of rows saved in \p ns.
  */
-void dynamic_record::get(SQLSMALLINT col, SQLGUID& guid) const
+SQLULEN dynamic_record::column_epoch_ns(const smartptr<bind_info_t>& info, SQLBIGINT *ns, SQLBIGINT null_value) const
 {
-	guid = *reinterpret_cast<SQLGUID *>(find_column(col, SQL_C_GUID, true)->f_data->get());
+	const SQLULEN count = rows_fetched();
+	switch(info->f_bind_type) {
+	case SQL_C_TIMESTAMP:
+	case SQL_C_TYPE_TIMESTAMP:
+		timestamps_to_epoch_ns(reinterpret_cast<const SQL_TIMESTAMP_STRUCT *>(info->f_data), info->f_indicator, count, ns, null_value);
+		return count;
+
+	case SQL_C_DATE:
+	case SQL_C_TYPE_DATE:
+	{
+		// convert the days with the batch kernel by blocks small enough
+		// to stay in the stack, then scale them to nanoseconds
+		const SQL_DATE_STRUCT *dates = reinterpret_cast<const SQL_DATE_STRUCT *>(info->f_data);
+		SQLINTEGER days[256];
+		for(SQLULEN start = 0; start < count; start += 256) {
+			const SQLULEN max = count - start < 256 ? count - start : 256;
+			const SQLLEN *indicators = info->f_indicator + start;
+			dates_to_epoch_days(dates + start, indicators, max, days);
+			SQLBIGINT *out = ns + start;
+			for(SQLULEN idx = 0; idx < max; ++idx) {
+				const SQLBIGINT value = static_cast<SQLBIGINT>(days[idx]) * (86400LL * 1000000000LL);
+				out[idx] = indicators[idx] == SQL_NULL_DATA ? null_value : value;
+			}
+		}
+		return count;
+	}
+
+	default:
+	{
+		std::ostringstream err;
+		err << "type mismatch for column \"" + f_schema->name(info->f_col) + "\"";
+		err << " (expected " << info->f_bind_type << ", requested a date or a timestamp)";
+		diagnostic d(odbcpp_error::ODBCPP_TYPE_MISMATCH, err.str());
+		throw odbcpp_error(d);
+	}
+
+	}
 }
 
 
@@ -2902,15 +3028,6 @@ void dynamic_record::get(SQLSMALLINT col, SQLGUID& guid) const
  * proper defaults so it can be used in all cases.
  */
 
-/** \var dynamic_record::bind_info_t::f_name
- *
- * \brief The name of the column when available.
- *
- * This variable is set to the name of the column the dynamic record
- * was bound to whenever the system could give us that name.
- */
-
-
 /** \var dynamic_record::bind_info_t::f_col
  *
  * \brief The column number of this bind information.
@@ -2950,12 +3067,28 @@ void dynamic_record::get(SQLSMALLINT col, SQLGUID& guid) const
  *
  * \brief The data buffer where the variable will be loaded.
  *
- * In the dynamic record, the data buffer is always dynamically
- * allocated. The smart pointer and the buffer class automatically
- * handle the memory buffer allocation and deallocation.
+ * In the dynamic record, the data buffer is always part of the
+ * record arena. It is released with the arena.
  */
 
 
+/** \var dynamic_record::bind_info_t::f_column_size
+ *
+ * \brief The size of the column as described by the driver.
+ *
+ * This is the size returned by SQLDescribeCol(), in characters for
+ * strings. It is used by rebind() to verify that a result has the
+ * same shape.
+ */
+
+/** \var dynamic_record::bind_info_t::f_stride
+ *
+ * \brief The distance in bytes between two rows of this column.
+ *
+ * This is the size of the C type for fixed types and f_size for
+ * strings and binary data.
+ */
+
 /** \var dynamic_record::bind_info_t::f_size
  *
  * \brief The size of the buffer in bytes.
@@ -2978,12 +3111,14 @@ void dynamic_record::get(SQLSMALLINT col, SQLGUID& guid) const
  * This number can be zero, but it cannot be negative.
  */
 
-/** \var dynamic_record::bind_info_t::f_fetch_size
+/** \var dynamic_record::bind_info_t::f_indicator
  *
  * \brief The number of bytes that the fetch() command copied in this column variable.
  *
- * This variable is used by the statement::fetch() call to save the size of
- * the column in bytes at the time the data is read in our dynamic variable.
+ * This pointer points to the indicator of this column in the record
+ * arena. The statement::fetch() call saves the size of the column in
+ * bytes at the time the data is read in our dynamic variable, or
+ * SQL_NULL_DATA.
  *
  * This should be equal or smaller to the f_size parameter.
  */
@@ -0,0 +1,458 @@
+//
+// File:	src/result_cache.cpp
+// Object:	Implementation of the result cache
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/result_cache.h"
+#include	<cctype>
+
+
+namespace odbcpp
+{
+
+
+/** \class cached_result_t
+ *
+ * \brief A result saved in a result cache.
+ *
+ * This structure holds the description of the columns and the rows
+ * of a result that was read up to the end. The rows are saved as
+ * images of the bound buffers so a cached result can only be replayed
+ * with the same bindings; the signature is used to verify that.
+ *
+ * Once inserted in a cache, a result is never modified. The statements
+ * replaying it keep a reference so it can safely be removed from the
+ * cache at any time.
+ *
+ * \sa statement::execute_cached()
+ */
+
+
+/** \struct cached_result_t::column_t
+ *
+ * \brief The description of a column as returned by SQLDescribeCol().
+ */
+
+
+/** \brief Append a row to the result.
+ *
+ * \param[in] image   The image of the row
+ */
+void cached_result_t::append(const std::vector<char>& image)
+{
+	f_offsets.push_back(f_data.size());
+	f_data.insert(f_data.end(), image.begin(), image.end());
+}
+
+
+/** \brief Compute the memory used by the result.
+ *
+ * \return An estimate of the number of bytes used by this result.
+ */
+SQLULEN cached_result_t::memory() const
+{
+	SQLULEN total = sizeof(cached_result_t)
+		      + f_data.capacity()
+		      + f_offsets.capacity() * sizeof(SQLULEN)
+		      + f_signature.capacity();
+	for(column_vector_t::const_iterator itr(f_columns.begin()); itr != f_columns.end(); ++itr) {
+		total += sizeof(column_t) + itr->f_name.capacity();
+	}
+	return total;
+}
+
+
+/** \fn cached_result_t::rows() const
+ *
+ * \brief Retrieve the number of rows.
+ *
+ * \return The number of rows of the result.
+ */
+
+/** \fn cached_result_t::row(SQLULEN idx) const
+ *
+ * \brief Retrieve the image of a row.
+ *
+ * \param[in] idx   The row number, starting at 0
+ *
+ * \return A pointer to the image of the row.
+ */
+
+/** \var cached_result_t::f_columns
+ *
+ * \brief The description of all the columns of the result.
+ */
+
+/** \var cached_result_t::f_signature
+ *
+ * \brief The types and sizes of the buffers used to save the rows.
+ */
+
+/** \var cached_result_t::f_data
+ *
+ * \brief The images of all the rows, one after the other.
+ */
+
+/** \var cached_result_t::f_offsets
+ *
+ * \brief The offset of each row image in f_data.
+ */
+
+
+
+
+/** \class result_cache
+ *
+ * \brief A cache of query results.
+ *
+ * Reference tables that rarely change are often read over and over.
+ * A result cache keeps the results of such queries in memory so
+ * statement::execute_cached() can replay them without sending
+ * anything to the database.
+ *
+ * The results are keyed by the SQL order, which includes the values
+ * of the parameters. Each result expires after a time to live. It
+ * can also be tagged with the names of the tables it depends on so
+ * a program modifying a table invalidates all the results depending
+ * on it:
+ *
+ * \code
+ * result_cache cache;
+ * conn.set_result_cache(&cache);
+ * ...
+ * stmt.execute_cached("SELECT * FROM country", "country");
+ * while(stmt.fetch(rec)) ...
+ * ...
+ * stmt.execute("UPDATE country SET ...");
+ * cache.invalidate("country");
+ * \endcode
+ *
+ * When the memory used by the results goes over the memory limit,
+ * the least recently used results are removed.
+ *
+ * The cache can be shared by many connections and threads.
+ *
+ * \sa connection::set_result_cache()
+ */
+
+
+/** \brief Initialize a result cache.
+ *
+ * \param[in] memory_limit   The maximum number of bytes used by the results
+ * \param[in] default_ttl    The time to live of the results in nanoseconds
+ */
+result_cache::result_cache(SQLULEN memory_limit, SQLUBIGINT default_ttl) :
+	//f_mutex -- auto-init
+	f_memory_limit(memory_limit),
+	f_default_ttl(default_ttl)
+	//f_entries -- auto-init
+	//f_tags -- auto-init
+	//f_lru -- auto-init
+	//f_statistics -- auto-init
+{
+}
+
+
+/** \brief Change the memory limit.
+ *
+ * Results are removed as required to fit the new limit.
+ *
+ * \param[in] memory_limit   The maximum number of bytes used by the results
+ */
+void result_cache::set_memory_limit(SQLULEN memory_limit)
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	f_memory_limit = memory_limit;
+	evict();
+}
+
+
+/** \brief Retrieve the memory limit.
+ *
+ * \return The maximum number of bytes used by the results.
+ */
+SQLULEN result_cache::get_memory_limit() const
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	return f_memory_limit;
+}
+
+
+/** \brief Change the default time to live.
+ *
+ * The results already in the cache keep their time to live.
+ *
+ * \param[in] ttl   The time to live in nanoseconds
+ */
+void result_cache::set_default_ttl(SQLUBIGINT ttl)
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	f_default_ttl = ttl;
+}
+
+
+/** \brief Retrieve the default time to live.
+ *
+ * \return The time to live of the results in nanoseconds.
+ */
+SQLUBIGINT result_cache::get_default_ttl() const
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	return f_default_ttl;
+}
+
+
+/** \brief Search a result.
+ *
+ * This function returns the result saved with \p key if it did not
+ * expire yet. Expired results are removed.
+ *
+ * \param[in] key   The key of the result, usually the SQL order
+ *
+ * \return The result or a null pointer.
+ */
+result_cache::result_pointer_t result_cache::find(const std::string& key)
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+
+	entry_map_t::iterator itr(f_entries.find(key));
+	if(itr == f_entries.end()) {
+		++f_statistics.f_misses;
+		return result_pointer_t();
+	}
+	if(itr->second.f_expires <= stopwatch::now()) {
+		++f_statistics.f_misses;
+		++f_statistics.f_expired;
+		erase(itr);
+		return result_pointer_t();
+	}
+
+	++f_statistics.f_hits;
+	f_lru.splice(f_lru.begin(), f_lru, itr->second.f_lru);
+	return itr->second.f_result;
+}
+
+
+/** \brief Save a result.
+ *
+ * This function saves \p result under \p key, replacing the previous
+ * result with the same key. Results larger than the memory limit are
+ * ignored.
+ *
+ * \p tags is a list of names separated by commas. A call to
+ * invalidate() with one of these names removes the result.
+ *
+ * \param[in] key      The key of the result, usually the SQL order
+ * \param[in] result   The result to save
+ * \param[in] tags     The names of the tables the result depends on
+ * \param[in] ttl      The time to live in nanoseconds, 0 for the default
+ */
+void result_cache::insert(const std::string& key, const result_pointer_t& result, const std::string& tags, SQLUBIGINT ttl)
+{
+	const SQLULEN memory = result->memory() + key.capacity();
+
+	std::lock_guard<std::mutex> lock(f_mutex);
+
+	entry_map_t::iterator itr(f_entries.find(key));
+	if(itr != f_entries.end()) {
+		erase(itr);
+	}
+	if(memory > f_memory_limit) {
+		return;
+	}
+
+	entry_t& entry(f_entries[key]);
+	entry.f_result = result;
+	entry.f_expires = stopwatch::now() + (ttl == 0 ? f_default_ttl : ttl);
+	entry.f_memory = memory;
+	std::string::size_type pos = 0;
+	while(pos < tags.length()) {
+		std::string::size_type end = tags.find(',', pos);
+		if(end == std::string::npos) {
+			end = tags.length();
+		}
+		std::string::size_type start = pos;
+		while(start < end && isspace(static_cast<unsigned char>(tags[start]))) {
+			++start;
+		}
+		std::string::size_type tag_end = end;
+		while(tag_end > start && isspace(static_cast<unsigned char>(tags[tag_end - 1]))) {
+			--tag_end;
+		}
+		if(tag_end > start) {
+			std::string tag(tags, start, tag_end - start);
+			entry.f_tags.push_back(tag);
+			f_tags.insert(tag_map_t::value_type(tag, key));
+		}
+		pos = end + 1;
+	}
+	f_lru.push_front(key);
+	entry.f_lru = f_lru.begin();
+
+	++f_statistics.f_insertions;
+	++f_statistics.f_entries;
+	f_statistics.f_memory += memory;
+	evict();
+}
+
+
+/** \brief Remove the results depending on a table.
+ *
+ * This function removes all the results that were inserted with
+ * \p tag in their list of tags.
+ *
+ * \param[in] tag   The name of the table that changed
+ */
+void result_cache::invalidate(const std::string& tag)
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+
+	std::pair<tag_map_t::iterator, tag_map_t::iterator> range(f_tags.equal_range(tag));
+	std::vector<std::string> keys;
+	for(tag_map_t::iterator itr(range.first); itr != range.second; ++itr) {
+		keys.push_back(itr->second);
+	}
+	for(std::vector<std::string>::const_iterator key(keys.begin()); key != keys.end(); ++key) {
+		entry_map_t::iterator itr(f_entries.find(*key));
+		if(itr != f_entries.end()) {
+			++f_statistics.f_invalidations;
+			erase(itr);
+		}
+	}
+}
+
+
+/** \brief Remove all the results.
+ */
+void result_cache::clear()
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+
+	f_entries.clear();
+	f_tags.clear();
+	f_lru.clear();
+	f_statistics.f_entries = 0;
+	f_statistics.f_memory = 0;
+}
+
+
+/** \brief Retrieve a snapshot of the cache statistics.
+ *
+ * \return A copy of the statistics.
+ */
+cache_statistics_t result_cache::get_statistics() const
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	return f_statistics;
+}
+
+
+/** \brief Reset the cache statistics.
+ *
+ * The results are kept.
+ */
+void result_cache::reset_statistics()
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	f_statistics.reset();
+}
+
+
+/** \brief Remove an entry.
+ *
+ * The caller must hold the mutex.
+ *
+ * \param[in] itr   The entry to remove
+ */
+void result_cache::erase(entry_map_t::iterator itr)
+{
+	const entry_t& entry(itr->second);
+	for(std::vector<std::string>::const_iterator tag(entry.f_tags.begin()); tag != entry.f_tags.end(); ++tag) {
+		std::pair<tag_map_t::iterator, tag_map_t::iterator> range(f_tags.equal_range(*tag));
+		for(tag_map_t::iterator t(range.first); t != range.second; ++t) {
+			if(t->second == itr->first) {
+				f_tags.erase(t);
+				break;
+			}
+		}
+	}
+	f_lru.erase(entry.f_lru);
+	--f_statistics.f_entries;
+	f_statistics.f_memory -= entry.f_memory;
+	f_entries.erase(itr);
+}
+
+
+/** \brief Remove the least recently used entries.
+ *
+ * This function removes entries until the memory used is under the
+ * memory limit. The caller must hold the mutex.
+ */
+void result_cache::evict()
+{
+	while(f_statistics.f_memory > f_memory_limit && !f_lru.empty()) {
+		++f_statistics.f_evictions;
+		erase(f_entries.find(f_lru.back()));
+	}
+}
+
+
+/** \var result_cache::f_mutex
+ *
+ * \brief The mutex protecting all the other members.
+ */
+
+/** \var result_cache::f_memory_limit
+ *
+ * \brief The maximum number of bytes used by the results.
+ */
+
+/** \var result_cache::f_default_ttl
+ *
+ * \brief The time to live used when insert() is called with 0.
+ */
+
+/** \var result_cache::f_entries
+ *
+ * \brief The results by key.
+ */
+
+/** \var result_cache::f_tags
+ *
+ * \brief The keys of the results by tag.
+ */
+
+/** \var result_cache::f_lru
+ *
+ * \brief The keys of the results, the most recently used first.
+ */
+
+/** \var result_cache::f_statistics
+ *
+ * \brief The counters of the cache.
+ *
+ * The f_entries and f_memory fields are kept up to date.
+ */
+
+
+
+}	// namespace odbcpp
+
@@ -0,0 +1,466 @@
+//
+// File:	src/result_schema.cpp
+// Object:	Implementation of the shared result schema
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/result_schema.h"
+#include	<string.h>
+#include	<map>
+#include	<mutex>
+#include	<set>
+
+
+namespace odbcpp
+{
+
+
+namespace
+{
+
+/** \brief The schemas in use.
+ *
+ * The schemas are found by the hash of their columns. The entries
+ * are removed when the last record using a schema releases it.
+ */
+struct schema_registry_t {
+	std::mutex						f_mutex;
+	std::multimap<size_t, std::weak_ptr<const result_schema> >	f_schemas;
+};
+
+
+/** \brief Retrieve the registry of the schemas.
+ *
+ * The registry is never destroyed so records destroyed at exit can
+ * still release their schema.
+ *
+ * \return The registry of the schemas.
+ */
+schema_registry_t& schema_registry()
+{
+	static schema_registry_t *r = new schema_registry_t;
+	return *r;
+}
+
+
+/** \brief The interned column names.
+ *
+ * The strings of a set do not move so the schemas keep pointers to
+ * them. The names are never freed; a program only uses a limited
+ * number of column names.
+ */
+struct name_pool_t {
+	std::mutex			f_mutex;
+	std::set<std::string>		f_names;
+};
+
+
+/** \brief Retrieve the pool of the interned names.
+ *
+ * \return The pool of the interned names.
+ */
+name_pool_t& name_pool()
+{
+	static name_pool_t *p = new name_pool_t;
+	return *p;
+}
+
+}	// no name namespace
+
+
+
+/** \brief Remove a schema from the registry once released.
+ *
+ * This functor is the deleter of the shared pointers returned by
+ * result_schema::get().
+ */
+class result_schema::release_t
+{
+public:
+	void			operator () (const result_schema *schema) const;
+};
+
+
+/** \brief Delete a schema.
+ *
+ * The registry entries of the schemas that are not used anymore are
+ * removed, then the schema is deleted.
+ *
+ * \param[in] schema   The schema to delete
+ */
+void result_schema::release_t::operator () (const result_schema *schema) const
+{
+	{
+		schema_registry_t& r(schema_registry());
+		std::lock_guard<std::mutex> lock(r.f_mutex);
+		std::multimap<size_t, std::weak_ptr<const result_schema> >::iterator itr(r.f_schemas.lower_bound(schema->f_hash));
+		while(itr != r.f_schemas.end() && itr->first == schema->f_hash) {
+			if(itr->second.expired()) {
+				r.f_schemas.erase(itr++);
+			}
+			else {
+				++itr;
+			}
+		}
+	}
+	delete schema;
+}
+
+
+
+
+/** \class result_schema
+ *
+ * \brief The names and types of the columns of a result.
+ *
+ * A dynamic_record describes the columns of each result it gets bound
+ * to. The names and types of the columns are saved in a schema which
+ * is shared by all the records bound to results of the same shape,
+ * for example one record per worker running the same query. The
+ * column names are interned so the same name is saved only once in
+ * the process, whatever the number of schemas using it.
+ *
+ * A schema is immutable. When a record is bound to a result with
+ * different columns, it gets another schema.
+ *
+ * The schema includes a hash table of the column names so searching
+ * a column by name does not compare the strings of a tree.
+ */
+
+
+/** \brief Retrieve the schema of a set of columns.
+ *
+ * This function returns the schema already used by another record
+ * when there is one with the same columns. Otherwise a new schema
+ * is created.
+ *
+ * The names of the columns must have been interned with intern().
+ *
+ * This function can be called from any thread.
+ *
+ * \param[in] columns   The columns of the result
+ *
+ * \return A pointer to the shared schema.
+ */
+result_schema::pointer_t result_schema::get(const column_vector_t& columns)
+{
+	const size_t hash = hash_columns(columns);
+
+	// schemas that do not match are released once unlocked since
+	// releasing the last reference locks the registry
+	std::vector<pointer_t> others;
+
+	schema_registry_t& r(schema_registry());
+	std::lock_guard<std::mutex> lock(r.f_mutex);
+	std::multimap<size_t, std::weak_ptr<const result_schema> >::const_iterator itr(r.f_schemas.lower_bound(hash));
+	for(; itr != r.f_schemas.end() && itr->first == hash; ++itr) {
+		pointer_t schema(itr->second.lock());
+		if(schema) {
+			if(schema->same_columns(columns)) {
+				return schema;
+			}
+			others.push_back(schema);
+		}
+	}
+
+	pointer_t schema(new result_schema(columns, hash), release_t());
+	r.f_schemas.insert(std::make_pair(hash, std::weak_ptr<const result_schema>(schema)));
+	return schema;
+}
+
+
+/** \brief Intern a column name.
+ *
+ * This function returns the one copy of \p name kept by the library.
+ * The reference remains valid until the process exits.
+ *
+ * \param[in] name     The name to intern, it does not need to be null terminated
+ * \param[in] length   The length of \p name in bytes
+ *
+ * \return The interned name.
+ */
+const std::string& result_schema::intern(const char *name, size_t length)
+{
+	std::string str(name, length);
+
+	name_pool_t& p(name_pool());
+	std::lock_guard<std::mutex> lock(p.f_mutex);
+	return *p.f_names.insert(str).first;
+}
+
+
+/** \brief Retrieve the number of schemas in use.
+ *
+ * \return The number of schemas used by at least one record.
+ */
+size_t result_schema::count()
+{
+	schema_registry_t& r(schema_registry());
+	std::lock_guard<std::mutex> lock(r.f_mutex);
+	size_t result = 0;
+	std::multimap<size_t, std::weak_ptr<const result_schema> >::const_iterator itr(r.f_schemas.begin());
+	for(; itr != r.f_schemas.end(); ++itr) {
+		if(!itr->second.expired()) {
+			++result;
+		}
+	}
+	return result;
+}
+
+
+/** \brief Initialize a schema.
+ *
+ * The constructor builds the hash table of the column names. When
+ * several columns have the same name, the first one is found.
+ *
+ * \param[in] columns   The columns of the result
+ * \param[in] hash      The hash of \p columns
+ */
+result_schema::result_schema(const column_vector_t& columns, size_t hash) :
+	f_columns(columns),
+	//f_index -- auto-init
+	f_hash(hash)
+{
+	if(f_columns.empty()) {
+		return;
+	}
+
+	// at most half full so the probes stay short
+	size_t slots = 4;
+	while(slots < f_columns.size() * 2) {
+		slots <<= 1;
+	}
+	f_index.resize(slots, 0);
+
+	const size_t mask = slots - 1;
+	for(SQLSMALLINT col = 1; col <= size(); ++col) {
+		const std::string& column_name(*f_columns[col - 1].f_name);
+		if(column_name.empty() || find(column_name) != 0) {
+			continue;
+		}
+		size_t pos = hash_name(column_name.data(), column_name.length()) & mask;
+		while(f_index[pos] != 0) {
+			pos = (pos + 1) & mask;
+		}
+		f_index[pos] = col;
+	}
+}
+
+
+/** \brief Search a column by name.
+ *
+ * \param[in] name     The name of the column, it does not need to be null terminated
+ * \param[in] length   The length of \p name in bytes
+ *
+ * \return The number of the column, 0 if not found.
+ */
+SQLSMALLINT result_schema::find(const char *name, size_t length) const
+{
+	if(f_index.empty()) {
+		return 0;
+	}
+
+	const size_t mask = f_index.size() - 1;
+	for(size_t pos = hash_name(name, length) & mask;; pos = (pos + 1) & mask) {
+		const SQLSMALLINT col = f_index[pos];
+		if(col == 0) {
+			return 0;
+		}
+		const std::string& column_name(*f_columns[col - 1].f_name);
+		if(column_name.length() == length && memcmp(column_name.data(), name, length) == 0) {
+			return col;
+		}
+	}
+}
+
+
+/** \brief Check whether a column is the same as a description.
+ *
+ * This function is used by the records to check whether a new result
+ * has the same shape as the previous one without creating a column
+ * vector.
+ *
+ * \param[in] col              The number of the column, 1 to size()
+ * \param[in] name             The name of the column
+ * \param[in] length           The length of \p name in bytes
+ * \param[in] type             The SQL type of the column
+ * \param[in] column_size      The size of the column
+ * \param[in] decimal_digits   The number of decimal digits of the column
+ *
+ * \return true if the column has the same name and type.
+ */
+bool result_schema::same_column(SQLSMALLINT col, const char *name, size_t length,
+		SQLSMALLINT type, SQLULEN column_size, SQLSMALLINT decimal_digits) const
+{
+	const column_t& column(f_columns[col - 1]);
+	return column.f_type == type
+		&& column.f_column_size == column_size
+		&& column.f_decimal_digits == decimal_digits
+		&& column.f_name->length() == length
+		&& memcmp(column.f_name->data(), name, length) == 0;
+}
+
+
+/** \brief Compute the hash of a name.
+ *
+ * This is the 64 bit FNV-1a hash, truncated on 32 bit systems.
+ *
+ * \param[in] name     The name to hash
+ * \param[in] length   The length of \p name in bytes
+ *
+ * \return The hash of \p name.
+ */
+size_t result_schema::hash_name(const char *name, size_t length)
+{
+	SQLUBIGINT hash = 14695981039346656037ULL;
+	for(size_t idx = 0; idx < length; ++idx) {
+		hash = (hash ^ static_cast<unsigned char>(name[idx])) * 1099511628211ULL;
+	}
+	return static_cast<size_t>(hash);
+}
+
+
+/** \brief Compute the hash of a set of columns.
+ *
+ * \param[in] columns   The columns to hash
+ *
+ * \return The hash of the names and types of \p columns.
+ */
+size_t result_schema::hash_columns(const column_vector_t& columns)
+{
+	size_t hash = columns.size();
+	for(column_vector_t::const_iterator itr(columns.begin()); itr != columns.end(); ++itr) {
+		hash = hash * 31 + hash_name(itr->f_name->data(), itr->f_name->length());
+		hash = hash * 31 + static_cast<size_t>(itr->f_type);
+		hash = hash * 31 + static_cast<size_t>(itr->f_column_size);
+		hash = hash * 31 + static_cast<size_t>(itr->f_decimal_digits);
+	}
+	return hash;
+}
+
+
+/** \brief Check whether this schema has the specified columns.
+ *
+ * The names are interned so they are compared by pointer.
+ *
+ * \param[in] columns   The columns to compare with
+ *
+ * \return true if the columns are the same.
+ */
+bool result_schema::same_columns(const column_vector_t& columns) const
+{
+	if(columns.size() != f_columns.size()) {
+		return false;
+	}
+	for(size_t idx = 0; idx < columns.size(); ++idx) {
+		const column_t& a(columns[idx]);
+		const column_t& b(f_columns[idx]);
+		if(a.f_name != b.f_name
+		|| a.f_type != b.f_type
+		|| a.f_column_size != b.f_column_size
+		|| a.f_decimal_digits != b.f_decimal_digits) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+/** \struct result_schema::column_t
+ *
+ * \brief The description of one column.
+ */
+
+/** \typedef result_schema::column_vector_t
+ *
+ * \brief The columns of a result, offset 0 is column 1.
+ */
+
+/** \typedef result_schema::pointer_t
+ *
+ * \brief A shared pointer to a schema.
+ *
+ * The reference count of a shared pointer is thread safe so records
+ * used by different threads can share a schema.
+ */
+
+/** \fn result_schema::size() const
+ *
+ * \brief Retrieve the number of columns.
+ *
+ * \return The number of columns of the result.
+ */
+
+/** \fn result_schema::columns() const
+ *
+ * \brief Retrieve all the columns.
+ *
+ * \return The vector of the columns, offset 0 is column 1.
+ */
+
+/** \fn result_schema::column(SQLSMALLINT col) const
+ *
+ * \brief Retrieve a column.
+ *
+ * \param[in] col   The number of the column, 1 to size()
+ *
+ * \return The description of the column.
+ */
+
+/** \fn result_schema::name(SQLSMALLINT col) const
+ *
+ * \brief Retrieve the name of a column.
+ *
+ * \param[in] col   The number of the column, 1 to size()
+ *
+ * \return The interned name of the column, empty if the column has no name.
+ */
+
+/** \fn result_schema::find(const std::string& name) const
+ *
+ * \brief Search a column by name.
+ *
+ * \param[in] name   The name of the column
+ *
+ * \return The number of the column, 0 if not found.
+ */
+
+/** \var result_schema::f_columns
+ *
+ * \brief The columns of the result.
+ */
+
+/** \var result_schema::f_index
+ *
+ * \brief The hash table of the column names.
+ *
+ * Each slot holds a column number or 0 when empty. Collisions use
+ * the next slots.
+ */
+
+/** \var result_schema::f_hash
+ *
+ * \brief The hash of the columns, the key of the schema in the registry.
+ */
+
+
+
+}	// namespace odbcpp
+
@@ -0,0 +1,270 @@
+//
+// File:	src/row_store.cpp
+// Object:	Implementation of the row store used by the client side cursor
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/row_store.h"
+#include	"odbcpp/exception.h"
+#include	<cstring>
+
+#if defined(_MSC_VER)
+#define	odbcpp_fseek	_fseeki64
+#else
+#define	odbcpp_fseek	fseeko
+#endif
+
+
+namespace odbcpp
+{
+
+
+/** \class row_store
+ *
+ * \brief A compact store of row images.
+ *
+ * This class saves rows as blocks of bytes one after another. It is
+ * used by the client side cursor of the statement to keep the rows
+ * already read from the driver so one can scroll back.
+ *
+ * The rows are saved in memory. When a memory limit is defined and
+ * the rows go over that limit, the rows in memory are written to a
+ * temporary file and the memory is reused for the following rows.
+ * Rows that were written to the file are read back one at a time
+ * when requested.
+ *
+ * Rows can only be appended. The store is emptied with clear().
+ */
+
+
+/** \brief Initialize an empty row store.
+ *
+ * The store starts empty with no memory limit.
+ */
+row_store::row_store() :
+	f_memory_limit(0),
+	//f_offsets -- auto-init
+	f_total(0),
+	f_memory_start(0),
+	//f_memory -- auto-init
+	f_file(NULL)
+	//f_scratch -- auto-init
+{
+}
+
+
+/** \brief Clean up the row store.
+ *
+ * The temporary file, if any, is closed and thus deleted.
+ */
+row_store::~row_store()
+{
+	if(f_file != NULL) {
+		fclose(f_file);
+	}
+}
+
+
+/** \brief Remove all the rows.
+ *
+ * This function empties the store. The memory buffers keep their
+ * capacity so the next result does not need to allocate them again.
+ * The temporary file is closed.
+ */
+void row_store::clear()
+{
+	f_offsets.clear();
+	f_total = 0;
+	f_memory_start = 0;
+	f_memory.clear();
+	if(f_file != NULL) {
+		fclose(f_file);
+		f_file = NULL;
+	}
+}
+
+
+/** \fn row_store::set_memory_limit(SQLULEN limit)
+ *
+ * \brief Define the amount of memory used before spilling rows to disk.
+ *
+ * When the rows in memory go over \p limit bytes, they are written
+ * to a temporary file. A limit of 0 means that all the rows are kept
+ * in memory.
+ *
+ * \param[in] limit   The memory limit in bytes, 0 for no limit
+ */
+
+/** \fn row_store::get_memory_limit() const
+ *
+ * \brief Retrieve the memory limit.
+ *
+ * \return The memory limit in bytes, 0 when there is no limit.
+ */
+
+/** \fn row_store::size() const
+ *
+ * \brief Retrieve the number of rows in the store.
+ *
+ * \return The number of rows appended since the last clear().
+ */
+
+
+/** \brief Add a row to the store.
+ *
+ * This function copies \p size bytes from \p data at the end of the
+ * store. The row number of the new row is size() - 1 once this
+ * function returns.
+ *
+ * \param[in] data   The row image
+ * \param[in] size   The size of the row image in bytes
+ *
+ * \exception odbcpp_error
+ * If the rows cannot be written to the temporary file, an error is thrown.
+ */
+void row_store::append(const char *data, SQLULEN size)
+{
+	f_offsets.push_back(f_total);
+	f_memory.insert(f_memory.end(), data, data + size);
+	f_total += size;
+
+	if(f_memory_limit != 0 && f_memory.size() > f_memory_limit) {
+		spill();
+	}
+}
+
+
+/** \brief Retrieve a row from the store.
+ *
+ * This function returns a pointer to the image of the specified row.
+ * The pointer remains valid until the next call to a function of
+ * this row store.
+ *
+ * \param[in] row    The row number, starting at 0
+ * \param[out] size  The size of the row image
+ *
+ * \return A pointer to the row image.
+ *
+ * \exception odbcpp_error
+ * If the row does not exist or cannot be read back from the temporary
+ * file, an error is thrown.
+ */
+const char *row_store::get(SQLULEN row, SQLULEN& size)
+{
+	if(row >= f_offsets.size()) {
+		diagnostic d(odbcpp_error::ODBCPP_NOT_FOUND, std::string("the row does not exist in this row store"));
+		throw odbcpp_error(d);
+	}
+
+	SQLUBIGINT start = f_offsets[row];
+	SQLUBIGINT end = row + 1 < f_offsets.size() ? f_offsets[row + 1] : f_total;
+	size = static_cast<SQLULEN>(end - start);
+
+	if(start >= f_memory_start) {
+		return &f_memory[0] + (start - f_memory_start);
+	}
+
+	// the row was written to the temporary file
+	f_scratch.resize(size == 0 ? 1 : size);
+	if(odbcpp_fseek(f_file, start, SEEK_SET) != 0
+	|| fread(&f_scratch[0], 1, size, f_file) != size) {
+		diagnostic d(odbcpp_error::ODBCPP_INTERNAL, std::string("could not read a row back from the row store temporary file"));
+		throw odbcpp_error(d);
+	}
+
+	return &f_scratch[0];
+}
+
+
+/** \brief Write the rows in memory to the temporary file.
+ *
+ * This function appends the rows currently in memory to the temporary
+ * file, creating the file the first time, and then empties the memory
+ * buffer.
+ *
+ * \exception odbcpp_error
+ * If the file cannot be created or written, an error is thrown.
+ */
+void row_store::spill()
+{
+	if(f_file == NULL) {
+		f_file = tmpfile();
+		if(f_file == NULL) {
+			diagnostic d(odbcpp_error::ODBCPP_INTERNAL, std::string("could not create the row store temporary file"));
+			throw odbcpp_error(d);
+		}
+	}
+
+	// a write following a read requires a seek
+	if(odbcpp_fseek(f_file, 0, SEEK_END) != 0
+	|| fwrite(&f_memory[0], 1, f_memory.size(), f_file) != f_memory.size()) {
+		diagnostic d(odbcpp_error::ODBCPP_INTERNAL, std::string("could not write rows to the row store temporary file"));
+		throw odbcpp_error(d);
+	}
+
+	f_memory_start = f_total;
+	f_memory.clear();
+}
+
+
+/** \var row_store::f_memory_limit
+ *
+ * \brief The number of bytes kept in memory before spilling to disk.
+ */
+
+/** \var row_store::f_offsets
+ *
+ * \brief The offset of each row in the store.
+ *
+ * The size of a row is the difference between its offset and the
+ * offset of the next row (or f_total for the last row.)
+ */
+
+/** \var row_store::f_total
+ *
+ * \brief The total number of bytes appended to the store.
+ */
+
+/** \var row_store::f_memory_start
+ *
+ * \brief The offset of the first byte kept in memory.
+ *
+ * The bytes before this offset are in the temporary file at the
+ * same offset.
+ */
+
+/** \var row_store::f_memory
+ *
+ * \brief The rows kept in memory.
+ */
+
+/** \var row_store::f_file
+ *
+ * \brief The temporary file holding the rows that were spilled.
+ */
+
+/** \var row_store::f_scratch
+ *
+ * \brief A buffer used to read a row back from the temporary file.
+ */
+
+
+
+}	// namespace odbcpp
@@ -0,0 +1,286 @@
+//
+// File:	src/slow_query.cpp
+// Object:	Implementation of the slow query log
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/slow_query.h"
+#include	"odbcpp/statistics.h"
+
+
+namespace odbcpp
+{
+
+
+/** \class slow_query_t
+ *
+ * \brief The description of a slow query.
+ *
+ * This structure is sent to the slow_query_sink::log() function
+ * whenever a query took longer or returned more rows than the
+ * thresholds defined with connection::set_slow_query_log().
+ *
+ * The query is measured from the call to statement::execute() up
+ * to the statement::fetch() that returns false. If the result is
+ * not read to the end, the measure stops when the statement
+ * executes another order, closes the cursor, cancels or gets
+ * destroyed. In that case f_drained is false. A query that fails
+ * or times out is measured up to the failure and reported right
+ * away with its error in f_diagnostic.
+ *
+ * The pointers are only valid during the call to the log()
+ * function. Copy the data if you need to keep it.
+ */
+
+/** \var slow_query_t::f_sql
+ *
+ * \brief The SQL order that was executed.
+ */
+
+/** \var slow_query_t::f_execute_time
+ *
+ * \brief The time spent in SQLExecDirect(), in nanoseconds.
+ */
+
+/** \var slow_query_t::f_first_row_time
+ *
+ * \brief The time until the first row was fetched, in nanoseconds.
+ *
+ * This time includes the f_execute_time. It is zero if no row
+ * was fetched.
+ */
+
+/** \var slow_query_t::f_total_time
+ *
+ * \brief The total time of the query, in nanoseconds.
+ *
+ * This time includes the f_execute_time and the time spent in
+ * all the fetch() calls, but also the time spent by your code
+ * between the fetch() calls.
+ */
+
+/** \var slow_query_t::f_rows
+ *
+ * \brief The number of rows that were fetched.
+ */
+
+/** \var slow_query_t::f_drained
+ *
+ * \brief Whether the result was read up to the end.
+ */
+
+/** \var slow_query_t::f_dropped
+ *
+ * \brief The number of slow queries not logged because of the rate limit.
+ *
+ * This is the number of slow queries that were dropped since the
+ * previous slow query was sent to the sink.
+ */
+
+/** \var slow_query_t::f_diagnostic
+ *
+ * \brief The diagnostic of the last ODBC call of the statement.
+ *
+ * This diagnostic includes the warnings (SQL_SUCCESS_WITH_INFO)
+ * that the driver returned, if any.
+ */
+
+
+/** \class slow_query_sink
+ *
+ * \brief The interface receiving the slow queries.
+ *
+ * Derive from this class and install your object with
+ * connection::set_slow_query_log() to receive the queries that
+ * go over the thresholds.
+ *
+ * The log() function is called from the thread using the statement.
+ * It must not throw.
+ *
+ * \note
+ * There is no driver independent way to retrieve the plan of
+ * execution of a query. If you need it, your sink can save the
+ * SQL order and run an EXPLAIN (or equivalent) later on another
+ * connection.
+ */
+
+/** \fn slow_query_sink::log(const slow_query_t& query)
+ *
+ * \brief Receive a slow query.
+ *
+ * \param[in] query   The description of the slow query
+ */
+
+
+/** \class slow_query_log
+ *
+ * \brief The slow query log settings of a connection.
+ *
+ * This class holds the sink, the thresholds and the rate limiter
+ * of the slow query log of a connection. The statements of the
+ * connection measure their queries and report them to this object
+ * which decides whether they get sent to the sink.
+ *
+ * The rate limit is applied per second. Queries that go over the
+ * limit are counted and the count is sent along the next query
+ * that gets logged.
+ *
+ * Nothing is allocated by this class.
+ */
+
+
+/** \brief Initialize an inactive slow query log.
+ *
+ * The slow query log starts with no sink and thus it is inactive.
+ */
+slow_query_log::slow_query_log() :
+	f_sink(0),
+	f_time_threshold(0),
+	f_rows_threshold(0),
+	f_max_per_second(0),
+	f_window_start(0),
+	f_window_count(0),
+	f_dropped(0)
+{
+}
+
+
+/** \brief Define the slow query log settings.
+ *
+ * This function sets the sink and the thresholds. A query is
+ * considered slow if its total time is larger or equal to
+ * \p time_threshold, or if it returned at least \p rows_threshold
+ * rows. A threshold set to zero is ignored.
+ *
+ * Set \p sink to NULL to turn off the slow query log.
+ *
+ * \param[in] sink             The object receiving the slow queries
+ * \param[in] time_threshold   The time threshold in nanoseconds
+ * \param[in] rows_threshold   The rows threshold
+ * \param[in] max_per_second   The maximum number of queries logged per second, 0 for no limit
+ */
+void slow_query_log::set(slow_query_sink *sink, SQLUBIGINT time_threshold, SQLLEN rows_threshold, SQLUINTEGER max_per_second)
+{
+	f_sink = sink;
+	f_time_threshold = time_threshold;
+	f_rows_threshold = rows_threshold;
+	f_max_per_second = max_per_second;
+	f_window_start = 0;
+	f_window_count = 0;
+	f_dropped = 0;
+}
+
+
+/** \fn slow_query_log::is_active() const
+ *
+ * \brief Check whether queries need to be measured.
+ *
+ * \return true if a sink is defined.
+ */
+
+
+/** \brief Check whether a query goes over the thresholds.
+ *
+ * \param[in] total_time   The total time of the query in nanoseconds
+ * \param[in] rows         The number of rows fetched
+ *
+ * \return true if the query is considered slow.
+ */
+bool slow_query_log::is_slow(SQLUBIGINT total_time, SQLLEN rows) const
+{
+	return (f_time_threshold != 0 && total_time >= f_time_threshold)
+	    || (f_rows_threshold != 0 && rows >= f_rows_threshold);
+}
+
+
+/** \brief Send a query to the sink.
+ *
+ * This function checks the thresholds and the rate limit. If the
+ * query is slow and the limit is not reached, the query is sent to
+ * the sink.
+ *
+ * The f_dropped field of \p query is set by this function.
+ *
+ * \param[in,out] query   The query to report
+ */
+void slow_query_log::report(slow_query_t& query)
+{
+	if(f_sink == 0 || !is_slow(query.f_total_time, query.f_rows)) {
+		return;
+	}
+
+	if(f_max_per_second != 0) {
+		SQLUBIGINT now = stopwatch::now();
+		if(now - f_window_start >= 1000000000ULL) {
+			f_window_start = now;
+			f_window_count = 0;
+		}
+		if(f_window_count >= f_max_per_second) {
+			++f_dropped;
+			return;
+		}
+		++f_window_count;
+	}
+
+	query.f_dropped = f_dropped;
+	f_dropped = 0;
+
+	f_sink->log(query);
+}
+
+
+/** \var slow_query_log::f_sink
+ *
+ * \brief The object receiving the slow queries, NULL when inactive.
+ */
+
+/** \var slow_query_log::f_time_threshold
+ *
+ * \brief The time over which a query is considered slow, in nanoseconds.
+ */
+
+/** \var slow_query_log::f_rows_threshold
+ *
+ * \brief The number of rows over which a query is considered slow.
+ */
+
+/** \var slow_query_log::f_max_per_second
+ *
+ * \brief The maximum number of queries sent to the sink each second.
+ */
+
+/** \var slow_query_log::f_window_start
+ *
+ * \brief The start time of the current rate limit window.
+ */
+
+/** \var slow_query_log::f_window_count
+ *
+ * \brief The number of queries sent to the sink in the current window.
+ */
+
+/** \var slow_query_log::f_dropped
+ *
+ * \brief The number of slow queries dropped since the last one logged.
+ */
+
+
+
+}	// namespace odbcpp
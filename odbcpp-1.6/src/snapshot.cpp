@@ -0,0 +1,815 @@
+//
+// File:	src/snapshot.cpp
+// Object:	Implementation of the result snapshot files
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/snapshot.h"
+#include	<algorithm>
+#include	<cstring>
+#include	<limits>
+#include	<stdio.h>
+#if !defined(_MSC_VER)
+#include	<fcntl.h>
+#include	<sys/mman.h>
+#include	<sys/stat.h>
+#include	<unistd.h>
+#endif
+
+
+namespace odbcpp
+{
+
+
+namespace
+{
+
+/// The magic of a snapshot file
+const char SNAPSHOT_MAGIC[8] = { 'O', 'D', 'B', 'C', 'P', 'P', 'S', 'S' };
+/// The version of the snapshot format
+const SQLUINTEGER SNAPSHOT_VERSION = 1;
+/// The value of the byte order field, written in the native order
+const SQLUINTEGER SNAPSHOT_BYTE_ORDER = 0x01020304;
+/// The alignment of the arrays in the file
+const SQLUBIGINT SNAPSHOT_ALIGNMENT = 16;
+
+/** \brief The header of a snapshot file.
+ *
+ * The file starts with this header. All the numbers are written in
+ * the byte order of the computer that created the file.
+ */
+struct snapshot_header_t
+{
+	char		f_magic[8];
+	SQLUINTEGER	f_version;
+	SQLUINTEGER	f_byte_order;
+	SQLUINTEGER	f_sqllen_size;
+	SQLUINTEGER	f_cols;
+	SQLUBIGINT	f_rows;
+	SQLUBIGINT	f_blocks;
+	SQLUBIGINT	f_columns_offset;
+	SQLUBIGINT	f_directory_offset;
+	SQLUBIGINT	f_reserved;
+};
+
+/** \brief The description of a column in a snapshot file.
+ *
+ * The column descriptions follow each other, each one followed by
+ * the column name padded to a multiple of 8 bytes.
+ */
+struct snapshot_column_t
+{
+	SQLUBIGINT	f_column_size;
+	SQLUBIGINT	f_size;
+	SQLUBIGINT	f_stride;
+	SQLSMALLINT	f_type;
+	SQLSMALLINT	f_bind_type;
+	SQLSMALLINT	f_decimal_digits;
+	SQLUSMALLINT	f_name_length;
+};
+
+/** \brief An entry of the block directory of a snapshot file.
+ */
+struct snapshot_block_t
+{
+	SQLUBIGINT	f_offset;
+	SQLUBIGINT	f_first_row;
+	SQLUBIGINT	f_rows;
+};
+
+
+/** \brief Align a file offset.
+ *
+ * \param[in] offset   The offset to align
+ * \param[in] alignment   The alignment, a power of 2
+ *
+ * \return The offset rounded up to \p alignment.
+ */
+inline SQLUBIGINT align(SQLUBIGINT offset, SQLUBIGINT alignment = SNAPSHOT_ALIGNMENT)
+{
+	return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+
+/** \brief Write to a snapshot file.
+ *
+ * This class keeps track of the offset and throws on errors.
+ */
+class snapshot_file
+{
+public:
+	snapshot_file(const std::string& filename) :
+		f_file(fopen(filename.c_str(), "wb")),
+		f_offset(0)
+	{
+		if(f_file == NULL) {
+			diagnostic d(odbcpp_error::ODBCPP_INTERNAL, std::string("could not create the snapshot file \"") + filename + "\"");
+			throw odbcpp_error(d);
+		}
+	}
+
+	~snapshot_file()
+	{
+		if(f_file != NULL) {
+			fclose(f_file);
+		}
+	}
+
+	void write(const void *data, SQLUBIGINT size)
+	{
+		if(size != 0 && fwrite(data, static_cast<size_t>(size), 1, f_file) != 1) {
+			diagnostic d(odbcpp_error::ODBCPP_INTERNAL, std::string("could not write to the snapshot file"));
+			throw odbcpp_error(d);
+		}
+		f_offset += size;
+	}
+
+	void pad(SQLUBIGINT alignment = SNAPSHOT_ALIGNMENT)
+	{
+		static const char zeroes[SNAPSHOT_ALIGNMENT] = { 0 };
+		write(zeroes, align(f_offset, alignment) - f_offset);
+	}
+
+	void rewrite_header(const snapshot_header_t& header)
+	{
+		if(fseek(f_file, 0, SEEK_SET) != 0) {
+			diagnostic d(odbcpp_error::ODBCPP_INTERNAL, std::string("could not write to the snapshot file"));
+			throw odbcpp_error(d);
+		}
+		write(&header, sizeof(header));
+	}
+
+	void close()
+	{
+		FILE *file = f_file;
+		f_file = NULL;
+		if(fclose(file) != 0) {
+			diagnostic d(odbcpp_error::ODBCPP_INTERNAL, std::string("could not write to the snapshot file"));
+			throw odbcpp_error(d);
+		}
+	}
+
+	SQLUBIGINT offset() const { return f_offset; }
+
+private:
+	FILE *		f_file;
+	SQLUBIGINT	f_offset;
+};
+
+
+/** \brief Add an array to the extent of a block.
+ *
+ * The array starts at \p offset aligned to SNAPSHOT_ALIGNMENT.
+ *
+ * \param[in,out] offset   The end of the previous array, then the end of this array
+ * \param[in] rows         The number of items in the array
+ * \param[in] stride       The size of one item
+ * \param[in] size         The size of the file
+ *
+ * \return false if the array does not fit in the file.
+ */
+bool add_array(SQLUBIGINT& offset, SQLUBIGINT rows, SQLUBIGINT stride, SQLUBIGINT size)
+{
+	if(offset > size) {
+		return false;
+	}
+	offset = align(offset);
+	if(offset > size
+	|| (stride != 0 && rows > (size - offset) / stride)) {
+		return false;
+	}
+	offset += rows * stride;
+	return true;
+}
+
+
+/** \brief Throw an error about an invalid snapshot file.
+ *
+ * \param[in] filename   The name of the file
+ */
+void invalid_snapshot(const std::string& filename)
+{
+	diagnostic d(odbcpp_error::ODBCPP_INCORRECT_USE, std::string("\"") + filename + "\" is not a valid snapshot file for this computer");
+	throw odbcpp_error(d);
+}
+
+}	// no name namespace
+
+
+
+
+/** \class snapshot_writer
+ *
+ * \brief Save a result in a snapshot file.
+ *
+ * A snapshot file holds a whole result in a binary format that a
+ * snapshot_reader maps in memory. Expensive reports can be computed
+ * once and then read instantly by many processes, even after a
+ * restart, without querying the database again.
+ *
+ * The file starts with a header, followed by blocks of rows. Each
+ * block is one rowset as fetched by a dynamic_record and holds, for
+ * each column, the array of indicators followed by the array of data.
+ * The description of the columns, as returned by SQLDescribeCol(),
+ * and the directory of the blocks are at the end of the file.
+ *
+ * Strings use the column size of the result for each row, so the
+ * snapshots of results with large VARCHAR columns are large.
+ *
+ * The numbers are written in the byte order of the computer, a
+ * snapshot can only be read on computers of the same kind.
+ *
+ * \code
+ * stmt.execute("SELECT ... expensive report ...");
+ * snapshot_writer writer("/var/cache/reports/sales.snapshot");
+ * writer.write(stmt);
+ * \endcode
+ *
+ * \sa snapshot_reader
+ */
+
+
+/** \brief Initialize a snapshot writer.
+ *
+ * \param[in] filename     The name of the snapshot file
+ * \param[in] block_rows   The number of rows per block
+ */
+snapshot_writer::snapshot_writer(const std::string& filename, SQLULEN block_rows) :
+	f_filename(filename),
+	f_block_rows(block_rows == 0 ? 1 : block_rows)
+{
+}
+
+
+/** \brief Write the result of a statement in the snapshot file.
+ *
+ * This function fetches all the remaining rows of \p stmt and saves
+ * them in the snapshot file. The statement must have executed a
+ * query.
+ *
+ * The file is first written with a temporary name and then renamed
+ * so readers never see a partial snapshot.
+ *
+ * \param[in] stmt   The statement with the result to save
+ *
+ * \return The number of rows saved.
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if the file cannot be written or if a
+ * fetch fails. The temporary file is then removed.
+ */
+SQLULEN snapshot_writer::write(statement& stmt)
+{
+	const std::string tmp(f_filename + ".tmp");
+	snapshot_header_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.f_magic, SNAPSHOT_MAGIC, sizeof(header.f_magic));
+	header.f_version = SNAPSHOT_VERSION;
+	header.f_byte_order = SNAPSHOT_BYTE_ORDER;
+	header.f_sqllen_size = sizeof(SQLLEN);
+
+	try {
+		snapshot_file file(tmp);
+		file.write(&header, sizeof(header));
+
+		// bind before fetching so the columns are described with
+		// describe_col() even when the result has no rows
+		dynamic_record rec;
+		rec.set_rowset_size(f_block_rows);
+		rec.bind(stmt);
+		std::vector<snapshot_block_t> directory;
+		while(stmt.fetch(rec)) {
+			snapshot_block_t block;
+			file.pad();
+			block.f_offset = file.offset();
+			block.f_first_row = header.f_rows;
+			block.f_rows = rec.rows_fetched();
+			dynamic_record::bind_info_col_vector_t::const_iterator itr(rec.f_bind_by_col.begin());
+			for(; itr != rec.f_bind_by_col.end(); ++itr) {
+				file.pad();
+				file.write((*itr)->f_indicator, block.f_rows * sizeof(SQLLEN));
+				file.pad();
+				file.write((*itr)->f_data, block.f_rows * (*itr)->f_stride);
+			}
+			directory.push_back(block);
+			header.f_rows += block.f_rows;
+		}
+
+		// the columns, also written for an empty result
+		file.pad();
+		header.f_columns_offset = file.offset();
+		header.f_cols = static_cast<SQLUINTEGER>(rec.f_bind_by_col.size());
+		dynamic_record::bind_info_col_vector_t::const_iterator itr(rec.f_bind_by_col.begin());
+		for(; itr != rec.f_bind_by_col.end(); ++itr) {
+			snapshot_column_t column;
+			memset(&column, 0, sizeof(column));
+			column.f_column_size = (*itr)->f_column_size;
+			column.f_size = (*itr)->f_size;
+			column.f_stride = (*itr)->f_stride;
+			column.f_type = (*itr)->f_target_type;
+			column.f_bind_type = (*itr)->f_bind_type;
+			column.f_decimal_digits = (*itr)->f_decimal_digits;
+			const std::string& name(rec.f_schema->name((*itr)->f_col));
+			column.f_name_length = static_cast<SQLUSMALLINT>(name.length());
+			file.write(&column, sizeof(column));
+			file.write(name.c_str(), column.f_name_length);
+			file.pad(8);
+		}
+
+		file.pad();
+		header.f_directory_offset = file.offset();
+		header.f_blocks = directory.size();
+		if(!directory.empty()) {
+			file.write(&directory[0], directory.size() * sizeof(snapshot_block_t));
+		}
+
+		file.rewrite_header(header);
+		file.close();
+	}
+	catch(...) {
+		remove(tmp.c_str());
+		throw;
+	}
+
+	if(rename(tmp.c_str(), f_filename.c_str()) != 0) {
+		remove(tmp.c_str());
+		diagnostic d(odbcpp_error::ODBCPP_INTERNAL, std::string("could not rename the snapshot file to \"") + f_filename + "\"");
+		throw odbcpp_error(d);
+	}
+
+	return header.f_rows;
+}
+
+
+/** \var snapshot_writer::f_filename
+ *
+ * \brief The name of the snapshot file.
+ */
+
+/** \var snapshot_writer::f_block_rows
+ *
+ * \brief The number of rows per block, also the rowset size used to fetch.
+ */
+
+
+
+
+/** \class snapshot_reader
+ *
+ * \brief Read a snapshot file.
+ *
+ * A snapshot reader maps a file written by a snapshot_writer in
+ * memory. The rows are read with a dynamic_record: the record
+ * columns point directly to the arrays in the mapping so the get()
+ * functions work as usual without copying nor parsing anything.
+ *
+ * \code
+ * snapshot_reader reader("/var/cache/reports/sales.snapshot");
+ * dynamic_record rec;
+ * while(reader.fetch(rec)) {
+ *	rec.get("total", total);
+ *	...
+ * }
+ * \endcode
+ *
+ * The pages of the file are shared by all the processes reading it.
+ *
+ * The reader must remain valid as long as records are attached to it.
+ * Binding a record to a statement detaches it from the snapshot.
+ *
+ * \sa snapshot_writer
+ */
+
+
+/** \brief Open a snapshot file.
+ *
+ * This function maps the file in memory and verifies the header,
+ * the column descriptions and the block directory, so reading the
+ * rows never accesses memory outside of the mapping.
+ *
+ * \param[in] filename   The name of the snapshot file
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if the file cannot be opened or is not
+ * a snapshot written on a computer of the same kind.
+ */
+snapshot_reader::snapshot_reader(const std::string& filename) :
+	f_map(NULL),
+	f_map_size(0),
+	//f_buffer -- auto-init
+	f_rows(0),
+	f_cols(0),
+	f_blocks(0),
+	f_columns(NULL),
+	f_directory(NULL),
+	f_position(0)
+{
+#if defined(_MSC_VER)
+	FILE *file = fopen(filename.c_str(), "rb");
+	if(file == NULL) {
+		diagnostic d(odbcpp_error::ODBCPP_NOT_FOUND, std::string("could not open the snapshot file \"") + filename + "\"");
+		throw odbcpp_error(d);
+	}
+	char buf[65536];
+	size_t size;
+	while((size = fread(buf, 1, sizeof(buf), file)) > 0) {
+		f_buffer.insert(f_buffer.end(), buf, buf + size);
+	}
+	fclose(file);
+	f_map = f_buffer.empty() ? NULL : &f_buffer[0];
+	f_map_size = f_buffer.size();
+#else
+	int fd = open(filename.c_str(), O_RDONLY);
+	if(fd < 0) {
+		diagnostic d(odbcpp_error::ODBCPP_NOT_FOUND, std::string("could not open the snapshot file \"") + filename + "\"");
+		throw odbcpp_error(d);
+	}
+	struct stat st;
+	if(fstat(fd, &st) != 0) {
+		close(fd);
+		diagnostic d(odbcpp_error::ODBCPP_INTERNAL, std::string("could not read the size of the snapshot file \"") + filename + "\"");
+		throw odbcpp_error(d);
+	}
+	f_map_size = static_cast<SQLULEN>(st.st_size);
+	if(f_map_size < sizeof(snapshot_header_t)) {
+		close(fd);
+		invalid_snapshot(filename);
+	}
+	void *map = mmap(NULL, f_map_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(map == MAP_FAILED) {
+		diagnostic d(odbcpp_error::ODBCPP_INTERNAL, std::string("could not map the snapshot file \"") + filename + "\"");
+		throw odbcpp_error(d);
+	}
+	f_map = static_cast<const char *>(map);
+#endif
+
+	try {
+		if(f_map_size < sizeof(snapshot_header_t)) {
+			invalid_snapshot(filename);
+		}
+		const snapshot_header_t *header = reinterpret_cast<const snapshot_header_t *>(f_map);
+		if(memcmp(header->f_magic, SNAPSHOT_MAGIC, sizeof(header->f_magic)) != 0
+		|| header->f_version != SNAPSHOT_VERSION
+		|| header->f_byte_order != SNAPSHOT_BYTE_ORDER
+		|| header->f_sqllen_size != sizeof(SQLLEN)
+		|| header->f_cols > static_cast<SQLUINTEGER>(std::numeric_limits<SQLSMALLINT>::max())
+		|| header->f_columns_offset % 8 != 0
+		|| header->f_directory_offset % 8 != 0
+		|| header->f_columns_offset > f_map_size
+		|| header->f_cols > (f_map_size - header->f_columns_offset) / sizeof(snapshot_column_t)
+		|| header->f_directory_offset > f_map_size
+		|| header->f_blocks > (f_map_size - header->f_directory_offset) / sizeof(snapshot_block_t)) {
+			invalid_snapshot(filename);
+		}
+		f_rows = header->f_rows;
+		f_cols = static_cast<SQLSMALLINT>(header->f_cols);
+		f_blocks = header->f_blocks;
+		f_columns = f_map + header->f_columns_offset;
+		f_directory = reinterpret_cast<const SQLUBIGINT *>(f_map + header->f_directory_offset);
+		if(!check_layout()) {
+			invalid_snapshot(filename);
+		}
+	}
+	catch(...) {
+#if !defined(_MSC_VER)
+		munmap(const_cast<char *>(f_map), f_map_size);
+#endif
+		throw;
+	}
+}
+
+
+/** \brief Close the snapshot file.
+ *
+ * The mapping is released. The records attached to this reader
+ * must not be used anymore.
+ */
+snapshot_reader::~snapshot_reader()
+{
+#if !defined(_MSC_VER)
+	munmap(const_cast<char *>(f_map), f_map_size);
+#endif
+}
+
+
+/** \brief Read the next row.
+ *
+ * This function makes the next row of the snapshot the current row
+ * of \p rec. The record is attached to the block of the row, so the
+ * columns are only updated when the row is in another block.
+ *
+ * \param[in,out] rec   The record used to read the row
+ *
+ * \return true if a row was read, false at the end of the snapshot.
+ */
+bool snapshot_reader::fetch(dynamic_record& rec)
+{
+	return read(rec, f_position);
+}
+
+
+/** \brief Read the rest of the current block.
+ *
+ * This function attaches \p rec to the block of the next row, like
+ * a fetch with a rowset. rows_fetched() returns the number of rows
+ * of the block and the current row is the next row. The next call
+ * reads the following block.
+ *
+ * \param[in,out] rec   The record used to read the rows
+ *
+ * \return true if rows were read, false at the end of the snapshot.
+ */
+bool snapshot_reader::fetch_block(dynamic_record& rec)
+{
+	if(!read(rec, f_position)) {
+		return false;
+	}
+	const snapshot_block_t *block = reinterpret_cast<const snapshot_block_t *>(f_directory) + rec.f_source_block;
+	f_position = block->f_first_row + block->f_rows;
+	return true;
+}
+
+
+/** \brief Read a row.
+ *
+ * This function makes \p row the current row of \p rec. The next
+ * call to fetch() reads the following row.
+ *
+ * When \p row does not exist, a record that was not attached to this
+ * snapshot yet still gets its columns, so the names and types of the
+ * columns of an empty snapshot are available.
+ *
+ * \param[in,out] rec   The record used to read the row
+ * \param[in] row       The row to read, starting at 0
+ *
+ * \return true if the row exists, false otherwise.
+ */
+bool snapshot_reader::read(dynamic_record& rec, SQLULEN row)
+{
+	if(row >= f_rows) {
+		// like a fetch() on a statement, the record gets the
+		// columns even when the snapshot has no rows
+		if(rec.f_source != this) {
+			attach_columns(rec);
+		}
+		return false;
+	}
+
+	const SQLULEN idx = find_block(row);
+	if(rec.f_source != this || rec.f_source_block != idx) {
+		attach(rec, idx);
+	}
+	const snapshot_block_t *block = reinterpret_cast<const snapshot_block_t *>(f_directory) + idx;
+	rec.f_row = row - block->f_first_row;
+	f_position = row + 1;
+
+	return true;
+}
+
+
+/** \brief Verify the columns and the blocks against the file size.
+ *
+ * This function verifies that the column descriptions, with their
+ * names, and the arrays of all the blocks are within the file, that
+ * the stride of each column is large enough for its type or buffer
+ * size, and that the blocks hold all the rows in order.
+ *
+ * \return true if the layout of the file is valid.
+ */
+bool snapshot_reader::check_layout() const
+{
+	std::vector<SQLUBIGINT> strides;
+	SQLUBIGINT offset = f_columns - f_map;
+	for(SQLSMALLINT col = 0; col < f_cols; ++col) {
+		if(f_map_size - offset < sizeof(snapshot_column_t)) {
+			return false;
+		}
+		const snapshot_column_t *column = reinterpret_cast<const snapshot_column_t *>(f_map + offset);
+		offset += sizeof(snapshot_column_t);
+		if(f_map_size - offset < align(column->f_name_length, 8)
+		|| column->f_stride < dynamic_record::c_type_size(column->f_bind_type)
+		|| (dynamic_record::c_type_size(column->f_bind_type) == 0 && column->f_size > column->f_stride)) {
+			return false;
+		}
+		offset += align(column->f_name_length, 8);
+		strides.push_back(column->f_stride);
+	}
+
+	const snapshot_block_t *blocks = reinterpret_cast<const snapshot_block_t *>(f_directory);
+	SQLUBIGINT rows = 0;
+	for(SQLULEN idx = 0; idx < f_blocks; ++idx) {
+		const snapshot_block_t& block(blocks[idx]);
+		if(block.f_first_row != rows
+		|| block.f_rows == 0
+		|| block.f_rows > f_rows - rows) {
+			return false;
+		}
+		rows += block.f_rows;
+		offset = block.f_offset;
+		for(std::vector<SQLUBIGINT>::const_iterator itr(strides.begin()); itr != strides.end(); ++itr) {
+			if(!add_array(offset, block.f_rows, sizeof(SQLLEN), f_map_size)
+			|| !add_array(offset, block.f_rows, *itr, f_map_size)) {
+				return false;
+			}
+		}
+	}
+
+	return rows == f_rows;
+}
+
+
+/** \brief Search the block holding a row.
+ *
+ * \param[in] row   The row to search
+ *
+ * \return The index of the block.
+ */
+SQLULEN snapshot_reader::find_block(SQLULEN row) const
+{
+	const snapshot_block_t *blocks = reinterpret_cast<const snapshot_block_t *>(f_directory);
+	SQLULEN lo = 0;
+	SQLULEN hi = f_blocks;
+	while(hi - lo > 1) {
+		SQLULEN mid = lo + (hi - lo) / 2;
+		if(blocks[mid].f_first_row <= row) {
+			lo = mid;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+
+/** \brief Attach a record to the columns of the snapshot.
+ *
+ * This function creates the column information of \p rec from the
+ * column descriptions of the snapshot. The columns do not point to
+ * any block yet and the record has no rows.
+ *
+ * \param[in,out] rec   The record to attach
+ */
+void snapshot_reader::attach_columns(dynamic_record& rec) const
+{
+	// the record buffers and columns are not used anymore
+	rec.unbind();
+	rec.f_arena.reset();
+	rec.f_bind_by_col.clear();
+	rec.f_bind_by_col.resize(f_cols);
+
+	result_schema::column_vector_t columns;
+	const char *p = f_columns;
+	for(SQLSMALLINT col = 0; col < f_cols; ++col) {
+		const snapshot_column_t *column = reinterpret_cast<const snapshot_column_t *>(p);
+		const char *name = p + sizeof(snapshot_column_t);
+		p = name + align(column->f_name_length, 8);
+
+		dynamic_record::bind_info_t *info = new dynamic_record::bind_info_t;
+		rec.f_bind_by_col[col] = info;
+		info->f_col = col + 1;
+		info->f_target_type = column->f_type;
+		info->f_bind_type = column->f_bind_type;
+		info->f_decimal_digits = column->f_decimal_digits;
+		info->f_column_size = column->f_column_size;
+		info->f_size = column->f_size;
+		info->f_stride = column->f_stride;
+		columns.push_back(result_schema::column_t(&result_schema::intern(name, column->f_name_length),
+				info->f_target_type, info->f_column_size, info->f_decimal_digits));
+	}
+	rec.f_schema = result_schema::get(columns);
+	rec.f_source = this;
+	// no block is attached yet
+	rec.f_source_block = f_blocks;
+	rec.f_source_rows = 0;
+}
+
+
+/** \brief Attach a record to a block.
+ *
+ * This function points the columns of \p rec to the arrays of the
+ * block in the mapping. The column information is created when the
+ * record was not attached to this snapshot yet.
+ *
+ * \param[in,out] rec   The record to attach
+ * \param[in] idx       The index of the block
+ */
+void snapshot_reader::attach(dynamic_record& rec, SQLULEN idx) const
+{
+	const snapshot_block_t *block = reinterpret_cast<const snapshot_block_t *>(f_directory) + idx;
+
+	if(rec.f_source != this) {
+		attach_columns(rec);
+	}
+
+	// the arrays of the columns follow each other in the block
+	// (the constructor verified that they are within the mapping)
+	SQLUBIGINT offset = block->f_offset;
+	dynamic_record::bind_info_col_vector_t::iterator itr(rec.f_bind_by_col.begin());
+	for(; itr != rec.f_bind_by_col.end(); ++itr) {
+		offset = align(offset);
+		(*itr)->f_indicator = const_cast<SQLLEN *>(reinterpret_cast<const SQLLEN *>(f_map + offset));
+		offset = align(offset + block->f_rows * sizeof(SQLLEN));
+		(*itr)->f_data = const_cast<char *>(f_map + offset);
+		offset += block->f_rows * (*itr)->f_stride;
+	}
+	rec.f_source_block = idx;
+	rec.f_source_rows = block->f_rows;
+}
+
+
+/** \fn snapshot_reader::rows() const
+ *
+ * \brief Retrieve the number of rows in the snapshot.
+ *
+ * \return The number of rows.
+ */
+
+/** \fn snapshot_reader::cols() const
+ *
+ * \brief Retrieve the number of columns in the snapshot.
+ *
+ * \return The number of columns.
+ */
+
+/** \fn snapshot_reader::blocks() const
+ *
+ * \brief Retrieve the number of blocks in the snapshot.
+ *
+ * \return The number of blocks.
+ */
+
+/** \fn snapshot_reader::rewind()
+ *
+ * \brief Restart reading at the first row.
+ *
+ * The next fetch() returns the first row.
+ */
+
+/** \var snapshot_reader::f_map
+ *
+ * \brief The snapshot file mapped in memory.
+ */
+
+/** \var snapshot_reader::f_map_size
+ *
+ * \brief The size of the mapping.
+ */
+
+/** \var snapshot_reader::f_buffer
+ *
+ * \brief The content of the file when mmap() is not available.
+ */
+
+/** \var snapshot_reader::f_rows
+ *
+ * \brief The number of rows in the snapshot.
+ */
+
+/** \var snapshot_reader::f_cols
+ *
+ * \brief The number of columns in the snapshot.
+ */
+
+/** \var snapshot_reader::f_blocks
+ *
+ * \brief The number of blocks in the snapshot.
+ */
+
+/** \var snapshot_reader::f_columns
+ *
+ * \brief The description of the columns in the mapping.
+ */
+
+/** \var snapshot_reader::f_directory
+ *
+ * \brief The directory of the blocks in the mapping.
+ */
+
+/** \var snapshot_reader::f_position
+ *
+ * \brief The row returned by the next call to fetch().
+ */
+
+
+
+}	// namespace odbcpp
+
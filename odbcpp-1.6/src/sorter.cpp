@@ -0,0 +1,1145 @@
+//
+// File:	src/sorter.cpp
+// Object:	Implementation of the external sorter
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/sorter.h"
+#include	<algorithm>
+#include	<cstring>
+#if !defined(_MSC_VER)
+#include	<stdlib.h>
+#include	<unistd.h>
+#endif
+
+
+namespace odbcpp
+{
+
+
+namespace
+{
+
+/// The maximum number of runs merged at once
+const SQLULEN MERGE_FANOUT = 64;
+/// The alignment of the columns in the output buffer
+const SQLULEN OUTPUT_ALIGNMENT = 16;
+
+
+/** \brief Compare two keys.
+ *
+ * The keys are compared byte per byte as unsigned numbers. When one
+ * key is the start of the other, the shorter key comes first.
+ *
+ * \param[in] a        The first key
+ * \param[in] a_size   The size of the first key
+ * \param[in] b        The second key
+ * \param[in] b_size   The size of the second key
+ *
+ * \return A negative number, zero or a positive number when \p a is
+ *         smaller than, equal to or larger than \p b.
+ */
+int compare_keys(const char *a, size_t a_size, const char *b, size_t b_size)
+{
+	int r = memcmp(a, b, std::min(a_size, b_size));
+	if(r != 0) {
+		return r;
+	}
+	return a_size < b_size ? -1 : (a_size > b_size ? 1 : 0);
+}
+
+
+/** \brief Append an unsigned number to a key.
+ *
+ * The number is saved with the most significant byte first so the
+ * keys compare like the numbers.
+ *
+ * \param[in,out] key       The key to append to
+ * \param[in] value         The number to append
+ * \param[in] descending    Whether the bytes get inverted
+ */
+void append_unsigned(std::string& key, SQLUBIGINT value, bool descending)
+{
+	if(descending) {
+		value = ~value;
+	}
+	key += static_cast<char>(descending ? 0xFE : 0x01);
+	for(int shift = 56; shift >= 0; shift -= 8) {
+		key += static_cast<char>((value >> shift) & 255);
+	}
+}
+
+
+/** \brief Check whether a C type is saved with its length.
+ *
+ * Strings and binary buffers are saved in the row images with the
+ * number of bytes that were fetched instead of the whole buffer.
+ *
+ * \param[in] c_type   The C type of the column
+ *
+ * \return true if the column has a variable length.
+ */
+bool is_variable(SQLSMALLINT c_type)
+{
+	return c_type == SQL_C_CHAR || c_type == SQL_C_WCHAR || c_type == SQL_C_BINARY;
+}
+
+
+/** \brief Compute the number of bytes of a column in a row image.
+ *
+ * \param[in] c_type      The C type of the column
+ * \param[in] stride      The size of the column buffer
+ * \param[in] indicator   The indicator of the column
+ *
+ * \return The number of bytes saved in the row image.
+ */
+SQLLEN image_bytes(SQLSMALLINT c_type, SQLULEN stride, SQLLEN indicator)
+{
+	if(indicator == SQL_NULL_DATA) {
+		return 0;
+	}
+	SQLLEN bytes = static_cast<SQLLEN>(stride);
+	if(is_variable(c_type)) {
+		// keep the null terminator
+		SQLLEN used = indicator + static_cast<SQLLEN>(sizeof(SQLWCHAR));
+		if(indicator >= 0 && used < bytes) {
+			bytes = used;
+		}
+	}
+	return bytes;
+}
+
+
+/** \brief Align an offset in the output buffer.
+ *
+ * \param[in] offset   The offset to align
+ *
+ * \return The offset rounded up to OUTPUT_ALIGNMENT.
+ */
+inline SQLULEN output_align(SQLULEN offset)
+{
+	return (offset + OUTPUT_ALIGNMENT - 1) & ~(OUTPUT_ALIGNMENT - 1);
+}
+
+}	// no name namespace
+
+
+
+/** \brief Sort the entries of the memory buffer by key.
+ */
+class external_sorter::entry_less
+{
+public:
+	entry_less(const char *buffer) : f_buffer(buffer) {}
+
+	bool operator () (const entry_t& a, const entry_t& b) const
+	{
+		return compare_keys(f_buffer + a.f_offset, a.f_key_size, f_buffer + b.f_offset, b.f_key_size) < 0;
+	}
+
+private:
+	const char *	f_buffer;
+};
+
+
+/** \brief Order the runs in the merge heap.
+ *
+ * The heap functions keep the largest item first, this comparison is
+ * inverted so the run with the smallest key comes first. Runs with
+ * equal keys come in the order they were created so the sort is
+ * stable.
+ */
+class external_sorter::run_greater
+{
+public:
+	run_greater(const std::vector<run_t>& runs) : f_runs(runs) {}
+
+	bool operator () (SQLULEN a, SQLULEN b) const
+	{
+		const std::string& ka(f_runs[a].f_key);
+		const std::string& kb(f_runs[b].f_key);
+		int r = compare_keys(ka.data(), ka.length(), kb.data(), kb.length());
+		return r != 0 ? r > 0 : a > b;
+	}
+
+private:
+	const std::vector<run_t>&	f_runs;
+};
+
+
+
+
+/** \class external_sorter
+ *
+ * \brief Sort a result on the client in bounded memory.
+ *
+ * When the server cannot sort a result (i.e. federated sources or
+ * sort keys computed on the client) the rows have to be sorted by
+ * the client. This object reads all the rows of a statement and
+ * returns them sorted, without ever holding more than about the
+ * specified amount of memory.
+ *
+ * The rows are read with a rowset and saved in a memory buffer along
+ * their sort key. Strings only use the bytes that were fetched. When
+ * the buffer is full, it gets sorted and saved in a temporary file,
+ * called a run. Once all the rows were read, the runs are merged and
+ * the rows are returned in order by fetch(). Results that fit in
+ * memory never touch the disk.
+ *
+ * The keys are strings of bytes compared with memcmp(). add_key()
+ * adds a column to the key and set_key_function() adds a key computed
+ * from the row. The append_key() functions can be used to build keys
+ * that sort like the values:
+ *
+ * \code
+ * external_sorter sorter(256 * 1024 * 1024, "/var/tmp");
+ * sorter.add_key("country");
+ * sorter.set_key_function([](const dynamic_record& rec, std::string& key) {
+ *	std::string name;
+ *	rec.get("name", name);
+ *	external_sorter::append_key(key, to_lower(name));
+ * });
+ * stmt.execute("SELECT * FROM remote_customers");
+ * sorter.sort(stmt);
+ * dynamic_record rec;
+ * while(sorter.fetch(rec)) {
+ *	...
+ * }
+ * \endcode
+ *
+ * The sort is stable: rows with equal keys are returned in the order
+ * they were read.
+ */
+
+
+/** \brief Initialize an external sorter.
+ *
+ * The temporary files are created in \p temp_directory, or with
+ * tmpfile() if empty. They are deleted as soon as created so they
+ * never stay on disk. On MS-Windows, tmpfile() is always used.
+ *
+ * \param[in] memory_limit     The amount of memory used to sort the rows
+ * \param[in] temp_directory   The directory of the temporary files
+ */
+external_sorter::external_sorter(SQLULEN memory_limit, const std::string& temp_directory) :
+	f_memory_limit(memory_limit),
+	f_temp_directory(temp_directory),
+	//f_keys -- auto-init
+	//f_key_function -- auto-init
+	//f_input -- auto-init
+	//f_buffer -- auto-init
+	//f_entries -- auto-init
+	//f_runs -- auto-init
+	//f_heap -- auto-init
+	//f_key -- auto-init
+	//f_image -- auto-init
+	f_rows(0),
+	f_position(0),
+	f_generation(0),
+	f_sorted(false)
+	//f_output -- auto-init
+	//f_output_indicators -- auto-init
+{
+}
+
+
+/** \brief Clean up the sorter.
+ *
+ * The temporary files are closed, which deletes them. The records
+ * attached to this sorter must not be used anymore.
+ */
+external_sorter::~external_sorter()
+{
+	close_runs();
+}
+
+
+/** \brief Add a column to the sort key.
+ *
+ * The columns are compared in the order they are added. The column
+ * keys come before the key of the key function.
+ *
+ * Integers, floating points, NUMERIC, dates, times and timestamps
+ * sort like their value, NUMERIC exactly whatever its precision.
+ * Strings are compared byte per byte. NULL comes first, or last when \p descending is
+ * true.
+ *
+ * \param[in] col          The column number, starting at 1
+ * \param[in] descending   Whether the column is sorted in descending order
+ */
+void external_sorter::add_key(SQLSMALLINT col, bool descending)
+{
+	sort_key_t key;
+	key.f_col = col;
+	key.f_descending = descending;
+	f_keys.push_back(key);
+}
+
+
+/** \brief Add a column to the sort key.
+ *
+ * \param[in] name         The name of the column
+ * \param[in] descending   Whether the column is sorted in descending order
+ *
+ * \sa add_key(SQLSMALLINT col, bool descending)
+ */
+void external_sorter::add_key(const std::string& name, bool descending)
+{
+	sort_key_t key;
+	key.f_name = name;
+	key.f_col = 0;
+	key.f_descending = descending;
+	f_keys.push_back(key);
+}
+
+
+/** \brief Read and sort the rows of a statement.
+ *
+ * This function fetches all the remaining rows of \p stmt, which
+ * must have executed a query, and sorts them. The rows previously
+ * sorted are forgotten. Use fetch() to read the sorted rows.
+ *
+ * \param[in] stmt          The statement with the rows to sort
+ * \param[in] rowset_size   The number of rows read per fetch
+ *
+ * \return The number of rows sorted.
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if a key column does not exist, if the
+ * fetch fails or if the temporary files cannot be written.
+ */
+SQLULEN external_sorter::sort(statement& stmt, SQLULEN rowset_size)
+{
+	clear();
+	++f_generation;
+
+	f_input.set_rowset_size(rowset_size);
+	bool first = true;
+	while(stmt.fetch(f_input)) {
+		if(first) {
+			first = false;
+			std::vector<sort_key_t>::iterator itr(f_keys.begin());
+			for(; itr != f_keys.end(); ++itr) {
+				if(itr->f_name.empty()) {
+					f_input.find_column(itr->f_col, SQL_UNKNOWN_TYPE);
+				}
+				else {
+					itr->f_col = f_input.find_column(itr->f_name, SQL_UNKNOWN_TYPE)->f_col;
+				}
+			}
+		}
+		const SQLULEN max = f_input.rows_fetched();
+		for(SQLULEN row = 0; row < max; ++row) {
+			f_input.set_row(row);
+			f_key.clear();
+			build_key(f_input, f_key);
+			build_image(f_input);
+
+			entry_t entry;
+			entry.f_offset = f_buffer.size();
+			entry.f_key_size = static_cast<SQLUINTEGER>(f_key.length());
+			entry.f_image_size = static_cast<SQLUINTEGER>(f_image.size());
+			f_buffer.insert(f_buffer.end(), f_key.begin(), f_key.end());
+			f_buffer.insert(f_buffer.end(), f_image.begin(), f_image.end());
+			f_entries.push_back(entry);
+			++f_rows;
+
+			if(f_buffer.size() + f_entries.size() * sizeof(entry_t) >= f_memory_limit) {
+				spill();
+			}
+		}
+	}
+	// the columns stay described once the statement is gone
+	f_input.unbind();
+
+	if(f_runs.empty()) {
+		std::stable_sort(f_entries.begin(), f_entries.end(), entry_less(f_buffer.data()));
+	}
+	else {
+		if(!f_entries.empty()) {
+			spill();
+		}
+		std::vector<char>().swap(f_buffer);
+		std::vector<entry_t>().swap(f_entries);
+
+		// merge the runs in passes if there are too many files
+		while(f_runs.size() > MERGE_FANOUT) {
+			std::vector<run_t> merged;
+			try {
+				for(SQLULEN idx = 0; idx < f_runs.size(); idx += MERGE_FANOUT) {
+					run_t run;
+					run.f_file = create_run();
+					merged.push_back(run);
+					merge(idx, std::min(MERGE_FANOUT, f_runs.size() - idx), run.f_file);
+				}
+			}
+			catch(...) {
+				f_runs.insert(f_runs.end(), merged.begin(), merged.end());
+				throw;
+			}
+			f_runs.swap(merged);
+		}
+		start_merge(0, f_runs.size());
+	}
+
+	// the buffers the attached records point to
+	SQLULEN size = 0;
+	dynamic_record::bind_info_col_vector_t::const_iterator itr(f_input.f_bind_by_col.begin());
+	for(; itr != f_input.f_bind_by_col.end(); ++itr) {
+		size = output_align(size) + (*itr)->f_stride;
+	}
+	f_output.assign(size, 0);
+	f_output_indicators.assign(f_input.f_bind_by_col.size(), SQL_NULL_DATA);
+
+	f_sorted = true;
+	return f_rows;
+}
+
+
+/** \brief Read the next sorted row.
+ *
+ * This function makes the next sorted row the current row of \p rec.
+ * The columns of \p rec point to buffers of the sorter, the record
+ * must not be used after the sorter is destroyed or sorts another
+ * result. Binding the record to a statement detaches it.
+ *
+ * \param[in,out] rec   The record receiving the row
+ *
+ * \return true if a row was read, false once all the rows were read.
+ */
+bool external_sorter::fetch(dynamic_record& rec)
+{
+	if(!f_sorted) {
+		return false;
+	}
+
+	const char *image;
+	if(f_runs.empty()) {
+		if(f_position >= f_entries.size()) {
+			return false;
+		}
+		const entry_t& entry(f_entries[f_position]);
+		image = f_buffer.data() + entry.f_offset + entry.f_key_size;
+	}
+	else {
+		if(!next_merged(f_key, f_image)) {
+			return false;
+		}
+		image = f_image.data();
+	}
+	++f_position;
+
+	if(rec.f_source != this || rec.f_source_block != f_generation) {
+		attach(rec);
+	}
+	load_image(image);
+	rec.f_row = 0;
+
+	return true;
+}
+
+
+/** \brief Forget the sorted rows.
+ *
+ * This function releases the memory and the temporary files used
+ * by the last sort. The keys remain defined.
+ */
+void external_sorter::clear()
+{
+	close_runs();
+	std::vector<char>().swap(f_buffer);
+	std::vector<entry_t>().swap(f_entries);
+	f_rows = 0;
+	f_position = 0;
+	f_sorted = false;
+}
+
+
+/** \brief Append an integer to a key.
+ *
+ * The integer is saved so keys compare like the integers.
+ *
+ * \param[in,out] key       The key to append to
+ * \param[in] value         The integer
+ * \param[in] descending    Whether larger values come first
+ */
+void external_sorter::append_key(std::string& key, SQLBIGINT value, bool descending)
+{
+	append_unsigned(key, static_cast<SQLUBIGINT>(value) ^ 0x8000000000000000ULL, descending);
+}
+
+
+/** \brief Append a floating point to a key.
+ *
+ * The number is saved so keys compare like the numbers, with -0.0
+ * before 0.0.
+ *
+ * \param[in,out] key       The key to append to
+ * \param[in] value         The number
+ * \param[in] descending    Whether larger values come first
+ */
+void external_sorter::append_key(std::string& key, double value, bool descending)
+{
+	SQLUBIGINT bits;
+	memcpy(&bits, &value, sizeof(bits));
+	// negative numbers are inverted, positive numbers come after
+	bits = (bits & 0x8000000000000000ULL) != 0 ? ~bits : bits ^ 0x8000000000000000ULL;
+	append_unsigned(key, bits, descending);
+}
+
+
+/** \brief Append a numeric to a key.
+ *
+ * The numeric is saved so keys compare exactly like the numbers,
+ * whatever their scale: the sign, then the position of the most
+ * significant digit relative to the decimal point, then the digits
+ * without the trailing zeroes. The bytes following the sign are
+ * inverted for negative numbers so larger magnitudes come first.
+ *
+ * \param[in,out] key       The key to append to
+ * \param[in] value         The numeric
+ * \param[in] descending    Whether larger values come first
+ */
+void external_sorter::append_key(std::string& key, const SQL_NUMERIC_STRUCT& value, bool descending)
+{
+	SQLCHAR digits[NUMERIC_MAX_DIGITS];
+	int count = numeric_digits(value, digits);
+
+	const std::string::size_type start = key.length();
+	if(count == 0) {
+		// zero, whatever its sign and scale
+		key += '\x02';
+	}
+	else {
+		const bool negative = value.sign == 0;
+		key += negative ? '\x01' : '\x03';
+		const std::string::size_type magnitude = key.length();
+		const SQLUINTEGER exponent = static_cast<SQLUINTEGER>(count - value.scale + 0x8000);
+		key += static_cast<char>((exponent >> 8) & 255);
+		key += static_cast<char>(exponent & 255);
+		while(digits[count - 1] == 0) {
+			--count;
+		}
+		// digits are saved from 1 to 10 so the terminator is smaller
+		for(int idx = 0; idx < count; ++idx) {
+			key += static_cast<char>(digits[idx] + 1);
+		}
+		key += '\0';
+		if(negative) {
+			for(std::string::size_type idx = magnitude; idx < key.length(); ++idx) {
+				key[idx] = static_cast<char>(~key[idx]);
+			}
+		}
+	}
+	if(descending) {
+		for(std::string::size_type idx = start; idx < key.length(); ++idx) {
+			key[idx] = static_cast<char>(~key[idx]);
+		}
+	}
+}
+
+
+/** \brief Append a string to a key.
+ *
+ * The string is compared byte per byte and shorter strings come
+ * first. The string is terminated so the parts of the key that
+ * follow do not change the order of the strings.
+ *
+ * \param[in,out] key       The key to append to
+ * \param[in] value         The string
+ * \param[in] descending    Whether larger values come first
+ */
+void external_sorter::append_key(std::string& key, const std::string& value, bool descending)
+{
+	const std::string::size_type start = key.length();
+	key += '\x01';
+	// 0 is escaped as 0 0xFF so the terminator 0 0 is smaller
+	for(std::string::const_iterator itr(value.begin()); itr != value.end(); ++itr) {
+		key += *itr;
+		if(*itr == '\0') {
+			key += '\xFF';
+		}
+	}
+	key += '\0';
+	key += '\0';
+	if(descending) {
+		for(std::string::size_type idx = start; idx < key.length(); ++idx) {
+			key[idx] = static_cast<char>(~key[idx]);
+		}
+	}
+}
+
+
+/** \brief Append a NULL to a key.
+ *
+ * NULL comes before all the values appended with append_key(), or
+ * after them when \p descending is true.
+ *
+ * \param[in,out] key       The key to append to
+ * \param[in] descending    Whether larger values come first
+ */
+void external_sorter::append_null_key(std::string& key, bool descending)
+{
+	key += static_cast<char>(descending ? 0xFF : 0x00);
+}
+
+
+/** \brief Build the sort key of the current row.
+ *
+ * \param[in] rec   The record with the current row
+ * \param[out] key  The key, the bytes get appended
+ */
+void external_sorter::build_key(const dynamic_record& rec, std::string& key) const
+{
+	std::vector<sort_key_t>::const_iterator itr(f_keys.begin());
+	for(; itr != f_keys.end(); ++itr) {
+		const smartptr<dynamic_record::bind_info_t>& info(rec.f_bind_by_col[itr->f_col - 1]);
+		const SQLLEN indicator = rec.column_indicator(info);
+		if(indicator == SQL_NULL_DATA) {
+			append_null_key(key, itr->f_descending);
+			continue;
+		}
+		const char *data = rec.column_data(info);
+		switch(info->f_bind_type) {
+		case SQL_C_BIT:
+		case SQL_C_UTINYINT:
+			append_key(key, static_cast<SQLBIGINT>(*reinterpret_cast<const SQLCHAR *>(data)), itr->f_descending);
+			break;
+
+		case SQL_C_TINYINT:
+		case SQL_C_STINYINT:
+			append_key(key, static_cast<SQLBIGINT>(*reinterpret_cast<const SQLSCHAR *>(data)), itr->f_descending);
+			break;
+
+		case SQL_C_SHORT:
+		case SQL_C_SSHORT:
+			append_key(key, static_cast<SQLBIGINT>(*reinterpret_cast<const SQLSMALLINT *>(data)), itr->f_descending);
+			break;
+
+		case SQL_C_USHORT:
+			append_key(key, static_cast<SQLBIGINT>(*reinterpret_cast<const SQLUSMALLINT *>(data)), itr->f_descending);
+			break;
+
+		case SQL_C_LONG:
+		case SQL_C_SLONG:
+			append_key(key, static_cast<SQLBIGINT>(*reinterpret_cast<const SQLINTEGER *>(data)), itr->f_descending);
+			break;
+
+		case SQL_C_ULONG:
+			append_key(key, static_cast<SQLBIGINT>(*reinterpret_cast<const SQLUINTEGER *>(data)), itr->f_descending);
+			break;
+
+		case SQL_C_SBIGINT:
+			append_key(key, *reinterpret_cast<const SQLBIGINT *>(data), itr->f_descending);
+			break;
+
+		case SQL_C_UBIGINT:
+			append_unsigned(key, *reinterpret_cast<const SQLUBIGINT *>(data), itr->f_descending);
+			break;
+
+		case SQL_C_FLOAT:
+			append_key(key, static_cast<double>(*reinterpret_cast<const SQLREAL *>(data)), itr->f_descending);
+			break;
+
+		case SQL_C_DOUBLE:
+			append_key(key, *reinterpret_cast<const SQLDOUBLE *>(data), itr->f_descending);
+			break;
+
+		case SQL_C_NUMERIC:
+			append_key(key, *reinterpret_cast<const SQL_NUMERIC_STRUCT *>(data), itr->f_descending);
+			break;
+
+		case SQL_C_DATE:
+		case SQL_C_TYPE_DATE:
+			append_key(key, static_cast<SQLBIGINT>(date_to_epoch_days(*reinterpret_cast<const SQL_DATE_STRUCT *>(data))), itr->f_descending);
+			break;
+
+		case SQL_C_TIME:
+		case SQL_C_TYPE_TIME:
+		{
+			const SQL_TIME_STRUCT *time = reinterpret_cast<const SQL_TIME_STRUCT *>(data);
+			append_key(key, static_cast<SQLBIGINT>(time->hour * 3600 + time->minute * 60 + time->second), itr->f_descending);
+		}
+			break;
+
+		case SQL_C_TIMESTAMP:
+		case SQL_C_TYPE_TIMESTAMP:
+			append_key(key, timestamp_to_epoch_ns(*reinterpret_cast<const SQL_TIMESTAMP_STRUCT *>(data)), itr->f_descending);
+			break;
+
+		case SQL_C_CHAR:
+		{
+			SQLULEN length = static_cast<SQLULEN>(indicator);
+			if(indicator < 0 || length >= info->f_size) {
+				// truncated or unknown length
+				length = strnlen(data, info->f_size - 1);
+			}
+			append_key(key, std::string(data, length), itr->f_descending);
+		}
+			break;
+
+		case SQL_C_WCHAR:
+		{
+			// UTF-16 saved most significant byte first
+			SQLULEN length = static_cast<SQLULEN>(indicator) / sizeof(SQLWCHAR);
+			const SQLWCHAR *str = reinterpret_cast<const SQLWCHAR *>(data);
+			const SQLULEN max = info->f_size / sizeof(SQLWCHAR) - 1;
+			if(indicator < 0 || length >= max) {
+				for(length = 0; length < max && str[length] != 0; ++length);
+			}
+			std::string bytes;
+			bytes.reserve(length * 2);
+			for(SQLULEN idx = 0; idx < length; ++idx) {
+				bytes += static_cast<char>((str[idx] >> 8) & 255);
+				bytes += static_cast<char>(str[idx] & 255);
+			}
+			append_key(key, bytes, itr->f_descending);
+		}
+			break;
+
+		default:
+			// no specific order, equal values still come together
+			append_key(key, std::string(data, info->f_stride), itr->f_descending);
+			break;
+
+		}
+	}
+
+	if(f_key_function) {
+		f_key_function(rec, key);
+	}
+}
+
+
+/** \brief Save the current row in f_image.
+ *
+ * The image holds the indicator and data of each column. Strings
+ * only use the number of bytes that were fetched and NULL columns
+ * only use their indicator.
+ *
+ * \param[in] rec   The record with the current row
+ */
+void external_sorter::build_image(const dynamic_record& rec)
+{
+	f_image.clear();
+
+	dynamic_record::bind_info_col_vector_t::const_iterator itr(rec.f_bind_by_col.begin());
+	for(; itr != rec.f_bind_by_col.end(); ++itr) {
+		const SQLLEN indicator = rec.column_indicator(*itr);
+		const char *ind = reinterpret_cast<const char *>(&indicator);
+		f_image.insert(f_image.end(), ind, ind + sizeof(SQLLEN));
+		const char *data = rec.column_data(*itr);
+		f_image.insert(f_image.end(), data, data + image_bytes((*itr)->f_bind_type, (*itr)->f_stride, indicator));
+	}
+}
+
+
+/** \brief Save the rows of the memory buffer in a run.
+ *
+ * The rows are sorted and written in a new temporary file. The
+ * buffer is then emptied.
+ */
+void external_sorter::spill()
+{
+	std::stable_sort(f_entries.begin(), f_entries.end(), entry_less(f_buffer.data()));
+
+	run_t run;
+	run.f_file = create_run();
+	f_runs.push_back(run);
+	std::vector<entry_t>::const_iterator itr(f_entries.begin());
+	for(; itr != f_entries.end(); ++itr) {
+		const char *key = f_buffer.data() + itr->f_offset;
+		write_row(run.f_file, key, itr->f_key_size, key + itr->f_key_size, itr->f_image_size);
+	}
+
+	// keep the capacity for the next run
+	f_buffer.clear();
+	f_entries.clear();
+}
+
+
+/** \brief Create a temporary file for a run.
+ *
+ * \return The new file, opened for reading and writing.
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if the file cannot be created.
+ */
+FILE *external_sorter::create_run() const
+{
+	FILE *file = NULL;
+#if !defined(_MSC_VER)
+	if(!f_temp_directory.empty()) {
+		std::string name(f_temp_directory + "/odbcpp-sort-XXXXXX");
+		int fd = mkstemp(&name[0]);
+		if(fd >= 0) {
+			// the file is deleted once closed
+			unlink(name.c_str());
+			file = fdopen(fd, "w+b");
+			if(file == NULL) {
+				close(fd);
+			}
+		}
+	}
+	else
+#endif
+	{
+		file = tmpfile();
+	}
+	if(file == NULL) {
+		diagnostic d(odbcpp_error::ODBCPP_INTERNAL, std::string("could not create a temporary file to sort the rows"));
+		throw odbcpp_error(d);
+	}
+	return file;
+}
+
+
+/** \brief Read the next row of a run.
+ *
+ * \param[in,out] run   The run to read from
+ *
+ * \return true if a row was read, false at the end of the run.
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if the file cannot be read.
+ */
+bool external_sorter::read_run(run_t& run) const
+{
+	SQLUINTEGER sizes[2];
+	size_t r = fread(sizes, sizeof(sizes), 1, run.f_file);
+	if(r != 1) {
+		if(feof(run.f_file)) {
+			return false;
+		}
+	}
+	else {
+		run.f_key.resize(sizes[0]);
+		run.f_image.resize(sizes[1]);
+		if((sizes[0] == 0 || fread(&run.f_key[0], sizes[0], 1, run.f_file) == 1)
+		&& (sizes[1] == 0 || fread(&run.f_image[0], sizes[1], 1, run.f_file) == 1)) {
+			return true;
+		}
+	}
+	diagnostic d(odbcpp_error::ODBCPP_INTERNAL, std::string("could not read a temporary file of sorted rows"));
+	throw odbcpp_error(d);
+}
+
+
+/** \brief Write a row in a run.
+ *
+ * \param[in] file         The file of the run
+ * \param[in] key          The sort key of the row
+ * \param[in] key_size     The size of the key
+ * \param[in] image        The row image
+ * \param[in] image_size   The size of the row image
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if the file cannot be written.
+ */
+void external_sorter::write_row(FILE *file, const char *key, SQLUINTEGER key_size, const char *image, SQLUINTEGER image_size) const
+{
+	SQLUINTEGER sizes[2] = { key_size, image_size };
+	if(fwrite(sizes, sizeof(sizes), 1, file) != 1
+	|| (key_size != 0 && fwrite(key, key_size, 1, file) != 1)
+	|| (image_size != 0 && fwrite(image, image_size, 1, file) != 1)) {
+		diagnostic d(odbcpp_error::ODBCPP_INTERNAL, std::string("could not write a temporary file of sorted rows"));
+		throw odbcpp_error(d);
+	}
+}
+
+
+/** \brief Merge runs in one run.
+ *
+ * This function merges \p count runs starting at \p first in
+ * \p output. The merged runs are closed.
+ *
+ * \param[in] first    The first run to merge
+ * \param[in] count    The number of runs to merge
+ * \param[in] output   The file receiving the merged rows
+ */
+void external_sorter::merge(SQLULEN first, SQLULEN count, FILE *output)
+{
+	start_merge(first, count);
+	while(next_merged(f_key, f_image)) {
+		write_row(output, f_key.data(), static_cast<SQLUINTEGER>(f_key.length()),
+				f_image.data(), static_cast<SQLUINTEGER>(f_image.size()));
+	}
+	for(SQLULEN idx = first; idx < first + count; ++idx) {
+		fclose(f_runs[idx].f_file);
+		f_runs[idx].f_file = NULL;
+	}
+}
+
+
+/** \brief Prepare the merge of runs.
+ *
+ * The runs are read from the start and their first row is loaded.
+ * The heap is then built with the runs that are not empty.
+ *
+ * \param[in] first   The first run to merge
+ * \param[in] count   The number of runs to merge
+ */
+void external_sorter::start_merge(SQLULEN first, SQLULEN count)
+{
+	f_heap.clear();
+	for(SQLULEN idx = first; idx < first + count; ++idx) {
+		if(fflush(f_runs[idx].f_file) != 0) {
+			diagnostic d(odbcpp_error::ODBCPP_INTERNAL, std::string("could not write a temporary file of sorted rows"));
+			throw odbcpp_error(d);
+		}
+		rewind(f_runs[idx].f_file);
+		if(read_run(f_runs[idx])) {
+			f_heap.push_back(idx);
+		}
+	}
+	std::make_heap(f_heap.begin(), f_heap.end(), run_greater(f_runs));
+}
+
+
+/** \brief Retrieve the smallest row of the merged runs.
+ *
+ * \param[out] key     The key of the row
+ * \param[out] image   The image of the row
+ *
+ * \return true if a row was returned, false once all the runs were read.
+ */
+bool external_sorter::next_merged(std::string& key, std::vector<char>& image)
+{
+	if(f_heap.empty()) {
+		return false;
+	}
+
+	std::pop_heap(f_heap.begin(), f_heap.end(), run_greater(f_runs));
+	run_t& run(f_runs[f_heap.back()]);
+	key.swap(run.f_key);
+	image.swap(run.f_image);
+	if(read_run(run)) {
+		std::push_heap(f_heap.begin(), f_heap.end(), run_greater(f_runs));
+	}
+	else {
+		f_heap.pop_back();
+	}
+
+	return true;
+}
+
+
+/** \brief Attach a record to the output buffers.
+ *
+ * The columns of \p rec are created as described by the sorted
+ * result and point to the output buffers of this sorter.
+ *
+ * \param[in,out] rec   The record to attach
+ */
+void external_sorter::attach(dynamic_record& rec)
+{
+	// the record buffers and columns are not used anymore
+	rec.unbind();
+	rec.f_arena.reset();
+	rec.f_bind_by_col.clear();
+	rec.f_schema = f_input.f_schema;
+
+	SQLULEN offset = 0;
+	const SQLULEN max = f_input.f_bind_by_col.size();
+	rec.f_bind_by_col.resize(max);
+	for(SQLULEN idx = 0; idx < max; ++idx) {
+		const dynamic_record::bind_info_t *input = f_input.f_bind_by_col[idx];
+		dynamic_record::bind_info_t *info = new dynamic_record::bind_info_t;
+		rec.f_bind_by_col[idx] = info;
+		info->f_col = input->f_col;
+		info->f_target_type = input->f_target_type;
+		info->f_bind_type = input->f_bind_type;
+		info->f_decimal_digits = input->f_decimal_digits;
+		info->f_column_size = input->f_column_size;
+		info->f_size = input->f_size;
+		info->f_stride = input->f_stride;
+		offset = output_align(offset);
+		info->f_data = &f_output[offset];
+		info->f_indicator = &f_output_indicators[idx];
+		offset += info->f_stride;
+	}
+
+	rec.f_source = this;
+	rec.f_source_block = f_generation;
+	rec.f_source_rows = 1;
+}
+
+
+/** \brief Copy a row image in the output buffers.
+ *
+ * \param[in] image   The row image
+ */
+void external_sorter::load_image(const char *image)
+{
+	SQLULEN offset = 0;
+	const SQLULEN max = f_input.f_bind_by_col.size();
+	for(SQLULEN idx = 0; idx < max; ++idx) {
+		const dynamic_record::bind_info_t *info = f_input.f_bind_by_col[idx];
+		SQLLEN indicator;
+		memcpy(&indicator, image, sizeof(SQLLEN));
+		image += sizeof(SQLLEN);
+		f_output_indicators[idx] = indicator;
+		offset = output_align(offset);
+		const SQLLEN bytes = image_bytes(info->f_bind_type, info->f_stride, indicator);
+		memcpy(&f_output[offset], image, bytes);
+		image += bytes;
+		offset += info->f_stride;
+	}
+}
+
+
+/** \brief Close the temporary files.
+ *
+ * Closing the files deletes them.
+ */
+void external_sorter::close_runs()
+{
+	std::vector<run_t>::iterator itr(f_runs.begin());
+	for(; itr != f_runs.end(); ++itr) {
+		if(itr->f_file != NULL) {
+			fclose(itr->f_file);
+		}
+	}
+	f_runs.clear();
+	f_heap.clear();
+}
+
+
+/** \typedef external_sorter::key_function_t
+ *
+ * \brief A function appending the key of the current row of a record.
+ */
+
+/** \fn external_sorter::set_key_function(const key_function_t& key)
+ *
+ * \brief Define a function computing a part of the sort key.
+ *
+ * The function is called for each row with the record and the key
+ * built from the key columns. It appends its own bytes to the key,
+ * usually with the append_key() functions.
+ *
+ * \param[in] key   The key function
+ */
+
+/** \fn external_sorter::rows() const
+ *
+ * \brief Retrieve the number of rows sorted.
+ *
+ * \return The number of rows read by the last sort().
+ */
+
+/** \fn external_sorter::runs() const
+ *
+ * \brief Retrieve the number of temporary files being merged.
+ *
+ * \return The number of runs, 0 when the rows fit in memory.
+ */
+
+/** \var external_sorter::f_memory_limit
+ *
+ * \brief The size of the memory buffer before the rows get spilled.
+ */
+
+/** \var external_sorter::f_temp_directory
+ *
+ * \brief The directory of the temporary files, empty for tmpfile().
+ */
+
+/** \var external_sorter::f_keys
+ *
+ * \brief The columns of the sort key.
+ */
+
+/** \var external_sorter::f_key_function
+ *
+ * \brief The function computing the end of the sort key, if any.
+ */
+
+/** \var external_sorter::f_input
+ *
+ * \brief The record used to read the rows of the statement.
+ *
+ * It also describes the columns of the sorted rows.
+ */
+
+/** \var external_sorter::f_buffer
+ *
+ * \brief The keys and images of the rows in memory.
+ */
+
+/** \var external_sorter::f_entries
+ *
+ * \brief The position of the rows in f_buffer, sorted by key.
+ */
+
+/** \var external_sorter::f_runs
+ *
+ * \brief The temporary files holding the sorted runs.
+ */
+
+/** \var external_sorter::f_heap
+ *
+ * \brief The runs being merged, the run with the smallest key first.
+ */
+
+/** \var external_sorter::f_key
+ *
+ * \brief The key of the current row.
+ */
+
+/** \var external_sorter::f_image
+ *
+ * \brief The image of the current row.
+ */
+
+/** \var external_sorter::f_rows
+ *
+ * \brief The number of rows sorted.
+ */
+
+/** \var external_sorter::f_position
+ *
+ * \brief The number of rows returned by fetch().
+ */
+
+/** \var external_sorter::f_generation
+ *
+ * \brief The number of calls to sort(), to detect stale records.
+ */
+
+/** \var external_sorter::f_sorted
+ *
+ * \brief Whether fetch() can return rows.
+ */
+
+/** \var external_sorter::f_output
+ *
+ * \brief The data of the columns of the attached records.
+ */
+
+/** \var external_sorter::f_output_indicators
+ *
+ * \brief The indicators of the columns of the attached records.
+ */
+
+
+
+}	// namespace odbcpp
+
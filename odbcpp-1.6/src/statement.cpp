@@ -22,7 +22,11 @@
 //
 
 #include	"odbcpp/odbcpp.h"
+#include	"odbcpp/watchdog.h"
 #include	<iostream>
+#include	<algorithm>
+#include	<cstring>
+#include	<sstream>
 
 
 namespace odbcpp
@@ -35,6 +39,15 @@ namespace odbcpp
  *
  * Create a statement in order to send an SQL order to a database.
  *
+ * The statement gathers performance statistics (number of executes
+ * and fetches, time spent in the driver, etc.) Use get_statistics()
+ * to retrieve a snapshot. The same statistics are also added to the
+ * parent connection statistics.
+ *
+ * Calls to the driver can be limited in time with set_timeout() or
+ * connection::set_timeout(). The calls that take longer are canceled
+ * by the watchdog.
+ *
  * \todo
  * We need to receive a signal if the connection is closed since
  * the statement results won't match the connection. The statement
@@ -57,14 +70,50 @@ statement::statement(connection& conn) :
 	handle(SQL_HANDLE_STMT),
 	f_connection(&conn),
 	f_has_data(false),
-	f_no_direct_fetch(false)
+	f_no_direct_fetch(false),
+	f_rowset_size(1),
+	f_rows_fetched(0),
+	//f_bindings -- auto-init
+	f_bound_record(NULL),
+	f_timeout(0),
+	f_client_cursor(false),
+	//f_row_store -- auto-init
+	f_cursor_position(0),
+	f_cursor_drained(false),
+	//f_row_image -- auto-init
+	//f_cache_key -- auto-init
+	//f_cache_tags -- auto-init
+	f_cache_ttl(0),
+	//f_replay -- auto-init
+	f_replay_row(0),
+	f_replay_verified(false),
+	//f_recording -- auto-init
+	//f_statistics -- auto-init
+	f_query_active(false),
+	//f_query_sql -- auto-init
+	f_query_start(0),
+	f_query_execute_time(0),
+	f_query_first_row_time(0),
+	f_query_rows(0)
 {
 	// we right away allocate a connection
 	// throw if it fails
+	trace(SQL_API_SQLALLOCHANDLE);
 	check(SQLAllocHandle(f_handle_type, f_connection->get_handle(), &f_handle), f_connection);
 }
 
 
+/** \brief Clean up the statement.
+ *
+ * If the slow query log is active and the result of the last
+ * query was not read to the end, the query is reported now.
+ */
+statement::~statement()
+{
+	end_query(false);
+}
+
+
 
 /** \brief Set a integer statement attribute.
  *
@@ -79,6 +128,7 @@ statement::statement(connection& conn) :
 void statement::set_attr(SQLINTEGER attr, SQLINTEGER integer)
 {
 	// TODO: do we need to use the SQL_IS_[U]INTEGER types?
+	trace(SQL_API_SQLSETSTMTATTR);
 	check(SQLSetStmtAttr(f_handle, attr, int_to_ptr(integer), 0));
 }
 
@@ -98,6 +148,7 @@ void statement::set_attr(SQLINTEGER attr, SQLPOINTER ptr, SQLINTEGER length)
 {
 	// TODO: if ptr is a pointer to a known structure, length should
 	//	 be set to SQL_IS_POINTER
+	trace(SQL_API_SQLSETSTMTATTR);
 	check(SQLSetStmtAttr(f_handle, attr, ptr, length));
 }
 
@@ -134,6 +185,64 @@ void statement::set_no_direct_fetch(bool no_direct_fetch)
 
 
 
+/** \brief Set the number of rows read by each fetch.
+ *
+ * This function sets the SQL_ATTR_ROW_ARRAY_SIZE attribute of the
+ * statement. With a size larger than 1, each fetch() reads up to
+ * \p size rows at once in the arrays bound by the record. Use
+ * rows_fetched() to know how many rows were read.
+ *
+ * The records call this function when they get bound. A record
+ * (static) always uses a rowset size of 1. A dynamic_record uses the
+ * size defined with dynamic_record::set_rowset_size().
+ *
+ * The attributes are only sent to the driver when the size changes.
+ *
+ * \param[in] size   The number of rows to read with each fetch, 0 is viewed as 1
+ *
+ * \exception odbcpp_error
+ * And odbcpp_error will be thrown if the SQL function returns an error.
+ */
+void statement::set_rowset_size(SQLULEN size)
+{
+	if(size == 0) {
+		size = 1;
+	}
+	if(size == f_rowset_size) {
+		return;
+	}
+
+	set_attr(SQL_ATTR_ROW_ARRAY_SIZE, static_cast<SQLINTEGER>(size));
+	set_attr(SQL_ATTR_ROWS_FETCHED_PTR, size == 1 ? NULL : &f_rows_fetched, 0);
+	f_rowset_size = size;
+}
+
+
+/** \fn statement::get_rowset_size() const
+ *
+ * \brief Retrieve the number of rows read by each fetch.
+ *
+ * \return The current rowset size.
+ *
+ * \sa set_rowset_size()
+ */
+
+
+/** \fn statement::rows_fetched() const
+ *
+ * \brief Retrieve the number of rows read by the last fetch.
+ *
+ * This function returns the number of rows that the last call to
+ * fetch() read. It is 1 or 0 unless the rowset size is larger
+ * than 1.
+ *
+ * \return The number of rows in the current rowset.
+ *
+ * \sa set_rowset_size()
+ */
+
+
+
 /** \brief Execute an SQL statement
  *
  * This function executes an SQL statement. The result is kept with the
@@ -152,19 +261,244 @@ void statement::set_no_direct_fetch(bool no_direct_fetch)
  * \sa cols()
  * \sa rows()
  * \sa cancel()
+ * \sa try_execute()
  */
 void statement::execute(const std::string& order)
 {
+	execute_order(order, true);
+}
+
+
+/** \brief Execute an SQL statement without throwing.
+ *
+ * This function is the same as execute() except that the errors
+ * returned by the driver are not thrown. Test the return code and
+ * use get_diagnostic() to retrieve the errors:
+ *
+ * \code
+ * if(stmt.try_execute(order) == SQL_ERROR) {
+ *     const diagnostic& d(stmt.get_diagnostic());
+ *     ...
+ * }
+ * \endcode
+ *
+ * This is useful when errors are expected, such as a duplicate key
+ * on an insert, since throwing and catching an exception is much
+ * slower than testing a return code.
+ *
+ * \param[in] order   The SQL order(s) to send the database
+ *
+ * \return SQL_SUCCESS, SQL_SUCCESS_WITH_INFO or SQL_ERROR.
+ */
+SQLRETURN statement::try_execute(const std::string& order)
+{
+	return execute_order(order, false);
+}
+
+
+/** \brief Execute an SQL statement.
+ *
+ * This function implements execute() and try_execute().
+ *
+ * \param[in] order    The SQL order(s) to send the database
+ * \param[in] except   Whether errors are thrown
+ *
+ * \return The code returned by the driver.
+ *
+ * \exception odbcpp_error
+ * And odbcpp_error will be thrown if the SQL function returns an error
+ * and \p except is true.
+ */
+SQLRETURN statement::execute_order(const std::string& order, bool except)
+{
+	end_query(false);
 	f_has_data = false;
+	reset_client_cursor();
+	f_replay.reset();
+	f_recording.reset();
+
+	bool log_query = f_connection->f_slow_query_log.is_active();
+	if(log_query) {
+		// assign() reuses the buffer of the previous query
+		f_query_sql.assign(order);
+		f_query_start = stopwatch::now();
+	}
+
+	const SQLUBIGINT timeout = call_timeout();
+	watchdog::ticket_t ticket = 0;
+	if(timeout != 0) {
+		ticket = watchdog::instance().arm(f_handle, timeout);
+	}
 
-	check(SQLExecDirect(f_handle,
+#ifndef ODBCPP_NO_STATISTICS
+	stopwatch sw;
+#endif
+	trace(SQL_API_SQLEXECDIRECT, order.c_str());
+	SQLRETURN return_code = SQLExecDirect(f_handle,
 		const_cast<SQLCHAR *>(reinterpret_cast<const SQLCHAR *>(order.c_str())),
-		SQL_NTS));
+		SQL_NTS);
+	bool canceled = ticket != 0 && watchdog::instance().disarm(ticket);
+#ifndef ODBCPP_NO_STATISTICS
+	SQLUBIGINT elapsed = sw.elapsed();
+	f_statistics.add_execute(elapsed);
+	f_connection->f_statistics.add_execute(elapsed);
+#endif
+
+	if(log_query) {
+		f_query_execute_time = stopwatch::now() - f_query_start;
+		f_query_first_row_time = 0;
+		f_query_rows = 0;
+		f_query_active = true;
+	}
 
+	if(canceled && return_code == SQL_ERROR) {
+		trace_done(return_code);
+		timed_out(timeout, except);
+		return return_code;
+	}
+	diagnose(return_code);
+	if(return_code == SQL_ERROR
+	|| (except && return_code != SQL_SUCCESS && return_code != SQL_SUCCESS_WITH_INFO)) {
+		// a failed query is reported at once, with its diagnostic
+		end_query(false);
+		if(except) {
+			throw odbcpp_error(get_diagnostic());
+		}
+		return return_code;
+	}
+
+	f_has_data = true;
+
+	return return_code;
+}
+
+
+/** \brief Execute an SQL statement or replay its cached result
+ *
+ * This function searches the result of \p order in the result cache
+ * of the connection. If found, the statement replays the cached rows
+ * and nothing is sent to the driver: fetch(), cols() and
+ * describe_col() use the saved result. Otherwise \p order is
+ * executed and the rows are saved as they get fetched. Once the
+ * last row was fetched, the result is added to the cache.
+ *
+ * Results that are not read to the end are not cached. Results that
+ * are read with another orientation than SQL_FETCH_NEXT are not
+ * cached either.
+ *
+ * The key of the result is \p order so the values of the parameters
+ * must be part of the SQL order. The \p tags are the names of the
+ * tables the result depends on, separated by commas. Call
+ * result_cache::invalidate() with one of these names to remove the
+ * result from the cache.
+ *
+ * The rows are saved as images of the bound buffers so a cached
+ * result is only replayed to records with the same bindings. When
+ * the bindings differ, fetch() executes the query instead.
+ *
+ * Without a result cache this function is the same as execute().
+ *
+ * \param[in] order   The SQL order to execute
+ * \param[in] tags    The names of the tables the result depends on
+ * \param[in] ttl     The time to live of the result in nanoseconds, 0 for the cache default
+ *
+ * \exception odbcpp_error
+ * And odbcpp_error will be thrown if the SQL function returns an error.
+ *
+ * \sa connection::set_result_cache()
+ * \sa from_cache()
+ */
+void statement::execute_cached(const std::string& order, const std::string& tags, SQLUBIGINT ttl)
+{
+	result_cache *cache = f_connection->get_result_cache();
+	if(cache == NULL) {
+		execute(order);
+		return;
+	}
+
+	result_cache::result_pointer_t result(cache->find(order));
+	if(!result) {
+		execute(order);
+
+		// save the description now, the rows get saved by fetch()
+		SQLSMALLINT count;
+		trace(SQL_API_SQLNUMRESULTCOLS);
+		check(SQLNumResultCols(f_handle, &count));
+		if(count <= 0) {
+			return;
+		}
+		std::shared_ptr<cached_result_t> recording(new cached_result_t);
+		recording->f_columns.resize(count);
+		for(SQLSMALLINT col = 1; col <= count; ++col) {
+			cached_result_t::column_t& column(recording->f_columns[col - 1]);
+			SQLCHAR name[256];
+			SQLSMALLINT name_length = 0;
+			describe_col(col, name, sizeof(name), &name_length,
+				&column.f_type, &column.f_size, &column.f_decimal_digits, &column.f_nullable);
+			if(name_length >= static_cast<SQLSMALLINT>(sizeof(name))) {
+				name_length = sizeof(name) - 1;
+			}
+			column.f_name.assign(reinterpret_cast<const char *>(name), name_length);
+		}
+		f_recording = recording;
+		f_cache_key = order;
+		f_cache_tags = tags;
+		f_cache_ttl = ttl;
+		return;
+	}
+
+	end_query(false);
+	reset_client_cursor();
+	f_recording.reset();
+	f_replay = result;
+	f_replay_row = 0;
+	f_replay_verified = false;
+	f_cache_key = order;
 	f_has_data = true;
 }
 
 
+/** \fn statement::from_cache() const
+ *
+ * \brief Check whether the current result comes from the result cache.
+ *
+ * \return true if the rows are replayed from the result cache.
+ *
+ * \sa execute_cached()
+ */
+
+
+/** \brief Report the current query to the slow query log.
+ *
+ * This function is called when the current query ends: the last
+ * row was fetched, the cursor gets closed or canceled, another
+ * query gets executed or the statement gets destroyed.
+ *
+ * If the query goes over the thresholds of the slow query log of
+ * the connection, it is sent to the sink.
+ *
+ * \param[in] drained   Whether the result was read up to the end
+ */
+void statement::end_query(bool drained)
+{
+	if(!f_query_active) {
+		return;
+	}
+	f_query_active = false;
+
+	slow_query_t query;
+	query.f_sql = f_query_sql.c_str();
+	query.f_execute_time = f_query_execute_time;
+	query.f_first_row_time = f_query_first_row_time;
+	query.f_total_time = stopwatch::now() - f_query_start;
+	query.f_rows = f_query_rows;
+	query.f_drained = drained;
+	query.f_dropped = 0;
+	query.f_diagnostic = &get_diagnostic();
+	f_connection->f_slow_query_log.report(query);
+}
+
+
 /** \brief Function used to check whether data is available.
  *
  * Whenever the statement is queried for some kind of data, this
@@ -251,7 +585,16 @@ void statement::cancel()
 {
 	has_data();
 	f_has_data = false;
+	end_query(false);
+	reset_client_cursor();
+	f_recording.reset();
+	if(f_replay) {
+		// nothing was sent to the driver
+		f_replay.reset();
+		return;
+	}
 
+	trace(SQL_API_SQLCANCEL);
 	check(SQLCancel(f_handle));
 }
 
@@ -274,7 +617,16 @@ void statement::close_cursor()
 {
 	has_data();
 	f_has_data = false;
+	end_query(false);
+	reset_client_cursor();
+	f_recording.reset();
+	if(f_replay) {
+		// nothing was sent to the driver
+		f_replay.reset();
+		return;
+	}
 
+	trace(SQL_API_SQLCLOSECURSOR);
 	check(SQLCloseCursor(f_handle));
 }
 
@@ -296,6 +648,11 @@ SQLLEN statement::cols() const
 
 	has_data();
 
+	if(f_replay) {
+		return static_cast<SQLLEN>(f_replay->f_columns.size());
+	}
+
+	trace(SQL_API_SQLNUMRESULTCOLS);
 	check(SQLNumResultCols(const_cast<SQLHANDLE>(f_handle), &count));
 
 	return static_cast<SQLLEN>(count);
@@ -319,6 +676,11 @@ SQLLEN statement::rows() const
 
 	has_data();
 
+	if(f_replay) {
+		return static_cast<SQLLEN>(f_replay->rows());
+	}
+
+	trace(SQL_API_SQLROWCOUNT);
 	check(SQLRowCount(const_cast<SQLHANDLE>(f_handle), &count));
 
 	return count;
@@ -372,26 +734,155 @@ SQLLEN statement::rows() const
  *
  * \sa rows()
  * \sa execute()
+ * \sa try_fetch()
  */
 bool statement::fetch(record_base& rec, SQLSMALLINT orientation, SQLLEN offset)
 {
-	SQLRETURN	return_code;
-
 	// in case the record is not bound yet, do it now
 	rec.bind(*this);
 
 	// make sure we sent an SQL statement
 	has_data();
 
+	if(f_replay && !f_replay_verified) {
+		verify_replay();
+	}
+
+	bool found;
+	if(f_client_cursor) {
+		found = client_fetch(orientation, offset);
+	}
+	else {
+		found = fetch_row(orientation, offset, true) != SQL_NO_DATA;
+	}
+	if(!found) {
+		return false;
+	}
+
+	// some data may need to be copied...
+	rec.finalize();
+
+	// it worked!
+	return true;
+}
+
+
+/** \brief Fetch the next row without throwing.
+ *
+ * This function is the same as fetch() except that the errors
+ * returned by the driver are not thrown. The errors are available
+ * with get_diagnostic(). When nothing was executed, SQL_ERROR is
+ * returned with an ODBCPP_NO_DATA diagnostic.
+ *
+ * \code
+ * SQLRETURN r;
+ * while((r = stmt.try_fetch(rec)) == SQL_SUCCESS || r == SQL_SUCCESS_WITH_INFO) {
+ *     ...
+ * }
+ * if(r == SQL_ERROR) {
+ *     ...
+ * }
+ * \endcode
+ *
+ * Rows replayed from the result cache or read with the client side
+ * cursor can still throw since these errors are not expected.
+ *
+ * \param[in,out] rec           The record where the row data is saved
+ * \param[in]     orientation   The direction for the offset
+ * \param[in]     offset        The offset used to move to that position to fetch
+ *
+ * \return SQL_SUCCESS, SQL_SUCCESS_WITH_INFO, SQL_NO_DATA or SQL_ERROR.
+ *
+ * \exception odbcpp_error
+ * The binding errors of the record are still thrown.
+ */
+SQLRETURN statement::try_fetch(record_base& rec, SQLSMALLINT orientation, SQLLEN offset)
+{
+	if(!f_has_data) {
+		diagnostic d(odbcpp_error::ODBCPP_NO_DATA, std::string("no SQL command was executed, the statement has no data available"));
+		set_diagnostic(d);
+		return SQL_ERROR;
+	}
+
+	if(f_client_cursor || f_replay) {
+		return fetch(rec, orientation, offset) ? SQL_SUCCESS : SQL_NO_DATA;
+	}
+
+	rec.bind(*this);
+	SQLRETURN return_code = fetch_row(orientation, offset, false);
+	if(return_code == SQL_SUCCESS || return_code == SQL_SUCCESS_WITH_INFO) {
+		rec.finalize();
+	}
+	return return_code;
+}
+
+
+/** \brief Fetch the next row from the driver.
+ *
+ * This function calls SQLFetch() or SQLFetchScroll() and updates
+ * the statistics and the slow query log.
+ *
+ * \param[in]     orientation   The direction for the offset
+ * \param[in]     offset        The offset used to move to that position to fetch
+ * \param[in]     except        Whether errors are thrown
+ *
+ * \return SQL_NO_DATA if there is no more data, SQL_ERROR if the fetch
+ *         failed and \p except is false, or a success code.
+ *
+ * \exception odbcpp_error
+ * And odbcpp_error will be thrown if the SQL function returns an error
+ * and \p except is true.
+ */
+SQLRETURN statement::fetch_row(SQLSMALLINT orientation, SQLLEN offset, bool except)
+{
+	SQLRETURN	return_code;
+
+	if(f_replay) {
+		return replay_rows(orientation) ? SQL_SUCCESS : SQL_NO_DATA;
+	}
+	if(f_recording && orientation != SQL_FETCH_NEXT) {
+		// rows would be missing or out of order
+		f_recording.reset();
+	}
+
+	const SQLUBIGINT timeout = call_timeout();
+	watchdog::ticket_t ticket = 0;
+	if(timeout != 0) {
+		ticket = watchdog::instance().arm(f_handle, timeout);
+	}
+
 	// fetch the row
+#ifndef ODBCPP_NO_STATISTICS
+	stopwatch sw;
+#endif
+	f_rows_fetched = 0;
 	if(orientation == SQL_FETCH_NEXT && !f_no_direct_fetch) {
+		trace(SQL_API_SQLFETCH);
 		return_code = SQLFetch(f_handle);
 	}
 	else {
+		trace(SQL_API_SQLFETCHSCROLL);
 		return_code = SQLFetchScroll(f_handle, orientation, offset);
 	}
+	bool canceled = ticket != 0 && watchdog::instance().disarm(ticket);
+	if(f_rowset_size == 1
+	&& (return_code == SQL_SUCCESS || return_code == SQL_SUCCESS_WITH_INFO)) {
+		// the driver only sets it when SQL_ATTR_ROWS_FETCHED_PTR is defined
+		f_rows_fetched = 1;
+	}
+#ifndef ODBCPP_NO_STATISTICS
+	SQLUBIGINT elapsed = sw.elapsed();
+	SQLUBIGINT rows = return_code == SQL_SUCCESS || return_code == SQL_SUCCESS_WITH_INFO ? f_rows_fetched : 0;
+	f_statistics.add_fetch(elapsed, rows);
+	f_connection->f_statistics.add_fetch(elapsed, rows);
+#endif
 	if(return_code == SQL_NO_DATA) {
-		return false;
+		trace_done(return_code);
+		end_query(true);
+		if(f_recording) {
+			end_recording();
+		}
+		return return_code;
 	}
 
 	//
@@ -402,48 +893,915 @@ bool statement::fetch(record_base& rec, SQLSMALLINT orientation, SQLLEN offset)
 	//
 
 	// check the returned code, if error, throw
-	check(return_code);
+	if(canceled && return_code == SQL_ERROR) {
+		trace_done(return_code);
+		timed_out(timeout, except);
+		return return_code;
+	}
+	if(except) {
+		check(return_code);
+	}
+	else if(diagnose(return_code) != SQL_SUCCESS
+	     && return_code != SQL_SUCCESS_WITH_INFO) {
+		return return_code;
+	}
 
-	// some data may need to be copied...
-	rec.finalize();
+	if(f_query_active) {
+		if(f_query_rows == 0) {
+			f_query_first_row_time = stopwatch::now() - f_query_start;
+		}
+		f_query_rows += f_rows_fetched;
+	}
 
-	// it worked!
-	return true;
+	if(f_recording) {
+		record_rows();
+	}
+
+	return return_code;
 }
 
 
+/** \brief Compute the time limit of the next call.
+ *
+ * The timeout of the statement has priority. When not defined, the
+ * timeout of the connection is used.
+ *
+ * \return The time limit in nanoseconds, 0 if the call is not limited.
+ */
+SQLUBIGINT statement::call_timeout() const
+{
+	return f_timeout != 0 ? f_timeout : f_connection->f_timeout;
+}
 
 
-/** \var statement::f_connection
+/** \brief Report a call canceled by the watchdog.
  *
- * \brief A pointer to the parent connection.
+ * This function closes the cursor so the statement can be reused and
+ * reports an error with the ODBCPP_TIMEOUT code. The error of the
+ * driver, usually HY008 (operation canceled), is replaced.
  *
- * Each statement is created within a specific connection. This is
- * the pointer back to the parent connection.
+ * \param[in] timeout   The time limit of the call in nanoseconds
+ * \param[in] except    Whether the error is thrown or only saved in the diagnostic
+ *
+ * \exception odbcpp_error
+ * This function throws when \p except is true.
  */
+void statement::timed_out(SQLUBIGINT timeout, bool except)
+{
+#ifndef ODBCPP_NO_STATISTICS
+	f_statistics.add_timeout();
+	f_connection->f_statistics.add_timeout();
+#endif
 
-/** \var statement::f_has_data
+	std::ostringstream msg;
+	msg << "the call did not complete within " << timeout / 1000000 << " ms and was canceled";
+	diagnostic d(odbcpp_error::ODBCPP_TIMEOUT, msg.str());
+	set_diagnostic(d);
+
+	// the slow query log reports the timeout
+	f_has_data = false;
+	end_query(false);
+	reset_client_cursor();
+	f_recording.reset();
+
+	// the cursor may not be opened, ignore errors
+	trace(SQL_API_SQLFREESTMT);
+	trace_done(SQLFreeStmt(f_handle, SQL_CLOSE));
+
+	if(except) {
+		throw odbcpp_error(d);
+	}
+}
+
+
+/** \brief Fetch a row using the client side cursor.
  *
- * \brief Defines whether data is available.
+ * This function computes the position of the requested row. Rows that
+ * were already read are loaded back from the row store into the
+ * bound buffers. Rows that were not yet read are fetched forward
+ * from the driver and saved in the row store.
  *
- * This variable is set to true after each successful execute() call.
- * This enables the object to have a state and avoid fetching data
- * if the last execute failed or execute was not called.
+ * \param[in]     orientation   The direction for the offset
+ * \param[in]     offset        The offset used to move to that position to fetch
+ *
+ * \return true if the function fetched a row, false if the position is out of the result
+ *
+ * \exception odbcpp_error
+ * And odbcpp_error will be thrown if the SQL function returns an error,
+ * if the rowset size is not 1 or if the orientation is SQL_FETCH_BOOKMARK.
  */
+bool statement::client_fetch(SQLSMALLINT orientation, SQLLEN offset)
+{
+	if(f_rowset_size != 1) {
+		diagnostic d(odbcpp_error::ODBCPP_NOT_IMPLEMENTED, std::string("the client side cursor only supports a rowset size of 1"));
+		throw odbcpp_error(d);
+	}
 
-/** \var statement::f_no_direct_fetch
- *
- * \brief Defines whether SQLFetch() can be used.
+	SQLLEN target;
+	bool from_end = false;
+	switch(orientation) {
+	case SQL_FETCH_NEXT:
+		target = f_cursor_position + 1;
+		break;
+
+	case SQL_FETCH_PRIOR:
+		target = f_cursor_position - 1;
+		break;
+
+	case SQL_FETCH_FIRST:
+		target = 1;
+		break;
+
+	case SQL_FETCH_LAST:
+		target = -1;
+		from_end = true;
+		break;
+
+	case SQL_FETCH_ABSOLUTE:
+		target = offset;
+		from_end = offset < 0;
+		break;
+
+	case SQL_FETCH_RELATIVE:
+		target = f_cursor_position + offset;
+		break;
+
+	default:
+		diagnostic d(odbcpp_error::ODBCPP_NOT_IMPLEMENTED, std::string("the client side cursor does not support this fetch orientation"));
+		throw odbcpp_error(d);
+
+	}
+
+	// when the bound buffers hold the requested row we can avoid
+	// loading it back from the row store
+	SQLLEN fetched_row = 0;
+	if(from_end) {
+		// negative positions are from the end so we need all the rows
+		while(client_fetch_next()) {
+			fetched_row = f_row_store.size();
+		}
+		target += f_row_store.size() + 1;
+	}
+
+	if(target <= 0) {
+		// before the first row
+		f_cursor_position = 0;
+		return false;
+	}
+
+	while(static_cast<SQLULEN>(target) > f_row_store.size() && client_fetch_next()) {
+		fetched_row = f_row_store.size();
+	}
+
+	if(static_cast<SQLULEN>(target) > f_row_store.size()) {
+		// after the last row
+		f_cursor_position = f_row_store.size() + 1;
+		return false;
+	}
+
+	if(fetched_row != target) {
+		load_row(target - 1);
+	}
+	f_cursor_position = target;
+
+	return true;
+}
+
+
+/** \brief Read the next row from the driver for the client side cursor.
  *
- * This variable determines whether the SQLFetch() function can be used
- * or not. By default, the function is used if the orientation is set
- * to SQL_FETCH_NEXT.
+ * This function fetches the next row from the driver and saves it
+ * in the row store.
  *
- * There are cases when it is better to always use the SQLFetchScroll()
- * function. In these cases cann the set_no_direct_fetch() function to
- * avoid the SQLFetch() function altogether.
+ * \return true if a row was read, false once the result is exhausted.
+ */
+bool statement::client_fetch_next()
+{
+	if(f_cursor_drained) {
+		return false;
+	}
+	if(fetch_row(SQL_FETCH_NEXT, 0, true) == SQL_NO_DATA) {
+		f_cursor_drained = true;
+		return false;
+	}
+	save_row();
+	return true;
+}
+
+
+/** \brief Forget the rows of the client side cursor.
  *
- * \sa statement::set_no_direct_fetch()
+ * This function is called whenever the current result goes away.
+ */
+void statement::reset_client_cursor()
+{
+	f_row_store.clear();
+	f_cursor_position = 0;
+	f_cursor_drained = false;
+}
+
+
+/** \brief Save the bound buffers in the row store.
+ *
+ * This function saves the indicator and data of all the bound columns
+ * in the row store.
+ */
+void statement::save_row()
+{
+	build_row_image(0);
+	f_row_store.append(f_row_image.empty() ? NULL : &f_row_image[0], f_row_image.size());
+}
+
+
+/** \brief Load a row from the row store in the bound buffers.
+ *
+ * This function is the converse of save_row(). The bindings must not
+ * have changed since the row was saved.
+ *
+ * \param[in] row   The row number, starting at 0
+ */
+void statement::load_row(SQLULEN row)
+{
+	SQLULEN size;
+	load_row_image(f_row_store.get(row, size), 0);
+}
+
+
+/** \brief Copy a row of the bound buffers in f_row_image.
+ *
+ * This function saves the indicator and data of all the bound columns
+ * in f_row_image. Strings only use the number of bytes that were
+ * fetched and NULL columns only use their indicator.
+ *
+ * With a rowset size larger than 1, the buffers are arrays and
+ * \p index selects the row in the rowset.
+ *
+ * \param[in] index   The row in the rowset, starting at 0
+ */
+void statement::build_row_image(SQLULEN index)
+{
+	f_row_image.clear();
+
+	binding_vector_t::const_iterator itr(f_bindings.begin());
+	for(; itr != f_bindings.end(); ++itr) {
+		if(itr->f_data == NULL) {
+			continue;
+		}
+		SQLLEN indicator = itr->f_indicator == NULL ? itr->f_size : itr->f_indicator[index];
+		SQLLEN size = itr->f_size;
+		if(indicator == SQL_NULL_DATA) {
+			size = 0;
+		}
+		else if(itr->f_type == SQL_C_CHAR
+		     || itr->f_type == SQL_C_WCHAR
+		     || itr->f_type == SQL_C_BINARY) {
+			// keep the null terminator
+			SQLLEN used = indicator + static_cast<SQLLEN>(sizeof(SQLWCHAR));
+			if(indicator >= 0 && used < size) {
+				size = used;
+			}
+		}
+		const char *ind = reinterpret_cast<const char *>(&indicator);
+		f_row_image.insert(f_row_image.end(), ind, ind + sizeof(SQLLEN));
+		const char *data = reinterpret_cast<const char *>(itr->f_data) + index * itr->f_size;
+		f_row_image.insert(f_row_image.end(), data, data + size);
+	}
+}
+
+
+/** \brief Copy a row image in the bound buffers.
+ *
+ * This function is the converse of build_row_image(). The bindings
+ * must not have changed since the image was built.
+ *
+ * \param[in] image   The row image
+ * \param[in] index   The row in the rowset, starting at 0
+ */
+void statement::load_row_image(const char *image, SQLULEN index)
+{
+	binding_vector_t::const_iterator itr(f_bindings.begin());
+	for(; itr != f_bindings.end(); ++itr) {
+		if(itr->f_data == NULL) {
+			continue;
+		}
+		SQLLEN indicator;
+		memcpy(&indicator, image, sizeof(SQLLEN));
+		image += sizeof(SQLLEN);
+		if(itr->f_indicator != NULL) {
+			itr->f_indicator[index] = indicator;
+		}
+		SQLLEN bytes = itr->f_size;
+		if(indicator == SQL_NULL_DATA) {
+			bytes = 0;
+		}
+		else if(itr->f_type == SQL_C_CHAR
+		     || itr->f_type == SQL_C_WCHAR
+		     || itr->f_type == SQL_C_BINARY) {
+			SQLLEN used = indicator + static_cast<SQLLEN>(sizeof(SQLWCHAR));
+			if(indicator >= 0 && used < bytes) {
+				bytes = used;
+			}
+		}
+		memcpy(reinterpret_cast<char *>(itr->f_data) + index * itr->f_size, image, bytes);
+		image += bytes;
+	}
+}
+
+
+/** \brief Describe the current bindings.
+ *
+ * The row images depend on the type and size of the bound buffers.
+ * This function returns a string representing them so a cached
+ * result is only replayed with the bindings used to save it.
+ *
+ * \return The signature of the bindings.
+ */
+std::string statement::binding_signature() const
+{
+	std::string signature;
+	for(SQLULEN col = 0; col < f_bindings.size(); ++col) {
+		const binding_t& b(f_bindings[col]);
+		if(b.f_data == NULL) {
+			continue;
+		}
+		signature.append(reinterpret_cast<const char *>(&col), sizeof(col));
+		signature.append(reinterpret_cast<const char *>(&b.f_type), sizeof(b.f_type));
+		signature.append(reinterpret_cast<const char *>(&b.f_size), sizeof(b.f_size));
+		signature += b.f_indicator == NULL ? '0' : '1';
+	}
+	return signature;
+}
+
+
+/** \brief Verify that the cached result can be replayed.
+ *
+ * This function is called by the first fetch() of a cached result,
+ * once the record is bound. If the bindings differ from the bindings
+ * used to save the result, the query is executed instead.
+ */
+void statement::verify_replay()
+{
+	if(binding_signature() == f_replay->f_signature) {
+		f_replay_verified = true;
+		return;
+	}
+
+	// execute() changes the state of the statement, keep a copy of the order
+	std::string order(f_cache_key);
+	execute(order);
+}
+
+
+/** \brief Load the next rows of the cached result.
+ *
+ * This function replaces the call to the driver when the result
+ * comes from the result cache. It loads up to a rowset of rows in
+ * the bound buffers.
+ *
+ * \param[in] orientation   The direction of the fetch, only SQL_FETCH_NEXT is supported
+ *
+ * \return true if at least one row was loaded.
+ *
+ * \exception odbcpp_error
+ * An odbcpp_error is thrown if the orientation is not SQL_FETCH_NEXT.
+ * Use the client side cursor to scroll a cached result.
+ */
+bool statement::replay_rows(SQLSMALLINT orientation)
+{
+	if(orientation != SQL_FETCH_NEXT) {
+		diagnostic d(odbcpp_error::ODBCPP_NOT_IMPLEMENTED, std::string("a cached result can only be read forward, use the client side cursor to scroll it"));
+		throw odbcpp_error(d);
+	}
+
+	const SQLULEN rows = f_replay->rows();
+	f_rows_fetched = 0;
+	while(f_rows_fetched < f_rowset_size && f_replay_row < rows) {
+		load_row_image(f_replay->row(f_replay_row), f_rows_fetched);
+		++f_replay_row;
+		++f_rows_fetched;
+	}
+	return f_rows_fetched != 0;
+}
+
+
+/** \brief Save the rows of the last fetch in the recorded result.
+ *
+ * The recording stops when the result gets larger than the memory
+ * limit of the cache since it could not be inserted anyway.
+ */
+void statement::record_rows()
+{
+	for(SQLULEN idx = 0; idx < f_rows_fetched; ++idx) {
+		build_row_image(idx);
+		f_recording->append(f_row_image);
+	}
+
+	result_cache *cache = f_connection->get_result_cache();
+	if(cache == NULL || f_recording->f_data.size() > cache->get_memory_limit()) {
+		f_recording.reset();
+	}
+}
+
+
+/** \brief Insert the recorded result in the result cache.
+ *
+ * This function is called once the last row was fetched.
+ */
+void statement::end_recording()
+{
+	result_cache *cache = f_connection->get_result_cache();
+	if(cache != NULL) {
+		f_recording->f_signature = binding_signature();
+		cache->insert(f_cache_key, f_recording, f_cache_tags, f_cache_ttl);
+	}
+	f_recording.reset();
+}
+
+
+/** \brief Describe a column of the current result.
+ *
+ * This function calls SQLDescribeCol() on this statement and checks
+ * the result. The records use this function to find out the name,
+ * type and size of the columns they bind. When the result comes from
+ * the result cache, the saved description is returned instead.
+ *
+ * All the pointers, except \p col, can be NULL if the corresponding
+ * information is not necessary.
+ *
+ * \param[in] col               The column number, starting at 1
+ * \param[out] name             The buffer receiving the column name
+ * \param[in] name_size         The size of the \p name buffer
+ * \param[out] name_length      The length of the column name
+ * \param[out] type             The SQL type of the column
+ * \param[out] size             The size of the column
+ * \param[out] decimal_digits   The number of decimal digits
+ * \param[out] nullable         Whether the column can be NULL
+ *
+ * \exception odbcpp_error
+ * And odbcpp_error will be thrown if the SQL function returns an error.
+ */
+void statement::describe_col(SQLUSMALLINT col, SQLCHAR *name, SQLSMALLINT name_size, SQLSMALLINT *name_length,
+		SQLSMALLINT *type, SQLULEN *size, SQLSMALLINT *decimal_digits, SQLSMALLINT *nullable)
+{
+	if(f_replay) {
+		if(col == 0 || col > f_replay->f_columns.size()) {
+			diagnostic d(odbcpp_error::ODBCPP_NOT_FOUND, std::string("column number out of range in the cached result"));
+			throw odbcpp_error(d);
+		}
+		const cached_result_t::column_t& column(f_replay->f_columns[col - 1]);
+		if(name != NULL && name_size > 0) {
+			std::string::size_type length = std::min<std::string::size_type>(column.f_name.length(), name_size - 1);
+			memcpy(name, column.f_name.c_str(), length);
+			name[length] = '\0';
+		}
+		if(name_length != NULL) {
+			*name_length = static_cast<SQLSMALLINT>(column.f_name.length());
+		}
+		if(type != NULL) {
+			*type = column.f_type;
+		}
+		if(size != NULL) {
+			*size = column.f_size;
+		}
+		if(decimal_digits != NULL) {
+			*decimal_digits = column.f_decimal_digits;
+		}
+		if(nullable != NULL) {
+			*nullable = column.f_nullable;
+		}
+		return;
+	}
+
+#ifndef ODBCPP_NO_STATISTICS
+	f_statistics.add_describe();
+	f_connection->f_statistics.add_describe();
+#endif
+
+	trace(SQL_API_SQLDESCRIBECOL);
+	check(SQLDescribeCol(f_handle, col, name, name_size, name_length,
+				type, size, decimal_digits, nullable));
+}
+
+
+/** \brief Bind a buffer to a column of the result.
+ *
+ * This function calls SQLBindCol() on this statement and checks the
+ * result. The records use this function to bind their buffers.
+ *
+ * The statement remembers the bindings so the client side cursor can
+ * save and restore the rows.
+ *
+ * SQLBindCol() does not let us specify the precision and scale of an
+ * SQL_C_NUMERIC buffer and the driver defaults are not usable (the
+ * scale is usually 0 so the decimals are lost.) When \p type is
+ * SQL_C_NUMERIC and \p precision is not zero, the precision and scale
+ * are set in the application row descriptor.
+ *
+ * \param[in] col         The column number, starting at 1 (0 for the bookmark)
+ * \param[in] type        The C type of the buffer
+ * \param[in] data        The buffer
+ * \param[in] size        The size of the buffer in bytes
+ * \param[in] indicator   The length/indicator buffer
+ * \param[in] precision   The precision of an SQL_C_NUMERIC buffer
+ * \param[in] scale       The scale of an SQL_C_NUMERIC buffer
+ *
+ * \exception odbcpp_error
+ * And odbcpp_error will be thrown if the SQL function returns an error
+ * or the client side cursor already saved rows with other bindings.
+ */
+void statement::bind_col(SQLUSMALLINT col, SQLSMALLINT type, SQLPOINTER data, SQLLEN size, SQLLEN *indicator,
+		SQLSMALLINT precision, SQLSMALLINT scale)
+{
+	if(f_row_store.size() != 0) {
+		diagnostic d(odbcpp_error::ODBCPP_INCORRECT_USE, std::string("columns cannot be bound while the client side cursor holds rows"));
+		throw odbcpp_error(d);
+	}
+
+	trace(SQL_API_SQLBINDCOL);
+	check(SQLBindCol(f_handle, col, type, data, size, indicator));
+
+	if(type == SQL_C_NUMERIC && precision > 0) {
+		SQLHDESC ard;
+		trace(SQL_API_SQLGETSTMTATTR);
+		check(SQLGetStmtAttr(f_handle, SQL_ATTR_APP_ROW_DESC, &ard, 0, NULL));
+
+		// changing the type resets the pointers so they are set last
+		set_desc_field(ard, col, SQL_DESC_TYPE, int_to_ptr(SQL_C_NUMERIC));
+		set_desc_field(ard, col, SQL_DESC_PRECISION, int_to_ptr(precision));
+		set_desc_field(ard, col, SQL_DESC_SCALE, int_to_ptr(scale));
+		set_desc_field(ard, col, SQL_DESC_DATA_PTR, data);
+		set_desc_field(ard, col, SQL_DESC_INDICATOR_PTR, indicator);
+		set_desc_field(ard, col, SQL_DESC_OCTET_LENGTH_PTR, indicator);
+	}
+
+	if(col >= f_bindings.size()) {
+		f_bindings.resize(col + 1);
+	}
+	binding_t& b(f_bindings[col]);
+	b.f_type = type;
+	b.f_data = data;
+	b.f_size = size;
+	b.f_indicator = indicator;
+}
+
+
+/** \brief Unbind all the columns of this statement.
+ *
+ * This function calls SQLFreeStmt() with SQL_UNBIND so the driver
+ * forgets all the buffers bound with bind_col() and clears the list
+ * of bindings of the statement.
+ *
+ * The records call this function before binding their buffers and
+ * when they get unbound or moved to another statement. This way the
+ * statement never keeps pointers to buffers that a record may release
+ * or reallocate, and the columns of a previous record with more
+ * columns do not remain bound.
+ *
+ * When rows were already recorded for the result cache, they were
+ * saved with the previous bindings so the recording is abandoned.
+ *
+ * \exception odbcpp_error
+ * And odbcpp_error will be thrown if the SQL function returns an error.
+ */
+void statement::unbind_cols()
+{
+	f_bindings.clear();
+	f_bound_record = NULL;
+	if(f_recording && f_recording->rows() != 0) {
+		f_recording.reset();
+	}
+
+	trace(SQL_API_SQLFREESTMT);
+	check(SQLFreeStmt(f_handle, SQL_UNBIND));
+}
+
+
+/** \brief Set a field of a descriptor of this statement.
+ *
+ * The driver posts the errors of SQLSetDescField() on the descriptor,
+ * not on the statement, so the diagnostic is read from \p desc.
+ *
+ * \param[in] desc    The descriptor handle (i.e. the ARD of the statement)
+ * \param[in] col     The record number, the column number for the ARD
+ * \param[in] field   The field identifier (SQL_DESC_...)
+ * \param[in] value   The new value of the field
+ *
+ * \exception odbcpp_error
+ * And odbcpp_error will be thrown if the SQL function returns an error.
+ */
+void statement::set_desc_field(SQLHDESC desc, SQLSMALLINT col, SQLSMALLINT field, SQLPOINTER value)
+{
+	trace(SQL_API_SQLSETDESCFIELD);
+	SQLRETURN return_code = SQLSetDescField(desc, col, field, value, 0);
+	trace_done(return_code);
+	if(return_code != SQL_SUCCESS && return_code != SQL_SUCCESS_WITH_INFO) {
+		diagnostic d(SQL_HANDLE_DESC, desc);
+		set_diagnostic(d);
+		throw odbcpp_error(d);
+	}
+}
+
+
+/** \brief Use a client side cursor.
+ *
+ * Scrolling through a result requires a scrollable cursor (i.e.
+ * SQL_CURSOR_DYNAMIC) which is expensive on the server side or not
+ * supported by some drivers. With a client side cursor, the statement
+ * only reads rows forward and saves them in a row store. The
+ * fetch() orientations SQL_FETCH_PRIOR, SQL_FETCH_FIRST,
+ * SQL_FETCH_LAST, SQL_FETCH_ABSOLUTE and SQL_FETCH_RELATIVE are then
+ * served from the row store. Rows that were not read yet are read
+ * from the driver as required (SQL_FETCH_LAST reads them all.)
+ *
+ * The rows are kept in memory. When \p memory_limit is not 0, rows
+ * over that limit are written to a temporary file.
+ *
+ * The client side cursor works with a rowset size of 1 and the record
+ * cannot be bound again until the next execute().
+ *
+ * Call this function before execute().
+ *
+ * \param[in] client_cursor   Whether the client side cursor is used
+ * \param[in] memory_limit    The number of bytes kept in memory, 0 for no limit
+ */
+void statement::set_client_cursor(bool client_cursor, SQLULEN memory_limit)
+{
+	reset_client_cursor();
+	f_client_cursor = client_cursor;
+	f_row_store.set_memory_limit(memory_limit);
+}
+
+
+/** \fn statement::get_client_cursor() const
+ *
+ * \brief Check whether the client side cursor is used.
+ *
+ * \return true if set_client_cursor() turned the client side cursor on.
+ */
+
+
+/** \fn statement::set_timeout(SQLUBIGINT timeout)
+ *
+ * \brief Limit the duration of the calls to the driver.
+ *
+ * Each call to execute() and each fetch from the driver has to
+ * complete within \p timeout nanoseconds. Otherwise the watchdog
+ * cancels it and an odbcpp_error with the ODBCPP_TIMEOUT code and
+ * the HYT00 state is thrown. The statement can then be used again.
+ *
+ * The limit applies to each call separately, not to the whole
+ * query.
+ *
+ * \param[in] timeout   The time limit in nanoseconds, 0 to use the timeout of the connection
+ *
+ * \sa connection::set_timeout()
+ */
+
+/** \fn statement::get_timeout() const
+ *
+ * \brief Retrieve the time limit of the calls to the driver.
+ *
+ * \return The time limit in nanoseconds, 0 if the timeout of the connection is used.
+ */
+
+
+/** \fn statement::get_statistics() const
+ *
+ * \brief Retrieve a snapshot of the statement statistics.
+ *
+ * This function returns a copy of the performance statistics
+ * gathered by this statement since it was created or since
+ * the last call to reset_statistics().
+ *
+ * \return A copy of the statement statistics.
+ *
+ * \sa reset_statistics()
+ * \sa connection::get_statistics()
+ */
+
+/** \fn statement::reset_statistics()
+ *
+ * \brief Reset the statement statistics.
+ *
+ * This function resets all the counters and histograms of this
+ * statement. The connection statistics are not affected.
+ */
+
+/** \brief Count bytes copied from the column buffers.
+ *
+ * The records call this function each time they copy data from
+ * their internal buffers to the user variables.
+ *
+ * \param[in] bytes   The number of bytes copied
+ */
+void statement::add_bytes_copied(SQLULEN bytes)
+{
+#ifndef ODBCPP_NO_STATISTICS
+	f_statistics.add_bytes_copied(bytes);
+	f_connection->f_statistics.add_bytes_copied(bytes);
+#else
+	(void) bytes;
+#endif
+}
+
+
+/** \brief Add the time spent binding a record.
+ *
+ * The records call this function each time they get bound to
+ * this statement.
+ *
+ * \param[in] ns   The number of nanoseconds spent binding
+ */
+void statement::add_bind_time(SQLUBIGINT ns)
+{
+#ifndef ODBCPP_NO_STATISTICS
+	f_statistics.add_bind_time(ns);
+	f_connection->f_statistics.add_bind_time(ns);
+#else
+	(void) ns;
+#endif
+}
+
+
+
+
+/** \var statement::f_connection
+ *
+ * \brief A pointer to the parent connection.
+ *
+ * Each statement is created within a specific connection. This is
+ * the pointer back to the parent connection.
+ */
+
+/** \var statement::f_has_data
+ *
+ * \brief Defines whether data is available.
+ *
+ * This variable is set to true after each successful execute() call.
+ * This enables the object to have a state and avoid fetching data
+ * if the last execute failed or execute was not called.
+ */
+
+/** \var statement::f_no_direct_fetch
+ *
+ * \brief Defines whether SQLFetch() can be used.
+ *
+ * This variable determines whether the SQLFetch() function can be used
+ * or not. By default, the function is used if the orientation is set
+ * to SQL_FETCH_NEXT.
+ *
+ * There are cases when it is better to always use the SQLFetchScroll()
+ * function. In these cases cann the set_no_direct_fetch() function to
+ * avoid the SQLFetch() function altogether.
+ *
+ * \sa statement::set_no_direct_fetch()
+ */
+
+/** \var statement::f_rowset_size
+ *
+ * \brief The number of rows read by each fetch.
+ *
+ * This is the value of the SQL_ATTR_ROW_ARRAY_SIZE attribute as
+ * set with set_rowset_size().
+ */
+
+/** \var statement::f_rows_fetched
+ *
+ * \brief The number of rows read by the last fetch.
+ *
+ * When the rowset size is larger than 1, the driver saves the number
+ * of rows fetched in this variable (SQL_ATTR_ROWS_FETCHED_PTR).
+ */
+
+/** \var statement::f_bindings
+ *
+ * \brief The buffers bound to the columns, by column number.
+ *
+ * This vector is updated by bind_col() and cleared by unbind_cols().
+ * It is used by the client side cursor to save and restore rows.
+ */
+
+/** \var statement::f_bound_record
+ *
+ * \brief The record whose buffers are bound to this statement.
+ *
+ * This pointer is set by the record_base::bind() and rebind() functions
+ * and reset by unbind_cols(). A record only unbinds the columns of its
+ * statement when it still is the record bound to it. The pointer is
+ * only compared, never dereferenced.
+ */
+
+/** \var statement::f_timeout
+ *
+ * \brief The time limit of the calls to the driver in nanoseconds.
+ *
+ * When 0, the timeout of the connection is used.
+ */
+
+/** \var statement::f_client_cursor
+ *
+ * \brief Whether the client side cursor is used.
+ */
+
+/** \var statement::f_row_store
+ *
+ * \brief The rows read by the client side cursor.
+ */
+
+/** \var statement::f_cursor_position
+ *
+ * \brief The current position of the client side cursor.
+ *
+ * The first row is 1. The position is 0 before the first row and
+ * the number of rows plus one after the last row.
+ */
+
+/** \var statement::f_cursor_drained
+ *
+ * \brief Whether the client side cursor read all the rows from the driver.
+ */
+
+/** \var statement::f_row_image
+ *
+ * \brief A buffer used to build the image of a row.
+ */
+
+/** \var statement::f_cache_key
+ *
+ * \brief The SQL order passed to execute_cached().
+ */
+
+/** \var statement::f_cache_tags
+ *
+ * \brief The tags of the result being recorded.
+ */
+
+/** \var statement::f_cache_ttl
+ *
+ * \brief The time to live of the result being recorded.
+ */
+
+/** \var statement::f_replay
+ *
+ * \brief The cached result being replayed, if any.
+ */
+
+/** \var statement::f_replay_row
+ *
+ * \brief The next row of the cached result to load.
+ */
+
+/** \var statement::f_replay_verified
+ *
+ * \brief Whether the bindings were verified against the cached result.
+ */
+
+/** \var statement::f_recording
+ *
+ * \brief The result being saved for the result cache, if any.
+ */
+
+/** \var statement::f_statistics
+ *
+ * \brief The performance statistics of this statement.
+ *
+ * This variable holds the counters and histograms gathered by this
+ * statement. Use get_statistics() to retrieve a copy.
+ */
+
+/** \var statement::f_query_active
+ *
+ * \brief Whether the current query is measured for the slow query log.
+ *
+ * This flag is set by execute() when the connection slow query log
+ * is active. It is reset by end_query().
+ */
+
+/** \var statement::f_query_sql
+ *
+ * \brief A copy of the SQL order of the current query.
+ *
+ * The buffer of this string is reused from one query to the next.
+ */
+
+/** \var statement::f_query_start
+ *
+ * \brief The time when execute() was called.
+ */
+
+/** \var statement::f_query_execute_time
+ *
+ * \brief The time spent in SQLExecDirect() for the current query.
+ */
+
+/** \var statement::f_query_first_row_time
+ *
+ * \brief The time from execute() to the first row fetched.
+ */
+
+/** \var statement::f_query_rows
+ *
+ * \brief The number of rows fetched by the current query.
  */
 
 
@@ -0,0 +1,767 @@
+//
+// File:	src/statistics.cpp
+// Object:	Implementation of the performance statistics objects
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/statistics.h"
+#if !defined(_MSC_VER) && !defined(WIN32)
+#include	<time.h>
+#endif
+
+
+namespace odbcpp
+{
+
+
+namespace
+{
+
+/// The minimum of an empty histogram, larger than any sample
+const SQLUBIGINT	NO_MINIMUM = static_cast<SQLUBIGINT>(-1);
+
+
+/** \brief Lower an atomic value.
+ *
+ * This function sets \p value to \p ns if \p ns is smaller. Other
+ * threads may update \p value at the same time.
+ *
+ * \param[in,out] value   The value to lower
+ * \param[in] ns          The new candidate
+ */
+inline void atomic_minimum(std::atomic<SQLUBIGINT>& value, SQLUBIGINT ns)
+{
+	SQLUBIGINT current = value.load(std::memory_order_relaxed);
+	while(ns < current && !value.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {
+		// current was reloaded, try again
+	}
+}
+
+
+/** \brief Raise an atomic value.
+ *
+ * This function sets \p value to \p ns if \p ns is larger. Other
+ * threads may update \p value at the same time.
+ *
+ * \param[in,out] value   The value to raise
+ * \param[in] ns          The new candidate
+ */
+inline void atomic_maximum(std::atomic<SQLUBIGINT>& value, SQLUBIGINT ns)
+{
+	SQLUBIGINT current = value.load(std::memory_order_relaxed);
+	while(ns > current && !value.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {
+		// current was reloaded, try again
+	}
+}
+
+}	// no name namespace
+
+
+/** \class stopwatch
+ *
+ * \brief Measure elapsed time in nanoseconds.
+ *
+ * This class is used to time the different ODBC calls. The
+ * constructor saves the current time and the elapsed() function
+ * returns the number of nanoseconds since then.
+ *
+ * The clock is monotonic so changing the system time does not
+ * affect the measurements.
+ */
+
+/** \fn stopwatch::stopwatch()
+ *
+ * \brief Start the stopwatch.
+ *
+ * The constructor saves the current time as the start time.
+ */
+
+/** \fn stopwatch::restart()
+ *
+ * \brief Restart the stopwatch.
+ *
+ * This function resets the start time to now.
+ */
+
+/** \fn stopwatch::elapsed() const
+ *
+ * \brief Return the time elapsed since the start.
+ *
+ * \return The number of nanoseconds since the stopwatch was started.
+ */
+
+/** \var stopwatch::f_start
+ *
+ * \brief The time when the stopwatch was started.
+ *
+ * This value is a time in nanoseconds as returned by the
+ * stopwatch::now() function.
+ */
+
+
+/** \brief Get the current monotonic time.
+ *
+ * This function returns the current time in nanoseconds. The time
+ * is not related to the wall clock and is only useful to compute
+ * durations.
+ *
+ * \return The current time in nanoseconds.
+ */
+SQLUBIGINT stopwatch::now()
+{
+#if defined(_MSC_VER) || defined(WIN32)
+	LARGE_INTEGER	counter;
+	static LARGE_INTEGER	frequency = { 0 };
+
+	if(frequency.QuadPart == 0) {
+		QueryPerformanceFrequency(&frequency);
+	}
+	QueryPerformanceCounter(&counter);
+
+	// avoid an overflow by separating the seconds from the rest
+	SQLUBIGINT seconds = counter.QuadPart / frequency.QuadPart;
+	SQLUBIGINT rest = counter.QuadPart % frequency.QuadPart;
+	return seconds * 1000000000ULL + rest * 1000000000ULL / frequency.QuadPart;
+#else
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<SQLUBIGINT>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+
+
+
+/** \class histogram
+ *
+ * \brief A latency histogram.
+ *
+ * This class counts durations in buckets of increasing size. Bucket
+ * number i counts durations from 2^i to 2^(i+1) - 1 nanoseconds. The
+ * last bucket also counts all the durations that are larger.
+ *
+ * Adding a sample is a few integer operations and it never allocates
+ * memory so it can be used in the fetch loop.
+ *
+ * The histogram also keeps the number of samples, the total, the
+ * minimum and the maximum durations.
+ *
+ * The values are relaxed atomics so several threads can add samples
+ * to the same histogram (i.e. the statements of one connection.) A
+ * copy is a snapshot which may only include part of the samples
+ * being added while it is made.
+ */
+
+
+/** \brief Initialize an empty histogram.
+ *
+ * This function initializes the histogram with no samples.
+ */
+histogram::histogram()
+{
+	reset();
+}
+
+
+/** \brief Copy a histogram.
+ *
+ * This function takes a snapshot of \p h.
+ *
+ * \param[in] h   The histogram to copy
+ */
+histogram::histogram(const histogram& h)
+{
+	*this = h;
+}
+
+
+/** \brief Copy a histogram.
+ *
+ * This function replaces the samples of this histogram with a
+ * snapshot of the samples of \p h.
+ *
+ * \param[in] h   The histogram to copy
+ *
+ * \return A reference to this histogram.
+ */
+histogram& histogram::operator = (const histogram& h)
+{
+	f_count.store(h.f_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	f_total.store(h.f_total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	f_minimum.store(h.f_minimum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	f_maximum.store(h.f_maximum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	for(int idx = 0; idx < HISTOGRAM_BUCKETS; ++idx) {
+		f_buckets[idx].store(h.f_buckets[idx].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+
+	return *this;
+}
+
+
+/** \brief Reset the histogram.
+ *
+ * This function removes all the samples from the histogram.
+ */
+void histogram::reset()
+{
+	f_count.store(0, std::memory_order_relaxed);
+	f_total.store(0, std::memory_order_relaxed);
+	f_minimum.store(NO_MINIMUM, std::memory_order_relaxed);
+	f_maximum.store(0, std::memory_order_relaxed);
+	for(int idx = 0; idx < HISTOGRAM_BUCKETS; ++idx) {
+		f_buckets[idx].store(0, std::memory_order_relaxed);
+	}
+}
+
+
+/** \brief Add a sample to the histogram.
+ *
+ * This function adds a duration to the histogram.
+ *
+ * \param[in] ns   The duration in nanoseconds
+ */
+void histogram::add(SQLUBIGINT ns)
+{
+	atomic_minimum(f_minimum, ns);
+	atomic_maximum(f_maximum, ns);
+	f_count.fetch_add(1, std::memory_order_relaxed);
+	f_total.fetch_add(ns, std::memory_order_relaxed);
+
+	// the bucket is the position of the most significant bit
+	int idx = 0;
+	while(ns > 1 && idx < HISTOGRAM_BUCKETS - 1) {
+		ns >>= 1;
+		++idx;
+	}
+	f_buckets[idx].fetch_add(1, std::memory_order_relaxed);
+}
+
+
+/** \brief Add the samples of another histogram to this histogram.
+ *
+ * This function adds all the samples of \p h to this histogram.
+ *
+ * \param[in] h   The histogram to merge in this histogram
+ */
+void histogram::merge(const histogram& h)
+{
+	if(h.count() == 0) {
+		return;
+	}
+	atomic_minimum(f_minimum, h.f_minimum.load(std::memory_order_relaxed));
+	atomic_maximum(f_maximum, h.maximum());
+	f_count.fetch_add(h.count(), std::memory_order_relaxed);
+	f_total.fetch_add(h.total(), std::memory_order_relaxed);
+	for(int idx = 0; idx < HISTOGRAM_BUCKETS; ++idx) {
+		f_buckets[idx].fetch_add(h.bucket(idx), std::memory_order_relaxed);
+	}
+}
+
+
+/** \brief Estimate a percentile.
+ *
+ * This function returns the upper bound of the bucket that includes
+ * the specified percentile. The result is capped by the maximum
+ * duration seen.
+ *
+ * \param[in] p   The percentile, between 0.0 and 1.0 (i.e. 0.99 for p99)
+ *
+ * \return The estimated duration in nanoseconds, 0 if the histogram is empty
+ */
+SQLUBIGINT histogram::percentile(double p) const
+{
+	SQLUBIGINT samples = count();
+	if(samples == 0) {
+		return 0;
+	}
+
+	SQLUBIGINT maximum_ns = maximum();
+	SQLUBIGINT limit = static_cast<SQLUBIGINT>(p * static_cast<double>(samples));
+	if(limit == 0) {
+		limit = 1;
+	}
+	SQLUBIGINT sum = 0;
+	for(int idx = 0; idx < HISTOGRAM_BUCKETS; ++idx) {
+		sum += bucket(idx);
+		if(sum >= limit) {
+			SQLUBIGINT upper = (2ULL << idx) - 1;
+			return upper < maximum_ns ? upper : maximum_ns;
+		}
+	}
+
+	return maximum_ns;
+}
+
+
+/** \fn histogram::count() const
+ *
+ * \brief Retrieve the number of samples.
+ *
+ * \return The number of durations added to this histogram.
+ */
+
+/** \fn histogram::total() const
+ *
+ * \brief Retrieve the sum of all the samples.
+ *
+ * \return The total duration in nanoseconds.
+ */
+
+/** \brief Retrieve the smallest sample.
+ *
+ * \return The smallest duration in nanoseconds, 0 if empty.
+ */
+SQLUBIGINT histogram::minimum() const
+{
+	SQLUBIGINT minimum_ns = f_minimum.load(std::memory_order_relaxed);
+	return minimum_ns == NO_MINIMUM ? 0 : minimum_ns;
+}
+
+/** \fn histogram::maximum() const
+ *
+ * \brief Retrieve the largest sample.
+ *
+ * \return The largest duration in nanoseconds, 0 if empty.
+ */
+
+/** \fn histogram::bucket(int idx) const
+ *
+ * \brief Retrieve the number of samples in a bucket.
+ *
+ * \param[in] idx   The bucket number, from 0 to HISTOGRAM_BUCKETS - 1
+ *
+ * \return The number of durations from 2^idx to 2^(idx+1) - 1 nanoseconds.
+ */
+
+
+
+
+/** \class statistics_t
+ *
+ * \brief The performance statistics of a statement or connection.
+ *
+ * This structure holds the counters and latency histograms gathered
+ * by the statement and the connection objects. A copy is returned
+ * by statement::get_statistics() and connection::get_statistics()
+ * so you can read it without interfering with the library.
+ *
+ * The counters are relaxed atomics. A statement is used by one
+ * thread at a time, but the statements of a connection may be used
+ * by different threads and they all update the statistics of the
+ * connection. The add_...() functions are used to update them. A
+ * copy is a snapshot which may only include part of the calls made
+ * while it is taken.
+ *
+ * Define ODBCPP_NO_STATISTICS in odbcpp_config.h to remove the
+ * gathering of the statistics altogether.
+ */
+
+
+/** \brief Initialize the statistics.
+ *
+ * All the counters are set to zero.
+ */
+statistics_t::statistics_t() :
+	f_executes(0),
+	f_fetches(0),
+	f_rows_fetched(0),
+	f_bytes_copied(0),
+	f_describes(0),
+	f_timeouts(0)
+	//f_execute_time -- auto-init
+	//f_fetch_time -- auto-init
+	//f_bind_time -- auto-init
+{
+}
+
+
+/** \brief Copy the statistics.
+ *
+ * This function takes a snapshot of \p stats.
+ *
+ * \param[in] stats   The statistics to copy
+ */
+statistics_t::statistics_t(const statistics_t& stats) :
+	f_executes(stats.f_executes.load(std::memory_order_relaxed)),
+	f_fetches(stats.f_fetches.load(std::memory_order_relaxed)),
+	f_rows_fetched(stats.f_rows_fetched.load(std::memory_order_relaxed)),
+	f_bytes_copied(stats.f_bytes_copied.load(std::memory_order_relaxed)),
+	f_describes(stats.f_describes.load(std::memory_order_relaxed)),
+	f_timeouts(stats.f_timeouts.load(std::memory_order_relaxed)),
+	f_execute_time(stats.f_execute_time),
+	f_fetch_time(stats.f_fetch_time),
+	f_bind_time(stats.f_bind_time)
+{
+}
+
+
+/** \brief Copy the statistics.
+ *
+ * This function replaces these statistics with a snapshot of \p stats.
+ *
+ * \param[in] stats   The statistics to copy
+ *
+ * \return A reference to these statistics.
+ */
+statistics_t& statistics_t::operator = (const statistics_t& stats)
+{
+	f_executes.store(stats.f_executes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	f_fetches.store(stats.f_fetches.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	f_rows_fetched.store(stats.f_rows_fetched.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	f_bytes_copied.store(stats.f_bytes_copied.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	f_describes.store(stats.f_describes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	f_timeouts.store(stats.f_timeouts.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	f_execute_time = stats.f_execute_time;
+	f_fetch_time = stats.f_fetch_time;
+	f_bind_time = stats.f_bind_time;
+
+	return *this;
+}
+
+
+/** \brief Reset the statistics.
+ *
+ * All the counters and histograms are reset to zero.
+ */
+void statistics_t::reset()
+{
+	f_executes.store(0, std::memory_order_relaxed);
+	f_fetches.store(0, std::memory_order_relaxed);
+	f_rows_fetched.store(0, std::memory_order_relaxed);
+	f_bytes_copied.store(0, std::memory_order_relaxed);
+	f_describes.store(0, std::memory_order_relaxed);
+	f_timeouts.store(0, std::memory_order_relaxed);
+	f_execute_time.reset();
+	f_fetch_time.reset();
+	f_bind_time.reset();
+}
+
+
+/** \brief Add the statistics of another object.
+ *
+ * This function adds the counters and histograms of \p stats
+ * to this statistics object.
+ *
+ * \param[in] stats   The statistics to add
+ */
+void statistics_t::merge(const statistics_t& stats)
+{
+	f_executes.fetch_add(stats.f_executes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	f_fetches.fetch_add(stats.f_fetches.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	f_rows_fetched.fetch_add(stats.f_rows_fetched.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	f_bytes_copied.fetch_add(stats.f_bytes_copied.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	f_describes.fetch_add(stats.f_describes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	f_timeouts.fetch_add(stats.f_timeouts.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	f_execute_time.merge(stats.f_execute_time);
+	f_fetch_time.merge(stats.f_fetch_time);
+	f_bind_time.merge(stats.f_bind_time);
+}
+
+
+/** \brief Count an execution.
+ *
+ * \param[in] ns   The time SQLExecDirect() took in nanoseconds
+ */
+void statistics_t::add_execute(SQLUBIGINT ns)
+{
+	f_executes.fetch_add(1, std::memory_order_relaxed);
+	f_execute_time.add(ns);
+}
+
+
+/** \brief Count a fetch.
+ *
+ * \param[in] ns     The time the fetch took in nanoseconds
+ * \param[in] rows   The number of rows returned by the fetch
+ */
+void statistics_t::add_fetch(SQLUBIGINT ns, SQLUBIGINT rows)
+{
+	f_fetches.fetch_add(1, std::memory_order_relaxed);
+	f_fetch_time.add(ns);
+	if(rows != 0) {
+		f_rows_fetched.fetch_add(rows, std::memory_order_relaxed);
+	}
+}
+
+
+/** \brief Count bytes copied to the user strings.
+ *
+ * \param[in] bytes   The number of bytes copied
+ */
+void statistics_t::add_bytes_copied(SQLUBIGINT bytes)
+{
+	f_bytes_copied.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+
+/** \brief Count a call to SQLDescribeCol().
+ */
+void statistics_t::add_describe()
+{
+	f_describes.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+/** \brief Count a call canceled by the watchdog.
+ */
+void statistics_t::add_timeout()
+{
+	f_timeouts.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+/** \brief Count the binding of a record.
+ *
+ * \param[in] ns   The time the binding took in nanoseconds
+ */
+void statistics_t::add_bind_time(SQLUBIGINT ns)
+{
+	f_bind_time.add(ns);
+}
+
+
+/** \var statistics_t::f_executes
+ *
+ * \brief The number of SQL orders executed.
+ */
+
+/** \var statistics_t::f_fetches
+ *
+ * \brief The number of calls to fetch(), including the last one returning no data.
+ */
+
+/** \var statistics_t::f_rows_fetched
+ *
+ * \brief The number of rows read by fetch().
+ */
+
+/** \var statistics_t::f_bytes_copied
+ *
+ * \brief The number of bytes copied from the column buffers to the user strings.
+ */
+
+/** \var statistics_t::f_describes
+ *
+ * \brief The number of calls to SQLDescribeCol().
+ */
+
+/** \var statistics_t::f_timeouts
+ *
+ * \brief The number of calls canceled by the watchdog.
+ */
+
+/** \var statistics_t::f_execute_time
+ *
+ * \brief The time spent in SQLExecDirect().
+ */
+
+/** \var statistics_t::f_fetch_time
+ *
+ * \brief The time spent in SQLFetch() and SQLFetchScroll().
+ */
+
+/** \var statistics_t::f_bind_time
+ *
+ * \brief The time spent binding records to the statement.
+ */
+
+
+
+
+/** \class connect_statistics_t
+ *
+ * \brief The connection statistics of an environment.
+ *
+ * This structure holds the counters and latency histograms of the
+ * connections made in an environment. A copy is returned by
+ * environment::get_connect_statistics().
+ *
+ * When the driver manager pools the connections, a connection taken
+ * from the pool is much faster than a new one. The connections that
+ * took less than the reuse threshold of the environment are counted
+ * as reused.
+ *
+ * \sa environment::set_reuse_threshold()
+ */
+
+
+/** \brief Initialize the connection statistics.
+ *
+ * All the counters are set to zero.
+ */
+connect_statistics_t::connect_statistics_t() :
+	f_connects(0),
+	f_reused(0),
+	f_disconnects(0)
+	//f_connect_time -- auto-init
+	//f_disconnect_time -- auto-init
+{
+}
+
+
+/** \brief Reset the connection statistics.
+ *
+ * All the counters and histograms are reset to zero.
+ */
+void connect_statistics_t::reset()
+{
+	f_connects = 0;
+	f_reused = 0;
+	f_disconnects = 0;
+	f_connect_time.reset();
+	f_disconnect_time.reset();
+}
+
+
+/** \var connect_statistics_t::f_connects
+ *
+ * \brief The number of successful connections.
+ */
+
+/** \var connect_statistics_t::f_reused
+ *
+ * \brief The number of connections faster than the reuse threshold.
+ *
+ * These connections were most certainly taken from the pool of the
+ * driver manager. The other connections were new connections.
+ */
+
+/** \var connect_statistics_t::f_disconnects
+ *
+ * \brief The number of disconnections.
+ */
+
+/** \var connect_statistics_t::f_connect_time
+ *
+ * \brief The time spent in SQLConnect() and SQLDriverConnect().
+ */
+
+/** \var connect_statistics_t::f_disconnect_time
+ *
+ * \brief The time spent in SQLDisconnect().
+ */
+
+
+
+
+/** \class cache_statistics_t
+ *
+ * \brief The statistics of a result cache.
+ *
+ * This structure holds the counters of a result cache. A copy is
+ * returned by result_cache::get_statistics().
+ *
+ * \sa result_cache
+ */
+
+
+/** \brief Initialize the cache statistics.
+ *
+ * All the counters are set to zero.
+ */
+cache_statistics_t::cache_statistics_t() :
+	f_hits(0),
+	f_misses(0),
+	f_expired(0),
+	f_insertions(0),
+	f_evictions(0),
+	f_invalidations(0),
+	f_entries(0),
+	f_memory(0)
+{
+}
+
+
+/** \brief Reset the cache statistics.
+ *
+ * All the counters are reset to zero. The number of entries and
+ * the memory are not counters and are not modified.
+ */
+void cache_statistics_t::reset()
+{
+	f_hits = 0;
+	f_misses = 0;
+	f_expired = 0;
+	f_insertions = 0;
+	f_evictions = 0;
+	f_invalidations = 0;
+}
+
+
+/** \brief Compute the hit ratio.
+ *
+ * \return The number of hits divided by the number of lookups, 0.0 if no lookup happened.
+ */
+double cache_statistics_t::hit_ratio() const
+{
+	const SQLUBIGINT lookups = f_hits + f_misses;
+	if(lookups == 0) {
+		return 0.0;
+	}
+	return static_cast<double>(f_hits) / static_cast<double>(lookups);
+}
+
+
+/** \var cache_statistics_t::f_hits
+ *
+ * \brief The number of lookups that found a valid entry.
+ */
+
+/** \var cache_statistics_t::f_misses
+ *
+ * \brief The number of lookups that did not find a valid entry.
+ *
+ * This includes the lookups of entries that had expired.
+ */
+
+/** \var cache_statistics_t::f_expired
+ *
+ * \brief The number of entries removed because their time to live was over.
+ */
+
+/** \var cache_statistics_t::f_insertions
+ *
+ * \brief The number of results saved in the cache.
+ */
+
+/** \var cache_statistics_t::f_evictions
+ *
+ * \brief The number of entries removed to stay under the memory limit.
+ */
+
+/** \var cache_statistics_t::f_invalidations
+ *
+ * \brief The number of entries removed by result_cache::invalidate().
+ */
+
+/** \var cache_statistics_t::f_entries
+ *
+ * \brief The number of entries currently in the cache.
+ */
+
+/** \var cache_statistics_t::f_memory
+ *
+ * \brief The number of bytes currently used by the entries.
+ */
+
+
+
+}	// namespace odbcpp
@@ -0,0 +1,415 @@
+//
+// File:	src/transaction.cpp
+// Object:	Implementation of the transaction runner
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/transaction.h"
+#include	<chrono>
+#include	<thread>
+
+
+namespace odbcpp
+{
+
+
+/** \class transaction_runner
+ *
+ * \brief Run a transaction again when it fails with a transient error.
+ *
+ * Serialization failures and deadlocks are expected under contention:
+ * the database aborts one of the transactions which succeeds when run
+ * again. Similarly, a transaction interrupted by a dropped connection
+ * can be run again on a new connection.
+ *
+ * The runner calls the transaction function, then commits. When an
+ * odbcpp_error is raised, the transaction is rolled back and the
+ * error is classified with its SQLSTATE:
+ *
+ * \li ERROR_RETRY -- 40001 (serialization failure) and 40P01 (deadlock)
+ * \li ERROR_RECONNECT -- 08001, 08003, 08006, 08007 and 08S01 (connection errors)
+ * \li ERROR_FATAL -- all the other errors
+ *
+ * Use set_error_class() to change these. The transaction is run again
+ * after a random delay which doubles with each attempt (exponential
+ * backoff with full jitter) so the transactions that conflicted do
+ * not all retry at the same time. The runner gives up and rethrows the
+ * error after the maximum number of attempts or once the time budget
+ * would be exceeded.
+ *
+ * \code
+ * transaction_runner runner(conn, reconnect_sales);
+ * runner.run(transfer_funds(from, to, amount));
+ * \endcode
+ *
+ * Connection errors are only retried when a reconnect function is
+ * given. The connection is then disconnected and the reconnect function
+ * is called before the next attempt. The statements used by the
+ * transaction must be created by the transaction function since the
+ * statements of the previous connection cannot be used anymore.
+ *
+ * The transaction function may be called several times so it must
+ * not have side effects other than on the database.
+ */
+
+
+/** \brief Initialize a transaction runner.
+ *
+ * The runner makes up to 5 attempts, waits up to 10 ms after the first
+ * failure, at most 1 s between attempts, and gives up after 30 s.
+ *
+ * \param[in] conn        The connection running the transactions
+ * \param[in] reconnect   The function connecting \p conn, may be empty
+ */
+transaction_runner::transaction_runner(connection& conn, const connect_t& reconnect) :
+	f_connection(&conn),
+	f_reconnect(reconnect),
+	f_max_attempts(5),
+	f_initial_backoff(10000000ULL),
+	f_max_backoff(1000000000ULL),
+	f_budget(30000000000ULL),
+	//f_states -- auto-init
+	f_random(stopwatch::now() ^ reinterpret_cast<uintptr_t>(this)),
+	f_reset(false),
+	f_attempts(0),
+	f_retries(0),
+	f_reconnects(0)
+{
+	f_states["40001"] = ERROR_RETRY;	// serialization failure
+	f_states["40P01"] = ERROR_RETRY;	// deadlock detected (PostgreSQL)
+	f_states["08001"] = ERROR_RECONNECT;	// unable to connect
+	f_states["08003"] = ERROR_RECONNECT;	// connection not open
+	f_states["08006"] = ERROR_RECONNECT;	// connection failure (PostgreSQL)
+	f_states["08007"] = ERROR_RECONNECT;	// connection failure during transaction
+	f_states["08S01"] = ERROR_RECONNECT;	// communication link failure
+}
+
+
+/** \brief Define the delays between attempts.
+ *
+ * The delay after the first failure is a random value between 0 and
+ * \p initial. The upper limit doubles with each attempt, up to
+ * \p maximum.
+ *
+ * \param[in] initial   The upper limit of the first delay in nanoseconds
+ * \param[in] maximum   The upper limit of all the delays in nanoseconds
+ */
+void transaction_runner::set_backoff(SQLUBIGINT initial, SQLUBIGINT maximum)
+{
+	f_initial_backoff = initial;
+	f_max_backoff = maximum < initial ? initial : maximum;
+}
+
+
+/** \brief Define how the errors with a given SQLSTATE are handled.
+ *
+ * \param[in] state         The SQLSTATE, i.e. "40001"
+ * \param[in] error_class   How these errors are handled
+ */
+void transaction_runner::set_error_class(const std::string& state, error_class_t error_class)
+{
+	f_states[state] = error_class;
+}
+
+
+/** \brief Classify an error.
+ *
+ * The class of the first diagnostic record with a known SQLSTATE is
+ * returned.
+ *
+ * \param[in] e   The error to classify
+ *
+ * \return The class of the error, ERROR_FATAL if none of its SQLSTATEs is known.
+ */
+transaction_runner::error_class_t transaction_runner::classify(const odbcpp_error& e) const
+{
+	const diagnostic d(e.get());
+	for(SQLSMALLINT record = 1; record <= d.size(); ++record) {
+		state_map_t::const_iterator itr(f_states.find(d.get(record).f_odbc_state));
+		if(itr != f_states.end()) {
+			return itr->second;
+		}
+	}
+	return ERROR_FATAL;
+}
+
+
+/** \brief Run a transaction.
+ *
+ * This function calls \p transaction and commits until it succeeds,
+ * an error that cannot be retried is raised, the maximum number of
+ * attempts is reached, or the next delay would exceed the time budget.
+ *
+ * Auto-commit is turned off during the transaction and back on once
+ * done.
+ *
+ * \param[in] transaction   The function running the transaction
+ *
+ * \exception odbcpp_error
+ * The last error is rethrown when the transaction does not succeed.
+ * Other exceptions raised by \p transaction are rethrown right away.
+ */
+void transaction_runner::run(const transaction_t& transaction)
+{
+	stopwatch sw;
+	for(SQLULEN retry = 0;; ++retry) {
+		SQLUBIGINT delay;
+		try {
+			if(f_reset) {
+				reset_connection();
+			}
+			attempt(transaction);
+			return;
+		}
+		catch(const odbcpp_error& e) {
+			error_class_t error_class = classify(e);
+			if(error_class == ERROR_RECONNECT && !f_reconnect) {
+				error_class = ERROR_FATAL;
+			}
+			if(error_class == ERROR_FATAL || retry + 1 >= f_max_attempts) {
+				throw;
+			}
+			delay = backoff(retry);
+			if(f_budget != 0 && sw.elapsed() + delay > f_budget) {
+				throw;
+			}
+			if(error_class == ERROR_RECONNECT) {
+				f_reset = true;
+			}
+		}
+
+		++f_retries;
+		std::this_thread::sleep_for(std::chrono::nanoseconds(delay));
+	}
+}
+
+
+/** \brief Run the transaction once.
+ *
+ * \param[in] transaction   The function running the transaction
+ */
+void transaction_runner::attempt(const transaction_t& transaction)
+{
+	++f_attempts;
+	f_connection->set_attr(SQL_ATTR_AUTOCOMMIT, static_cast<SQLINTEGER>(SQL_AUTOCOMMIT_OFF));
+	try {
+		transaction(*f_connection);
+		f_connection->commit();
+	}
+	catch(...) {
+		rollback();
+		throw;
+	}
+	f_connection->set_attr(SQL_ATTR_AUTOCOMMIT, static_cast<SQLINTEGER>(SQL_AUTOCOMMIT_ON));
+}
+
+
+/** \brief Roll back a failed transaction.
+ *
+ * The errors are ignored since the connection may be lost.
+ */
+void transaction_runner::rollback()
+{
+	try {
+		f_connection->rollback();
+		f_connection->set_attr(SQL_ATTR_AUTOCOMMIT, static_cast<SQLINTEGER>(SQL_AUTOCOMMIT_ON));
+	}
+	catch(const odbcpp_error&) {
+	}
+}
+
+
+/** \brief Connect again after a connection error.
+ *
+ * The connection is disconnected, ignoring errors, and the reconnect
+ * function is called. If it fails, the next attempt tries again.
+ */
+void transaction_runner::reset_connection()
+{
+	if(f_connection->is_connected()) {
+		try {
+			f_connection->disconnect();
+		}
+		catch(const odbcpp_error&) {
+		}
+	}
+	++f_reconnects;
+	f_reconnect(*f_connection);
+	f_reset = false;
+}
+
+
+/** \brief Compute the delay before the next attempt.
+ *
+ * \param[in] retry   The number of retries so far
+ *
+ * \return A random delay in nanoseconds.
+ */
+SQLUBIGINT transaction_runner::backoff(SQLULEN retry)
+{
+	SQLUBIGINT limit = f_initial_backoff;
+	for(; retry > 0 && limit < f_max_backoff; --retry) {
+		limit *= 2;
+	}
+	if(limit > f_max_backoff) {
+		limit = f_max_backoff;
+	}
+	std::uniform_int_distribution<SQLUBIGINT> delay(0, limit);
+	return delay(f_random);
+}
+
+
+/** \typedef transaction_runner::transaction_t
+ *
+ * \brief A function running the statements of a transaction.
+ *
+ * The function receives the connection on which the statements have
+ * to be created. It must not commit.
+ */
+
+/** \typedef transaction_runner::connect_t
+ *
+ * \brief A function connecting a connection.
+ *
+ * Usually a call to connection::connect() or connection::connect_string().
+ */
+
+/** \typedef transaction_runner::state_map_t
+ *
+ * \brief The classes of the errors by SQLSTATE.
+ */
+
+/** \fn transaction_runner::set_max_attempts(SQLULEN max_attempts)
+ *
+ * \brief Define the maximum number of attempts.
+ *
+ * \param[in] max_attempts   The number of times the transaction can be run
+ */
+
+/** \fn transaction_runner::get_max_attempts() const
+ *
+ * \brief Retrieve the maximum number of attempts.
+ *
+ * \return The number of times the transaction can be run.
+ */
+
+/** \fn transaction_runner::set_budget(SQLUBIGINT budget)
+ *
+ * \brief Define the maximum duration of run().
+ *
+ * run() does not wait before another attempt if the delay would end
+ * after \p budget. The duration of the attempts is not limited; use
+ * connection::set_timeout() for that purpose.
+ *
+ * \param[in] budget   The time budget in nanoseconds, 0 for no limit
+ */
+
+/** \fn transaction_runner::get_budget() const
+ *
+ * \brief Retrieve the maximum duration of run().
+ *
+ * \return The time budget in nanoseconds.
+ */
+
+/** \fn transaction_runner::attempts() const
+ *
+ * \brief Retrieve the number of times a transaction was run.
+ *
+ * \return The number of attempts of all the calls to run().
+ */
+
+/** \fn transaction_runner::retries() const
+ *
+ * \brief Retrieve the number of times a transaction was run again.
+ *
+ * \return The number of retries of all the calls to run().
+ */
+
+/** \fn transaction_runner::reconnects() const
+ *
+ * \brief Retrieve the number of times the connection was reset.
+ *
+ * \return The number of calls to the reconnect function.
+ */
+
+/** \var transaction_runner::f_connection
+ *
+ * \brief The connection running the transactions.
+ */
+
+/** \var transaction_runner::f_reconnect
+ *
+ * \brief The function connecting the connection after a connection error.
+ */
+
+/** \var transaction_runner::f_max_attempts
+ *
+ * \brief The maximum number of attempts per transaction.
+ */
+
+/** \var transaction_runner::f_initial_backoff
+ *
+ * \brief The upper limit of the first delay in nanoseconds.
+ */
+
+/** \var transaction_runner::f_max_backoff
+ *
+ * \brief The upper limit of the delays in nanoseconds.
+ */
+
+/** \var transaction_runner::f_budget
+ *
+ * \brief The maximum duration of run() in nanoseconds, 0 for no limit.
+ */
+
+/** \var transaction_runner::f_states
+ *
+ * \brief The classes of the errors by SQLSTATE.
+ */
+
+/** \var transaction_runner::f_random
+ *
+ * \brief The generator of the delays.
+ */
+
+/** \var transaction_runner::f_reset
+ *
+ * \brief Whether the connection has to be reset before the next attempt.
+ */
+
+/** \var transaction_runner::f_attempts
+ *
+ * \brief The number of attempts.
+ */
+
+/** \var transaction_runner::f_retries
+ *
+ * \brief The number of retries.
+ */
+
+/** \var transaction_runner::f_reconnects
+ *
+ * \brief The number of times the connection was reset.
+ */
+
+
+
+}	// namespace odbcpp
+
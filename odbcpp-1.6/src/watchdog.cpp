@@ -0,0 +1,282 @@
+//
+// File:	src/watchdog.cpp
+// Object:	Implementation of the query watchdog
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+
+#include	"odbcpp/watchdog.h"
+#include	"odbcpp/handle.h"
+#include	"odbcpp/statistics.h"
+#include	<chrono>
+
+
+namespace odbcpp
+{
+
+
+/** \class watchdog
+ *
+ * \brief Cancel the calls that run past their deadline.
+ *
+ * The statements with a timeout (see statement::set_timeout() and
+ * connection::set_timeout()) arm the watchdog before calling
+ * SQLExecDirect(), SQLFetch() or SQLFetchScroll() and disarm it
+ * once the call returns. When a call is still running at its
+ * deadline, the watchdog calls SQLCancel() on the statement from its
+ * own thread. The driver then returns an error which the statement
+ * reports as an odbcpp_error with the ODBCPP_TIMEOUT code.
+ *
+ * This works with all the drivers that support SQLCancel() from
+ * another thread, whether or not they support SQL_ATTR_QUERY_TIMEOUT.
+ *
+ * There is one watchdog per process. Its thread is started with the
+ * first call to arm().
+ */
+
+
+/** \brief Retrieve the watchdog.
+ *
+ * \return The watchdog of the process.
+ */
+watchdog& watchdog::instance()
+{
+	static watchdog dog;
+	return dog;
+}
+
+
+/** \brief Initialize the watchdog.
+ *
+ * The thread is only started by arm().
+ */
+watchdog::watchdog() :
+	//f_mutex -- auto-init
+	//f_condition -- auto-init
+	//f_cancelled -- auto-init
+	//f_entries -- auto-init
+	//f_deadlines -- auto-init
+	f_next_ticket(0),
+	f_cancellations(0),
+	f_stop(false)
+	//f_thread -- auto-init
+{
+}
+
+
+/** \brief Stop the watchdog thread.
+ */
+watchdog::~watchdog()
+{
+	{
+		std::lock_guard<std::mutex> lock(f_mutex);
+		f_stop = true;
+	}
+	f_condition.notify_one();
+	if(f_thread.joinable()) {
+		f_thread.join();
+	}
+}
+
+
+/** \brief Watch a call.
+ *
+ * This function registers the statement handle of a call that is
+ * about to start. If disarm() is not called within \p timeout
+ * nanoseconds, the watchdog calls SQLCancel() on \p stmt.
+ *
+ * \param[in] stmt      The handle of the statement
+ * \param[in] timeout   The maximum duration of the call in nanoseconds
+ *
+ * \return The ticket to pass to disarm().
+ */
+watchdog::ticket_t watchdog::arm(SQLHSTMT stmt, SQLUBIGINT timeout)
+{
+	const SQLUBIGINT deadline = stopwatch::now() + timeout;
+
+	bool wakeup;
+	ticket_t ticket;
+	{
+		std::lock_guard<std::mutex> lock(f_mutex);
+		if(!f_thread.joinable()) {
+			f_thread = std::thread(&watchdog::run, this);
+		}
+		ticket = ++f_next_ticket;
+		entry_t& entry(f_entries[ticket]);
+		entry.f_handle = stmt;
+		entry.f_fired = false;
+		entry.f_cancelling = false;
+		entry.f_deadline = f_deadlines.insert(deadline_map_t::value_type(deadline, ticket));
+		// only wake up the thread if it waits for a later deadline
+		wakeup = entry.f_deadline == f_deadlines.begin();
+	}
+	if(wakeup) {
+		f_condition.notify_one();
+	}
+
+	return ticket;
+}
+
+
+/** \brief Stop watching a call.
+ *
+ * This function is called once the call returned. Once it returns,
+ * the watchdog does not use the statement handle anymore: when the
+ * watchdog is calling SQLCancel() on this call, this function waits
+ * for SQLCancel() to return.
+ *
+ * \param[in] ticket   The ticket returned by arm()
+ *
+ * \return true if the watchdog canceled the call.
+ */
+bool watchdog::disarm(ticket_t ticket)
+{
+	std::unique_lock<std::mutex> lock(f_mutex);
+	entry_map_t::iterator itr(f_entries.find(ticket));
+	if(itr == f_entries.end()) {
+		return false;
+	}
+	// the entry cannot be erased by anyone else, itr remains valid
+	while(itr->second.f_cancelling) {
+		f_cancelled.wait(lock);
+	}
+	bool fired = itr->second.f_fired;
+	if(!fired) {
+		f_deadlines.erase(itr->second.f_deadline);
+	}
+	f_entries.erase(itr);
+	return fired;
+}
+
+
+/** \brief Retrieve the number of calls canceled.
+ *
+ * \return The number of times the watchdog called SQLCancel().
+ */
+SQLUBIGINT watchdog::cancellations() const
+{
+	std::lock_guard<std::mutex> lock(f_mutex);
+	return f_cancellations;
+}
+
+
+/** \brief The watchdog thread.
+ *
+ * This function sleeps until the next deadline and cancels the
+ * calls that are still running.
+ *
+ * SQLCancel() is called with the mutex unlocked so the other calls
+ * can be armed and disarmed while the driver cancels the statement.
+ * The entry is marked as being canceled in the meantime so disarm()
+ * waits and the statement cannot be freed before SQLCancel() returns.
+ */
+void watchdog::run()
+{
+	std::unique_lock<std::mutex> lock(f_mutex);
+	while(!f_stop) {
+		if(f_deadlines.empty()) {
+			f_condition.wait(lock);
+			continue;
+		}
+		deadline_map_t::iterator first(f_deadlines.begin());
+		SQLUBIGINT now = stopwatch::now();
+		if(first->first > now) {
+			f_condition.wait_for(lock, std::chrono::nanoseconds(first->first - now));
+			continue;
+		}
+
+		const ticket_t ticket = first->second;
+		entry_t& entry(f_entries[ticket]);
+		entry.f_fired = true;
+		entry.f_cancelling = true;
+		f_deadlines.erase(first);
+		++f_cancellations;
+		SQLHSTMT handle = entry.f_handle;
+
+		lock.unlock();
+		trace_call call(SQL_HANDLE_STMT, handle, SQL_API_SQLCANCEL);
+		call.done(SQLCancel(handle));
+		lock.lock();
+
+		// disarm() waited for us so the entry still exists
+		f_entries[ticket].f_cancelling = false;
+		f_cancelled.notify_all();
+	}
+}
+
+
+/** \typedef watchdog::deadline_map_t
+ *
+ * \brief The tickets sorted by deadline, in nanoseconds.
+ */
+
+/** \typedef watchdog::entry_map_t
+ *
+ * \brief The calls being watched, by ticket.
+ */
+
+/** \var watchdog::f_mutex
+ *
+ * \brief The mutex protecting the watchdog.
+ */
+
+/** \var watchdog::f_condition
+ *
+ * \brief The condition used to wake up the thread on a new deadline.
+ */
+
+/** \var watchdog::f_cancelled
+ *
+ * \brief The condition used to wake up disarm() once SQLCancel() returned.
+ */
+
+/** \var watchdog::f_entries
+ *
+ * \brief The calls being watched.
+ */
+
+/** \var watchdog::f_deadlines
+ *
+ * \brief The deadlines of the calls that were not canceled yet.
+ */
+
+/** \var watchdog::f_next_ticket
+ *
+ * \brief The last ticket returned by arm().
+ */
+
+/** \var watchdog::f_cancellations
+ *
+ * \brief The number of calls canceled.
+ */
+
+/** \var watchdog::f_stop
+ *
+ * \brief Whether the thread has to exit.
+ */
+
+/** \var watchdog::f_thread
+ *
+ * \brief The thread canceling the calls.
+ */
+
+
+
+}	// namespace odbcpp
+
@@ -0,0 +1,419 @@
+//
+// File:	tests/datetime.cpp
+// Object:	Verify the date and timestamp conversions
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+//
+//
+// IMPORTANT NOTE:
+//
+// This test does not need a database. It verifies the conversions of
+// datetime.h against known dates, walks every day of the years -32768
+// to 32767 in both directions, and compares the array conversions,
+// with and without NULL rows, to the conversions of one value.
+//
+// datetime [-v]
+//
+
+#include	"odbcpp/odbcpp.h"
+#include	"odbcpp/datetime.h"
+#include	<iostream>
+#include	<cstring>
+#include	<cstdlib>
+#include	<cstdio>
+#include	<vector>
+
+
+const char	*progname;
+bool		verbose = false;
+unsigned long	g_errors = 0;
+
+void usage()
+{
+	std::cerr << "odbcpp:test: datetime v" << odbcpp::get_version() << "\n";
+	std::cerr << "Usage: " << progname << " [-opts]\n";
+	std::cerr << "where -opts is one of the following:\n";
+	std::cerr << "   -h     print out this help screen\n";
+	std::cerr << "   -l     print out license information\n";
+	std::cerr << "   -v     print out the name of each check\n";
+	exit(1);
+}
+
+
+void license()
+{
+	std::cerr << "odbcpp::datetime  Copyright (C) 2008  Made to Order Software Corporation\n";
+	std::cerr << "This program comes with ABSOLUTELY NO WARRANTY.\n";
+	std::cerr << "This is free software, and you are welcome to redistribute it under\n";
+	std::cerr << "certain conditions.\n";
+	std::cerr << "Read the COPYING file accompagnying the odbcpp project for more information.\n";
+#ifdef _MSC_VER
+	std::cerr << "\nType return to close the window.\n";
+	getchar();
+#endif
+	exit(1);
+}
+
+
+/** \brief Report an error.
+ *
+ * Only the first 20 errors are printed.
+ *
+ * \param[in] msg   The description of the error
+ */
+void error(const std::string& msg)
+{
+	if(++g_errors <= 20) {
+		std::cerr << progname << ":error: " << msg << "\n";
+	}
+}
+
+
+std::string date_string(const SQL_DATE_STRUCT& date)
+{
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%d-%02d-%02d", date.year, date.month, date.day);
+	return buf;
+}
+
+
+std::string timestamp_string(const SQL_TIMESTAMP_STRUCT& t)
+{
+	char buf[96];
+	snprintf(buf, sizeof(buf), "%d-%02d-%02d %02d:%02d:%02d.%09u",
+			t.year, t.month, t.day, t.hour, t.minute, t.second, static_cast<unsigned>(t.fraction));
+	return buf;
+}
+
+
+bool same_date(const SQL_DATE_STRUCT& a, const SQL_DATE_STRUCT& b)
+{
+	return a.year == b.year && a.month == b.month && a.day == b.day;
+}
+
+
+bool same_timestamp(const SQL_TIMESTAMP_STRUCT& a, const SQL_TIMESTAMP_STRUCT& b)
+{
+	return a.year == b.year && a.month == b.month && a.day == b.day
+		&& a.hour == b.hour && a.minute == b.minute && a.second == b.second
+		&& a.fraction == b.fraction;
+}
+
+
+/** \brief Check dates which number of days is known.
+ *
+ * The values were computed with the proleptic Gregorian calendar of
+ * another implementation. The year 0 is a leap year.
+ */
+void check_known_dates()
+{
+	struct known_t {
+		SQLSMALLINT	f_year;
+		SQLUSMALLINT	f_month;
+		SQLUSMALLINT	f_day;
+		SQLINTEGER	f_days;
+	};
+	static const known_t known[] = {
+		{  1970,  1,  1,         0 },
+		{  1969, 12, 31,        -1 },
+		{  2000,  2, 28,     11015 },
+		{  2000,  2, 29,     11016 },	// leap day of a 400th year
+		{  2000,  3,  1,     11017 },
+		{  1900,  2, 28,    -25509 },	// 1900 is not a leap year
+		{  1900,  3,  1,    -25508 },
+		{  2100,  3,  1,     47541 },
+		{  1600,  2, 29,   -135081 },
+		{     1,  1,  1,   -719162 },
+		{     0,  3,  1,   -719468 },	// start of the era 0
+		{     0,  2, 29,   -719469 },
+		{     0,  1,  1,   -719528 },
+		{    -1, 12, 31,   -719529 },
+		{  9999, 12, 31,   2932896 },
+		{ -32768, 1,  1, -12687794 }
+	};
+
+	if(verbose) {
+		std::cout << "known dates\n";
+	}
+	for(size_t idx = 0; idx < sizeof(known) / sizeof(known[0]); ++idx) {
+		SQL_DATE_STRUCT date;
+		date.year = known[idx].f_year;
+		date.month = known[idx].f_month;
+		date.day = known[idx].f_day;
+		SQLINTEGER days = odbcpp::date_to_epoch_days(date);
+		if(days != known[idx].f_days) {
+			char buf[32];
+			snprintf(buf, sizeof(buf), "%ld", static_cast<long>(days));
+			error(date_string(date) + " converted to " + buf);
+		}
+		SQL_DATE_STRUCT back;
+		odbcpp::epoch_days_to_date(known[idx].f_days, back);
+		if(!same_date(date, back)) {
+			error(date_string(date) + " converted back to " + date_string(back));
+		}
+	}
+}
+
+
+/** \brief Walk every day of the SQLSMALLINT years.
+ *
+ * The dates are incremented one day at a time with the usual leap
+ * year rules and compared with a counter of days in both directions.
+ */
+void check_all_days()
+{
+	static const SQLUSMALLINT month_days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+	if(verbose) {
+		std::cout << "all the days of the years -32768 to 32767\n";
+	}
+	SQL_DATE_STRUCT date = { -32768, 1, 1 };
+	SQLINTEGER days = odbcpp::date_to_epoch_days(date);
+	for(;;) {
+		if(odbcpp::date_to_epoch_days(date) != days) {
+			error(date_string(date) + " is not the day after the previous date");
+		}
+		SQL_DATE_STRUCT back;
+		odbcpp::epoch_days_to_date(days, back);
+		if(!same_date(date, back)) {
+			error(date_string(date) + " converted back to " + date_string(back));
+		}
+		if(date.year == 32767 && date.month == 12 && date.day == 31) {
+			break;
+		}
+
+		const int year = date.year;
+		const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+		if(++date.day > month_days[date.month - 1] + (date.month == 2 && leap)) {
+			date.day = 1;
+			if(++date.month > 12) {
+				date.month = 1;
+				++date.year;
+			}
+		}
+		++days;
+	}
+}
+
+
+/** \brief Check timestamps around the epoch and at the limits.
+ *
+ * A 64 bit number of nanoseconds covers 1677-09-21 00:12:43.145224192
+ * to 2262-04-11 23:47:16.854775807.
+ */
+void check_timestamps()
+{
+	struct known_t {
+		SQL_TIMESTAMP_STRUCT	f_timestamp;
+		SQLBIGINT		f_ns;
+	};
+	static const known_t known[] = {
+		{ { 1970,  1,  1,  0,  0,  0,         0 }, 0LL },
+		{ { 1970,  1,  1,  0,  0,  0,         1 }, 1LL },
+		{ { 1969, 12, 31, 23, 59, 59, 999999999 }, -1LL },
+		{ { 1969, 12, 31,  0,  0,  0,         0 }, -86400000000000LL },
+		{ { 1900,  3,  1, 12, 30, 15, 500000000 }, -2203846184500000000LL },
+		{ { 2000,  2, 29, 23, 59, 59, 999999999 }, 951868799999999999LL },
+		{ { 1677,  9, 21,  0, 12, 43, 145224192 }, -9223372036854775807LL - 1 },
+		{ { 2262,  4, 11, 23, 47, 16, 854775807 }, 9223372036854775807LL }
+	};
+
+	if(verbose) {
+		std::cout << "known timestamps\n";
+	}
+	for(size_t idx = 0; idx < sizeof(known) / sizeof(known[0]); ++idx) {
+		const SQL_TIMESTAMP_STRUCT& timestamp(known[idx].f_timestamp);
+		SQLBIGINT ns = odbcpp::timestamp_to_epoch_ns(timestamp);
+		if(ns != known[idx].f_ns) {
+			char buf[32];
+			snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(ns));
+			error(timestamp_string(timestamp) + " converted to " + buf);
+		}
+		SQL_TIMESTAMP_STRUCT back;
+		odbcpp::epoch_ns_to_timestamp(known[idx].f_ns, back);
+		if(!same_timestamp(timestamp, back)) {
+			error(timestamp_string(timestamp) + " converted back to " + timestamp_string(back));
+		}
+	}
+
+	// a prime step visits all the times of the day over the range
+	if(verbose) {
+		std::cout << "timestamps from 1678 to 2261\n";
+	}
+	const SQLBIGINT step = 86399999999971LL;
+	const SQLBIGINT period = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::duration(1)).count();
+	for(SQLBIGINT ns = -9223372036854775807LL + step; ns < 9223372036854775807LL - step; ns += step) {
+		SQL_TIMESTAMP_STRUCT timestamp;
+		odbcpp::epoch_ns_to_timestamp(ns, timestamp);
+		if(odbcpp::timestamp_to_epoch_ns(timestamp) != ns) {
+			error(timestamp_string(timestamp) + " does not round trip");
+		}
+		std::chrono::system_clock::time_point tp(odbcpp::timestamp_to_time_point(timestamp));
+		SQL_TIMESTAMP_STRUCT from_tp;
+		odbcpp::time_point_to_timestamp(tp, from_tp);
+		// the system clock may be less precise than a nanosecond
+		const SQLBIGINT diff = odbcpp::timestamp_to_epoch_ns(from_tp) - ns;
+		if(diff <= -period || diff >= period) {
+			error(timestamp_string(timestamp) + " does not round trip through a time point");
+		}
+	}
+}
+
+
+/** \brief Compare the array conversions with the single conversions.
+ *
+ * One row in three is NULL. The count is not a multiple of a vector
+ * size so the tail of the loops is verified too.
+ */
+void check_arrays()
+{
+	if(verbose) {
+		std::cout << "array conversions\n";
+	}
+	const SQLULEN count = 1001;
+	std::vector<SQL_DATE_STRUCT> dates(count);
+	std::vector<SQL_TIMESTAMP_STRUCT> timestamps(count);
+	std::vector<SQLLEN> indicators(count);
+	SQLULEN defined = 0;
+	for(SQLULEN idx = 0; idx < count; ++idx) {
+		const SQLINTEGER days = static_cast<SQLINTEGER>(idx * 977) - 400000;
+		odbcpp::epoch_days_to_date(days, dates[idx]);
+		odbcpp::epoch_ns_to_timestamp(static_cast<SQLBIGINT>(days / 6) * 86400000000000LL + static_cast<SQLBIGINT>(idx) * 7919000013LL, timestamps[idx]);
+		indicators[idx] = idx % 3 == 1 ? SQL_NULL_DATA : 0;
+		defined += idx % 3 != 1;
+	}
+	// the NULL rows may include anything
+	dates[1].month = 0;
+	dates[4].day = 99;
+	timestamps[1].month = 13;
+
+	std::vector<SQLINTEGER> days(count);
+	if(odbcpp::dates_to_epoch_days(&dates[0], 0, count, &days[0]) != count) {
+		error("dates_to_epoch_days() without indicators did not return the count");
+	}
+	for(SQLULEN idx = 0; idx < count; ++idx) {
+		if(idx % 3 != 1 && days[idx] != odbcpp::date_to_epoch_days(dates[idx])) {
+			error("dates_to_epoch_days() without indicators converted " + date_string(dates[idx]) + " differently");
+		}
+	}
+	if(odbcpp::dates_to_epoch_days(&dates[0], &indicators[0], count, &days[0], -99) != defined) {
+		error("dates_to_epoch_days() did not return the number of rows that are not NULL");
+	}
+	for(SQLULEN idx = 0; idx < count; ++idx) {
+		SQLINTEGER expected = idx % 3 == 1 ? -99 : odbcpp::date_to_epoch_days(dates[idx]);
+		if(days[idx] != expected) {
+			error("dates_to_epoch_days() converted " + date_string(dates[idx]) + " differently");
+		}
+	}
+
+	std::vector<SQL_DATE_STRUCT> back_dates(count);
+	odbcpp::epoch_days_to_dates(&days[0], &indicators[0], count, &back_dates[0]);
+	for(SQLULEN idx = 0; idx < count; ++idx) {
+		if(idx % 3 == 1) {
+			if(back_dates[idx].year != 0 || back_dates[idx].month != 0 || back_dates[idx].day != 0) {
+				error("epoch_days_to_dates() did not clear a NULL row");
+			}
+		}
+		else if(!same_date(back_dates[idx], dates[idx])) {
+			error("epoch_days_to_dates() converted " + date_string(dates[idx]) + " back to " + date_string(back_dates[idx]));
+		}
+	}
+
+	std::vector<SQLBIGINT> ns(count);
+	if(odbcpp::timestamps_to_epoch_ns(&timestamps[0], &indicators[0], count, &ns[0], -1) != defined) {
+		error("timestamps_to_epoch_ns() did not return the number of rows that are not NULL");
+	}
+	for(SQLULEN idx = 0; idx < count; ++idx) {
+		SQLBIGINT expected = idx % 3 == 1 ? -1 : odbcpp::timestamp_to_epoch_ns(timestamps[idx]);
+		if(ns[idx] != expected) {
+			error("timestamps_to_epoch_ns() converted " + timestamp_string(timestamps[idx]) + " differently");
+		}
+	}
+
+	std::vector<SQL_TIMESTAMP_STRUCT> back_timestamps(count);
+	odbcpp::epoch_ns_to_timestamps(&ns[0], &indicators[0], count, &back_timestamps[0]);
+	for(SQLULEN idx = 0; idx < count; ++idx) {
+		if(idx % 3 == 1) {
+			if(back_timestamps[idx].year != 0 || back_timestamps[idx].month != 0 || back_timestamps[idx].fraction != 0) {
+				error("epoch_ns_to_timestamps() did not clear a NULL row");
+			}
+		}
+		else if(!same_timestamp(back_timestamps[idx], timestamps[idx])) {
+			error("epoch_ns_to_timestamps() converted " + timestamp_string(timestamps[idx])
+					+ " back to " + timestamp_string(back_timestamps[idx]));
+		}
+	}
+}
+
+
+int main(int argc, char *argv[])
+{
+	progname = strrchr(argv[0], '/');
+	if(progname == 0) {
+		progname = argv[0];
+	}
+	else {
+		++progname;
+	}
+
+	for(int i = 1; i < argc; ++i) {
+		if(argv[i][0] != '-') {
+			std::cerr << argv[0] << ":error: this test does not take any parameter; try -h.\n";
+			exit(1);
+		}
+		switch(argv[i][1]) {
+		case 'h':
+			usage();
+			break;
+
+		case 'l':
+			license();
+			break;
+
+		case 'v':
+			verbose = true;
+			break;
+
+		default:
+			std::cerr << argv[0] << ":error: unrecognized option \"-" << argv[i][1] << "\".\n";
+			exit(1);
+
+		}
+		if(argv[i][2]) {
+			std::cerr << argv[0] << ":error: multi-option not supported; try -h.\n";
+			exit(1);
+		}
+	}
+
+	check_known_dates();
+	check_all_days();
+	check_timestamps();
+	check_arrays();
+
+	if(g_errors != 0) {
+		std::cerr << progname << ":error: " << g_errors << " conversions failed.\n";
+		return 1;
+	}
+	std::cout << "all the conversions are correct\n";
+
+	return 0;
+}
+
+// vim: ts=8 sw=8
@@ -0,0 +1,283 @@
+//
+// File:	tests/fetch-alloc.cpp
+// Object:	Verify that fetching rows does not allocate memory
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+//
+//
+// IMPORTANT NOTE:
+//
+// This test runs the SQL order twice, once with a record binding all
+// the columns as strings and once with a dynamic record. After the
+// first row, the fetches must not allocate any memory. The allocations
+// are counted with a replacement of the global operator new, so the
+// allocations made by the driver with malloc() are not counted.
+//
+// Use a SELECT returning several rows with strings of various lengths,
+// for instance with the table of the record test:
+//
+// fetch-alloc <dsn> <login> <password> "SELECT * FROM odbcpp"
+//
+
+#include	"odbcpp/odbcpp.h"
+#include	<iostream>
+#include	<cstring>
+#include	<cstdlib>
+#include	<cstdio>
+#include	<new>
+#include	<algorithm>
+
+
+namespace
+{
+unsigned long	g_allocations = 0;
+}
+
+void *operator new(std::size_t size)
+{
+	++g_allocations;
+	void *ptr = malloc(size == 0 ? 1 : size);
+	if(ptr == 0) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+	free(ptr);
+}
+
+
+const char *progname;
+
+void usage()
+{
+	std::cerr << "odbcpp:test: fetch-alloc v" << odbcpp::get_version() << "\n";
+	std::cerr << "Usage: " << progname << " [-opts] <dsn> <login> <password> <SQL order>\n";
+	std::cerr << "where -opts is one of the following:\n";
+	std::cerr << "   -h     print out this help screen\n";
+	std::cerr << "   -l     print out license information\n";
+	std::cerr << "   -v     print out the number of allocations of each row\n";
+	exit(1);
+}
+
+
+void license()
+{
+	std::cerr << "odbcpp::fetch-alloc  Copyright (C) 2008  Made to Order Software Corporation\n";
+	std::cerr << "This program comes with ABSOLUTELY NO WARRANTY.\n";
+	std::cerr << "This is free software, and you are welcome to redistribute it under\n";
+	std::cerr << "certain conditions.\n";
+	std::cerr << "Read the COPYING file accompagnying the odbcpp project for more information.\n";
+#ifdef _MSC_VER
+	std::cerr << "\nType return to close the window.\n";
+	getchar();
+#endif
+	exit(1);
+}
+
+
+class string_record_t : public odbcpp::record
+{
+public:
+	string_record_t(SQLSMALLINT cols) :
+		f_columns(cols)
+	{
+		for(SQLSMALLINT col = 0; col < cols; ++col) {
+			bind(col + 1, f_columns[col].f_value, &f_columns[col].f_is_null);
+		}
+	}
+
+private:
+	struct column_t {
+		std::string	f_value;
+		bool		f_is_null;
+	};
+
+	std::vector<column_t>	f_columns;
+};
+
+
+/// Largest reserve of a column string, TEXT columns may report a huge size
+const SQLULEN	MAX_RESERVE = 64 * 1024;
+
+
+/** \brief Count the allocations of the fetches after the first row.
+ *
+ * \param[in] stmt      The statement with the result to read
+ * \param[in] rec       The record receiving the rows
+ * \param[in] dynamic   Whether the columns are read with get()
+ * \param[in] verbose   Whether the allocations of each row are printed
+ *
+ * \return The number of allocations.
+ */
+unsigned long count_allocations(odbcpp::statement& stmt, odbcpp::record_base& rec, bool dynamic, bool verbose)
+{
+	// one string per column, reserved before the measured rows, so
+	// the growth of our own strings is not counted
+	std::vector<std::string> values;
+	if(dynamic) {
+		SQLSMALLINT cols = static_cast<SQLSMALLINT>(stmt.cols());
+		values.resize(cols);
+		for(SQLSMALLINT col = 1; col <= cols; ++col) {
+			SQLULEN size;
+			stmt.describe_col(col, NULL, 0, NULL, NULL, &size, NULL, NULL);
+			// numbers and dates can be a bit longer once converted
+			values[col - 1].reserve(std::min<SQLULEN>(size, MAX_RESERVE) + 64);
+		}
+	}
+
+	unsigned long total = 0;
+	for(unsigned long row = 1;; ++row) {
+		unsigned long start = g_allocations;
+		bool found = stmt.fetch(rec);
+		if(found && dynamic) {
+			odbcpp::dynamic_record& drec(static_cast<odbcpp::dynamic_record&>(rec));
+			for(SQLSMALLINT col = 1; col <= static_cast<SQLSMALLINT>(drec.size()); ++col) {
+				drec.try_get(col, values[col - 1]);
+			}
+		}
+		unsigned long count = g_allocations - start;
+		if(row > 1) {
+			total += count;
+		}
+		if(verbose) {
+			std::cerr << "row " << row << ": " << count << " allocations\n";
+		}
+		if(!found) {
+			return total;
+		}
+	}
+}
+
+
+int main(int argc, char *argv[])
+{
+	int		i;
+	const char	*dsn;
+	const char	*login;
+	const char	*passwd;
+	const char	*order;
+	bool		verbose;
+
+	progname = strrchr(argv[0], '/');
+	if(progname == 0) {
+		progname = argv[0];
+	}
+	else {
+		++progname;
+	}
+
+	dsn = 0;
+	login = 0;
+	passwd = 0;
+	order = 0;
+	verbose = false;
+
+	i = 1;
+	while(i < argc) {
+		if(argv[i][0] == '-') {
+			switch(argv[i][1]) {
+			case 'h':
+				usage();
+				break;
+
+			case 'l':
+				license();
+				break;
+
+			case 'v':
+				verbose = true;
+				break;
+
+			default:
+				std::cerr << argv[0] << ":error: unrecognized option \"-" << argv[i][1] << "\".\n";
+				exit(1);
+
+			}
+			if(argv[i][2]) {
+				std::cerr << argv[0] << ":error: multi-option not supported; try -h.\n";
+				exit(1);
+			}
+		}
+		else if(dsn == 0) {
+			dsn = argv[i];
+		}
+		else if(login == 0) {
+			login = argv[i];
+		}
+		else if(passwd == 0) {
+			passwd = argv[i];
+		}
+		else if(order == 0) {
+			order = argv[i];
+		}
+		else {
+			std::cerr << argv[0] << ":error: too many arguments; try -h.\n";
+			exit(1);
+		}
+		++i;
+	}
+
+	if(order == 0) {
+		std::cerr << "odbc:fetch-alloc:error: the server name, login, password and order are all mandatory parameters.\n";
+		exit(1);
+	}
+
+	unsigned long record_allocations;
+	unsigned long dynamic_allocations;
+	try {
+		odbcpp::environment env;
+		odbcpp::connection conn(env);
+		conn.connect(dsn, login, passwd);
+		odbcpp::statement stmt(conn);
+
+		stmt.execute(order);
+		string_record_t rec(static_cast<SQLSMALLINT>(stmt.cols()));
+		record_allocations = count_allocations(stmt, rec, false, verbose);
+
+		stmt.execute(order);
+		odbcpp::dynamic_record drec;
+		dynamic_allocations = count_allocations(stmt, drec, true, verbose);
+	}
+	catch(odbcpp::odbcpp_error& err) {
+		fflush(stdout);
+		std::cerr << "\nodbcpp:error: " << err.what() << std::endl;
+		std::cerr << "Program Abort.\n";
+		exit(1);
+	}
+
+	std::cout << "record: " << record_allocations << " allocations after the first row\n";
+	std::cout << "dynamic_record: " << dynamic_allocations << " allocations after the first row\n";
+	if(record_allocations != 0 || dynamic_allocations != 0) {
+		std::cerr << progname << ":error: the fetches allocated memory.\n";
+		return 1;
+	}
+
+	return 0;
+}
+
+// vim: ts=8 sw=8
@@ -0,0 +1,543 @@
+//
+// File:	tests/mock-driver.cpp
+// Object:	A minimal in-memory ODBC driver used by "make check"
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+//
+//
+// IMPORTANT NOTE:
+//
+// This file implements the ODBC functions used by the odbcpp library
+// so the tests that need a data source can run without a database.
+// It is linked in the test programs instead of -lodbc.
+//
+// Whatever the SQL order, the result has the following columns and
+// MOCK_ROWS rows:
+//
+//    id          INTEGER          1, 2, 3, ...
+//    name        VARCHAR(32)      "name-1", "name-22", "name-333", ...
+//    note        VARCHAR(16)      NULL on even rows, "note 1", ...
+//
+// The names have various lengths so the strings of the records have
+// to grow on the first rows.
+//
+// The connection and login parameters are ignored. Only column-wise
+// binding and the SQL_FETCH_NEXT, SQL_FETCH_FIRST and SQL_FETCH_ABSOLUTE
+// orientations are supported.
+//
+
+#include	"odbcpp/odbcpp_config.h"
+#include	<sql.h>
+#include	<sqlext.h>
+#include	<cstdio>
+#include	<cstdlib>
+#include	<cstring>
+#include	<map>
+
+
+namespace
+{
+
+/// The number of rows of the result
+const SQLLEN		MOCK_ROWS = 10;
+
+/// The number of columns of the result
+const SQLSMALLINT	MOCK_COLS = 3;
+
+
+struct column_t
+{
+	const char *		f_name;
+	SQLSMALLINT		f_type;
+	SQLULEN			f_size;
+};
+
+const column_t g_columns[MOCK_COLS] =
+{
+	{ "id",   SQL_INTEGER, 10 },
+	{ "name", SQL_VARCHAR, 32 },
+	{ "note", SQL_VARCHAR, 16 }
+};
+
+
+struct binding_t
+{
+	SQLSMALLINT		f_type;
+	SQLPOINTER		f_data;
+	SQLLEN			f_size;
+	SQLLEN *		f_indicator;
+};
+typedef std::map<SQLUSMALLINT, binding_t>	binding_map_t;
+
+
+struct mock_statement_t
+{
+				mock_statement_t() :
+					f_open(false),
+					f_row(0),
+					f_array_size(1),
+					f_rows_fetched(NULL)
+					//f_bindings -- auto-init
+				{
+				}
+
+	bool			f_open;
+	SQLLEN			f_row;		// the next row to fetch, starting at 0
+	SQLULEN			f_array_size;
+	SQLULEN *		f_rows_fetched;
+	binding_map_t		f_bindings;
+};
+
+
+/** \brief Generate the text of a column.
+ *
+ * \param[in] row    The row number, starting at 0
+ * \param[in] col    The column number, starting at 1
+ * \param[out] buf   The buffer receiving the text
+ * \param[in] size   The size of \p buf
+ *
+ * \return false if the column is NULL.
+ */
+bool column_text(SQLLEN row, SQLUSMALLINT col, char *buf, size_t size)
+{
+	switch(col) {
+	case 1:
+		snprintf(buf, size, "%ld", static_cast<long>(row + 1));
+		return true;
+
+	case 2:
+		// 1 to 12 digits so the strings grow
+		{
+			int length = snprintf(buf, size, "name-");
+			for(SQLLEN idx = 0; idx <= row % 12 && length + 1 < static_cast<int>(size); ++idx, ++length) {
+				buf[length] = static_cast<char>('1' + row % 9);
+			}
+			buf[length] = '\0';
+		}
+		return true;
+
+	case 3:
+		if(row % 2 == 1) {
+			return false;
+		}
+		snprintf(buf, size, "note %ld", static_cast<long>(row + 1));
+		return true;
+
+	}
+
+	buf[0] = '\0';
+	return false;
+}
+
+
+/** \brief Copy a row in the bound buffers.
+ *
+ * \param[in] stmt    The statement with the bindings
+ * \param[in] row     The row number, starting at 0
+ * \param[in] index   The position in the rowset
+ *
+ * \return SQL_ERROR if a binding uses an unsupported C type.
+ */
+SQLRETURN copy_row(mock_statement_t *stmt, SQLLEN row, SQLULEN index)
+{
+	for(binding_map_t::const_iterator itr(stmt->f_bindings.begin()); itr != stmt->f_bindings.end(); ++itr) {
+		const binding_t& b(itr->second);
+		char text[64];
+		bool not_null = column_text(row, itr->first, text, sizeof(text));
+		SQLLEN length = static_cast<SQLLEN>(strlen(text));
+		SQLLEN *indicator = b.f_indicator == NULL ? NULL : b.f_indicator + index;
+		switch(b.f_type) {
+		case SQL_C_CHAR:
+			if(not_null) {
+				char *data = reinterpret_cast<char *>(b.f_data) + index * b.f_size;
+				SQLLEN copy = length < b.f_size ? length : b.f_size - 1;
+				memcpy(data, text, copy);
+				data[copy] = '\0';
+			}
+			break;
+
+		case SQL_C_WCHAR:
+			if(not_null) {
+				SQLWCHAR *data = reinterpret_cast<SQLWCHAR *>(reinterpret_cast<char *>(b.f_data) + index * b.f_size);
+				SQLLEN max = b.f_size / static_cast<SQLLEN>(sizeof(SQLWCHAR)) - 1;
+				SQLLEN copy = length < max ? length : max;
+				for(SQLLEN idx = 0; idx < copy; ++idx) {
+					data[idx] = static_cast<SQLWCHAR>(text[idx]);
+				}
+				data[copy] = 0;
+				length *= sizeof(SQLWCHAR);
+			}
+			break;
+
+		case SQL_C_LONG:
+		case SQL_C_SLONG:
+			if(not_null) {
+				reinterpret_cast<SQLINTEGER *>(b.f_data)[index] = static_cast<SQLINTEGER>(strtol(text, NULL, 10));
+				length = sizeof(SQLINTEGER);
+			}
+			break;
+
+		case SQL_C_SBIGINT:
+			if(not_null) {
+				reinterpret_cast<SQLBIGINT *>(b.f_data)[index] = strtoll(text, NULL, 10);
+				length = sizeof(SQLBIGINT);
+			}
+			break;
+
+		default:
+			return SQL_ERROR;
+
+		}
+		if(indicator != NULL) {
+			*indicator = not_null ? length : SQL_NULL_DATA;
+		}
+	}
+
+	return SQL_SUCCESS;
+}
+
+}	// no name namespace
+
+
+// the library expects the C names of the ODBC functions
+extern "C" {
+
+
+SQLRETURN SQL_API SQLAllocHandle(SQLSMALLINT handle_type, SQLHANDLE input_handle, SQLHANDLE *output_handle)
+{
+	(void) input_handle;
+
+	if(handle_type == SQL_HANDLE_STMT) {
+		*output_handle = new mock_statement_t;
+	}
+	else {
+		// the environment and connections have no state
+		*output_handle = new char[1];
+	}
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLFreeHandle(SQLSMALLINT handle_type, SQLHANDLE hdl)
+{
+	if(handle_type == SQL_HANDLE_STMT) {
+		delete reinterpret_cast<mock_statement_t *>(hdl);
+	}
+	else {
+		delete [] reinterpret_cast<char *>(hdl);
+	}
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLFreeStmt(SQLHSTMT hstmt, SQLUSMALLINT option)
+{
+	mock_statement_t *stmt = reinterpret_cast<mock_statement_t *>(hstmt);
+	if(option == SQL_UNBIND) {
+		stmt->f_bindings.clear();
+	}
+	else if(option == SQL_CLOSE) {
+		stmt->f_open = false;
+	}
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLSetEnvAttr(SQLHENV henv, SQLINTEGER attr, SQLPOINTER value, SQLINTEGER length)
+{
+	(void) henv;
+	(void) attr;
+	(void) value;
+	(void) length;
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLDataSources(SQLHENV henv, SQLUSMALLINT direction,
+		SQLCHAR *server_name, SQLSMALLINT server_size, SQLSMALLINT *server_length,
+		SQLCHAR *description, SQLSMALLINT description_size, SQLSMALLINT *description_length)
+{
+	(void) henv;
+	(void) direction;
+	(void) server_name;
+	(void) server_size;
+	(void) server_length;
+	(void) description;
+	(void) description_size;
+	(void) description_length;
+	return SQL_NO_DATA;
+}
+
+
+SQLRETURN SQL_API SQLConnect(SQLHDBC hdbc, SQLCHAR *dsn, SQLSMALLINT dsn_length,
+		SQLCHAR *login, SQLSMALLINT login_length, SQLCHAR *passwd, SQLSMALLINT passwd_length)
+{
+	(void) hdbc;
+	(void) dsn;
+	(void) dsn_length;
+	(void) login;
+	(void) login_length;
+	(void) passwd;
+	(void) passwd_length;
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLDriverConnect(SQLHDBC hdbc, SQLHWND hwnd, SQLCHAR *in, SQLSMALLINT in_length,
+		SQLCHAR *out, SQLSMALLINT out_size, SQLSMALLINT *out_length, SQLUSMALLINT completion)
+{
+	(void) hdbc;
+	(void) hwnd;
+	(void) completion;
+
+	size_t length = in_length == SQL_NTS ? strlen(reinterpret_cast<char *>(in)) : in_length;
+	if(out != NULL && out_size > 0) {
+		size_t copy = length < static_cast<size_t>(out_size) ? length : out_size - 1;
+		memcpy(out, in, copy);
+		out[copy] = '\0';
+	}
+	if(out_length != NULL) {
+		*out_length = static_cast<SQLSMALLINT>(length);
+	}
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLDisconnect(SQLHDBC hdbc)
+{
+	(void) hdbc;
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLSetConnectAttr(SQLHDBC hdbc, SQLINTEGER attr, SQLPOINTER value, SQLINTEGER length)
+{
+	(void) hdbc;
+	(void) attr;
+	(void) value;
+	(void) length;
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLEndTran(SQLSMALLINT handle_type, SQLHANDLE hdl, SQLSMALLINT completion)
+{
+	(void) handle_type;
+	(void) hdl;
+	(void) completion;
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLSetStmtAttr(SQLHSTMT hstmt, SQLINTEGER attr, SQLPOINTER value, SQLINTEGER length)
+{
+	(void) length;
+
+	mock_statement_t *stmt = reinterpret_cast<mock_statement_t *>(hstmt);
+	if(attr == SQL_ATTR_ROW_ARRAY_SIZE) {
+		stmt->f_array_size = reinterpret_cast<SQLULEN>(value);
+	}
+	else if(attr == SQL_ATTR_ROWS_FETCHED_PTR) {
+		stmt->f_rows_fetched = reinterpret_cast<SQLULEN *>(value);
+	}
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLGetStmtAttr(SQLHSTMT hstmt, SQLINTEGER attr, SQLPOINTER value, SQLINTEGER size, SQLINTEGER *length)
+{
+	(void) size;
+	(void) length;
+
+	if(attr == SQL_ATTR_APP_ROW_DESC) {
+		// the descriptor fields are ignored
+		*reinterpret_cast<SQLHDESC *>(value) = hstmt;
+		return SQL_SUCCESS;
+	}
+	return SQL_ERROR;
+}
+
+
+SQLRETURN SQL_API SQLSetDescField(SQLHDESC hdesc, SQLSMALLINT record, SQLSMALLINT field, SQLPOINTER value, SQLINTEGER length)
+{
+	(void) hdesc;
+	(void) record;
+	(void) field;
+	(void) value;
+	(void) length;
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLExecDirect(SQLHSTMT hstmt, SQLCHAR *order, SQLINTEGER length)
+{
+	(void) order;
+	(void) length;
+
+	mock_statement_t *stmt = reinterpret_cast<mock_statement_t *>(hstmt);
+	stmt->f_open = true;
+	stmt->f_row = 0;
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLCancel(SQLHSTMT hstmt)
+{
+	(void) hstmt;
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLCloseCursor(SQLHSTMT hstmt)
+{
+	reinterpret_cast<mock_statement_t *>(hstmt)->f_open = false;
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLNumResultCols(SQLHSTMT hstmt, SQLSMALLINT *cols)
+{
+	(void) hstmt;
+	*cols = MOCK_COLS;
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLRowCount(SQLHSTMT hstmt, SQLLEN *rows)
+{
+	(void) hstmt;
+	*rows = MOCK_ROWS;
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLDescribeCol(SQLHSTMT hstmt, SQLUSMALLINT col, SQLCHAR *name, SQLSMALLINT name_size,
+		SQLSMALLINT *name_length, SQLSMALLINT *type, SQLULEN *size, SQLSMALLINT *decimal_digits, SQLSMALLINT *nullable)
+{
+	(void) hstmt;
+
+	if(col < 1 || col > MOCK_COLS) {
+		return SQL_ERROR;
+	}
+	const column_t& column(g_columns[col - 1]);
+	if(name != NULL && name_size > 0) {
+		strncpy(reinterpret_cast<char *>(name), column.f_name, name_size);
+		name[name_size - 1] = '\0';
+	}
+	if(name_length != NULL) {
+		*name_length = static_cast<SQLSMALLINT>(strlen(column.f_name));
+	}
+	if(type != NULL) {
+		*type = column.f_type;
+	}
+	if(size != NULL) {
+		*size = column.f_size;
+	}
+	if(decimal_digits != NULL) {
+		*decimal_digits = 0;
+	}
+	if(nullable != NULL) {
+		*nullable = col == 3 ? SQL_NULLABLE : SQL_NO_NULLS;
+	}
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLBindCol(SQLHSTMT hstmt, SQLUSMALLINT col, SQLSMALLINT type,
+		SQLPOINTER data, SQLLEN size, SQLLEN *indicator)
+{
+	mock_statement_t *stmt = reinterpret_cast<mock_statement_t *>(hstmt);
+	if(data == NULL) {
+		stmt->f_bindings.erase(col);
+		return SQL_SUCCESS;
+	}
+	binding_t& b(stmt->f_bindings[col]);
+	b.f_type = type;
+	b.f_data = data;
+	b.f_size = size;
+	b.f_indicator = indicator;
+	return SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLFetch(SQLHSTMT hstmt)
+{
+	mock_statement_t *stmt = reinterpret_cast<mock_statement_t *>(hstmt);
+	if(!stmt->f_open) {
+		return SQL_ERROR;
+	}
+
+	SQLULEN count = 0;
+	while(count < stmt->f_array_size && stmt->f_row >= 0 && stmt->f_row < MOCK_ROWS) {
+		if(copy_row(stmt, stmt->f_row, count) != SQL_SUCCESS) {
+			return SQL_ERROR;
+		}
+		++stmt->f_row;
+		++count;
+	}
+	if(stmt->f_rows_fetched != NULL) {
+		*stmt->f_rows_fetched = count;
+	}
+	return count == 0 ? SQL_NO_DATA : SQL_SUCCESS;
+}
+
+
+SQLRETURN SQL_API SQLFetchScroll(SQLHSTMT hstmt, SQLSMALLINT orientation, SQLLEN offset)
+{
+	mock_statement_t *stmt = reinterpret_cast<mock_statement_t *>(hstmt);
+	switch(orientation) {
+	case SQL_FETCH_NEXT:
+		break;
+
+	case SQL_FETCH_FIRST:
+		stmt->f_row = 0;
+		break;
+
+	case SQL_FETCH_ABSOLUTE:
+		stmt->f_row = offset - 1;
+		break;
+
+	default:
+		return SQL_ERROR;
+
+	}
+	return SQLFetch(hstmt);
+}
+
+
+SQLRETURN SQL_API SQLGetDiagField(SQLSMALLINT handle_type, SQLHANDLE hdl, SQLSMALLINT record,
+		SQLSMALLINT identifier, SQLPOINTER info, SQLSMALLINT size, SQLSMALLINT *length)
+{
+	(void) handle_type;
+	(void) hdl;
+	(void) record;
+	(void) identifier;
+	(void) info;
+	(void) size;
+	(void) length;
+
+	// the mock driver does not keep any diagnostic
+	return SQL_NO_DATA;
+}
+
+
+}	// extern "C"
+
+// vim: ts=8 sw=8
@@ -0,0 +1,231 @@
+//
+// File:	tests/rebind.cpp
+// Object:	Verify that a record moved to another statement is left alone
+// Project:	http://www.m2osw.com/odbcpp
+// Author:	alexis_wilke@sourceforge.net
+//
+// Copyright (C)   2008-2011 Made to Order Software Corp.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>
+// or <http://gpl3.m2osw.com/>.
+//
+//
+//
+// IMPORTANT NOTE:
+//
+// This test runs the SQL order on two statements, A and B. A dynamic
+// record fetches the first row of A and is then moved to B with
+// rebind(). Another record, binding only the first column, fetches
+// the next row of A. The buffers of the dynamic record must not
+// change since A must not write in them anymore.
+//
+// Use a SELECT returning at least two different rows with two columns
+// or more, for instance with the table of the record test:
+//
+// rebind <dsn> <login> <password> "SELECT * FROM odbcpp"
+//
+
+#include	"odbcpp/odbcpp.h"
+#include	<iostream>
+#include	<cstring>
+#include	<cstdlib>
+#include	<cstdio>
+
+
+const char *progname;
+
+void usage()
+{
+	std::cerr << "odbcpp:test: rebind v" << odbcpp::get_version() << "\n";
+	std::cerr << "Usage: " << progname << " [-opts] <dsn> <login> <password> <SQL order>\n";
+	std::cerr << "where -opts is one of the following:\n";
+	std::cerr << "   -h     print out this help screen\n";
+	std::cerr << "   -l     print out license information\n";
+	exit(1);
+}
+
+
+void license()
+{
+	std::cerr << "odbcpp::rebind  Copyright (C) 2008  Made to Order Software Corporation\n";
+	std::cerr << "This program comes with ABSOLUTELY NO WARRANTY.\n";
+	std::cerr << "This is free software, and you are welcome to redistribute it under\n";
+	std::cerr << "certain conditions.\n";
+	std::cerr << "Read the COPYING file accompagnying the odbcpp project for more information.\n";
+#ifdef _MSC_VER
+	std::cerr << "\nType return to close the window.\n";
+	getchar();
+#endif
+	exit(1);
+}
+
+
+class first_column_t : public odbcpp::record
+{
+public:
+	first_column_t()
+	{
+		bind(1, f_value, &f_is_null);
+	}
+
+private:
+	std::string	f_value;
+	bool		f_is_null;
+};
+
+
+/** \brief Read all the columns of a dynamic record as strings.
+ *
+ * \param[in] rec   The record to read
+ *
+ * \return The columns, NULL columns are represented by "(null)".
+ */
+std::vector<std::string> read_columns(const odbcpp::dynamic_record& rec)
+{
+	std::vector<std::string> columns;
+	for(SQLSMALLINT col = 1; col <= static_cast<SQLSMALLINT>(rec.size()); ++col) {
+		std::string value;
+		if(rec.try_get(col, value) != odbcpp::odbcpp_error::ODBCPP_NONE) {
+			value = "(null)";
+		}
+		columns.push_back(value);
+	}
+	return columns;
+}
+
+
+int main(int argc, char *argv[])
+{
+	int		i;
+	const char	*dsn;
+	const char	*login;
+	const char	*passwd;
+	const char	*order;
+
+	progname = strrchr(argv[0], '/');
+	if(progname == 0) {
+		progname = argv[0];
+	}
+	else {
+		++progname;
+	}
+
+	dsn = 0;
+	login = 0;
+	passwd = 0;
+	order = 0;
+
+	i = 1;
+	while(i < argc) {
+		if(argv[i][0] == '-') {
+			switch(argv[i][1]) {
+			case 'h':
+				usage();
+				break;
+
+			case 'l':
+				license();
+				break;
+
+			default:
+				std::cerr << argv[0] << ":error: unrecognized option \"-" << argv[i][1] << "\".\n";
+				exit(1);
+
+			}
+			if(argv[i][2]) {
+				std::cerr << argv[0] << ":error: multi-option not supported; try -h.\n";
+				exit(1);
+			}
+		}
+		else if(dsn == 0) {
+			dsn = argv[i];
+		}
+		else if(login == 0) {
+			login = argv[i];
+		}
+		else if(passwd == 0) {
+			passwd = argv[i];
+		}
+		else if(order == 0) {
+			order = argv[i];
+		}
+		else {
+			std::cerr << argv[0] << ":error: too many arguments; try -h.\n";
+			exit(1);
+		}
+		++i;
+	}
+
+	if(order == 0) {
+		std::cerr << "odbc:rebind:error: the server name, login, password and order are all mandatory parameters.\n";
+		exit(1);
+	}
+
+	std::vector<std::string> before;
+	std::vector<std::string> after;
+	try {
+		odbcpp::environment env;
+		odbcpp::connection conn(env);
+		conn.connect(dsn, login, passwd);
+		odbcpp::statement stmt_a(conn);
+		odbcpp::statement stmt_b(conn);
+
+		stmt_a.execute(order);
+		stmt_b.execute(order);
+
+		odbcpp::dynamic_record rec;
+		if(!stmt_a.fetch(rec)) {
+			std::cerr << progname << ":error: the SQL order did not return any row.\n";
+			exit(1);
+		}
+
+		rec.rebind(stmt_b);
+		if(!stmt_b.fetch(rec)) {
+			std::cerr << progname << ":error: the second statement did not return any row.\n";
+			exit(1);
+		}
+		before = read_columns(rec);
+
+		first_column_t first;
+		if(!stmt_a.fetch(first)) {
+			std::cerr << progname << ":error: the SQL order returned only one row.\n";
+			exit(1);
+		}
+		after = read_columns(rec);
+	}
+	catch(odbcpp::odbcpp_error& err) {
+		fflush(stdout);
+		std::cerr << "\nodbcpp:error: " << err.what() << std::endl;
+		std::cerr << "Program Abort.\n";
+		exit(1);
+	}
+
+	int errcnt = 0;
+	for(std::vector<std::string>::size_type col = 0; col < before.size(); ++col) {
+		if(before[col] != after[col]) {
+			std::cerr << progname << ":error: column " << col + 1 << " changed from \""
+					<< before[col] << "\" to \"" << after[col] << "\".\n";
+			++errcnt;
+		}
+	}
+	if(errcnt != 0) {
+		return 1;
+	}
+
+	std::cout << "the " << before.size() << " columns of the rebound record were left alone\n";
+
+	return 0;
+}
+
+// vim: ts=8 sw=8